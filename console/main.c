@@ -14,10 +14,105 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <strsafe.h>
+#include "../engine/pattern.h"
+#include "../engine/extstat.h"
+#include "../engine/agehist.h"
+#include "../engine/dupes.h"
+#include "../engine/engine.h"
+#include "../engine/serve.h"
+#include "../engine/pathidx.h"
+#include "../engine/snap.h"
+#include "../engine/share.h"
+#include "../engine/shard.h"
+#include "../engine/spill.h"
+#include "../engine/search.h"
+#include "../engine/pred.h"
+#include "../engine/colstat.h"
+#include "../engine/export.h"
+#include "../engine/history.h"
+#include "../engine/weigh.h"
+
+#define EXT_ROWS 10     // how many extensions to list for a subfolder
+#define DUPE_ROWS 20    // how many duplicate sets and folders to list
+#define RANK_ROWS 10    // biggest top folders listed, --progressive
+#define GENTLE_RATE 200 // folders opened a second, --gentle
+
+// per folder data kept by the engine hooks, see EngineExtra
+typedef struct _node_extra
+{
+    AGE_HIST    age;        // this folder and all below, for --age
+    EXT_TABLE   ** ext;     // --by-ext=N breakdown, folders at depth N,
+                            // a table per worker, NULL until it has a
+                            // file there; merged when the folder's done
+    UINT        anchor;     // folder at depth N this one counts into
+} NODE_EXTRA;
 
-BOOL IsDotOrTwoDots ( const WCHAR * src );
 BOOL IsConsoleRedirected ( void );
-__int64 FolderSize  ( const WCHAR * fpath, UINT_PTR max_depth );
+void OnEnter ( void * ctx, UINT worker, UINT node );
+void OnFile ( void * ctx, UINT worker, UINT node, const WCHAR * dir,
+    const WIN32_FIND_DATAW * fd );
+void OnRollup ( void * ctx, UINT node, UINT parent );
+void OnFinal ( void * ctx, UINT node );
+void OnRound ( void * ctx, UINT levels );
+void PrintExtTable ( const EXT_TABLE * et, UINT max_rows );
+UINT AgePct ( const __int64 * buckets, UINT bucket, __int64 size );
+void PrintDupes ( DUPE_LIST * dl );
+void PrintRoots ( const ENGINE * eng );
+void FormatKB ( __int64 size, WCHAR * dest, UINT cch );
+int ServeFolders ( WCHAR ** roots, int nroots, UINT depth );
+int AskServer ( UINT op, UINT count, const WCHAR * path );
+BOOL SaveSnapshot ( const ENGINE * eng, const WCHAR * fname, UINT64 scanned );
+int QuerySnapshot ( int argc, WCHAR ** argv );
+BOOL QueryPath ( const SNAPSHOT * snap, const WCHAR * path );
+int QueryGrep ( const SNAPSHOT * snap, int argc, WCHAR ** argv );
+BOOL WhereCompile ( PRED * pr, const WCHAR * expr );
+int QueryWhere ( PRED * pr, const ENGINE * eng );
+int QueryStats ( PRED * pr, const ENGINE * eng );
+int QueryExport ( PRED * pr, const ENGINE * eng, const WCHAR * fname );
+void PrintPrevious ( const ENGINE * eng, const SNAPSHOT * prev );
+int ViewShared ( const WCHAR * name );
+BOOL OnSubdir ( void * ctx, UINT node, const WCHAR * name );
+UINT OnWeigh ( void * ctx, UINT worker, UINT node, const WCHAR * name );
+int MergeSnapshots ( int argc, WCHAR ** argv );
+int ShowHistory ( int argc, WCHAR ** argv );
+
+PAT_FILTER  gFilter;        // --exclude / --include globs
+BOOL        gByExt;         // --by-ext, extension histogram wanted
+UINT_PTR    gExtDepth;      // --by-ext=N, also break down folders at N
+BOOL        gAge;           // --age, file age histograms per folder
+__int64     gNow;           // scan start time, to age files against
+BOOL        gDupes;         // --dupes, look for duplicate files
+DUPE_LIST   gDupeList;      // every file big enough to be a dupe
+DUPE_LIST   gDupeWk[ENG_MAX_THREADS]; // the same, one per worker
+BOOL        gServe;         // --serve, keep the trees and answer --ask
+UINT        gAskOp;         // --ask, PROTO_xxx request to send
+UINT        gAskCount;      // --ask top=N
+WCHAR       * gSave;        // --save, snapshot file to write
+WCHAR       * gPrev;        // --prev, snapshot of the last walk
+WCHAR       * gHistory;     // --history, file the --save one goes into
+SNAPSHOT    gPrevSnap;      // the same, mapped, if it could be opened
+WCHAR       * gShareName;   // --share, publish the walk under this name
+SHARE       gShare;         // the section it's published in
+UINT        gShardIndex;    // --shard i/N[:depth], 1 based
+UINT        gShardCount;
+UINT        gShardDepth;
+SHARD_PLAN  gShard;         // which folders at the cut are ours
+BOOL        gArchives;      // --archives, walk into .zip/.tar/.tar.gz
+BOOL        gProgressive;   // --progressive, level by level, ranked
+BOOL        gInOrder;       // --in-order, not heaviest first by --prev
+WEIGHER     gWeigh;         // what the --prev folders weigh, otherwise
+BOOL        gTiming;        // --timing, how long the walk took
+BOOL        gGentle;        // --gentle[=N], background priority and
+UINT        gGentleRate;    // at most N folders a second (0, no limit)
+UINT64      gMemLimit;      // --mem-limit, in bytes, 0 for none
+SPILL       gSpill;         // where the finished folders go then
+PRED        gWhere;         // --where, folders to list after the walk
+BOOL        gWhereOn;
+ENGINE      gEngine;        // the crawler
+BOOL        gRedirected;    // output goes to a file, don't chop paths
+CRITICAL_SECTION gOutLock;  // hooks run on all workers, one at a time
+                            // gets to print or touch shared tables
+EXT_TABLE   gExt[ENG_MAX_THREADS]; // --by-ext totals, one per worker
 
 /*-@@+@@--------------------------------------------------------------------*/
 //       Function: wmain 
@@ -35,39 +130,364 @@ int wmain ( int argc, WCHAR ** argv )
 /*--------------------------------------------------------------------------*/
 {
     UINT_PTR                    barlen;
-    INT_PTR                     iterations, idx;
+    INT_PTR                     iterations;
+    int                         i, nroots;
+    UINT                        w;
     WCHAR                       bar[128];
+    WCHAR                       run[ENG_MAX_PATH];
+    WCHAR                       * roots[ENG_MAX_ROOTS];
+    WCHAR                       * depth;
     HANDLE                      hStdout;
     CONSOLE_SCREEN_BUFFER_INFO  csbiInfo;
     WORD                        wOldColorAttrs;
+    FILETIME                    ftStart;
+    LARGE_INTEGER               freq, t0, t1;
+    BOOL                        ok;
+
+    // fsize query <snapshot> <folder>..., nothing else to set up
+    if ( argc >= 4 && lstrcmpiW ( argv[1], L"query" ) == 0 )
+        return QuerySnapshot ( argc - 2, argv + 2 );
+
+    // fsize view <name>, follow a walk published with --share
+    if ( argc == 3 && lstrcmpiW ( argv[1], L"view" ) == 0 )
+        return ViewShared ( argv[2] );
+
+    // fsize merge <snapshot> <part>..., the shards' snapshots into one
+    if ( argc >= 4 && lstrcmpiW ( argv[1], L"merge" ) == 0 )
+        return MergeSnapshots ( argc - 2, argv + 2 );
+
+    // fsize history [add | compact] <file> ..., sizes over the scans
+    if ( argc >= 4 && lstrcmpiW ( argv[1], L"history" ) == 0 )
+        return ShowHistory ( argc - 2, argv + 2 );
+
+    PatFilterInit ( &gFilter );
+    DupeListInit ( &gDupeList, 1 );
+
+    nroots  = 0;
+    depth   = NULL;
+
+    // sort out options from the folder paths and depth
+    for ( i = 1; i < argc; i++ )
+    {
+        if ( ( lstrcmpiW ( argv[i], L"--exclude" ) == 0 ||
+               lstrcmpiW ( argv[i], L"--include" ) == 0 ) && i+1 < argc )
+        {
+            if ( !PatFilterAdd ( &gFilter, argv[i+1], 
+                    ( argv[i][2] == L'i' || argv[i][2] == L'I' ) ) )
+            {
+                fwprintf ( stderr, L"Bad or too many patterns: %ls\n", 
+                    argv[i+1] );
+
+                return 1;
+            }
+
+            i++;
+        }
+        else if ( lstrcmpiW ( argv[i], L"--age" ) == 0 )
+            gAge = TRUE;
+        else if ( lstrcmpiW ( argv[i], L"--archives" ) == 0 )
+            gArchives = TRUE;
+        else if ( lstrcmpiW ( argv[i], L"--progressive" ) == 0 )
+            gProgressive = TRUE;
+        else if ( lstrcmpiW ( argv[i], L"--in-order" ) == 0 )
+            gInOrder = TRUE;
+        else if ( lstrcmpiW ( argv[i], L"--timing" ) == 0 )
+            gTiming = TRUE;
+        else if ( lstrcmpiW ( argv[i], L"--save" ) == 0 && i+1 < argc )
+            gSave = argv[++i];
+        else if ( lstrcmpiW ( argv[i], L"--prev" ) == 0 && i+1 < argc )
+            gPrev = argv[++i];
+        else if ( lstrcmpiW ( argv[i], L"--history" ) == 0 && i+1 < argc )
+            gHistory = argv[++i];
+        else if ( lstrcmpiW ( argv[i], L"--where" ) == 0 && i+1 < argc )
+        {
+            if ( !WhereCompile ( &gWhere, argv[++i] ) )
+                return 1;
+
+            gWhereOn = TRUE;
+        }
+        else if ( lstrcmpiW ( argv[i], L"--share" ) == 0 && i+1 < argc )
+            gShareName = argv[++i];
+        else if ( lstrcmpiW ( argv[i], L"--mem-limit" ) == 0 && i+1 < argc )
+        {
+            gMemLimit = _wcstoui64 ( argv[++i], NULL, 10 ) << 20;
+
+            if ( gMemLimit == 0 )
+            {
+                fwprintf ( stderr, L"Bad memory limit %ls, want MB\n",
+                    argv[i] );
+
+                return 1;
+            }
+        }
+        else if ( lstrcmpiW ( argv[i], L"--shard" ) == 0 && i+1 < argc )
+        {
+            i++;
+            gShardDepth = 1;
+
+            if ( swscanf ( argv[i], L"%u/%u:%u", &gShardIndex, 
+                    &gShardCount, &gShardDepth ) < 2 || gShardIndex == 0 ||
+                    gShardIndex > gShardCount || gShardCount > SHARD_MAX ||
+                    gShardDepth == 0 )
+            {
+                fwprintf ( stderr, L"Bad shard %ls, want i/N[:depth] with "
+                    L"1 <= i <= N <= %u\n", argv[i], SHARD_MAX );
+
+                return 1;
+            }
+        }
+        else if ( lstrcmpiW ( argv[i], L"--serve" ) == 0 )
+            gServe = TRUE;
+        else if ( lstrcmpiW ( argv[i], L"--ask" ) == 0 && i+1 < argc )
+        {
+            i++;
+
+            if ( lstrcmpiW ( argv[i], L"size" ) == 0 )
+                gAskOp = PROTO_SIZE;
+            else if ( lstrcmpiW ( argv[i], L"children" ) == 0 )
+                gAskOp = PROTO_CHILDREN;
+            else if ( _wcsnicmp ( argv[i], L"top", 3 ) == 0 )
+            {
+                gAskOp      = PROTO_TOP;
+                gAskCount   = ( argv[i][3] == L'=' ) ? 
+                    wcstoul ( argv[i]+4, NULL, 10 ) : 20;
+            }
+            else if ( lstrcmpiW ( argv[i], L"scan" ) == 0 )
+                gAskOp = PROTO_SCAN;
+            else if ( lstrcmpiW ( argv[i], L"drop" ) == 0 )
+                gAskOp = PROTO_DROP;
+            else if ( lstrcmpiW ( argv[i], L"quit" ) == 0 )
+                gAskOp = PROTO_QUIT;
+            else
+            {
+                fwprintf ( stderr, L"Don't know how to ask %ls\n", argv[i] );
+                return 1;
+            }
+        }
+        else if ( wcsncmp ( argv[i], L"--dupes", 7 ) == 0 )
+        {
+            gDupes = TRUE;
+
+            if ( argv[i][7] == L'=' )
+                DupeListInit ( &gDupeList, _wcstoi64 ( argv[i]+8, NULL, 10 ) );
+        }
+        else if ( wcsncmp ( argv[i], L"--gentle", 8 ) == 0 )
+        {
+            gGentle     = TRUE;
+            gGentleRate = GENTLE_RATE;
+
+            if ( argv[i][8] == L'=' )
+                gGentleRate = wcstoul ( argv[i]+9, NULL, 10 );
+        }
+        else if ( wcsncmp ( argv[i], L"--by-ext", 8 ) == 0 )
+        {
+            gByExt = TRUE;
+
+            if ( argv[i][8] == L'=' )
+                gExtDepth = wcstoul ( argv[i]+9, NULL, 10 );
+        }
+        // a bare number after the folders is the depth, unless it's a
+        // folder that's there (say .\2024)
+        else if ( nroots != 0 && i == argc - 1 &&
+                    wcsspn ( argv[i], L"0123456789" ) == wcslen ( argv[i] ) &&
+                    GetFileAttributesW ( argv[i] ) == INVALID_FILE_ATTRIBUTES )
+            depth = argv[i];
+        else if ( nroots < ENG_MAX_ROOTS )
+            roots[nroots++] = argv[i];
+    }
 
-    if ( argc < 2 )
+    if ( nroots == 0 && !gServe && gAskOp != PROTO_QUIT )
     {
         fwprintf ( stderr, 
             L"\n*** fsize v1.0, copyright (c) 2022"
                 L" by Adrian Petrila, YO3GFH ***\n\n"
             L"Prints folder size, along with each subfolder, "
                 L"if any. By default, recurses %u folder levels "
-            L"unless told otherwise by the second parameter. "
-                L"A value of 1 disables recursion\n\n"
-            L"\tUsage: fsize <full folder path> [max. recursions]\n\n", 
+            L"unless told otherwise by the last parameter, a "
+                L"number that is not also a folder there. A value of "
+            L"1 disables recursion. Several folders are scanned at "
+                L"the same time, folders inside other ones given are "
+            L"counted only once.\n\n"
+            L"\tUsage: fsize [options] <full folder path> "
+                L"[more folders...] [max. recursions]\n"
+            L"\t       fsize query <snapshot> <folder | -> [more "
+                L"folders...]\n"
+            L"\t       fsize query <snapshot> --grep <text> [more "
+                L"texts...]\n"
+            L"\t       fsize query <snapshot> --where <expression>\n"
+            L"\t       fsize query <snapshot> --stats [<expression>]\n"
+            L"\t       fsize query <snapshot> --export <file.csv|tsv|json> "
+                L"[<expression>]\n"
+            L"\t       fsize view <name>\n"
+            L"\t       fsize merge <snapshot> <part snapshot> [more "
+                L"parts...]\n"
+            L"\t       fsize history <file> <folder> [days]\n"
+            L"\t       fsize history add <file> <snapshot>\n"
+            L"\t       fsize history compact <file> <snapshot> [days]\n\n"
+            L"\t--exclude <globs>  skip matching files and folders "
+                L"(folders are not even opened)\n"
+            L"\t--include <globs>  count only matching files\n"
+            L"\t--by-ext[=depth]   size by file extension, for the root "
+                L"folder and, if asked,\n"
+            L"\t                   for each folder at the given depth\n"
+            L"\t--age              share of each folder's bytes not "
+                L"modified (m) and not\n"
+            L"\t                   accessed (a) for 30, 90 and 365 days\n"
+            L"\t--dupes[=minsize]  find duplicate files (of at least "
+                L"minsize bytes) and how\n"
+            L"\t                   much space deleting the extra copies "
+                L"would free\n"
+            L"\t--archives         count .zip, .tar and .tar.gz files as "
+                L"folders, from their\n"
+            L"\t                   headers, with the unpacked sizes\n"
+            L"\t--progressive      walk level by level, listing the "
+                L"biggest top folders so\n"
+            L"\t                   far after each\n"
+            L"\t--save <file>      write a snapshot of the tree, for "
+                L"fsize query\n"
+            L"\t--prev <file>      show the roots as of an older "
+                L"snapshot first, then each\n"
+            L"\t                   folder's change since (defaults to "
+                L"the --save file); the\n"
+            L"\t                   folders that had the most below them "
+                L"are walked first\n"
+            L"\t--in-order         don't, walk in the order found\n"
+            L"\t--timing           how long the walk took, and how much "
+                L"of it the workers\n"
+            L"\t                   spent waiting for a folder\n"
+            L"\t--gentle[=N]       low I/O and CPU priority, at most N "
+                L"folders opened a\n"
+            L"\t                   second (200, 0 for no limit), fewer "
+                L"while the disk is busy\n"
+            L"\t--history <file>   add the --save snapshot to a history "
+                L"of folder sizes,\n"
+            L"\t                   for fsize history\n"
+            L"\t--where <expr>     list the folders matching, e.g. "
+                L"\"size>10G age>1y depth>2\n"
+            L"\t                   path:d:\\proj name:*.git\" (also "
+                L"own, files, dirs, or, not)\n"
+            L"\t--share <name>     publish the walk as it goes, for "
+                L"fsize view <name>\n"
+            L"\t--mem-limit <MB>   keep the tree under MB of memory, "
+                L"finished folders go to\n"
+            L"\t                   a file next to the --save one "
+                L"until the snapshot is written\n"
+            L"\t--shard i/N[:d]    walk only the i-th of N shares of the "
+                L"folders at depth d\n"
+            L"\t                   (1), balanced by the --prev snapshot "
+                L"if given; fsize merge\n"
+            L"\t                   puts the shards' --save snapshots "
+                L"together\n"
+            L"\t--serve            stay resident, keep the folders given "
+                L"(and any asked about\n"
+            L"\t                   later) in memory and answer --ask\n"
+            L"\t--ask <what>       ask the resident fsize about a folder: "
+                L"size, children,\n"
+            L"\t                   top[=N] (biggest below it), scan (walk "
+                L"it again), drop\n"
+            L"\t                   (forget it) or quit (stop the server)"
+                L"\n\n"
+            L"\tGlobs are separated by ';' and may use * ? [a-z] [!a-z]. "
+                L"A glob holding a \\ or / is\n"
+            L"\tmatched against the path relative to the root folder, "
+                L"otherwise against the name.\n\n", 
             MAX_DEPTH );
 
         return 1;
     }
 
-    // argc = 2, default case 
+    // default case 
     iterations = MAX_DEPTH;
 
-    if ( argc > 2 )
+    if ( depth != NULL )
     {
-        iterations = wcstoul ( argv[2], NULL, 10 );
+        iterations = wcstoul ( depth, NULL, 10 );
 
-        // some bogus value for argv[2]
+        // some bogus value for depth
         if ( ( iterations < 1 ) || ( iterations > MAX_DEPTH ) )
             iterations = MAX_DEPTH;  
     }
 
+    if ( gAskOp != 0 )
+        return AskServer ( gAskOp, gAskCount, nroots ? roots[0] : NULL );
+
+    if ( gServe )
+        return ServeFolders ( roots, nroots, (UINT)iterations );
+
+    // the spilled folders only come back in the snapshot, and a viewer
+    // would see their slots taken by others
+    if ( gMemLimit != 0 && ( gSave == NULL || gShareName != NULL ||
+            gProgressive ) )
+    {
+        fwprintf ( stderr, L"--mem-limit needs --save, and can't go with "
+            L"--share or --progressive\n" );
+
+        return 1;
+    }
+
+    if ( gHistory != NULL && gSave == NULL )
+    {
+        fwprintf ( stderr, L"--history needs --save\n" );
+        return 1;
+    }
+
+    // per folder data only if some option needs it
+    if ( !EngineInit ( &gEngine, 0, (UINT)iterations, 
+            ( gAge || ( gByExt && gExtDepth ) ) ? sizeof ( NODE_EXTRA ) : 0 ) )
+    {
+        fwprintf ( stderr, L"Out of memory!\n" );
+        return 1;
+    }
+
+    // NODE_EXTRA starts with it, so --save and the run file keep it
+    gEngine.age = gAge;
+
+    for ( i = 0; i < nroots; i++ )
+        if ( EngineAddRoot ( &gEngine, roots[i] ) < 0 )
+        {
+            fwprintf ( stderr, L"Out of memory!\n" );
+            return 1;
+        }
+
+    // before any node is made, the columns move into the section
+    if ( gShareName != NULL && !ShareCreate ( &gShare, &gEngine, 
+            gShareName ) )
+    {
+        fwprintf ( stderr, L"Can't publish the walk as %ls\n", gShareName );
+        return 1;
+    }
+
+    if ( gMemLimit != 0 && ( FAILED ( StringCchPrintfW ( run,
+            ARRAYSIZE(run), L"%ls.run", gSave ) ) ||
+            !SpillInit ( &gSpill, &gEngine, gMemLimit, run ) ) )
+    {
+        fwprintf ( stderr, L"Can't make the run file %ls.run\n", gSave );
+        return 1;
+    }
+
+    if ( PatFilterActive ( &gFilter ) )
+        gEngine.filter = &gFilter;
+
+    // out of the way of whatever else the machine is doing
+    if ( gGentle )
+    {
+        SetPriorityClass ( GetCurrentProcess(), BELOW_NORMAL_PRIORITY_CLASS );
+        gEngine.gentle.background   = TRUE;
+        gEngine.gentle.rate         = gGentleRate;
+    }
+
+    gEngine.archives        = gArchives;
+    gEngine.breadth         = gProgressive;
+    gEngine.hooks.on_round  = gProgressive ? OnRound : NULL;
+    gEngine.hooks.on_enter  = ( gByExt && gExtDepth ) ? OnEnter : NULL;
+    gEngine.hooks.on_subdir = ( gShardCount > 1 ) ? OnSubdir : NULL;
+    gEngine.hooks.on_file   = ( gByExt || gAge || gDupes ) ? OnFile : NULL;
+    gEngine.hooks.on_rollup = gAge ? OnRollup : NULL;
+    gEngine.hooks.on_final  = OnFinal;
+
+    gRedirected = IsConsoleRedirected();
+    InitializeCriticalSection ( &gOutLock );
+
     barlen = 78; // console width
     bar[barlen] = L'\0';
 
@@ -87,7 +507,10 @@ int wmain ( int argc, WCHAR ** argv )
     SetConsoleTextAttribute ( hStdout, FOREGROUND_GREEN |
         FOREGROUND_INTENSITY );
 
-    fwprintf ( stdout, L"[%ls]", argv[1] );
+    if ( nroots > 1 )
+        fwprintf ( stdout, L"[%ls] (+%d more)", roots[0], nroots - 1 );
+    else
+        fwprintf ( stdout, L"[%ls]", roots[0] );
     
     SetConsoleTextAttribute ( hStdout, wOldColorAttrs );
 
@@ -103,137 +526,1769 @@ int wmain ( int argc, WCHAR ** argv )
     fwprintf ( stdout, L" folder depth levels...\n" );
     fwprintf ( stdout, L"%ls\n", bar );
 
-    idx = lstrlenW ( argv[1] );
+    // the last known sizes are up at once, the walk then brings
+    // each folder's fresh one along with the change
+    if ( gPrev == NULL && gShardCount <= 1 )
+        gPrev = gSave;
+
+    if ( gPrev != NULL && SnapOpen ( &gPrevSnap, gPrev ) )
+    {
+        PrintPrevious ( &gEngine, &gPrevSnap );
+        fwprintf ( stdout, L"%ls\n", bar );
+
+        // the big subtrees of last time go first, so the walk doesn't
+        // end with one worker deep in one and the rest idle
+        if ( !gInOrder )
+        {
+            WeighInit ( &gWeigh, &gPrevSnap );
+            gEngine.longest         = TRUE;
+            gEngine.hooks.on_weigh  = OnWeigh;
+        }
+    }
+
+    // every shard plans the same from the same snapshot
+    if ( gShardCount != 0 )
+    {
+        if ( !ShardPlanInit ( &gShard, gShardIndex - 1, gShardCount,
+                gShardDepth, &gPrevSnap ) )
+        {
+            fwprintf ( stderr, L"Out of memory!\n" );
+            return 1;
+        }
+
+        fwprintf ( stdout, L" Shard %u of %u, split at depth %u%ls\n%ls\n",
+            gShardIndex, gShardCount, gShardDepth, ( gShard.owner != NULL ) ?
+            L", balanced by the snapshot" : L"", bar );
+    }
+
+    if ( gAge )
+    {
+        fwprintf ( stdout, L"%-*ls %*ls    m>30d >90d >1y | "
+            L"a>30d >90d >1y\n", MAX_LEN, L"", 18, L"" );
+
+        gNow = AgeNow();
+    }
+
+    if ( gByExt )
+        for ( w = 0; w < gEngine.threads; w++ )
+            if ( !ExtTableInit ( &gExt[w] ) )
+            {
+                fwprintf ( stderr, L"Out of memory!\n" );
+                return 1;
+            }
+
+    // each worker keeps its own, joined once the walk is over
+    if ( gDupes )
+        for ( w = 0; w < gEngine.threads; w++ )
+            DupeListInit ( &gDupeWk[w], gDupeList.min_size );
+
+    GetSystemTimeAsFileTime ( &ftStart );
+
+    QueryPerformanceFrequency ( &freq );
+    QueryPerformanceCounter ( &t0 );
+
+    ok = EngineRun ( &gEngine );
+
+    QueryPerformanceCounter ( &t1 );
+    ShareDone ( &gShare, &gEngine, ok );
+
+    // done with it, and it may well be the file --save replaces
+    ShardPlanFree ( &gShard );
+    SnapClose ( &gPrevSnap );
+
+    if ( !ok )
+        fwprintf ( stderr, L"Out of memory, results are partial!\n" );
+    else if ( gSave != NULL && !SaveSnapshot ( &gEngine, gSave, 
+            ( (UINT64)ftStart.dwHighDateTime << 32 ) | ftStart.dwLowDateTime ) )
+        fwprintf ( stderr, L"Can't write snapshot %ls\n", gSave );
+    else if ( gHistory != NULL && !HistAdd ( gHistory, gSave, NULL ) )
+        fwprintf ( stderr, L"Can't add the snapshot to history %ls\n",
+            gHistory );
+
+    if ( gSpill.spills != 0 )
+        fwprintf ( stdout, L"%ls\n Over the memory limit, %u subtrees "
+            L"(%llu folders, %llu MB) went to the run file\n", bar,
+            gSpill.spills, gSpill.nodes, gSpill.len >> 20 );
+
+    if ( gSpill.failed )
+        fwprintf ( stderr, L"Can't write the run file, the memory limit "
+            L"was exceeded\n" );
+
+    // idle time is all the workers', the walk's is the wall clock's
+    if ( gTiming && t1.QuadPart > t0.QuadPart )
+        fwprintf ( stdout, L"%ls\n Walked in %.3f s%ls, the %u workers "
+            L"waited for a folder %.1f%% of it\n", bar,
+            (double)( t1.QuadPart - t0.QuadPart ) / freq.QuadPart,
+            gEngine.longest ? L", heaviest first" : L"", gEngine.threads,
+            100.0 * gEngine.idle / ( (double)( t1.QuadPart - t0.QuadPart ) *
+            gEngine.threads ) );
+
+    // what the rate came to, to tune --gentle=N by
+    if ( gGentle && gGentleRate != 0 )
+        fwprintf ( stdout, L"%ls\n Gentle: %u folders a second (at most "
+            L"%u), backed off %u times, down to %u\n", bar,
+            EngineRate ( &gEngine ), gGentleRate, gEngine.gentle.backoffs,
+            gEngine.gentle.lowest );
+    else if ( gGentle )
+        fwprintf ( stdout, L"%ls\n Gentle: %u folders a second\n", bar,
+            EngineRate ( &gEngine ) );
+
+    if ( nroots > 1 )
+    {
+        fwprintf ( stdout, L"%ls\n", bar );
+        PrintRoots ( &gEngine );
+    }
+
+    if ( gByExt )
+    {
+        for ( w = 1; w < gEngine.threads; w++ )
+        {
+            ExtTableMerge ( &gExt[0], &gExt[w] );
+            ExtTableFree ( &gExt[w] );
+        }
+
+        fwprintf ( stdout, L"%ls\n By extension:\n", bar );
+        PrintExtTable ( &gExt[0], (UINT)-1 );
+        ExtTableFree ( &gExt[0] );
+    }
+
+    if ( gDupes )
+    {
+        for ( w = 0; w < gEngine.threads; w++ )
+        {
+            if ( !DupeListMerge ( &gDupeList, &gDupeWk[w] ) )
+                fwprintf ( stderr, L"Out of memory!\n" );
+
+            DupeListFree ( &gDupeWk[w] );
+        }
+
+        fwprintf ( stdout, L"%ls\n", bar );
+        PrintDupes ( &gDupeList );
+        DupeListFree ( &gDupeList );
+    }
+
+    // a walk that spilled only has all its folders in the snapshot
+    if ( gWhereOn && ok )
+    {
+        fwprintf ( stdout, L"%ls\n", bar );
+
+        if ( gEngine.spill == NULL )
+            QueryWhere ( &gWhere, &gEngine );
+        else if ( SnapOpen ( &gPrevSnap, gSave ) )
+        {
+            QueryWhere ( &gWhere, &gPrevSnap.eng );
+            SnapClose ( &gPrevSnap );
+        }
+        else
+            fwprintf ( stderr, L"Can't open snapshot %ls\n", gSave );
+    }
 
-    if ( argv[1][idx-1] == L'\\' )
-        argv[1][idx-1] = L'\0';
+    PredFree ( &gWhere );
 
-    FolderSize ( argv[1], iterations );
+    EngineFree ( &gEngine );
+    SpillFree ( &gSpill );
+    ShareFree ( &gShare );
+    DeleteCriticalSection ( &gOutLock );
 
     return 0;
 }
 
 /*-@@+@@--------------------------------------------------------------------*/
-//       Function: FolderSize 
+//       Function: OnEnter 
 /*--------------------------------------------------------------------------*/
-//           Type: __int64 
-//    Param.    1: const WCHAR * fpath: path to folder to calculate size
-//    Param.    2: UINT_PTR max_depth : max. number of recursions
+//           Type: void 
+//    Param.    1: void * ctx  : unused
+//    Param.    2: UINT worker : worker thread index
+//    Param.    3: UINT node   : folder about to be enumerated
 /*--------------------------------------------------------------------------*/
 //         AUTHOR: Adrian Petrila, YO3GFH
-//           DATE: 04.09.2022
-//    DESCRIPTION: takes a folder path as an argument and recursively goes 
-//                 from there calculating each subfolder size, up to a
-//                 maximum of max_depth iterations (folder in folder depth).
-//                 Returns folder size, in bytes, or 0 on error.
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine hook, only for --by-ext=N. Folders at depth N get
+//                 their own histograms, one per worker, the ones below
+//                 point to them. The parent is always entered before its
+//                 subfolders.
 /*--------------------------------------------------------------------@@-@@-*/
-__int64 FolderSize ( const WCHAR * fpath, UINT_PTR max_depth )
+void OnEnter ( void * ctx, UINT worker, UINT node )
 /*--------------------------------------------------------------------------*/
 {
-    WIN32_FIND_DATA ffData;
-    HANDLE          hFind;
-    __int64         size;
-    static UINT_PTR depth;
-    WCHAR           buf[1024];
-    WCHAR           tmp[1024];
-    WCHAR           s[128], f[128];
-    LARGE_INTEGER   li;
+    NODE_EXTRA  * ne, * pe;
+    UINT        parent;
 
-    if ( fpath == NULL )
-        return 0;
+    ne      = EngineExtra ( &gEngine, node );
+    parent  = gEngine.parent[node];
+
+    ne->anchor = ENG_NONE;
+
+    if ( gEngine.depth[node] == gExtDepth )
+    {
+        ne->ext = calloc ( gEngine.threads, sizeof ( EXT_TABLE * ) );
+
+        if ( ne->ext != NULL )
+            ne->anchor = node;
+    }
+    else if ( parent != ENG_NONE )
+    {
+        pe          = EngineExtra ( &gEngine, parent );
+        ne->anchor  = pe->anchor;
+    }
+}
 
-    size = 0;
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnFile 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: void * ctx                  : unused
+//    Param.    2: UINT worker                 : worker thread index
+//    Param.    3: UINT node                   : folder holding the file
+//    Param.    4: const WCHAR * dir           : its full path
+//    Param.    5: const WIN32_FIND_DATAW * fd : the file
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine hook, feeds the file to --by-ext, --age and
+//                 --dupes. Everything goes to the worker's own tables and
+//                 lists, no lock is taken.
+/*--------------------------------------------------------------------@@-@@-*/
+void OnFile ( void * ctx, UINT worker, UINT node, const WCHAR * dir,
+    const WIN32_FIND_DATAW * fd )
+/*--------------------------------------------------------------------------*/
+{
+    NODE_EXTRA      * ne, * ae;
+    EXT_TABLE       * et;
+    LARGE_INTEGER   li;
+    WCHAR           buf[ENG_MAX_PATH];
 
-    StringCchCopyW ( buf, ARRAYSIZE(buf), fpath );
-    StringCchCopyW ( tmp, ARRAYSIZE(tmp), fpath );
-    StringCchCatW ( buf, ARRAYSIZE(buf), L"\\*" );
+    li.u.HighPart   = fd->nFileSizeHigh;
+    li.u.LowPart    = fd->nFileSizeLow;
 
-    // start enumerating
-    hFind = FindFirstFileExW ( buf, FindExInfoStandard, &ffData, 
-        FindExSearchNameMatch, NULL, 0 );
+    ne = EngineExtra ( &gEngine, node );
 
-    if ( hFind != INVALID_HANDLE_VALUE )
+    if ( gByExt )
     {
-        do
+        ExtTableAdd ( &gExt[worker], fd->cFileName, li.QuadPart );
+
+        if ( gExtDepth && ne->anchor != ENG_NONE )
         {
-            // do we have a folder?
-            if ( ffData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+            ae = EngineExtra ( &gEngine, ne->anchor );
+            et = ae->ext[worker];
+
+            if ( et == NULL )
             {
-                // skip . and .. (crt and parent folder)
-                if ( !IsDotOrTwoDots ( ffData.cFileName ) )
+                et = malloc ( sizeof ( EXT_TABLE ) );
+
+                if ( et != NULL && !ExtTableInit ( et ) )
                 {
-                    // complete path with folder name
-                    StringCchCopyW ( buf+lstrlenW(fpath)+1, 
-                        ARRAYSIZE(buf), ffData.cFileName );
-
-                    depth++;
-                    // do recursion!
-                    size += FolderSize ( buf, max_depth );
-                    depth--;
+                    free ( et );
+                    et = NULL;
                 }
+
+                ae->ext[worker] = et;
             }
-            else // just files
-            {
-                li.u.HighPart = ffData.nFileSizeHigh;
-                li.u.LowPart = ffData.nFileSizeLow;
-                size += li.QuadPart;
-            }
+
+            if ( et != NULL )
+                ExtTableAdd ( et, fd->cFileName, li.QuadPart );
         }
+    }
+
+    // only this worker touches the folder until it's enumerated
+    if ( gAge )
+        AgeHistAdd ( &ne->age, gNow, &fd->ftLastWriteTime,
+            &fd->ftLastAccessTime, li.QuadPart );
+
+    // only remember it here, nothing is read until the
+    // crawl is over and the sizes are all known
+    if ( gDupes )
+    {
+        StringCchPrintfW ( buf, ARRAYSIZE(buf), L"%ls\\%ls", 
+            dir, fd->cFileName );
 
-        // stop if max. level of folder imbrication reached
-        while ( ( FindNextFile ( hFind, &ffData ) != 0 ) &&
-                  ( depth < max_depth ) );
+        DupeListAdd ( &gDupeWk[worker], buf, li.QuadPart );
     }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnRollup 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: void * ctx  : unused
+//    Param.    2: UINT node   : final folder
+//    Param.    3: UINT parent : its parent
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine hook, --age only. Rolls a finished folder's
+//                 histogram into its parent's, atomically: no lock is
+//                 held and its siblings may be doing the same.
+/*--------------------------------------------------------------------@@-@@-*/
+void OnRollup ( void * ctx, UINT node, UINT parent )
+/*--------------------------------------------------------------------------*/
+{
+    NODE_EXTRA * ne, * pe;
+
+    ne = EngineExtra ( &gEngine, node );
+    pe = EngineExtra ( &gEngine, parent );
+
+    AgeHistMerge ( &pe->age, &ne->age );
+}
 
-    FindClose ( hFind );
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnFinal 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: void * ctx : unused
+//    Param.    2: UINT node  : folder whose size is now known
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine hook, prints the folder's line (and its extension
+//                 breakdown, for --by-ext=N), with --prev the change
+//                 since the older walk. Subfolders are always done
+//                 before their parent, as in the old recursive walk, but
+//                 the roots being scanned at the same time get mixed.
+/*--------------------------------------------------------------------@@-@@-*/
+void OnFinal ( void * ctx, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    NODE_EXTRA  * ne;
+    EXT_TABLE   * et;
+    __int64     size;
+    UINT        prev, w;
+    WCHAR       tmp[ENG_MAX_PATH];
+    WCHAR       s[128], d[128], delta[160];
+
+    ne      = EngineExtra ( &gEngine, node );
+    size    = gEngine.size[node];
+
+    // --prev, how much it changed since that walk
+    delta[0] = L'\0';
+
+    if ( gPrevSnap.view != NULL )
+    {
+        prev = PathIdxMatch ( &gPrevSnap.idx, &gPrevSnap.eng, &gEngine,
+            node );
+
+        if ( prev == ENG_NONE )
+            StringCchCopyW ( delta, ARRAYSIZE(delta), L"  (new)" );
+        else if ( gPrevSnap.eng.size[prev] == size )
+            StringCchCopyW ( delta, ARRAYSIZE(delta), L"  (same)" );
+        else
+        {
+            FormatKB ( size - gPrevSnap.eng.size[prev], d, ARRAYSIZE(d) );
+            StringCchPrintfW ( delta, ARRAYSIZE(delta), L"  (%ls%ls KB)",
+                ( size > gPrevSnap.eng.size[prev] ) ? L"+" : L"", d );
+        }
+    }
 
     // if we're not redirected to text, chop path length so
     // it will fit in the console
-    if ( !IsConsoleRedirected() )
+    if ( EnginePath ( &gEngine, node, tmp, ARRAYSIZE(tmp) ) > MAX_LEN 
+            && !gRedirected )
     {
         tmp[MAX_LEN] = L'\0';
         tmp[MAX_LEN-1] = L'.';
         tmp[MAX_LEN-2] = L'.';
         tmp[MAX_LEN-3] = L'.';
     }
-    
-    StringCchPrintfW ( f, ARRAYSIZE(f), L"%.2f", ((float)size)/1024);
 
-    GetNumberFormatW ( LOCALE_SYSTEM_DEFAULT, LOCALE_NOUSEROVERRIDE, 
-        f, NULL, s, ARRAYSIZE(s) );
+    FormatKB ( size, s, ARRAYSIZE(s) );
+
+    // a --by-ext=N folder's tables, one per worker, in one; all below
+    // it is done, no worker adds to them any more
+    et = NULL;
+
+    if ( ne != NULL && ne->ext != NULL && ne->anchor == node )
+    {
+        for ( w = 0; w < gEngine.threads; w++ )
+        {
+            if ( ne->ext[w] == NULL )
+                continue;
+
+            if ( et == NULL )
+            {
+                et = ne->ext[w];
+                continue;
+            }
 
-    fwprintf ( stdout, L"%-*ls %*ls KB\n", 
-        MAX_LEN, tmp, 18, s );
+            ExtTableMerge ( et, ne->ext[w] );
+            ExtTableFree ( ne->ext[w] );
+            free ( ne->ext[w] );
+        }
+
+        free ( ne->ext );
+        ne->ext = NULL;
+    }
+
+    EnterCriticalSection ( &gOutLock );
+
+    if ( gAge )
+        fwprintf ( stdout, L"%-*ls %*ls KB  %3u%% %3u%% %3u%% | "
+            L"%3u%% %3u%% %3u%%%ls\n", MAX_LEN, tmp, 18, s,
+            AgePct ( ne->age.mbytes, 1, size ), 
+            AgePct ( ne->age.mbytes, 2, size ),
+            AgePct ( ne->age.mbytes, 3, size ), 
+            AgePct ( ne->age.abytes, 1, size ),
+            AgePct ( ne->age.abytes, 2, size ), 
+            AgePct ( ne->age.abytes, 3, size ), delta );
+    else
+        fwprintf ( stdout, L"%-*ls %*ls KB%ls\n", 
+            MAX_LEN, tmp, 18, s, delta );
+
+    // folders at --by-ext=N show their histogram right under them
+    if ( et != NULL )
+    {
+        PrintExtTable ( et, EXT_ROWS );
+        ExtTableFree ( et );
+        free ( et );
+    }
 
-    return size;
+    LeaveCriticalSection ( &gOutLock );
 }
 
 /*-@@+@@--------------------------------------------------------------------*/
-//       Function: IsDotOrTwoDots 
+//       Function: OnRound 
 /*--------------------------------------------------------------------------*/
-//           Type: BOOL 
-//    Param.    1: const WCHAR * src : 
+//           Type: void 
+//    Param.    1: void * ctx  : not used
+//    Param.    2: UINT levels : folder levels done
 /*--------------------------------------------------------------------------*/
 //         AUTHOR: Adrian Petrila, YO3GFH
-//           DATE: 29.08.2022
-//    DESCRIPTION: <lol>
-//
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine hook for --progressive, after each level. Lists
+//                 the roots' biggest subfolders as they stand: what's
+//                 been found in them so far, which only grows, or their
+//                 size if they're done. The order usually settles long
+//                 before the sizes do.
 /*--------------------------------------------------------------------@@-@@-*/
-BOOL IsDotOrTwoDots ( const WCHAR * src )
+void OnRound ( void * ctx, UINT levels )
 /*--------------------------------------------------------------------------*/
 {
-    INT_PTR len;
+    UINT        top[RANK_ROWS];
+    UINT        i, j, r, node, ntop, first, n;
+    WCHAR       tmp[ENG_MAX_PATH];
+    WCHAR       s[128];
 
-    if ( src == NULL )
-        return FALSE;
+    // only the top folders themselves are in at first, all empty
+    if ( levels < 2 )
+        return;
+
+    ntop = 0;
 
-    len = lstrlenW ( src );
+    // a few rows, kept sorted as they come
+    for ( r = 0; r < gEngine.nroots; r++ )
+    {
+        if ( gEngine.roots[r].state != ENG_ROOT_WALKED )
+            continue;
 
-    if ( (len == 1 && src[0] == L'.') || 
-         (len == 2 && src[0] == L'.' && src[1] == L'.') )
-            return TRUE;
+        first   = gEngine.first[gEngine.roots[r].node];
+        n       = gEngine.nchild[gEngine.roots[r].node];
 
-    return FALSE;
+        for ( i = 0; first != ENG_NONE && i < n; i++ )
+        {
+            node = first + i;
+
+            for ( j = ntop; j > 0 && gEngine.size[top[j-1]] <
+                    gEngine.size[node]; j-- )
+                if ( j < RANK_ROWS )
+                    top[j] = top[j-1];
+
+            if ( j < RANK_ROWS )
+            {
+                top[j] = node;
+
+                if ( ntop < RANK_ROWS )
+                    ntop++;
+            }
+        }
+    }
+
+    EnterCriticalSection ( &gOutLock );
+
+    fwprintf ( stdout, L" %u levels done, %lld folders and %lld files so "
+        L"far, biggest:\n", levels, gEngine.total_dirs,
+        gEngine.total_files );
+
+    for ( i = 0; i < ntop; i++ )
+    {
+        if ( EnginePath ( &gEngine, top[i], tmp, ARRAYSIZE(tmp) ) >
+                MAX_LEN - 4 && !gRedirected )
+        {
+            tmp[MAX_LEN-4] = L'\0';
+            tmp[MAX_LEN-5] = L'.';
+            tmp[MAX_LEN-6] = L'.';
+            tmp[MAX_LEN-7] = L'.';
+        }
+
+        FormatKB ( gEngine.size[top[i]], s, ARRAYSIZE(s) );
+
+        fwprintf ( stdout, L"    %-*ls %*ls KB%ls\n", MAX_LEN - 4, tmp,
+            18, s, ( gEngine.flags[top[i]] & ENG_FINAL ) ? L"" :
+            L" so far" );
+    }
+
+    LeaveCriticalSection ( &gOutLock );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PrintRoots 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: const ENGINE * eng : engine, after the scan
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one line per root given, then the grand total. Roots
+//                 nested in others show their size but aren't added
+//                 twice.
+/*--------------------------------------------------------------------@@-@@-*/
+void PrintRoots ( const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    const ENG_ROOT  * r;
+    UINT            i, node;
+    __int64         total;
+    WCHAR           s[128];
+
+    total = 0;
+
+    fwprintf ( stdout, L" Roots:\n" );
+
+    for ( i = 0; i < eng->nroots; i++ )
+    {
+        r       = &eng->roots[i];
+        node    = EngineRootNode ( eng, i );
+
+        if ( r->state == ENG_ROOT_MISSING )
+        {
+            fwprintf ( stdout, L"    %ls: can't open\n", r->path );
+            continue;
+        }
+
+        if ( node == ENG_NONE )
+        {
+            fwprintf ( stdout, L"    %ls: inside %ls, not walked\n", 
+                r->path, eng->roots[r->inside].path );
+            continue;
+        }
+
+        FormatKB ( eng->size[node], s, ARRAYSIZE(s) );
+
+        if ( r->state == ENG_ROOT_NESTED )
+            fwprintf ( stdout, L"    %ls: %ls KB, inside %ls\n", 
+                r->path, s, eng->roots[r->inside].path );
+        else
+        {
+            fwprintf ( stdout, L"    %ls: %ls KB (%lld subfolders, "
+                L"%lld files)\n", r->path, s, r->dirs - 1, r->files );
+
+            total += eng->size[node];
+        }
+    }
+
+    FormatKB ( total, s, ARRAYSIZE(s) );
+
+    fwprintf ( stdout, L" Total: %ls KB (%lld folders, %lld files)\n", 
+        s, eng->total_dirs, eng->total_files );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeFolders 
+/*--------------------------------------------------------------------------*/
+//           Type: int 
+//    Param.    1: WCHAR ** roots : folders to load right away
+//    Param.    2: int nroots     : how many
+//    Param.    3: UINT depth     : max. folder depth
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: --serve. Walk the folders given, then answer --ask
+//                 requests on the pipe until one says quit. Folders asked
+//                 about that aren't loaded yet get walked on the first
+//                 request; the --exclude/--include and depth given here
+//                 apply to all of them.
+/*--------------------------------------------------------------------@@-@@-*/
+int ServeFolders ( WCHAR ** roots, int nroots, UINT depth )
+/*--------------------------------------------------------------------------*/
+{
+    SERVER  sv;
+    HANDLE  hPipe;
+    int     i;
+
+    // don't walk anything for nothing
+    hPipe = ProtoConnect ( NULL );
+
+    if ( hPipe != INVALID_HANDLE_VALUE )
+    {
+        CloseHandle ( hPipe );
+        fwprintf ( stderr, L"Another fsize --serve is already running\n" );
+        return 1;
+    }
+
+    ServeInit ( &sv, 0, depth, 
+        PatFilterActive ( &gFilter ) ? &gFilter : NULL );
+
+    for ( i = 0; i < nroots; i++ )
+        if ( ServeScan ( &sv, roots[i] ) < 0 )
+            fwprintf ( stderr, L" Can't open %ls\n", roots[i] );
+        else
+            fwprintf ( stdout, L" Loaded %ls\n", roots[i] );
+
+    fwprintf ( stdout, L" Serving on %ls, \"fsize --ask quit\" "
+        L"stops it\n", PROTO_PIPE_NAME );
+
+    if ( !ServeRun ( &sv, NULL ) )
+    {
+        fwprintf ( stderr, L"Can't create %ls\n", PROTO_PIPE_NAME );
+        ServeFree ( &sv );
+        return 1;
+    }
+
+    ServeFree ( &sv );
+
+    return 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: AskServer 
+/*--------------------------------------------------------------------------*/
+//           Type: int 
+//    Param.    1: UINT op            : PROTO_xxx request
+//    Param.    2: UINT count         : for PROTO_TOP
+//    Param.    3: const WCHAR * path : folder, may be relative
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: --ask. Send one request to the resident fsize and print
+//                 the answer, with the round trip time.
+/*--------------------------------------------------------------------@@-@@-*/
+int AskServer ( UINT op, UINT count, const WCHAR * path )
+/*--------------------------------------------------------------------------*/
+{
+    PROTO_BUF       reply;
+    PROTO_RESP      resp;
+    PROTO_REC       rec;
+    const WCHAR     * name;
+    HANDLE          hPipe;
+    LARGE_INTEGER   freq, t0, t1;
+    WCHAR           full[ENG_MAX_PATH];
+    WCHAR           s[128];
+    UINT            pos, i;
+    BOOL            ok;
+
+    // the server has no idea what our current folder is
+    if ( path != NULL )
+    {
+        if ( !GetFullPathNameW ( path, ARRAYSIZE(full), full, NULL ) )
+        {
+            fwprintf ( stderr, L"Bad path: %ls\n", path );
+            return 1;
+        }
+
+        path = full;
+    }
+
+    hPipe = ProtoConnect ( NULL );
+
+    if ( hPipe == INVALID_HANDLE_VALUE )
+    {
+        fwprintf ( stderr, L"No fsize --serve running\n" );
+        return 1;
+    }
+
+    ProtoBufInit ( &reply );
+
+    QueryPerformanceFrequency ( &freq );
+    QueryPerformanceCounter ( &t0 );
+
+    ok = ProtoCall ( hPipe, op, count, path, &reply );
+
+    QueryPerformanceCounter ( &t1 );
+    CloseHandle ( hPipe );
+
+    if ( !ok )
+    {
+        fwprintf ( stderr, L"The server went away\n" );
+        ProtoBufFree ( &reply );
+        return 1;
+    }
+
+    CopyMemory ( &resp, reply.data, sizeof ( resp ) );
+
+    switch ( resp.status )
+    {
+        case PROTO_OK:
+            break;
+
+        case PROTO_NOTFOUND:
+            fwprintf ( stderr, L"Not in the tree (excluded or too deep?): "
+                L"%ls\n", path );
+            break;
+
+        case PROTO_NOROOT:
+            fwprintf ( stderr, L"Can't open %ls\n", path );
+            break;
+
+        case PROTO_NOMEM:
+            fwprintf ( stderr, L"The server is out of memory\n" );
+            break;
+
+        default:
+            fwprintf ( stderr, L"The server didn't understand us\n" );
+            break;
+    }
+
+    pos = sizeof ( resp );
+
+    for ( i = 0; i < resp.count && 
+            ProtoNextRec ( &reply, &pos, &rec, &name ); i++ )
+    {
+        FormatKB ( rec.size, s, ARRAYSIZE(s) );
+
+        fwprintf ( stdout, L"%-*.*ls %*ls KB\n", MAX_LEN, (int)rec.nlen, 
+            name, 18, s );
+
+        if ( op == PROTO_SIZE || op == PROTO_SCAN )
+            fwprintf ( stdout, L"    %u subfolders, %u files right "
+                L"inside\n", rec.folders, rec.files );
+    }
+
+    fwprintf ( stdout, L" Answered in %.0f us\n", 
+        (double)( t1.QuadPart - t0.QuadPart ) * 1e6 / freq.QuadPart );
+
+    ProtoBufFree ( &reply );
+
+    return ( resp.status == PROTO_OK ) ? 0 : 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SaveSnapshot 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: const ENGINE * eng  : engine, done walking
+//    Param.    2: const WCHAR * fname : file to write
+//    Param.    3: UINT64 scanned      : FILETIME the walk started
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: --save. The path index is built here and saved along,
+//                 so fsize query doesn't have to. A walk that spilled
+//                 is saved by SpillSave instead.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL SaveSnapshot ( const ENGINE * eng, const WCHAR * fname, UINT64 scanned )
+/*--------------------------------------------------------------------------*/
+{
+    PATH_INDEX  pi;
+    BOOL        ok;
+
+    // with --mem-limit the tree is put together from the run file
+    if ( eng->spill != NULL )
+        return SpillSave ( eng->spill, eng, scanned, fname );
+
+    if ( !PathIdxBuild ( &pi, eng ) )
+        return FALSE;
+
+    ok = SnapSave ( eng, &pi, scanned, fname );
+
+    PathIdxFree ( &pi );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: QuerySnapshot 
+/*--------------------------------------------------------------------------*/
+//           Type: int 
+//    Param.    1: int argc      : args after "query"
+//    Param.    2: WCHAR ** argv : snapshot, then folders
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: fsize query. Print "bytes<TAB>folder" for each folder
+//                 given ("-" reads them from stdin, one per line), or
+//                 "-<TAB>folder" if it's not in the snapshot. The
+//                 snapshot is mapped, not read, and each lookup hashes
+//                 one path component per level, so a batch of them costs
+//                 about what printing the answers does.
+/*--------------------------------------------------------------------@@-@@-*/
+int QuerySnapshot ( int argc, WCHAR ** argv )
+/*--------------------------------------------------------------------------*/
+{
+    SNAPSHOT        snap;
+    LARGE_INTEGER   freq, t0, t1;
+    WCHAR           line[ENG_MAX_PATH];
+    UINT_PTR        len, asked, found;
+    int             i;
+
+    if ( !SnapOpen ( &snap, argv[0] ) )
+    {
+        fwprintf ( stderr, L"Can't open snapshot %ls\n", argv[0] );
+        return 1;
+    }
+
+    if ( lstrcmpiW ( argv[1], L"--grep" ) == 0 )
+    {
+        i = ( argc > 2 ) ? QueryGrep ( &snap, argc - 2, argv + 2 ) : 1;
+        SnapClose ( &snap );
+        return i;
+    }
+
+    if ( lstrcmpiW ( argv[1], L"--where" ) == 0 )
+    {
+        i = 1;
+
+        if ( argc == 3 && WhereCompile ( &gWhere, argv[2] ) )
+            i = QueryWhere ( &gWhere, &snap.eng );
+
+        PredFree ( &gWhere );
+        SnapClose ( &snap );
+        return i;
+    }
+
+    if ( lstrcmpiW ( argv[1], L"--export" ) == 0 && argc > 2 )
+    {
+        i = 1;
+
+        if ( argc == 3 )
+            i = QueryExport ( NULL, &snap.eng, argv[2] );
+        else if ( argc == 4 && WhereCompile ( &gWhere, argv[3] ) )
+            i = QueryExport ( &gWhere, &snap.eng, argv[2] );
+
+        PredFree ( &gWhere );
+        SnapClose ( &snap );
+        return i;
+    }
+
+    if ( lstrcmpiW ( argv[1], L"--stats" ) == 0 )
+    {
+        i = 1;
+
+        if ( argc == 2 )
+            i = QueryStats ( NULL, &snap.eng );
+        else if ( argc == 3 && WhereCompile ( &gWhere, argv[2] ) )
+            i = QueryStats ( &gWhere, &snap.eng );
+
+        PredFree ( &gWhere );
+        SnapClose ( &snap );
+        return i;
+    }
+
+    asked = 0;
+    found = 0;
+
+    QueryPerformanceFrequency ( &freq );
+    QueryPerformanceCounter ( &t0 );
+
+    for ( i = 1; i < argc; i++ )
+    {
+        if ( wcscmp ( argv[i], L"-" ) != 0 )
+        {
+            found += QueryPath ( &snap, argv[i] );
+            asked++;
+            continue;
+        }
+
+        while ( fgetws ( line, ARRAYSIZE(line), stdin ) != NULL )
+        {
+            len = wcslen ( line );
+
+            while ( len != 0 && ( line[len-1] == L'\n' || 
+                    line[len-1] == L'\r' ) )
+                line[--len] = L'\0';
+
+            if ( len == 0 )
+                continue;
+
+            found += QueryPath ( &snap, line );
+            asked++;
+        }
+    }
+
+    QueryPerformanceCounter ( &t1 );
+
+    fwprintf ( stderr, L" %zu folders looked up, %zu found, in %.3f ms\n", 
+        asked, found, 
+        (double)( t1.QuadPart - t0.QuadPart ) * 1e3 / freq.QuadPart );
+
+    SnapClose ( &snap );
+
+    return ( found == asked ) ? 0 : 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: QueryPath 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: const SNAPSHOT * snap : snapshot
+//    Param.    2: const WCHAR * path    : folder, may be relative
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one lookup for QuerySnapshot, prints the answer
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL QueryPath ( const SNAPSHOT * snap, const WCHAR * path )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR       full[ENG_MAX_PATH];
+    UINT_PTR    len;
+    UINT        node;
+
+    node = ENG_NONE;
+
+    if ( GetFullPathNameW ( path, ARRAYSIZE(full), full, NULL ) )
+    {
+        // roots are kept without the trailing backslash
+        len = wcslen ( full );
+
+        if ( len > 1 && full[len-1] == L'\\' )
+            full[len-1] = L'\0';
+
+        node = PathIdxLookup ( &snap->idx, &snap->eng, full );
+    }
+
+    if ( node == ENG_NONE )
+    {
+        fwprintf ( stdout, L"-\t%ls\n", path );
+        return FALSE;
+    }
+
+    fwprintf ( stdout, L"%lld\t%ls\n", snap->eng.size[node], path );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: QueryGrep 
+/*--------------------------------------------------------------------------*/
+//           Type: int 
+//    Param.    1: const SNAPSHOT * snap : snapshot
+//    Param.    2: int argc              : texts to look for
+//    Param.    3: WCHAR ** argv         : the texts
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: fsize query <snapshot> --grep <text>... Print
+//                 "bytes<TAB>folder" for every folder whose name has the
+//                 text in it, or whose path does if the text has a
+//                 backslash (see SearchRun). The names are indexed
+//                 once, then each text is a few posting lists away.
+/*--------------------------------------------------------------------@@-@@-*/
+int QueryGrep ( const SNAPSHOT * snap, int argc, WCHAR ** argv )
+/*--------------------------------------------------------------------------*/
+{
+    SEARCH_INDEX    si;
+    SEARCH          s;
+    LARGE_INTEGER   freq, t0, t1, t2;
+    WCHAR           path[ENG_MAX_PATH];
+    UINT_PTR        hits;
+    int             i;
+    UINT            k;
+
+    QueryPerformanceFrequency ( &freq );
+    QueryPerformanceCounter ( &t0 );
+
+    if ( !SearchBuild ( &si, &snap->eng ) )
+    {
+        fwprintf ( stderr, L"Not enough memory for the name index\n" );
+        return 1;
+    }
+
+    QueryPerformanceCounter ( &t1 );
+    SearchInit ( &s, &si );
+
+    hits = 0;
+
+    for ( i = 0; i < argc; i++ )
+    {
+        if ( !SearchRun ( &s, argv[i] ) )
+        {
+            fwprintf ( stderr, L"Not enough memory for the search\n" );
+            break;
+        }
+
+        for ( k = 0; k < s.nhits; k++ )
+        {
+            EnginePath ( &snap->eng, s.hits[k], path, ARRAYSIZE(path) );
+            fwprintf ( stdout, L"%lld\t%ls\n",
+                snap->eng.size[s.hits[k]], path );
+        }
+
+        hits += s.nhits;
+    }
+
+    QueryPerformanceCounter ( &t2 );
+
+    fwprintf ( stderr, L" %zu folders found among %u, index built in "
+        L"%.3f ms, searched and printed in %.3f ms\n", hits,
+        snap->eng.count,
+        (double)( t1.QuadPart - t0.QuadPart ) * 1e3 / freq.QuadPart,
+        (double)( t2.QuadPart - t1.QuadPart ) * 1e3 / freq.QuadPart );
+
+    SearchFree ( &s );
+    SearchFreeIndex ( &si );
+
+    return ( hits != 0 ) ? 0 : 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: WhereCompile 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: PRED * pr          : receives the plan
+//    Param.    2: const WCHAR * expr : --where expression
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: compile it, or show where it stops making sense
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL WhereCompile ( PRED * pr, const WCHAR * expr )
+/*--------------------------------------------------------------------------*/
+{
+    if ( PredCompile ( pr, expr ) )
+        return TRUE;
+
+    fwprintf ( stderr, L"Bad --where expression:\n  %ls\n  %*ls^\n", expr,
+        pr->err, L"" );
+
+    PredFree ( pr );
+
+    return FALSE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: QueryWhere 
+/*--------------------------------------------------------------------------*/
+//           Type: int 
+//    Param.    1: PRED * pr          : compiled --where
+//    Param.    2: const ENGINE * eng : finished walk or snapshot
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: print "bytes<TAB>folder" for every folder the
+//                 expression keeps, in tree order, and how long picking
+//                 them took (see PredRun)
+/*--------------------------------------------------------------------@@-@@-*/
+int QueryWhere ( PRED * pr, const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    LARGE_INTEGER   freq, t0, t1;
+    WCHAR           path[ENG_MAX_PATH];
+    UINT            k;
+    BOOL            ok;
+
+    QueryPerformanceFrequency ( &freq );
+    QueryPerformanceCounter ( &t0 );
+
+    ok = PredRun ( pr, eng );
+
+    QueryPerformanceCounter ( &t1 );
+
+    if ( !ok )
+    {
+        fwprintf ( stderr, L"Not enough memory for --where\n" );
+        return 1;
+    }
+
+    for ( k = 0; k < pr->nhits; k++ )
+    {
+        EnginePath ( eng, pr->hits[k], path, ARRAYSIZE(path) );
+        fwprintf ( stdout, L"%lld\t%ls\n", eng->size[pr->hits[k]], path );
+    }
+
+    fwprintf ( stderr, L" %u folders matching among %u, picked in "
+        L"%.3f ms\n", pr->nhits, eng->count,
+        (double)( t1.QuadPart - t0.QuadPart ) * 1e3 / freq.QuadPart );
+
+    return ( pr->nhits != 0 ) ? 0 : 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: QueryStats 
+/*--------------------------------------------------------------------------*/
+//           Type: int 
+//    Param.    1: PRED * pr          : compiled --where, or NULL for all
+//    Param.    2: const ENGINE * eng : finished walk or snapshot
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: fsize query <snapshot> --stats [expr]. Totals for the
+//                 folders (all, or the ones the expression keeps), how
+//                 many there are by size and how many bytes sit right
+//                 in them by the age of their newest file. Each figure
+//                 is one pass over one column (see colstat.c), the
+//                 selection a byte per folder.
+/*--------------------------------------------------------------------@@-@@-*/
+int QueryStats ( PRED * pr, const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    static const WCHAR * const sname[] =
+    {
+        L"under 1 MB", L"1 - 10 MB", L"10 - 100 MB", L"100 MB - 1 GB",
+        L"1 - 10 GB", L"10 - 100 GB", L"100 GB and up"
+    };
+
+    static const WCHAR * const aname[] =
+    {
+        L"no files", L"over a year", L"90 days - a year", L"30 - 90 days",
+        L"under 30 days"
+    };
+
+    LARGE_INTEGER   freq, t0, t1;
+    FILETIME        ft;
+    __int64         sedge[ARRAYSIZE(sname)-1], aedge[ARRAYSIZE(aname)-1];
+    __int64         aweight[ARRAYSIZE(aname)];
+    UINT64          scount[ARRAYSIZE(sname)], acount[ARRAYSIZE(aname)];
+    __int64         now, day, bytes, newest;
+    UINT64          files, folders;
+    BYTE            * sel;
+    WCHAR           s[128];
+    UINT            k;
+
+    GetSystemTimeAsFileTime ( &ft );
+    now = ( (__int64)ft.dwHighDateTime << 32 ) | ft.dwLowDateTime;
+    day = 864000000000LL;
+
+    sedge[0]    = (__int64)1 << 20;
+    sedge[1]    = sedge[0] * 10;
+    sedge[2]    = sedge[0] * 100;
+    sedge[3]    = (__int64)1 << 30;
+    sedge[4]    = sedge[3] * 10;
+    sedge[5]    = sedge[3] * 100;
+
+    aedge[0]    = 1;            // 0, nothing was ever written below
+    aedge[1]    = now - 365 * day;
+    aedge[2]    = now - 90 * day;
+    aedge[3]    = now - 30 * day;
+
+    sel = NULL;
+
+    QueryPerformanceFrequency ( &freq );
+    QueryPerformanceCounter ( &t0 );
+
+    if ( pr != NULL )
+    {
+        if ( !PredRun ( pr, eng ) || 
+            ( sel = calloc ( eng->count + 1, 1 ) ) == NULL )
+        {
+            fwprintf ( stderr, L"Not enough memory for --stats\n" );
+            return 1;
+        }
+
+        for ( k = 0; k < pr->nhits; k++ )
+            sel[pr->hits[k]] = 1;
+    }
+
+    folders = ( pr != NULL ) ? pr->nhits : eng->count;
+    files   = ColSum32 ( eng->files, sel, eng->count );
+    bytes   = ColSum64 ( eng->own, sel, eng->count );
+    newest  = ColMax64 ( eng->mtime, sel, eng->count );
+
+    ColHist64 ( eng->size, NULL, sel, eng->count, sedge, ARRAYSIZE(sedge),
+        scount, NULL );
+    ColHist64 ( eng->mtime, eng->own, sel, eng->count, aedge, 
+        ARRAYSIZE(aedge), acount, aweight );
+
+    QueryPerformanceCounter ( &t1 );
+
+    FormatKB ( bytes, s, ARRAYSIZE(s) );
+
+    fwprintf ( stdout, L" %llu folders, %llu files, %ls KB\n", folders,
+        files, s );
+
+    if ( newest > 0 )
+        fwprintf ( stdout, L" newest file written %.1f days ago\n",
+            (double)( now - newest ) / day );
+
+    fwprintf ( stdout, L"\n folders by size:\n" );
+
+    for ( k = 0; k < ARRAYSIZE(sname); k++ )
+        fwprintf ( stdout, L"    %-18ls %12llu\n", sname[k], scount[k] );
+
+    fwprintf ( stdout, L"\n bytes right in them, by newest file:\n" );
+
+    for ( k = 0; k < ARRAYSIZE(aname); k++ )
+    {
+        FormatKB ( aweight[k], s, ARRAYSIZE(s) );
+        fwprintf ( stdout, L"    %-18ls %12llu folders %18ls KB\n", 
+            aname[k], acount[k], s );
+    }
+
+    fwprintf ( stderr, L" %u folders looked at in %.3f ms\n", eng->count,
+        (double)( t1.QuadPart - t0.QuadPart ) * 1e3 / freq.QuadPart );
+
+    free ( sel );
+
+    return ( folders != 0 ) ? 0 : 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: QueryExport 
+/*--------------------------------------------------------------------------*/
+//           Type: int 
+//    Param.    1: PRED * pr           : compiled --where, or NULL for all
+//    Param.    2: const ENGINE * eng  : finished walk or snapshot
+//    Param.    3: const WCHAR * fname : .csv, .tsv or .json file to write
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: fsize query <snapshot> --export <file> [expr]. Every
+//                 folder (or the ones the expression keeps) in tree
+//                 order, as UTF-8 CSV, TSV or JSON lines by the file's
+//                 extension, formatted on all CPUs (see ExportFile).
+/*--------------------------------------------------------------------@@-@@-*/
+int QueryExport ( PRED * pr, const ENGINE * eng, const WCHAR * fname )
+/*--------------------------------------------------------------------------*/
+{
+    LARGE_INTEGER   freq, t0, t1;
+    UINT64          bytes;
+    double          ms;
+    BOOL            ok;
+
+    if ( pr != NULL && !PredRun ( pr, eng ) )
+    {
+        fwprintf ( stderr, L"Not enough memory for --where\n" );
+        return 1;
+    }
+
+    QueryPerformanceFrequency ( &freq );
+    QueryPerformanceCounter ( &t0 );
+
+    if ( pr != NULL )
+        ok = ExportFile ( eng, pr->hits, pr->nhits, NULL,
+            ExportFormat ( fname ), 0, fname, &bytes );
+    else
+        ok = ExportFile ( eng, NULL, eng->count, NULL,
+            ExportFormat ( fname ), 0, fname, &bytes );
+
+    QueryPerformanceCounter ( &t1 );
+
+    if ( !ok )
+    {
+        fwprintf ( stderr, L"Can't write %ls\n", fname );
+        return 1;
+    }
+
+    ms = (double)( t1.QuadPart - t0.QuadPart ) * 1e3 / freq.QuadPart;
+
+    fwprintf ( stderr, L" %u folders, %llu bytes written in %.3f ms "
+        L"(%.1f MB/s)\n", ( pr != NULL ) ? pr->nhits : eng->count, bytes,
+        ms, ( ms > 0 ) ? bytes / ms / 1e3 : 0.0 );
+
+    return 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PrintPrevious 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: const ENGINE * eng      : engine, roots added
+//    Param.    2: const SNAPSHOT * prev   : --prev snapshot
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: before the walk, the roots as the snapshot has them,
+//                 marked as such. Straight from the mapped file, one
+//                 lookup per root.
+/*--------------------------------------------------------------------@@-@@-*/
+void PrintPrevious ( const ENGINE * eng, const SNAPSHOT * prev )
+/*--------------------------------------------------------------------------*/
+{
+    FILETIME    ft, lt;
+    SYSTEMTIME  st;
+    UINT        i, node;
+    WCHAR       s[128];
+
+    ft.dwLowDateTime    = (DWORD)prev->scanned;
+    ft.dwHighDateTime   = (DWORD)( prev->scanned >> 32 );
+
+    FileTimeToLocalFileTime ( &ft, &lt );
+    FileTimeToSystemTime ( &lt, &st );
+
+    fwprintf ( stdout, L" As of the %02u.%02u.%04u %02u:%02u scan "
+        L"(stale, walking again):\n", st.wDay, st.wMonth, st.wYear,
+        st.wHour, st.wMinute );
+
+    for ( i = 0; i < eng->nroots; i++ )
+    {
+        node = PathIdxLookup ( &prev->idx, &prev->eng, 
+            eng->roots[i].path );
+
+        if ( node == ENG_NONE )
+        {
+            fwprintf ( stdout, L"    %ls: not in it\n", 
+                eng->roots[i].path );
+            continue;
+        }
+
+        FormatKB ( prev->eng.size[node], s, ARRAYSIZE(s) );
+
+        fwprintf ( stdout, L"    %ls: %ls KB\n", eng->roots[i].path, s );
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ViewShared 
+/*--------------------------------------------------------------------------*/
+//           Type: int 
+//    Param.    1: const WCHAR * name : as given to fsize --share
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: fsize view. Map the walk another fsize is publishing and
+//                 print each folder's line as it gets its final size,
+//                 straight from the walker's own columns; nothing is
+//                 copied and neither side waits on the other. Folders
+//                 below lo are all printed, so a poll only looks at the
+//                 ones still pending and the new ones.
+/*--------------------------------------------------------------------@@-@@-*/
+int ViewShared ( const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    SHARE_VIEW  sv;
+    BYTE        * seen, * tmp;
+    UINT        lo, have, n, node;
+    int         state;
+    WCHAR       path[ENG_MAX_PATH];
+    WCHAR       s[128];
+
+    if ( !ShareOpen ( &sv, name ) )
+    {
+        fwprintf ( stderr, L"Nothing published as %ls\n", name );
+        return 1;
+    }
+
+    gRedirected = IsConsoleRedirected();
+
+    seen    = NULL;
+    lo      = 0;
+    have    = 0;
+
+    do
+    {
+        state   = ShareSync ( &sv );
+        n       = sv.eng.count;
+
+        if ( n > have )
+        {
+            tmp = realloc ( seen, n );
+
+            if ( tmp == NULL )
+            {
+                fwprintf ( stderr, L"Out of memory!\n" );
+                break;
+            }
+
+            seen = tmp;
+            ZeroMemory ( seen + have, n - have );
+            have = n;
+        }
+
+        for ( node = lo; node < n; node++ )
+        {
+            if ( seen[node] || !( sv.eng.flags[node] & ENG_FINAL ) )
+                continue;
+
+            // the flag is in, the size written before it is too
+            MemoryBarrier ( );
+            seen[node] = 1;
+
+            if ( EnginePath ( &sv.eng, node, path, ARRAYSIZE(path) ) > 
+                    MAX_LEN && !gRedirected )
+            {
+                path[MAX_LEN] = L'\0';
+                path[MAX_LEN-1] = L'.';
+                path[MAX_LEN-2] = L'.';
+                path[MAX_LEN-3] = L'.';
+            }
+
+            FormatKB ( sv.eng.size[node], s, ARRAYSIZE(s) );
+            fwprintf ( stdout, L"%-*ls %*ls KB\n", MAX_LEN, path, 18, s );
+        }
+
+        while ( lo < n && seen[lo] )
+            lo++;
+
+        // the state was read before the count, one more pass saw it all
+        if ( state == SHARE_RUNNING )
+            Sleep ( 100 );
+    }
+    while ( state == SHARE_RUNNING );
+
+    if ( state == SHARE_DONE )
+        fwprintf ( stdout, L" %u folders, %llu files\n", sv.eng.count,
+            sv.hdr->files );
+    else
+        fwprintf ( stderr, L"The walk didn't finish, results are "
+            L"partial!\n" );
+
+    free ( seen );
+    ShareClose ( &sv );
+
+    return ( state == SHARE_DONE ) ? 0 : 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnSubdir 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: void * ctx         : unused
+//    Param.    2: UINT node          : folder being enumerated
+//    Param.    3: const WCHAR * name : subfolder found in it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine hook, --shard only. Other shards' folders are
+//                 left out, as if they weren't there.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL OnSubdir ( void * ctx, UINT node, const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    return ShardOwns ( &gShard, &gEngine, node, name );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnWeigh 
+/*--------------------------------------------------------------------------*/
+//           Type: UINT 
+//    Param.    1: void * ctx         : unused
+//    Param.    2: UINT worker        : worker asking
+//    Param.    3: UINT node          : folder being enumerated
+//    Param.    4: const WCHAR * name : subfolder found in it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine hook, with a --prev snapshot. What the subfolder
+//                 had below it then, so the biggest are walked first.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT OnWeigh ( void * ctx, UINT worker, UINT node, const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    return WeighFolder ( &gWeigh, &gEngine, worker, node, name );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: MergeSnapshots 
+/*--------------------------------------------------------------------------*/
+//           Type: int 
+//    Param.    1: int argc      : args after "merge"
+//    Param.    2: WCHAR ** argv : snapshot to write, then the parts
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: fsize merge. The --save snapshots of all the shards of
+//                 a walk make the snapshot of the whole, as if one fsize
+//                 had walked it; the roots' sizes are printed after.
+/*--------------------------------------------------------------------@@-@@-*/
+int MergeSnapshots ( int argc, WCHAR ** argv )
+/*--------------------------------------------------------------------------*/
+{
+    SNAPSHOT    snap;
+    UINT        count, i;
+    WCHAR       s[128];
+
+    count = ShardMerge ( argv[0], argv + 1, (UINT)( argc - 1 ) );
+
+    if ( count == 0 || !SnapOpen ( &snap, argv[0] ) )
+    {
+        fwprintf ( stderr, L"Can't merge into %ls\n", argv[0] );
+        return 1;
+    }
+
+    for ( i = 0; i < snap.eng.count && ( snap.eng.flags[i] & ENG_TOP ); i++ )
+    {
+        FormatKB ( snap.eng.size[i], s, ARRAYSIZE(s) );
+        fwprintf ( stdout, L"%-*ls %*ls KB\n", MAX_LEN, 
+            snap.eng.names + snap.eng.name[i], 18, s );
+    }
+
+    fwprintf ( stdout, L" %d snapshots merged, %u folders\n", argc - 1,
+        count );
+
+    SnapClose ( &snap );
+
+    return 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShowHistory 
+/*--------------------------------------------------------------------------*/
+//           Type: int 
+//    Param.    1: int argc      : args after "history"
+//    Param.    2: WCHAR ** argv : add or compact and its args, or the
+//                                 history file, a folder and the days
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: fsize history. Adds a snapshot to a history, compacts
+//                 one, or prints a folder's size at every scan of the
+//                 last days (90 if not given), oldest first, with the
+//                 change from the scan before.
+/*--------------------------------------------------------------------@@-@@-*/
+int ShowHistory ( int argc, WCHAR ** argv )
+/*--------------------------------------------------------------------------*/
+{
+    HISTORY     h;
+    HIST_POINT  * pts;
+    FILETIME    ft, lt;
+    SYSTEMTIME  st;
+    UINT64      now, days;
+    UINT        i, n, changed;
+    WCHAR       s[128], d[160], t[128];
+
+    if ( lstrcmpiW ( argv[0], L"add" ) == 0 && argc >= 3 )
+    {
+        if ( !HistAdd ( argv[1], argv[2], &changed ) )
+        {
+            fwprintf ( stderr, L"Can't add %ls to history %ls\n", argv[2],
+                argv[1] );
+
+            return 1;
+        }
+
+        fwprintf ( stdout, L" Added, %u folders changed size\n", changed );
+        return 0;
+    }
+
+    if ( lstrcmpiW ( argv[0], L"compact" ) == 0 && argc >= 3 )
+    {
+        days = ( argc > 3 ) ? wcstoul ( argv[3], NULL, 10 ) : HIST_KEEP_DAYS;
+
+        if ( !HistCompact ( argv[1], argv[2], (UINT)days ) )
+        {
+            fwprintf ( stderr, L"Can't compact history %ls on %ls\n",
+                argv[1], argv[2] );
+
+            return 1;
+        }
+
+        fwprintf ( stdout, L" Compacted on %ls, kept %u days\n", argv[2],
+            (UINT)days );
+
+        return 0;
+    }
+
+    if ( !HistOpen ( &h, argv[0] ) )
+    {
+        fwprintf ( stderr, L"Can't open history %ls\n", argv[0] );
+        return 1;
+    }
+
+    pts = malloc ( HIST_MAX_SCANS * sizeof ( HIST_POINT ) );
+
+    if ( pts == NULL )
+    {
+        HistClose ( &h );
+        fwprintf ( stderr, L"Out of memory!\n" );
+
+        return 1;
+    }
+
+    days = ( argc > 2 ) ? wcstoul ( argv[2], NULL, 10 ) : 90;
+
+    GetSystemTimeAsFileTime ( &ft );
+
+    now = ( (UINT64)ft.dwHighDateTime << 32 ) | ft.dwLowDateTime;
+    now = ( now > days * HIST_DAY ) ? now - days * HIST_DAY : 0;
+    n   = HistSeries ( &h, argv[1], now, pts, HIST_MAX_SCANS );
+
+    if ( n == 0 )
+        fwprintf ( stdout, L" %ls: no scans of it in the last %u days\n",
+            argv[1], (UINT)days );
+
+    // newest first from the history, the other way round on screen
+    for ( i = n; i-- > 0; )
+    {
+        ft.dwLowDateTime    = (DWORD)pts[i].when;
+        ft.dwHighDateTime   = (DWORD)( pts[i].when >> 32 );
+
+        FileTimeToLocalFileTime ( &ft, &lt );
+        FileTimeToSystemTime ( &lt, &st );
+        FormatKB ( pts[i].size, s, ARRAYSIZE(s) );
+
+        d[0] = L'\0';
+
+        if ( i + 1 < n && pts[i].size != pts[i+1].size )
+        {
+            FormatKB ( pts[i].size - pts[i+1].size, t, ARRAYSIZE(t) );
+            StringCchPrintfW ( d, ARRAYSIZE(d), L"  (%ls%ls KB)",
+                ( pts[i].size > pts[i+1].size ) ? L"+" : L"", t );
+        }
+
+        fwprintf ( stdout, L" %02u.%02u.%04u %02u:%02u %*ls KB%ls\n",
+            st.wDay, st.wMonth, st.wYear, st.wHour, st.wMinute, 18, s, d );
+    }
+
+    free ( pts );
+    HistClose ( &h );
+
+    return 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PrintExtTable 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: const EXT_TABLE * et : histogram to print
+//    Param.    2: UINT max_rows        : print only the biggest ones
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one line per extension, biggest first, with size, file
+//                 count and share of the total
+/*--------------------------------------------------------------------@@-@@-*/
+void PrintExtTable ( const EXT_TABLE * et, UINT max_rows )
+/*--------------------------------------------------------------------------*/
+{
+    EXT_ENTRY   * rows;
+    UINT        i, count;
+    WCHAR       s[128], f[128];
+    WCHAR       name[EXT_MAX_LEN+2];
+    float       pct;
+
+    rows = ExtTableSorted ( et, &count );
+
+    if ( rows == NULL )
+        return;
+
+    for ( i = 0; i < count && i < max_rows; i++ )
+    {
+        if ( rows[i].len )
+            StringCchPrintfW ( name, ARRAYSIZE(name), L".%ls", 
+                ExtEntryName ( et, &rows[i] ) );
+        else
+            StringCchCopyW ( name, ARRAYSIZE(name), L"(none)" );
+
+        StringCchPrintfW ( f, ARRAYSIZE(f), L"%.2f", 
+            ((float)rows[i].bytes)/1024 );
+
+        GetNumberFormatW ( LOCALE_SYSTEM_DEFAULT, LOCALE_NOUSEROVERRIDE, 
+            f, NULL, s, ARRAYSIZE(s) );
+
+        pct = ( et->bytes != 0 ) ? 
+            ((float)rows[i].bytes)*100/et->bytes : 0;
+
+        fwprintf ( stdout, L"    %-*ls %*ls KB %10zu files %6.2f%%\n", 
+            EXT_MAX_LEN+1, name, 18, s, rows[i].files, pct );
+    }
+
+    if ( count > max_rows )
+        fwprintf ( stdout, L"    (%u more)\n", count - max_rows );
+
+    free ( rows );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: AgePct 
+/*--------------------------------------------------------------------------*/
+//           Type: UINT 
+//    Param.    1: const __int64 * buckets : AGE_HIST mbytes or abytes
+//    Param.    2: UINT bucket             : age limit (1 = 30 days...)
+//    Param.    3: __int64 size            : folder size
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: percent of the folder's bytes older than the limit
+/*--------------------------------------------------------------------@@-@@-*/
+UINT AgePct ( const __int64 * buckets, UINT bucket, __int64 size )
+/*--------------------------------------------------------------------------*/
+{
+    if ( size <= 0 )
+        return 0;
+
+    return (UINT)( AgeHistOlder ( buckets, bucket ) * 100 / size );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PrintDupes 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: DUPE_LIST * dl : files collected by the crawl
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: run the duplicate finder and print the biggest sets, the
+//                 folders with the most to reclaim and how much we had to
+//                 read to find out
+/*--------------------------------------------------------------------@@-@@-*/
+void PrintDupes ( DUPE_LIST * dl )
+/*--------------------------------------------------------------------------*/
+{
+    DUPE_FOLDER * fl;
+    UINT_PTR    i, j, nfl;
+    WCHAR       s[128], r[128];
+
+    if ( !DupeFind ( dl, 0 ) )
+    {
+        fwprintf ( stderr, L"Out of memory!\n" );
+        return;
+    }
+
+    fwprintf ( stdout, L" Duplicates:\n" );
+
+    for ( i = 0; i < dl->nsets && i < DUPE_ROWS; i++ )
+    {
+        FormatKB ( dl->sets[i].size, s, ARRAYSIZE(s) );
+        FormatKB ( dl->sets[i].size * (__int64)( dl->sets[i].count - 1 ), 
+            r, ARRAYSIZE(r) );
+
+        fwprintf ( stdout, L"    %zu copies of %ls KB, %ls KB reclaimable\n", 
+            dl->sets[i].count, s, r );
+
+        for ( j = 0; j < dl->sets[i].count; j++ )
+            fwprintf ( stdout, L"        %ls\n", 
+                DupePath ( dl, dl->sets[i].first + j ) );
+    }
+
+    if ( dl->nsets > DUPE_ROWS )
+        fwprintf ( stdout, L"    (%zu more sets)\n", dl->nsets - DUPE_ROWS );
+
+    fl = DupeFolders ( dl, &nfl );
+
+    if ( fl != NULL )
+    {
+        fwprintf ( stdout, L" Reclaimable by folder:\n" );
+
+        for ( i = 0; i < nfl && i < DUPE_ROWS; i++ )
+        {
+            FormatKB ( fl[i].bytes, s, ARRAYSIZE(s) );
+
+            fwprintf ( stdout, L"    %*ls KB %8zu files  %.*ls\n", 18, s, 
+                fl[i].files, (int)fl[i].len, dl->arena + fl[i].path );
+        }
+
+        free ( fl );
+    }
+
+    FormatKB ( dl->reclaimable, r, ARRAYSIZE(r) );
+    fwprintf ( stdout, L" %zu sets, %ls KB reclaimable\n", dl->nsets, r );
+
+    FormatKB ( dl->bytes_read, r, ARRAYSIZE(r) );
+    FormatKB ( dl->total, s, ARRAYSIZE(s) );
+
+    fwprintf ( stdout, L" Read %ls KB of %ls KB (%.2f%%) to find them\n", 
+        r, s, ( dl->total != 0 ) ? 
+            ((float)dl->bytes_read)*100/dl->total : 0.0f );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: FormatKB 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: __int64 size  : bytes
+//    Param.    2: WCHAR * dest  : receives the KB count, locale formatted
+//    Param.    3: UINT cch      : dest size, in chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void FormatKB ( __int64 size, WCHAR * dest, UINT cch )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR f[128];
+
+    StringCchPrintfW ( f, ARRAYSIZE(f), L"%.2f", ((float)size)/1024 );
+
+    GetNumberFormatW ( LOCALE_SYSTEM_DEFAULT, LOCALE_NOUSEROVERRIDE, 
+        f, NULL, dest, cch );
 }
 
 /*-@@+@@--------------------------------------------------------------------*/
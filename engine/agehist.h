@@ -0,0 +1,33 @@
+
+// agehist.h - file age histograms (--age)
+
+#ifndef _AGEHIST_H
+#define _AGEHIST_H
+
+#include <windows.h>
+
+// buckets: younger than 30 days, 30..90, 90..365 and older than a year
+#define AGE_BUCKETS     4
+
+// one FILETIME day, in 100ns units
+#define AGE_DAY         864000000000LL
+
+// bytes by age, by last write and by last access time. Kept compact
+// (64 bytes) since there's one for each folder when --age is on.
+typedef struct _age_hist
+{
+    __int64     mbytes[AGE_BUCKETS];    // by last write (mtime)
+    __int64     abytes[AGE_BUCKETS];    // by last access (atime)
+} AGE_HIST;
+
+extern const UINT gAgeDays[AGE_BUCKETS-1];
+
+__int64     AgeNow          ( void );
+UINT        AgeBucket       ( __int64 now, const FILETIME * ft );
+void        AgeHistAdd      ( AGE_HIST * ah, __int64 now,
+                                const FILETIME * mtime,
+                                const FILETIME * atime, __int64 size );
+void        AgeHistMerge    ( AGE_HIST * dst, const AGE_HIST * src );
+__int64     AgeHistOlder    ( const __int64 * buckets, UINT bucket );
+
+#endif // _AGEHIST_H
@@ -0,0 +1,1029 @@
+
+// archive.c - the folder tree inside a .zip, .tar or .tar.gz, from its
+// headers only
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "archive.h"
+#include "engine.h"
+#include "pathidx.h"
+#include "inflate.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+#define ARC_TAIL            ( 65535 + 22 + 20 ) // zip comment, EOCD, and
+                                                // the zip64 locator
+#define ARC_PAX_MAX         65536   // biggest pax header we look into
+#define ARC_NAME_MAX        4096    // member path, in bytes
+
+// where tar data comes from, the file or the gzip stream over it
+typedef struct _arc_stream
+{
+    HANDLE      hFile;
+    INFLATE     * z;        // NULL for a plain tar
+} ARC_STREAM;
+
+static BOOL             ArcZip          ( ARC_TREE * at, HANDLE hFile );
+static BOOL             ArcTar          ( ARC_TREE * at, HANDLE hFile,
+                                            BOOL gz );
+static BOOL             ArcAdd          ( ARC_TREE * at, const WCHAR * path,
+                                            UINT64 size, BOOL dir );
+static UINT             ArcChild        ( ARC_TREE * at, UINT parent,
+                                            const WCHAR * name, UINT len );
+static UINT             ArcNewDir       ( ARC_TREE * at, UINT parent,
+                                            const WCHAR * name, UINT len );
+static BOOL             ArcRehash       ( ARC_TREE * at );
+static BOOL             ArcReadAt       ( HANDLE hFile, UINT64 off,
+                                            void * buf, UINT len );
+static UINT             ArcStreamRead   ( ARC_STREAM * s, void * buf,
+                                            UINT len );
+static BOOL             ArcStreamSkip   ( ARC_STREAM * s, UINT64 len );
+static UINT64           ArcLe           ( const BYTE * p, UINT n );
+static UINT64           ArcTarNum       ( const BYTE * f, UINT len );
+static BOOL             ArcTarSum       ( const BYTE * hdr );
+static void             ArcWide         ( const char * s, UINT cp,
+                                            WCHAR * out, UINT cch );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcKind
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const WCHAR * name : file name
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: ARC_xxx by the extension, ARC_NONE if we can't look in
+/*--------------------------------------------------------------------@@-@@-*/
+UINT ArcKind ( const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    UINT_PTR len;
+
+    if ( name == NULL )
+        return ARC_NONE;
+
+    len = wcslen ( name );
+
+    if ( len > 4 && _wcsicmp ( name + len - 4, L".zip" ) == 0 )
+        return ARC_ZIP;
+
+    if ( len > 4 && _wcsicmp ( name + len - 4, L".tar" ) == 0 )
+        return ARC_TAR;
+
+    if ( ( len > 4 && _wcsicmp ( name + len - 4, L".tgz" ) == 0 ) ||
+            ( len > 7 && _wcsicmp ( name + len - 7, L".tar.gz" ) == 0 ) )
+        return ARC_TGZ;
+
+    return ARC_NONE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcRead
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: ARC_TREE * at             : receives the tree
+//    Param.    2: const WCHAR * path        : the archive
+//    Param.    3: UINT kind                 : ARC_xxx
+//    Param.    4: UINT max_levels           : folder levels kept inside
+//    Param.    5: const PAT_FILTER * filter : optional, for member files
+//    Param.    6: const WCHAR * rel         : archive path below the
+//                                             root, for path globs
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the archive's folders with their unpacked sizes. A zip
+//                 is read from the end: the directory is found in the
+//                 last 64 KB and read in one go. A tar is walked header
+//                 by header, seeking over the data; a .tar.gz has to be
+//                 inflated to find the headers, but the data only goes
+//                 through the 32 KB window, it's never kept. Returns
+//                 FALSE if the file can't be read or is damaged, with
+//                 what was found up to there in at. ArcFree it anyway.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ArcRead ( ARC_TREE * at, const WCHAR * path, UINT kind,
+    UINT max_levels, const PAT_FILTER * filter, const WCHAR * rel )
+/*--------------------------------------------------------------------------*/
+{
+    HANDLE          hFile;
+    LARGE_INTEGER   li;
+    FILETIME        ft;
+    UINT            i;
+    BOOL            ok;
+
+    if ( at == NULL )
+        return FALSE;
+
+    RtlZeroMemory ( at, sizeof ( ARC_TREE ) );
+
+    at->max_levels  = max_levels;
+    at->filter      = PatFilterActive ( filter ) ? filter : NULL;
+    at->rel         = ( rel != NULL ) ? rel : L"";
+
+    if ( path == NULL || kind == ARC_NONE ||
+            ArcNewDir ( at, ENG_NONE, L"", 0 ) == ENG_NONE )
+        return FALSE;
+
+    hFile = CreateFileW ( path, GENERIC_READ, FILE_SHARE_READ |
+        FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+
+    if ( hFile == INVALID_HANDLE_VALUE )
+        return FALSE;
+
+    ok = GetFileSizeEx ( hFile, &li );
+
+    if ( ok )
+    {
+        at->disk_size = (UINT64)li.QuadPart;
+
+        if ( GetFileTime ( hFile, NULL, NULL, &ft ) )
+            at->disk_time = ( (__int64)ft.dwHighDateTime << 32 ) |
+                ft.dwLowDateTime;
+
+        ok = ( kind == ARC_ZIP ) ? ArcZip ( at, hFile ) :
+            ArcTar ( at, hFile, ( kind == ARC_TGZ ) );
+    }
+
+    CloseHandle ( hFile );
+
+    // children always come after their parent
+    for ( i = 0; i < at->ndirs; i++ )
+        at->dirs[i].size = at->dirs[i].own;
+
+    for ( i = at->ndirs; --i > 0; )
+        at->dirs[at->dirs[i].parent].size += at->dirs[i].size;
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: ARC_TREE * at : from ArcRead
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void ArcFree ( ARC_TREE * at )
+/*--------------------------------------------------------------------------*/
+{
+    if ( at == NULL )
+        return;
+
+    free ( at->dirs );
+    free ( at->names );
+    free ( at->slots );
+    RtlZeroMemory ( at, sizeof ( ARC_TREE ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcZip
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: ARC_TREE * at : tree being read
+//    Param.    2: HANDLE hFile  : the zip
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: find the end of central directory record (and the
+//                 zip64 one, for big archives), then go through the
+//                 directory entries. Nothing before the directory is
+//                 read; if it fits in the tail already read, not even
+//                 that.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ArcZip ( ARC_TREE * at, HANDLE hFile )
+/*--------------------------------------------------------------------------*/
+{
+    BYTE    * tail, * cd, * big, * e, * x;
+    BYTE    rec[56];
+    WCHAR   name[ENG_MAX_PATH];
+    char    raw[ENG_MAX_PATH];
+    UINT64  base, cdoff, cdsize, usize, pos;
+    UINT    len, i, flags, nlen, xlen, clen, xl, cp;
+    BOOL    ok, dir;
+
+    len     = ( at->disk_size < ARC_TAIL ) ? (UINT)at->disk_size : ARC_TAIL;
+    base    = at->disk_size - len;
+    tail    = malloc ( len + 1 );
+
+    if ( tail == NULL || len < 22 || !ArcReadAt ( hFile, base, tail, len ) )
+    {
+        free ( tail );
+        return FALSE;
+    }
+
+    // backwards, the comment after it might hold anything
+    for ( i = len - 22 + 1; i--; )
+        if ( ArcLe ( tail + i, 4 ) == 0x06054B50 &&
+                i + 22 + ArcLe ( tail + i + 20, 2 ) <= len )
+            break;
+
+    if ( i == (UINT)-1 )
+    {
+        free ( tail );
+        return FALSE;
+    }
+
+    cdsize  = ArcLe ( tail + i + 12, 4 );
+    cdoff   = ArcLe ( tail + i + 16, 4 );
+
+    if ( ( cdsize == 0xFFFFFFFF || cdoff == 0xFFFFFFFF ||
+            ArcLe ( tail + i + 10, 2 ) == 0xFFFF ) && i >= 20 &&
+            ArcLe ( tail + i - 20, 4 ) == 0x07064B50 )
+    {
+        if ( !ArcReadAt ( hFile, ArcLe ( tail + i - 12, 8 ), rec, 56 ) ||
+                ArcLe ( rec, 4 ) != 0x06064B50 )
+        {
+            free ( tail );
+            return FALSE;
+        }
+
+        cdsize  = ArcLe ( rec + 40, 8 );
+        cdoff   = ArcLe ( rec + 48, 8 );
+    }
+
+    if ( cdoff > at->disk_size || cdsize > at->disk_size - cdoff ||
+            cdsize > ARC_MAX_CD )
+    {
+        free ( tail );
+        return FALSE;
+    }
+
+    // small archives have it all in the tail already
+    big = NULL;
+
+    if ( cdoff >= base )
+        cd = tail + ( cdoff - base );
+    else
+    {
+        big = malloc ( (UINT_PTR)cdsize + 1 );
+
+        if ( big == NULL || !ArcReadAt ( hFile, cdoff, big, (UINT)cdsize ) )
+        {
+            free ( big );
+            free ( tail );
+            return FALSE;
+        }
+
+        cd = big;
+    }
+
+    ok = TRUE;
+
+    for ( pos = 0; ok && pos + 46 <= cdsize; pos += 46 + nlen + xlen + clen )
+    {
+        e       = cd + pos;
+        flags   = (UINT)ArcLe ( e + 8, 2 );
+        usize   = ArcLe ( e + 24, 4 );
+        nlen    = (UINT)ArcLe ( e + 28, 2 );
+        xlen    = (UINT)ArcLe ( e + 30, 2 );
+        clen    = (UINT)ArcLe ( e + 32, 2 );
+
+        if ( ArcLe ( e, 4 ) != 0x02014B50 ||
+                pos + 46 + nlen + xlen + clen > cdsize )
+        {
+            ok = FALSE;
+            break;
+        }
+
+        len = ( nlen < ARRAYSIZE(raw) ) ? nlen : ARRAYSIZE(raw) - 1;
+        CopyMemory ( raw, e + 46, len );
+
+        // bit 11, UTF-8 names, otherwise the old DOS code page
+        cp = ( flags & 0x800 ) ? CP_UTF8 : 437;
+
+        // the real size is in the zip64 extra field, Info-ZIP puts a
+        // UTF-8 copy of a DOS name in its own
+        for ( x = e + 46 + nlen; x + 4 <= e + 46 + nlen + xlen;
+                x += 4 + ArcLe ( x + 2, 2 ) )
+        {
+            xl = (UINT)ArcLe ( x + 2, 2 );
+
+            if ( ArcLe ( x, 2 ) == 0x0001 && xl >= 8 &&
+                    usize == 0xFFFFFFFF )
+                usize = ArcLe ( x + 4, 8 );
+            else if ( ArcLe ( x, 2 ) == 0x7075 && xl > 5 && x[4] == 1 &&
+                    x + 4 + xl <= e + 46 + nlen + xlen )
+            {
+                len = ( xl - 5 < ARRAYSIZE(raw) ) ? xl - 5 :
+                    ARRAYSIZE(raw) - 1;
+                CopyMemory ( raw, x + 9, len );
+                cp = CP_UTF8;
+            }
+        }
+
+        raw[len] = '\0';
+        ArcWide ( raw, cp, name, ARRAYSIZE(name) );
+
+        dir = ( len != 0 && ( raw[len-1] == '/' || raw[len-1] == '\\' ) );
+        ok  = ArcAdd ( at, name, usize, dir );
+    }
+
+    free ( big );
+    free ( tail );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcTar
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: ARC_TREE * at : tree being read
+//    Param.    2: HANDLE hFile  : the tar
+//    Param.    3: BOOL gz       : gzipped
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one 512 byte header per member, the data after it is
+//                 skipped. Knows ustar prefixes, GNU long names (L) and
+//                 pax headers (x, path and size only).
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ArcTar ( ARC_TREE * at, HANDLE hFile, BOOL gz )
+/*--------------------------------------------------------------------------*/
+{
+    ARC_STREAM  s;
+    BYTE        hdr[512];
+    char        path[ARC_NAME_MAX], lname[ARC_NAME_MAX];
+    WCHAR       name[ENG_MAX_PATH];
+    char        * pax, * p, * q, * end;
+    UINT64      size, stored, pax_size, n;
+    UINT        len, i;
+    BOOL        ok, dir, have_lname, have_path, have_size;
+    BYTE        type;
+
+    s.hFile = hFile;
+    s.z     = NULL;
+    pax     = malloc ( ARC_PAX_MAX + 1 );
+
+    if ( pax == NULL )
+        return FALSE;
+
+    if ( gz )
+    {
+        s.z = malloc ( sizeof ( INFLATE ) );
+
+        if ( s.z == NULL || !InflateInit ( s.z, hFile ) )
+        {
+            free ( s.z );
+            free ( pax );
+            return FALSE;
+        }
+    }
+
+    ok          = TRUE;
+    have_lname  = FALSE;
+    have_path   = FALSE;
+    have_size   = FALSE;
+    pax_size    = 0;
+
+    for ( ;; )
+    {
+        // the end is two zero blocks, some tools leave them out
+        if ( ArcStreamRead ( &s, hdr, 512 ) != 512 )
+        {
+            ok = ( s.z == NULL || !s.z->error );
+            break;
+        }
+
+        for ( i = 0; i < 512 && hdr[i] == 0; i++ )
+            ;
+
+        if ( i == 512 )
+            break;
+
+        if ( !ArcTarSum ( hdr ) )
+        {
+            ok = FALSE;
+            break;
+        }
+
+        stored  = ArcTarNum ( hdr + 124, 12 );
+        type    = hdr[156];
+        n       = ( stored + 511 ) & ~(UINT64)511;
+
+        // GNU long name, the member's path is the data
+        if ( type == 'L' || type == 'x' )
+        {
+            len = ( stored < ARC_PAX_MAX ) ? (UINT)stored : ARC_PAX_MAX;
+
+            if ( ArcStreamRead ( &s, pax, len ) != len ||
+                    !ArcStreamSkip ( &s, n - len ) )
+            {
+                ok = FALSE;
+                break;
+            }
+
+            pax[len] = '\0';
+
+            if ( type == 'L' )
+            {
+                lstrcpynA ( lname, pax, ARC_NAME_MAX );
+                have_lname = TRUE;
+                continue;
+            }
+
+            // pax records are "<length> <key>=<value>\n"
+            for ( p = pax, end = pax + len; p < end; p += i )
+            {
+                i = (UINT)strtoul ( p, &q, 10 );
+
+                if ( i == 0 || *q != ' ' || i > (UINT)( end - p ) )
+                    break;
+
+                p[i-1] = '\0';
+
+                if ( strncmp ( q + 1, "path=", 5 ) == 0 )
+                {
+                    lstrcpynA ( lname, q + 6, ARC_NAME_MAX );
+                    have_path = TRUE;
+                }
+                else if ( strncmp ( q + 1, "size=", 5 ) == 0 )
+                {
+                    pax_size    = _strtoui64 ( q + 6, NULL, 10 );
+                    have_size   = TRUE;
+                }
+            }
+
+            continue;
+        }
+
+        // global pax, long link names, volume labels: nothing for us
+        if ( type == 'g' || type == 'K' || type == 'V' )
+        {
+            if ( !ArcStreamSkip ( &s, n ) )
+            {
+                ok = FALSE;
+                break;
+            }
+
+            continue;
+        }
+
+        if ( have_lname || have_path )
+            lstrcpynA ( path, lname, ARC_NAME_MAX );
+        else
+        {
+            // ustar (not GNU) has a prefix for long paths
+            len = 0;
+
+            if ( memcmp ( hdr + 257, "ustar\0", 6 ) == 0 && hdr[345] )
+            {
+                for ( ; len < 155 && hdr[345+len]; len++ )
+                    path[len] = (char)hdr[345+len];
+
+                path[len++] = '/';
+            }
+
+            for ( i = 0; i < 100 && hdr[i]; i++ )
+                path[len++] = (char)hdr[i];
+
+            path[len] = '\0';
+        }
+
+        if ( have_size )
+        {
+            stored  = pax_size;
+            n       = ( stored + 511 ) & ~(UINT64)511;
+        }
+
+        // links and devices have no data of their own
+        size = stored;
+
+        if ( type >= '1' && type <= '6' )
+            size = 0;
+        else if ( type == 'S' )
+            size = ArcTarNum ( hdr + 483, 12 );
+
+        len = (UINT)strlen ( path );
+        dir = ( type == '5' || ( len != 0 && path[len-1] == '/' ) );
+
+        ArcWide ( path, CP_UTF8, name, ARRAYSIZE(name) );
+
+        if ( !ArcAdd ( at, name, size, dir ) || !ArcStreamSkip ( &s, n ) )
+        {
+            ok = FALSE;
+            break;
+        }
+
+        have_lname  = FALSE;
+        have_path   = FALSE;
+        have_size   = FALSE;
+    }
+
+    free ( s.z );
+    free ( pax );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcAdd
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: ARC_TREE * at      : tree being read
+//    Param.    2: const WCHAR * path : member path, / or \ separated
+//    Param.    3: UINT64 size        : unpacked size
+//    Param.    4: BOOL dir           : it's a folder entry
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: make the member's folders (archives don't always list
+//                 them) and count a file into the last one. Past
+//                 max_levels, files count into the deepest folder kept.
+//                 The filter goes over every folder on the way, as the
+//                 walk would. Returns FALSE if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ArcAdd ( ARC_TREE * at, const WCHAR * path, UINT64 size,
+    BOOL dir )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR           rel[ENG_MAX_PATH];
+    const WCHAR     * p, * q;
+    UINT            cur, level, len, rlen;
+    BOOL            named;
+
+    cur     = 0;
+    level   = 0;
+    p       = path;
+
+    // path globs see the members as if the archive were a folder
+    rlen    = (UINT)wcslen ( at->rel );
+
+    if ( rlen >= ARRAYSIZE(rel) )
+        rlen = 0;
+
+    wmemcpy ( rel, at->rel, rlen );
+    rel[rlen] = L'\0';
+
+    for ( ;; )
+    {
+        while ( *p == L'/' || *p == L'\\' )
+            p++;
+
+        for ( q = p; *q != L'\0' && *q != L'/' && *q != L'\\'; q++ )
+            ;
+
+        len = (UINT)( q - p );
+
+        if ( len == 0 )
+            break;
+
+        if ( ( len == 1 && p[0] == L'.' ) ||
+                ( len == 2 && p[0] == L'.' && p[1] == L'.' ) )
+        {
+            p = q;
+            continue;
+        }
+
+        // the name is the tail of rel, NUL terminated there
+        named = ( rlen + len + 2 < ARRAYSIZE(rel) );
+
+        if ( named )
+        {
+            rel[rlen++] = L'\\';
+            wmemcpy ( rel + rlen, p, len );
+            rlen += len;
+            rel[rlen] = L'\0';
+        }
+
+        // a file's last component is its name
+        if ( *q == L'\0' && !dir )
+        {
+            if ( at->filter != NULL && named && PatSkipEntry ( at->filter,
+                    rel + rlen - len, rel, FALSE ) )
+                return TRUE;
+
+            at->dirs[cur].own  += (__int64)size;
+            at->dirs[cur].files++;
+
+            return TRUE;
+        }
+
+        // excluded folders take all below with them
+        if ( at->filter != NULL && named && PatSkipEntry ( at->filter,
+                rel + rlen - len, rel, TRUE ) )
+            return TRUE;
+
+        if ( level < at->max_levels )
+        {
+            cur = ArcChild ( at, cur, p, len );
+
+            if ( cur == ENG_NONE )
+                return FALSE;
+
+            level++;
+        }
+
+        p = q;
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcChild
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: ARC_TREE * at      : tree being read
+//    Param.    2: UINT parent        : folder
+//    Param.    3: const WCHAR * name : subfolder name
+//    Param.    4: UINT len           : its length
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the subfolder, made if it isn't there yet. ENG_NONE if
+//                 out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT ArcChild ( ARC_TREE * at, UINT parent, const WCHAR * name,
+    UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    ARC_DIR     * d;
+    UINT        mask, j, k;
+
+    mask = at->nslots - 1;
+
+    for ( j = PathIdxHash ( parent, name, len ) & mask; ;
+            j = ( j + 1 ) & mask )
+    {
+        k = at->slots[j];
+
+        if ( k == ENG_NONE )
+            break;
+
+        d = &at->dirs[k];
+
+        if ( d->parent == parent && d->nlen == len &&
+                _wcsnicmp ( at->names + d->name, name, len ) == 0 )
+            return k;
+    }
+
+    return ArcNewDir ( at, parent, name, len );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcNewDir
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: ARC_TREE * at      : tree being read
+//    Param.    2: UINT parent        : folder, ENG_NONE for the archive
+//    Param.    3: const WCHAR * name : subfolder name
+//    Param.    4: UINT len           : its length
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: append a folder, link it to its parent and hash it.
+//                 ENG_NONE if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT ArcNewDir ( ARC_TREE * at, UINT parent, const WCHAR * name,
+    UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    ARC_DIR     * d;
+    WCHAR       * names;
+    UINT        cap, k, j, mask;
+
+    if ( len > 0xFFFF )
+        len = 0xFFFF;
+
+    if ( at->ndirs == at->dirs_cap )
+    {
+        cap = at->dirs_cap ? at->dirs_cap * 2 : 64;
+        d   = realloc ( at->dirs, (UINT_PTR)cap * sizeof ( ARC_DIR ) );
+
+        if ( d == NULL )
+            return ENG_NONE;
+
+        at->dirs        = d;
+        at->dirs_cap    = cap;
+    }
+
+    if ( at->names_len + len + 1 > at->names_cap )
+    {
+        cap = at->names_cap ? at->names_cap * 2 : 4096;
+
+        while ( cap < at->names_len + len + 1 )
+            cap *= 2;
+
+        names = realloc ( at->names, (UINT_PTR)cap * sizeof ( WCHAR ) );
+
+        if ( names == NULL )
+            return ENG_NONE;
+
+        at->names       = names;
+        at->names_cap   = cap;
+    }
+
+    // keep it under half full
+    if ( ( at->ndirs + 1 ) * 2 > at->nslots && !ArcRehash ( at ) )
+        return ENG_NONE;
+
+    k   = at->ndirs++;
+    d   = &at->dirs[k];
+
+    RtlZeroMemory ( d, sizeof ( ARC_DIR ) );
+
+    d->parent   = parent;
+    d->name     = at->names_len;
+    d->nlen     = (USHORT)len;
+    d->child    = ENG_NONE;
+    d->last     = ENG_NONE;
+    d->next     = ENG_NONE;
+
+    wmemcpy ( at->names + at->names_len, name, len );
+    at->names[at->names_len + len] = L'\0';
+    at->names_len += len + 1;
+
+    if ( parent != ENG_NONE )
+    {
+        if ( at->dirs[parent].last == ENG_NONE )
+            at->dirs[parent].child = k;
+        else
+            at->dirs[at->dirs[parent].last].next = k;
+
+        at->dirs[parent].last = k;
+    }
+
+    mask = at->nslots - 1;
+
+    for ( j = PathIdxHash ( parent, name, len ) & mask;
+            at->slots[j] != ENG_NONE; j = ( j + 1 ) & mask )
+        ;
+
+    at->slots[j] = k;
+
+    return k;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcRehash
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: ARC_TREE * at : tree being read
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: twice the slots, every folder hashed again
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ArcRehash ( ARC_TREE * at )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    * slots;
+    UINT    nslots, mask, i, j;
+
+    nslots  = at->nslots ? at->nslots * 2 : 256;
+    slots   = malloc ( (UINT_PTR)nslots * sizeof ( UINT ) );
+
+    if ( slots == NULL )
+        return FALSE;
+
+    FillMemory ( slots, (UINT_PTR)nslots * sizeof ( UINT ), 0xFF );
+
+    mask = nslots - 1;
+
+    for ( i = 0; i < at->ndirs; i++ )
+    {
+        for ( j = PathIdxHash ( at->dirs[i].parent, at->names +
+                at->dirs[i].name, at->dirs[i].nlen ) & mask;
+                slots[j] != ENG_NONE; j = ( j + 1 ) & mask )
+            ;
+
+        slots[j] = i;
+    }
+
+    free ( at->slots );
+
+    at->slots   = slots;
+    at->nslots  = nslots;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcReadAt
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: HANDLE hFile : file
+//    Param.    2: UINT64 off   : where from
+//    Param.    3: void * buf   : where to
+//    Param.    4: UINT len     : how many bytes, all or nothing
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ArcReadAt ( HANDLE hFile, UINT64 off, void * buf, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    LARGE_INTEGER   li;
+    DWORD           got;
+    UINT            done;
+
+    li.QuadPart = (LONGLONG)off;
+
+    if ( !SetFilePointerEx ( hFile, li, NULL, FILE_BEGIN ) )
+        return FALSE;
+
+    for ( done = 0; done < len; done += got )
+        if ( !ReadFile ( hFile, (BYTE *)buf + done, len - done, &got,
+                NULL ) || got == 0 )
+            return FALSE;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcStreamRead
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: ARC_STREAM * s : tar data
+//    Param.    2: void * buf     : where to
+//    Param.    3: UINT len       : bytes wanted
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: returns how many there were, less than len at the end
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT ArcStreamRead ( ARC_STREAM * s, void * buf, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    DWORD   got;
+    UINT    done;
+
+    if ( s->z != NULL )
+        return InflateRead ( s->z, buf, len );
+
+    for ( done = 0; done < len; done += got )
+        if ( !ReadFile ( s->hFile, (BYTE *)buf + done, len - done, &got,
+                NULL ) || got == 0 )
+            break;
+
+    return done;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcStreamSkip
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: ARC_STREAM * s : tar data
+//    Param.    2: UINT64 len     : bytes to go past
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: a seek for a plain tar; gzip has to be inflated through,
+//                 into nowhere. FALSE if the stream ends first.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ArcStreamSkip ( ARC_STREAM * s, UINT64 len )
+/*--------------------------------------------------------------------------*/
+{
+    LARGE_INTEGER   li;
+    UINT            chunk;
+
+    if ( s->z == NULL )
+    {
+        li.QuadPart = (LONGLONG)len;
+        return SetFilePointerEx ( s->hFile, li, NULL, FILE_CURRENT );
+    }
+
+    while ( len != 0 )
+    {
+        chunk = ( len < ( 1U << 30 ) ) ? (UINT)len : ( 1U << 30 );
+
+        if ( InflateRead ( s->z, NULL, chunk ) != chunk )
+            return FALSE;
+
+        len -= chunk;
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcLe
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT64
+//    Param.    1: const BYTE * p : little endian number
+//    Param.    2: UINT n         : bytes in it, up to 8
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT64 ArcLe ( const BYTE * p, UINT n )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64 v;
+
+    for ( v = 0; n--; )
+        v = ( v << 8 ) | p[n];
+
+    return v;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcTarNum
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT64
+//    Param.    1: const BYTE * f : tar header number field
+//    Param.    2: UINT len       : its size
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: octal text, or big endian binary if the top bit of the
+//                 first byte is set (GNU, for sizes past 8 GB)
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT64 ArcTarNum ( const BYTE * f, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  v;
+    UINT    i;
+
+    v = 0;
+
+    if ( f[0] & 0x80 )
+    {
+        for ( i = 0; i < len; i++ )
+            v = ( v << 8 ) | ( i ? f[i] : ( f[0] & 0x7F ) );
+
+        return v;
+    }
+
+    for ( i = 0; i < len && ( f[i] == ' ' || f[i] == '\0' ); i++ )
+        ;
+
+    for ( ; i < len && f[i] >= '0' && f[i] <= '7'; i++ )
+        v = ( v << 3 ) | (UINT64)( f[i] - '0' );
+
+    return v;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcTarSum
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: const BYTE * hdr : 512 byte tar header
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the header checksum, with the checksum field counted as
+//                 spaces. Some old tars summed signed chars, both go.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ArcTarSum ( const BYTE * hdr )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  want;
+    UINT    sum;
+    int     ssum;
+    UINT    i;
+
+    want    = ArcTarNum ( hdr + 148, 8 );
+    sum     = 0;
+    ssum    = 0;
+
+    for ( i = 0; i < 512; i++ )
+    {
+        if ( i >= 148 && i < 156 )
+        {
+            sum    += ' ';
+            ssum   += ' ';
+        }
+        else
+        {
+            sum    += hdr[i];
+            ssum   += (signed char)hdr[i];
+        }
+    }
+
+    return ( want == sum || want == (UINT64)(UINT)ssum );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ArcWide
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const char * s : member path, NUL terminated
+//    Param.    2: UINT cp        : its code page
+//    Param.    3: WCHAR * out    : receives it
+//    Param.    4: UINT cch       : size of out, in chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: to UTF-16. Names that aren't valid UTF-8 come from
+//                 tools writing the local code page, they get that.
+/*--------------------------------------------------------------------@@-@@-*/
+static void ArcWide ( const char * s, UINT cp, WCHAR * out, UINT cch )
+/*--------------------------------------------------------------------------*/
+{
+    if ( MultiByteToWideChar ( cp, ( cp == CP_UTF8 ) ?
+            MB_ERR_INVALID_CHARS : 0, s, -1, out, (int)cch ) != 0 )
+        return;
+
+    if ( MultiByteToWideChar ( CP_ACP, 0, s, -1, out, (int)cch ) == 0 )
+        out[0] = L'\0';
+
+    out[cch-1] = L'\0';
+}
@@ -0,0 +1,57 @@
+
+// archive.h - the folder tree inside a .zip, .tar or .tar.gz, from its
+// headers only
+
+#ifndef _ARCHIVE_H
+#define _ARCHIVE_H
+
+#include <windows.h>
+#include "pattern.h"
+
+#define ARC_NONE            0
+#define ARC_ZIP             1
+#define ARC_TAR             2
+#define ARC_TGZ             3
+
+#define ARC_MAX_CD          ( 256U << 20 ) // biggest zip directory we read
+
+// a folder inside the archive
+typedef struct _arc_dir
+{
+    UINT        parent;     // ENG_NONE for the archive itself
+    UINT        name;       // offset of the NUL terminated name
+    USHORT      nlen;
+    UINT        child;      // first subfolder, ENG_NONE if none
+    UINT        last;       // last one, to append to
+    UINT        next;       // next sibling
+    __int64     own;        // unpacked bytes of the files right inside
+    __int64     size;       // own plus all below, once ArcRead is done
+    UINT        files;
+} ARC_DIR;
+
+// ArcRead's result. Folders are numbered as met, parents before
+// children; dirs[0] is the archive.
+typedef struct _arc_tree
+{
+    ARC_DIR     * dirs;
+    UINT        ndirs;
+    UINT        dirs_cap;
+    WCHAR       * names;
+    UINT        names_len;
+    UINT        names_cap;
+    UINT        * slots;    // (parent, name) hash, as in pathidx
+    UINT        nslots;
+    UINT        max_levels; // folders deeper down count into their parent
+    const PAT_FILTER * filter; // optional, for the member files
+    const WCHAR * rel;      // archive path below the root, for the filter
+    UINT64      disk_size;  // the archive file's own size
+    __int64     disk_time;  // and last write time, FILETIME
+} ARC_TREE;
+
+UINT    ArcKind         ( const WCHAR * name );
+BOOL    ArcRead         ( ARC_TREE * at, const WCHAR * path, UINT kind,
+                            UINT max_levels, const PAT_FILTER * filter,
+                            const WCHAR * rel );
+void    ArcFree         ( ARC_TREE * at );
+
+#endif // _ARCHIVE_H
@@ -0,0 +1,323 @@
+
+// colstat.c - sums, ranges and histograms over one engine column at a time
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "colstat.h"
+#include <windows.h>
+#include <limits.h>
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ColSum64
+/*--------------------------------------------------------------------------*/
+//           Type: __int64
+//    Param.    1: const __int64 * c : column
+//    Param.    2: const BYTE * sel  : 1 per value to add, or NULL for all
+//    Param.    3: UINT n            : values
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: four sums side by side, so no add waits for the one
+//                 before it; a value left out is anded with 0, not
+//                 jumped over
+/*--------------------------------------------------------------------@@-@@-*/
+__int64 ColSum64 ( const __int64 * c, const BYTE * sel, UINT n )
+/*--------------------------------------------------------------------------*/
+{
+    __int64 s0, s1, s2, s3;
+    UINT    i, n4;
+
+    s0  = 0;
+    s1  = 0;
+    s2  = 0;
+    s3  = 0;
+    n4  = n & ~3U;
+
+    if ( sel == NULL )
+    {
+        for ( i = 0; i < n4; i += 4 )
+        {
+            s0 += c[i];
+            s1 += c[i+1];
+            s2 += c[i+2];
+            s3 += c[i+3];
+        }
+
+        for ( ; i < n; i++ )
+            s0 += c[i];
+    }
+    else
+    {
+        for ( i = 0; i < n4; i += 4 )
+        {
+            s0 += c[i] & -(__int64)sel[i];
+            s1 += c[i+1] & -(__int64)sel[i+1];
+            s2 += c[i+2] & -(__int64)sel[i+2];
+            s3 += c[i+3] & -(__int64)sel[i+3];
+        }
+
+        for ( ; i < n; i++ )
+            s0 += c[i] & -(__int64)sel[i];
+    }
+
+    return s0 + s1 + s2 + s3;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ColSum32
+/*--------------------------------------------------------------------------*/
+//           Type: UINT64
+//    Param.    1: const UINT * c   : column
+//    Param.    2: const BYTE * sel : 1 per value to add, or NULL for all
+//    Param.    3: UINT n           : values
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: as ColSum64, into 64 bits so it can't wrap
+/*--------------------------------------------------------------------@@-@@-*/
+UINT64 ColSum32 ( const UINT * c, const BYTE * sel, UINT n )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  s0, s1, s2, s3;
+    UINT    i, n4;
+
+    s0  = 0;
+    s1  = 0;
+    s2  = 0;
+    s3  = 0;
+    n4  = n & ~3U;
+
+    if ( sel == NULL )
+    {
+        for ( i = 0; i < n4; i += 4 )
+        {
+            s0 += c[i];
+            s1 += c[i+1];
+            s2 += c[i+2];
+            s3 += c[i+3];
+        }
+
+        for ( ; i < n; i++ )
+            s0 += c[i];
+    }
+    else
+    {
+        for ( i = 0; i < n4; i += 4 )
+        {
+            s0 += c[i] & -(UINT)sel[i];
+            s1 += c[i+1] & -(UINT)sel[i+1];
+            s2 += c[i+2] & -(UINT)sel[i+2];
+            s3 += c[i+3] & -(UINT)sel[i+3];
+        }
+
+        for ( ; i < n; i++ )
+            s0 += c[i] & -(UINT)sel[i];
+    }
+
+    return s0 + s1 + s2 + s3;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ColMax64
+/*--------------------------------------------------------------------------*/
+//           Type: __int64
+//    Param.    1: const __int64 * c : column
+//    Param.    2: const BYTE * sel  : 1 per value to look at, or NULL
+//    Param.    3: UINT n            : values
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the biggest value, LLONG_MIN if none was looked at.
+//                 Selects rather than branches, a compare and a blend.
+/*--------------------------------------------------------------------@@-@@-*/
+__int64 ColMax64 ( const __int64 * c, const BYTE * sel, UINT n )
+/*--------------------------------------------------------------------------*/
+{
+    __int64 m0, m1, x;
+    UINT    i, n2;
+
+    m0  = LLONG_MIN;
+    m1  = LLONG_MIN;
+    n2  = n & ~1U;
+
+    for ( i = 0; i < n2; i += 2 )
+    {
+        x   = ( sel == NULL || sel[i] ) ? c[i] : LLONG_MIN;
+        m0  = ( x > m0 ) ? x : m0;
+        x   = ( sel == NULL || sel[i+1] ) ? c[i+1] : LLONG_MIN;
+        m1  = ( x > m1 ) ? x : m1;
+    }
+
+    if ( i < n && ( sel == NULL || sel[i] ) && c[i] > m0 )
+        m0 = c[i];
+
+    return ( m0 > m1 ) ? m0 : m1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ColRange64
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: const __int64 * c : column
+//    Param.    2: const BYTE * sel  : 1 per value to test, or NULL
+//    Param.    3: UINT n            : values
+//    Param.    4: __int64 lo        : lowest in, inclusive
+//    Param.    5: __int64 hi        : highest in, inclusive, >= lo
+//    Param.    6: BYTE * out        : receives 1 per value in, 0 else
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: lo <= x <= hi is x - lo <= hi - lo, unsigned: one
+//                 compare and an and per value, nothing to branch on
+/*--------------------------------------------------------------------@@-@@-*/
+void ColRange64 ( const __int64 * c, const BYTE * sel, UINT n, __int64 lo,
+    __int64 hi, BYTE * out )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  span;
+    UINT    i;
+
+    span = (UINT64)hi - (UINT64)lo;
+
+    if ( sel == NULL )
+        for ( i = 0; i < n; i++ )
+            out[i] = ( (UINT64)c[i] - (UINT64)lo <= span );
+    else
+        for ( i = 0; i < n; i++ )
+            out[i] = sel[i] & ( (UINT64)c[i] - (UINT64)lo <= span );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ColRange32
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: const UINT * c   : column
+//    Param.    2: const BYTE * sel : 1 per value to test, or NULL
+//    Param.    3: UINT n           : values
+//    Param.    4: __int64 lo       : lowest in, inclusive
+//    Param.    5: __int64 hi       : highest in, inclusive, >= lo
+//    Param.    6: BYTE * out       : receives 1 per value in, 0 else
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: ColRange64 for a 32 bit column. Bounds outside
+//                 0..UINT_MAX are clamped first, so the compare stays
+//                 32 bits wide.
+/*--------------------------------------------------------------------@@-@@-*/
+void ColRange32 ( const UINT * c, const BYTE * sel, UINT n, __int64 lo,
+    __int64 hi, BYTE * out )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    l, span, i;
+
+    if ( hi < 0 || lo > (__int64)UINT_MAX )
+    {
+        RtlZeroMemory ( out, n );
+        return;
+    }
+
+    l       = ( lo < 0 ) ? 0 : (UINT)lo;
+    span    = ( ( hi > (__int64)UINT_MAX ) ? UINT_MAX : (UINT)hi ) - l;
+
+    if ( sel == NULL )
+        for ( i = 0; i < n; i++ )
+            out[i] = ( c[i] - l <= span );
+    else
+        for ( i = 0; i < n; i++ )
+            out[i] = sel[i] & ( c[i] - l <= span );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ColRange16
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: const USHORT * c : column
+//    Param.    2: const BYTE * sel : 1 per value to test, or NULL
+//    Param.    3: UINT n           : values
+//    Param.    4: __int64 lo       : lowest in, inclusive
+//    Param.    5: __int64 hi       : highest in, inclusive, >= lo
+//    Param.    6: BYTE * out       : receives 1 per value in, 0 else
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: as ColRange32, for a 16 bit column
+/*--------------------------------------------------------------------@@-@@-*/
+void ColRange16 ( const USHORT * c, const BYTE * sel, UINT n, __int64 lo,
+    __int64 hi, BYTE * out )
+/*--------------------------------------------------------------------------*/
+{
+    USHORT  l, span;
+    UINT    i;
+
+    if ( hi < 0 || lo > USHRT_MAX )
+    {
+        RtlZeroMemory ( out, n );
+        return;
+    }
+
+    l       = ( lo < 0 ) ? 0 : (USHORT)lo;
+    span    = (USHORT)( ( ( hi > USHRT_MAX ) ? USHRT_MAX : hi ) - l );
+
+    if ( sel == NULL )
+        for ( i = 0; i < n; i++ )
+            out[i] = ( (USHORT)( c[i] - l ) <= span );
+    else
+        for ( i = 0; i < n; i++ )
+            out[i] = sel[i] & ( (USHORT)( c[i] - l ) <= span );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ColHist64
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const __int64 * c     : column to bin
+//    Param.    2: const __int64 * w     : weight per value, or NULL
+//    Param.    3: const BYTE * sel      : 1 per value to count, or NULL
+//    Param.    4: UINT n                : values
+//    Param.    5: const __int64 * edges : where each bin but the first
+//                                         starts, ascending
+//    Param.    6: UINT nedges           : how many, up to COL_MAX_EDGES
+//    Param.    7: UINT64 * count        : receives values per bin,
+//                                         nedges + 1 of them
+//    Param.    8: __int64 * weight      : receives the weights per bin,
+//                                         or NULL
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: a value's bin is how many edges it's at or past, a sum
+//                 of compares rather than a search, the same few steps
+//                 for every value. A value left out still goes to a bin,
+//                 adding 0.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ColHist64 ( const __int64 * c, const __int64 * w, const BYTE * sel,
+    UINT n, const __int64 * edges, UINT nedges, UINT64 * count,
+    __int64 * weight )
+/*--------------------------------------------------------------------------*/
+{
+    __int64 x, mask;
+    UINT    i, k, bin;
+
+    if ( c == NULL || count == NULL || nedges > COL_MAX_EDGES )
+        return FALSE;
+
+    RtlZeroMemory ( count, ( nedges + 1 ) * sizeof ( UINT64 ) );
+
+    if ( weight != NULL )
+        RtlZeroMemory ( weight, ( nedges + 1 ) * sizeof ( __int64 ) );
+
+    for ( i = 0; i < n; i++ )
+    {
+        x   = c[i];
+        bin = 0;
+
+        for ( k = 0; k < nedges; k++ )
+            bin += ( x >= edges[k] );
+
+        mask        = ( sel == NULL ) ? -1 : -(__int64)sel[i];
+        count[bin]  += mask & 1;
+
+        if ( weight != NULL && w != NULL )
+            weight[bin] += w[i] & mask;
+    }
+
+    return TRUE;
+}
@@ -0,0 +1,29 @@
+
+// colstat.h - sums, ranges and histograms over one engine column at a
+// time, for reports over every folder
+
+#ifndef _COLSTAT_H
+#define _COLSTAT_H
+
+#include <windows.h>
+
+#define COL_MAX_EDGES       15      // ColHist bin edges, bins are one more
+
+// All of them take n values of one column and, optionally, a selection:
+// a byte per value, 1 to count it, 0 not to (NULL counts everything).
+// Nothing in the loops depends on the values, so they run straight
+// through and the compiler is free to use vector registers on them.
+__int64 ColSum64        ( const __int64 * c, const BYTE * sel, UINT n );
+UINT64  ColSum32        ( const UINT * c, const BYTE * sel, UINT n );
+__int64 ColMax64        ( const __int64 * c, const BYTE * sel, UINT n );
+void    ColRange64      ( const __int64 * c, const BYTE * sel, UINT n,
+                            __int64 lo, __int64 hi, BYTE * out );
+void    ColRange32      ( const UINT * c, const BYTE * sel, UINT n,
+                            __int64 lo, __int64 hi, BYTE * out );
+void    ColRange16      ( const USHORT * c, const BYTE * sel, UINT n,
+                            __int64 lo, __int64 hi, BYTE * out );
+BOOL    ColHist64       ( const __int64 * c, const __int64 * w,
+                            const BYTE * sel, UINT n, const __int64 * edges,
+                            UINT nedges, UINT64 * count, __int64 * weight );
+
+#endif // _COLSTAT_H
@@ -0,0 +1,924 @@
+
+// dupes.c - staged duplicate file finder (--dupes)
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "dupes.h"
+#include <windows.h>
+#include <process.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+// XXH64 primes
+#define P64_1   0x9E3779B185EBCA87ULL
+#define P64_2   0xC2B2AE3D27D4EB4FULL
+#define P64_3   0x165667B19E3779F9ULL
+#define P64_4   0x85EBCA77C2B2AE63ULL
+#define P64_5   0x27D4EB2F165667C5ULL
+
+#define ROTL64(x,r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+// work shared by the hashing threads of one stage
+typedef struct _dupe_job
+{
+    DUPE_LIST       * dl;
+    UINT            stage;      // files in this stage get hashed
+    volatile LONG   next;       // next file to pick up
+    volatile LONG64 bytes_read;
+} DUPE_JOB;
+
+static UINT __stdcall   DupeWorker      ( void * param );
+static BOOL             DupeRunStage    ( DUPE_LIST * dl, UINT stage,
+                                            UINT threads );
+static UINT_PTR         DupeKeepGroups  ( DUPE_LIST * dl, BOOL by_hash );
+static BOOL             DupeQuickHash   ( HANDLE hFile, DUPE_FILE * df,
+                                            BYTE * buf, __int64 * nread );
+static BOOL             DupeFullHash    ( HANDLE hFile, DUPE_FILE * df,
+                                            BYTE * buf, __int64 * nread );
+static int              DupeCmpSize     ( const void * a, const void * b );
+static int              DupeCmpHash     ( const void * a, const void * b );
+static int              DupeCmpSet      ( const void * a, const void * b );
+static int              DupeCmpFolder   ( const void * a, const void * b );
+static int              DupeCmpWaste    ( const void * a, const void * b );
+
+// qsort has no context param, the comparers need the path arena
+static const DUPE_LIST  * gSortList;
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeListInit
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: DUPE_LIST * dl     : list to set up
+//    Param.    2: __int64 min_size   : ignore files smaller than this
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: empty list, ready for DupeListAdd. Empty files are never
+//                 worth reporting, so min_size is at least 1.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL DupeListInit ( DUPE_LIST * dl, __int64 min_size )
+/*--------------------------------------------------------------------------*/
+{
+    if ( dl == NULL )
+        return FALSE;
+
+    RtlZeroMemory ( dl, sizeof ( DUPE_LIST ) );
+
+    dl->min_size = ( min_size < 1 ) ? 1 : min_size;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeListFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: DUPE_LIST * dl : list to release
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void DupeListFree ( DUPE_LIST * dl )
+/*--------------------------------------------------------------------------*/
+{
+    if ( dl == NULL )
+        return;
+
+    free ( dl->files );
+    free ( dl->arena );
+    free ( dl->sets );
+
+    RtlZeroMemory ( dl, sizeof ( DUPE_LIST ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeListAdd
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: DUPE_LIST * dl     : list
+//    Param.    2: const WCHAR * path : full path to file
+//    Param.    3: __int64 size       : file size, as enumerated
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: remember a file found by the crawl. Nothing is read here.
+//                 Returns FALSE if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL DupeListAdd ( DUPE_LIST * dl, const WCHAR * path, __int64 size )
+/*--------------------------------------------------------------------------*/
+{
+    DUPE_FILE   * df;
+    WCHAR       * tmp;
+    UINT_PTR    len, cap;
+
+    if ( dl == NULL || path == NULL )
+        return FALSE;
+
+    dl->total += size;
+
+    if ( size < dl->min_size )
+        return TRUE;
+
+    if ( dl->count >= dl->capacity )
+    {
+        cap = dl->capacity ? dl->capacity * 2 : 4096;
+        df  = realloc ( dl->files, cap * sizeof ( DUPE_FILE ) );
+
+        if ( df == NULL )
+            return FALSE;
+
+        dl->files       = df;
+        dl->capacity    = cap;
+    }
+
+    len = wcslen ( path ) + 1;
+
+    if ( dl->arena_len + len > dl->arena_cap )
+    {
+        cap = dl->arena_cap ? dl->arena_cap * 2 : 65536;
+
+        while ( cap < dl->arena_len + len )
+            cap *= 2;
+
+        tmp = realloc ( dl->arena, cap * sizeof ( WCHAR ) );
+
+        if ( tmp == NULL )
+            return FALSE;
+
+        dl->arena       = tmp;
+        dl->arena_cap   = cap;
+    }
+
+    wmemcpy ( dl->arena + dl->arena_len, path, len );
+
+    df          = &dl->files[dl->count++];
+    df->size    = size;
+    df->hash    = 0;
+    df->path    = dl->arena_len;
+    df->stage   = DUPE_SIZE;
+
+    dl->arena_len += len;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeListMerge
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: DUPE_LIST * dst       : list to append to
+//    Param.    2: const DUPE_LIST * src : list to append from
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: append src's files (e.g. one worker's) to dst, before
+//                 DupeFind. Returns FALSE if out of memory, dst unchanged.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL DupeListMerge ( DUPE_LIST * dst, const DUPE_LIST * src )
+/*--------------------------------------------------------------------------*/
+{
+    DUPE_FILE   * df;
+    WCHAR       * tmp;
+    UINT_PTR    i, cap;
+
+    if ( dst == NULL || src == NULL )
+        return FALSE;
+
+    if ( dst->count + src->count > dst->capacity )
+    {
+        cap = dst->capacity ? dst->capacity : 4096;
+
+        while ( cap < dst->count + src->count )
+            cap *= 2;
+
+        df = realloc ( dst->files, cap * sizeof ( DUPE_FILE ) );
+
+        if ( df == NULL )
+            return FALSE;
+
+        dst->files      = df;
+        dst->capacity   = cap;
+    }
+
+    if ( dst->arena_len + src->arena_len > dst->arena_cap )
+    {
+        cap = dst->arena_cap ? dst->arena_cap : 65536;
+
+        while ( cap < dst->arena_len + src->arena_len )
+            cap *= 2;
+
+        tmp = realloc ( dst->arena, cap * sizeof ( WCHAR ) );
+
+        if ( tmp == NULL )
+            return FALSE;
+
+        dst->arena      = tmp;
+        dst->arena_cap  = cap;
+    }
+
+    if ( src->arena_len )
+        wmemcpy ( dst->arena + dst->arena_len, src->arena, src->arena_len );
+
+    // the paths move up by what dst already held
+    for ( i = 0; i < src->count; i++ )
+    {
+        df          = &dst->files[dst->count + i];
+        *df         = src->files[i];
+        df->path    += dst->arena_len;
+    }
+
+    dst->count      += src->count;
+    dst->arena_len  += src->arena_len;
+    dst->total      += src->total;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeFind
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: DUPE_LIST * dl : list filled by the crawl
+//    Param.    2: UINT threads   : hashing threads (0 = one per CPU)
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: find the duplicates, each stage much cheaper than the
+//                 next, so that most files are ruled out before reading
+//                 a single byte of them:
+//                   1. group by exact size, drop the unique sizes
+//                   2. hash DUPE_EDGE bytes from both ends, drop uniques
+//                   3. fully hash the survivors, in parallel, with big
+//                      sequential reads
+//                 Files that ended up with the same size and full hash
+//                 make a set. Returns FALSE if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL DupeFind ( DUPE_LIST * dl, UINT threads )
+/*--------------------------------------------------------------------------*/
+{
+    SYSTEM_INFO si;
+    UINT_PTR    i, j;
+
+    if ( dl == NULL )
+        return FALSE;
+
+    if ( threads == 0 )
+    {
+        GetSystemInfo ( &si );
+        threads = si.dwNumberOfProcessors;
+    }
+
+    if ( threads > DUPE_MAX_THREADS )
+        threads = DUPE_MAX_THREADS;
+
+    gSortList = dl;
+
+    // stage 1, sizes only
+    qsort ( dl->files, dl->count, sizeof ( DUPE_FILE ), DupeCmpSize );
+
+    if ( DupeKeepGroups ( dl, FALSE ) == 0 )
+        return TRUE;
+
+    // stage 2, head and tail
+    if ( !DupeRunStage ( dl, DUPE_SIZE, threads ) )
+        return FALSE;
+
+    qsort ( dl->files, dl->count, sizeof ( DUPE_FILE ), DupeCmpHash );
+
+    if ( DupeKeepGroups ( dl, TRUE ) == 0 )
+        return TRUE;
+
+    // stage 3, whole content (small files are already there)
+    if ( !DupeRunStage ( dl, DUPE_QUICK, threads ) )
+        return FALSE;
+
+    qsort ( dl->files, dl->count, sizeof ( DUPE_FILE ), DupeCmpHash );
+
+    if ( DupeKeepGroups ( dl, TRUE ) == 0 )
+        return TRUE;
+
+    // what's left is sorted by size and hash, make the sets
+    dl->sets = malloc ( ( dl->count / 2 + 1 ) * sizeof ( DUPE_SET ) );
+
+    if ( dl->sets == NULL )
+        return FALSE;
+
+    for ( i = 0; i < dl->count; i = j )
+    {
+        for ( j = i + 1; j < dl->count &&
+            dl->files[j].size == dl->files[i].size &&
+                dl->files[j].hash == dl->files[i].hash; j++ )
+            ;
+
+        dl->sets[dl->nsets].size    = dl->files[i].size;
+        dl->sets[dl->nsets].first   = i;
+        dl->sets[dl->nsets].count   = j - i;
+        dl->reclaimable += dl->files[i].size * (__int64)( j - i - 1 );
+        dl->nsets++;
+    }
+
+    qsort ( dl->sets, dl->nsets, sizeof ( DUPE_SET ), DupeCmpSet );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupePath
+/*--------------------------------------------------------------------------*/
+//           Type: const WCHAR *
+//    Param.    1: const DUPE_LIST * dl : list
+//    Param.    2: UINT_PTR file        : index in files[]
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: full path of a file
+/*--------------------------------------------------------------------@@-@@-*/
+const WCHAR * DupePath ( const DUPE_LIST * dl, UINT_PTR file )
+/*--------------------------------------------------------------------------*/
+{
+    if ( dl == NULL || file >= dl->count )
+        return L"";
+
+    return dl->arena + dl->files[file].path;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeFolders
+/*--------------------------------------------------------------------------*/
+//           Type: DUPE_FOLDER *
+//    Param.    1: const DUPE_LIST * dl : list, after DupeFind
+//    Param.    2: UINT_PTR * count     : receives the number of folders
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: reclaimable bytes per folder, biggest first. The first
+//                 copy of a set (by path) is the one kept, every other
+//                 copy counts against its folder. free() the result.
+/*--------------------------------------------------------------------@@-@@-*/
+DUPE_FOLDER * DupeFolders ( const DUPE_LIST * dl, UINT_PTR * count )
+/*--------------------------------------------------------------------------*/
+{
+    DUPE_FOLDER     * fl;
+    const WCHAR     * path, * slash;
+    UINT_PTR        i, j, n;
+
+    if ( count != NULL )
+        *count = 0;
+
+    if ( dl == NULL || count == NULL || dl->nsets == 0 )
+        return NULL;
+
+    fl = malloc ( dl->count * sizeof ( DUPE_FOLDER ) );
+
+    if ( fl == NULL )
+        return NULL;
+
+    for ( i = 0, n = 0; i < dl->nsets; i++ )
+    {
+        for ( j = 1; j < dl->sets[i].count; j++ )
+        {
+            path    = DupePath ( dl, dl->sets[i].first + j );
+            slash   = wcsrchr ( path, L'\\' );
+
+            fl[n].path  = dl->files[dl->sets[i].first + j].path;
+            fl[n].len   = ( slash != NULL ) ? (UINT_PTR)( slash - path ) : 0;
+            fl[n].bytes = dl->sets[i].size;
+            fl[n].files = 1;
+            n++;
+        }
+    }
+
+    gSortList = dl;
+    qsort ( fl, n, sizeof ( DUPE_FOLDER ), DupeCmpFolder );
+
+    // fold the runs of the same folder
+    for ( i = 0, j = 0; i < n; i++ )
+    {
+        if ( j != 0 && DupeCmpFolder ( &fl[j-1], &fl[i] ) == 0 )
+        {
+            fl[j-1].bytes += fl[i].bytes;
+            fl[j-1].files += fl[i].files;
+        }
+        else
+            fl[j++] = fl[i];
+    }
+
+    qsort ( fl, j, sizeof ( DUPE_FOLDER ), DupeCmpWaste );
+
+    *count = j;
+
+    return fl;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeHash
+/*--------------------------------------------------------------------------*/
+//           Type: UINT64
+//    Param.    1: const void * data : bytes to hash
+//    Param.    2: size_t len        : how many
+//    Param.    3: UINT64 seed       : seed, or the hash of the previous
+//                                     chunk when hashing a file piecewise
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: XXH64, a fast non-cryptographic 64 bit hash (Yann Collet,
+//                 https://github.com/Cyan4973/xxHash, BSD license).
+//                 Good enough to tell files apart, not to fight an enemy.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT64 DupeHash ( const void * data, size_t len, UINT64 seed )
+/*--------------------------------------------------------------------------*/
+{
+    const BYTE  * p, * end;
+    UINT64      v1, v2, v3, v4, h, k;
+    UINT        k32;
+
+    p   = (const BYTE *)data;
+    end = p + len;
+
+    if ( len >= 32 )
+    {
+        v1 = seed + P64_1 + P64_2;
+        v2 = seed + P64_2;
+        v3 = seed;
+        v4 = seed - P64_1;
+
+        do
+        {
+            memcpy ( &k, p, 8 );
+            v1 += k * P64_2; v1 = ROTL64 ( v1, 31 ); v1 *= P64_1;
+            memcpy ( &k, p+8, 8 );
+            v2 += k * P64_2; v2 = ROTL64 ( v2, 31 ); v2 *= P64_1;
+            memcpy ( &k, p+16, 8 );
+            v3 += k * P64_2; v3 = ROTL64 ( v3, 31 ); v3 *= P64_1;
+            memcpy ( &k, p+24, 8 );
+            v4 += k * P64_2; v4 = ROTL64 ( v4, 31 ); v4 *= P64_1;
+            p += 32;
+        }
+        while ( p <= end - 32 );
+
+        h = ROTL64 ( v1, 1 ) + ROTL64 ( v2, 7 ) +
+            ROTL64 ( v3, 12 ) + ROTL64 ( v4, 18 );
+
+        v1 *= P64_2; v1 = ROTL64 ( v1, 31 ); v1 *= P64_1;
+        h ^= v1; h = h * P64_1 + P64_4;
+        v2 *= P64_2; v2 = ROTL64 ( v2, 31 ); v2 *= P64_1;
+        h ^= v2; h = h * P64_1 + P64_4;
+        v3 *= P64_2; v3 = ROTL64 ( v3, 31 ); v3 *= P64_1;
+        h ^= v3; h = h * P64_1 + P64_4;
+        v4 *= P64_2; v4 = ROTL64 ( v4, 31 ); v4 *= P64_1;
+        h ^= v4; h = h * P64_1 + P64_4;
+    }
+    else
+        h = seed + P64_5;
+
+    h += (UINT64)len;
+
+    while ( p + 8 <= end )
+    {
+        memcpy ( &k, p, 8 );
+        k *= P64_2; k = ROTL64 ( k, 31 ); k *= P64_1;
+        h ^= k;
+        h = ROTL64 ( h, 27 ) * P64_1 + P64_4;
+        p += 8;
+    }
+
+    if ( p + 4 <= end )
+    {
+        memcpy ( &k32, p, 4 );
+        h ^= (UINT64)k32 * P64_1;
+        h = ROTL64 ( h, 23 ) * P64_2 + P64_3;
+        p += 4;
+    }
+
+    while ( p < end )
+    {
+        h ^= (*p) * P64_5;
+        h = ROTL64 ( h, 11 ) * P64_1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= P64_2;
+    h ^= h >> 29;
+    h *= P64_3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeRunStage
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: DUPE_LIST * dl : list
+//    Param.    2: UINT stage     : hash the files in this stage
+//    Param.    3: UINT threads   : how many workers
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: start the workers and wait for them to go through the
+//                 whole list. Falls back to doing the work right here if
+//                 no thread could be started. Files no worker got to
+//                 (none had the memory for a buffer) are left out, their
+//                 hash was never set.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL DupeRunStage ( DUPE_LIST * dl, UINT stage, UINT threads )
+/*--------------------------------------------------------------------------*/
+{
+    DUPE_JOB    job;
+    HANDLE      th[DUPE_MAX_THREADS];
+    UINT_PTR    k;
+    UINT        i, n;
+
+    job.dl          = dl;
+    job.stage       = stage;
+    job.next        = 0;
+    job.bytes_read  = 0;
+
+    for ( i = 0, n = 0; i < threads; i++ )
+    {
+        th[n] = (HANDLE)_beginthreadex ( NULL, 0, DupeWorker, &job, 0, NULL );
+
+        if ( th[n] != NULL )
+            n++;
+    }
+
+    if ( n == 0 )
+    {
+        if ( !DupeWorker ( &job ) )
+            return FALSE;
+    }
+    else
+    {
+        WaitForMultipleObjects ( n, th, TRUE, INFINITE );
+
+        for ( i = 0; i < n; i++ )
+            CloseHandle ( th[i] );
+    }
+
+    dl->bytes_read += job.bytes_read;
+
+    for ( k = 0; k < dl->count; k++ )
+        if ( dl->files[k].stage == stage )
+            dl->files[k].stage = DUPE_FAILED;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeWorker
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT __stdcall
+//    Param.    1: void * param : DUPE_JOB
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: thread function for _beginthreadex. Grabs files one at a
+//                 time off the shared counter and hashes the ones in the
+//                 job's stage. Each worker has its own read buffer; one
+//                 that can't get it takes no files, the others do them.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT __stdcall DupeWorker ( void * param )
+/*--------------------------------------------------------------------------*/
+{
+    DUPE_JOB    * job;
+    DUPE_FILE   * df;
+    BYTE        * buf;
+    HANDLE      hFile;
+    UINT_PTR    i;
+    __int64     nread;
+    BOOL        ok;
+
+    job = (DUPE_JOB *)param;
+    buf = malloc ( DUPE_READ_CHUNK );
+
+    if ( buf == NULL )
+        return FALSE;
+
+    while ( ( i = (UINT_PTR)( InterlockedIncrement ( &job->next ) - 1 ) )
+            < job->dl->count )
+    {
+        df = &job->dl->files[i];
+
+        if ( df->stage != job->stage )
+            continue;
+
+        hFile = CreateFileW ( job->dl->arena + df->path, GENERIC_READ,
+            FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE, NULL,
+                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+
+        if ( hFile == INVALID_HANDLE_VALUE )
+        {
+            df->stage = DUPE_FAILED;
+            continue;
+        }
+
+        nread = 0;
+
+        ok = ( job->stage == DUPE_SIZE ) ?
+            DupeQuickHash ( hFile, df, buf, &nread ) :
+                DupeFullHash ( hFile, df, buf, &nread );
+
+        if ( !ok )
+            df->stage = DUPE_FAILED;
+
+        InterlockedExchangeAdd64 ( &job->bytes_read, nread );
+        CloseHandle ( hFile );
+    }
+
+    free ( buf );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeQuickHash
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: HANDLE hFile     : opened file
+//    Param.    2: DUPE_FILE * df   : its entry
+//    Param.    3: BYTE * buf       : scratch, at least 2*DUPE_EDGE
+//    Param.    4: __int64 * nread  : bytes read, for the stats
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: hash the first and last DUPE_EDGE bytes. Small files are
+//                 read whole and hashed exactly like the full stage does,
+//                 so they skip it.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL DupeQuickHash ( HANDLE hFile, DUPE_FILE * df, BYTE * buf,
+    __int64 * nread )
+/*--------------------------------------------------------------------------*/
+{
+    DWORD           got, got2;
+    LARGE_INTEGER   li;
+
+    if ( df->size <= 2 * DUPE_EDGE )
+        return DupeFullHash ( hFile, df, buf, nread );
+
+    if ( !ReadFile ( hFile, buf, DUPE_EDGE, &got, NULL ) ||
+            got != DUPE_EDGE )
+        return FALSE;
+
+    li.QuadPart = df->size - DUPE_EDGE;
+
+    if ( !SetFilePointerEx ( hFile, li, NULL, FILE_BEGIN ) )
+        return FALSE;
+
+    if ( !ReadFile ( hFile, buf + DUPE_EDGE, DUPE_EDGE, &got2, NULL ) ||
+            got2 != DUPE_EDGE )
+        return FALSE;
+
+    *nread      = got + got2;
+    df->hash    = DupeHash ( buf, 2 * DUPE_EDGE, (UINT64)df->size );
+    df->stage   = DUPE_QUICK;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeFullHash
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: HANDLE hFile     : opened file
+//    Param.    2: DUPE_FILE * df   : its entry
+//    Param.    3: BYTE * buf       : DUPE_READ_CHUNK scratch
+//    Param.    4: __int64 * nread  : bytes read, for the stats
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: hash the whole file, chunk by chunk, each chunk seeded
+//                 with the previous one's hash. Fails if the file changed
+//                 size under us.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL DupeFullHash ( HANDLE hFile, DUPE_FILE * df, BYTE * buf,
+    __int64 * nread )
+/*--------------------------------------------------------------------------*/
+{
+    LARGE_INTEGER   li;
+    UINT64          h;
+    DWORD           got;
+    __int64         total;
+
+    li.QuadPart = 0;
+
+    if ( !SetFilePointerEx ( hFile, li, NULL, FILE_BEGIN ) )
+        return FALSE;
+
+    h       = (UINT64)df->size;
+    total   = 0;
+
+    for ( ;; )
+    {
+        if ( !ReadFile ( hFile, buf, DUPE_READ_CHUNK, &got, NULL ) )
+            return FALSE;
+
+        if ( got == 0 )
+            break;
+
+        h       = DupeHash ( buf, got, h );
+        total  += got;
+    }
+
+    *nread += total;
+
+    if ( total != df->size )
+        return FALSE;
+
+    df->hash    = h;
+    df->stage   = DUPE_FULL;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeKeepGroups
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT_PTR
+//    Param.    1: DUPE_LIST * dl : list, sorted by size (and hash)
+//    Param.    2: BOOL by_hash   : group by size and hash, not size only
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: squeeze out the files that are alone in their group, and
+//                 those we failed to read. Returns how many are left.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT_PTR DupeKeepGroups ( DUPE_LIST * dl, BOOL by_hash )
+/*--------------------------------------------------------------------------*/
+{
+    UINT_PTR    i, j, k, n;
+
+    for ( i = 0, n = 0; i < dl->count; i = j )
+    {
+        // failed ones were sorted to the end of their size group
+        if ( dl->files[i].stage == DUPE_FAILED )
+        {
+            j = i + 1;
+            continue;
+        }
+
+        for ( j = i + 1; j < dl->count &&
+            dl->files[j].size == dl->files[i].size &&
+            dl->files[j].stage != DUPE_FAILED &&
+            ( !by_hash || dl->files[j].hash == dl->files[i].hash ); j++ )
+            ;
+
+        if ( j - i < 2 )
+            continue;
+
+        for ( k = i; k < j; k++ )
+            dl->files[n++] = dl->files[k];
+    }
+
+    dl->count = n;
+
+    return n;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeCmpSize
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const void * a : DUPE_FILE
+//    Param.    2: const void * b : DUPE_FILE
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, by size, then by path so the report comes
+//                 out the same every time
+/*--------------------------------------------------------------------@@-@@-*/
+static int DupeCmpSize ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    const DUPE_FILE * f1, * f2;
+
+    f1 = (const DUPE_FILE *)a;
+    f2 = (const DUPE_FILE *)b;
+
+    if ( f1->size != f2->size )
+        return ( f1->size < f2->size ) ? -1 : 1;
+
+    return wcscmp ( gSortList->arena + f1->path,
+        gSortList->arena + f2->path );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeCmpHash
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const void * a : DUPE_FILE
+//    Param.    2: const void * b : DUPE_FILE
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, by size, failed ones last, then by hash
+//                 and path
+/*--------------------------------------------------------------------@@-@@-*/
+static int DupeCmpHash ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    const DUPE_FILE * f1, * f2;
+    BOOL            bad1, bad2;
+
+    f1 = (const DUPE_FILE *)a;
+    f2 = (const DUPE_FILE *)b;
+
+    if ( f1->size != f2->size )
+        return ( f1->size < f2->size ) ? -1 : 1;
+
+    bad1 = ( f1->stage == DUPE_FAILED );
+    bad2 = ( f2->stage == DUPE_FAILED );
+
+    if ( bad1 != bad2 )
+        return bad1 ? 1 : -1;
+
+    if ( f1->hash != f2->hash )
+        return ( f1->hash < f2->hash ) ? -1 : 1;
+
+    return wcscmp ( gSortList->arena + f1->path,
+        gSortList->arena + f2->path );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeCmpSet
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const void * a : DUPE_SET
+//    Param.    2: const void * b : DUPE_SET
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, most reclaimable bytes first
+/*--------------------------------------------------------------------@@-@@-*/
+static int DupeCmpSet ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    const DUPE_SET  * s1, * s2;
+    __int64         w1, w2;
+
+    s1 = (const DUPE_SET *)a;
+    s2 = (const DUPE_SET *)b;
+
+    w1 = s1->size * (__int64)( s1->count - 1 );
+    w2 = s2->size * (__int64)( s2->count - 1 );
+
+    if ( w1 != w2 )
+        return ( w1 < w2 ) ? 1 : -1;
+
+    return ( s1->first < s2->first ) ? -1 : ( s1->first > s2->first );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeCmpFolder
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const void * a : DUPE_FOLDER
+//    Param.    2: const void * b : DUPE_FOLDER
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, by folder name, case insensitive
+/*--------------------------------------------------------------------@@-@@-*/
+static int DupeCmpFolder ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    const DUPE_FOLDER   * f1, * f2;
+    int                 r;
+
+    f1 = (const DUPE_FOLDER *)a;
+    f2 = (const DUPE_FOLDER *)b;
+
+    r = _wcsnicmp ( gSortList->arena + f1->path, gSortList->arena + f2->path,
+        ( f1->len < f2->len ) ? f1->len : f2->len );
+
+    if ( r != 0 )
+        return r;
+
+    return ( f1->len < f2->len ) ? -1 : ( f1->len > f2->len );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: DupeCmpWaste
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const void * a : DUPE_FOLDER
+//    Param.    2: const void * b : DUPE_FOLDER
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, most reclaimable bytes first
+/*--------------------------------------------------------------------@@-@@-*/
+static int DupeCmpWaste ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    const DUPE_FOLDER * f1, * f2;
+
+    f1 = (const DUPE_FOLDER *)a;
+    f2 = (const DUPE_FOLDER *)b;
+
+    if ( f1->bytes != f2->bytes )
+        return ( f1->bytes < f2->bytes ) ? 1 : -1;
+
+    return DupeCmpFolder ( a, b );
+}
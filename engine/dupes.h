@@ -0,0 +1,80 @@
+
+// dupes.h - staged duplicate file finder (--dupes)
+
+#ifndef _DUPES_H
+#define _DUPES_H
+
+#include <windows.h>
+
+// bytes hashed from each end of a file in the quick stage; files up
+// to twice this size are fully known after it
+#define DUPE_EDGE           4096
+
+// read size for the full hash stage
+#define DUPE_READ_CHUNK     (1024*1024)
+
+// max. hashing threads
+#define DUPE_MAX_THREADS    16
+
+// stage a file is in
+#define DUPE_SIZE           0   // only its size is known
+#define DUPE_QUICK          1   // head/tail hash done
+#define DUPE_FULL           2   // full content hash done
+#define DUPE_FAILED         3   // couldn't be read, left out
+
+// one candidate file
+typedef struct _dupe_file
+{
+    __int64     size;
+    UINT64      hash;       // quick or full hash, see stage
+    UINT_PTR    path;       // offset of the full path in the arena
+    UINT        stage;
+} DUPE_FILE;
+
+// a set of identical files, filled in by DupeFind
+typedef struct _dupe_set
+{
+    __int64     size;       // size of one copy
+    UINT_PTR    first;      // index of the first copy in files[]
+    UINT_PTR    count;      // how many copies
+} DUPE_SET;
+
+// reclaimable bytes in one folder, from DupeFolders. The folder is the
+// first len chars of a file path in the list's arena.
+typedef struct _dupe_folder
+{
+    UINT_PTR    path;       // arena offset of a path in this folder
+    UINT_PTR    len;        // folder name length, in chars
+    __int64     bytes;      // bytes freed by deleting the extra copies
+    UINT_PTR    files;      // how many extra copies live here
+} DUPE_FOLDER;
+
+typedef struct _dupe_list
+{
+    DUPE_FILE   * files;
+    UINT_PTR    count;
+    UINT_PTR    capacity;
+    WCHAR       * arena;    // NUL terminated full paths
+    UINT_PTR    arena_len;
+    UINT_PTR    arena_cap;
+    __int64     min_size;   // smaller files are ignored (default 1)
+    __int64     total;      // bytes of all files seen
+    __int64     bytes_read; // what it cost us to find the dupes
+    DUPE_SET    * sets;     // result, biggest waste first
+    UINT_PTR    nsets;
+    __int64     reclaimable;
+} DUPE_LIST;
+
+BOOL    DupeListInit    ( DUPE_LIST * dl, __int64 min_size );
+void    DupeListFree    ( DUPE_LIST * dl );
+BOOL    DupeListAdd     ( DUPE_LIST * dl, const WCHAR * path,
+                            __int64 size );
+BOOL    DupeListMerge   ( DUPE_LIST * dst, const DUPE_LIST * src );
+BOOL    DupeFind        ( DUPE_LIST * dl, UINT threads );
+
+const WCHAR * DupePath  ( const DUPE_LIST * dl, UINT_PTR file );
+DUPE_FOLDER * DupeFolders ( const DUPE_LIST * dl, UINT_PTR * count );
+
+UINT64  DupeHash        ( const void * data, size_t len, UINT64 seed );
+
+#endif // _DUPES_H
@@ -0,0 +1,2415 @@
+
+// engine.c - parallel folder crawler shared by fsize and wfsize
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "engine.h"
+#include "archive.h"
+#include "spill.h"
+#include <windows.h>
+#include <process.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+// per thread state
+typedef struct _eng_worker
+{
+    ENGINE      * eng;
+    UINT        index;
+    WCHAR       path[ENG_MAX_PATH];     // folder being enumerated
+    WCHAR       * sub;                  // its subfolder names, NUL
+    UINT        sub_len;                // separated
+    UINT        sub_cap;
+    UINT        nsub;
+    BYTE        * subfl;                // ENG_xxx for each of them
+    UINT        * subw;                 // and their weight, if longest
+    UINT        subfl_cap;
+    UINT        nfin;                   // nodes made final by the
+    UINT        fin[ENG_MAX_DEPTH+1];   // last folder, for on_final
+} ENG_WORKER;
+
+static UINT __stdcall   EngineWorker    ( void * param );
+static void             EngineScanDir   ( ENG_WORKER * w, UINT node );
+static void             EngineScanArchive ( ENG_WORKER * w, UINT node );
+static BOOL             EngineAddSub    ( ENG_WORKER * w, UINT node,
+                                            const WCHAR * name, BYTE flags );
+static void             EngineFinish    ( ENGINE * eng, ENG_WORKER * w,
+                                            UINT node );
+static BOOL             EngineGrow      ( ENGINE * eng, UINT n );
+static UINT             EngineAddName   ( ENGINE * eng, const WCHAR * name,
+                                            UINT len );
+static UINT             EngineNewNode   ( ENGINE * eng, UINT parent,
+                                            const WCHAR * name, UINT len );
+static void             EngineSetNode   ( ENGINE * eng, UINT node,
+                                            UINT parent, UINT off, UINT len );
+static UINT             EngineReuse     ( ENGINE * eng, UINT n, UINT chars,
+                                            UINT * off );
+static void             EngineRelease   ( ENGINE * eng, UINT node );
+static void             EngineSpill     ( ENG_WORKER * w );
+static BOOL             EngineRangePut  ( ENG_RANGES * rs, UINT start,
+                                            UINT len );
+static UINT             EngineRangeTake ( ENG_RANGES * rs, UINT len );
+static BOOL             EngineColumn    ( ENGINE * eng, void * pbase,
+                                            UINT elem );
+static void             EngineResolveRoots ( ENGINE * eng );
+static BOOL             EngineFolderId  ( const WCHAR * path, DWORD * volume,
+                                            UINT64 * fileid, WCHAR * final,
+                                            UINT cch );
+static BOOL             EngineIsDots    ( const WCHAR * name );
+static void             EnginePublish   ( ENGINE * eng );
+static void             EngineNewer     ( __int64 * at, __int64 t );
+static void             EngineRaise     ( ENGINE * eng, UINT node,
+                                            __int64 bytes );
+static UINT             EngineLevelDone ( ENGINE * eng, UINT node );
+static void             EngineHeapPush  ( ENGINE * eng, UINT node );
+static UINT             EngineHeapPop   ( ENGINE * eng );
+static BOOL             EngineHeavier   ( const ENGINE * eng, UINT a,
+                                            UINT b );
+static void             EngineThrottle  ( ENGINE * eng );
+static void             EngineBackOff   ( ENGINE * eng, __int64 took );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineInit
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: ENGINE * eng       : engine to set up
+//    Param.    2: UINT threads       : workers (0 = two per CPU)
+//    Param.    3: UINT max_depth     : folders this deep are not opened
+//    Param.    4: UINT extra_size    : bytes of hook data per node, or 0
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: reserve the node columns and name arena, nothing is
+//                 committed yet. Set eng->filter and eng->hooks before
+//                 EngineRun, if needed. Returns FALSE if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL EngineInit ( ENGINE * eng, UINT threads, UINT max_depth,
+    UINT extra_size )
+/*--------------------------------------------------------------------------*/
+{
+    SYSTEM_INFO si;
+    BOOL        ok;
+
+    if ( eng == NULL )
+        return FALSE;
+
+    RtlZeroMemory ( eng, sizeof ( ENGINE ) );
+
+    // folder enumeration waits on the disk (or the network) much more
+    // than on the CPU, so have some more threads than cores
+    if ( threads == 0 )
+    {
+        GetSystemInfo ( &si );
+        threads = si.dwNumberOfProcessors * 2;
+    }
+
+    if ( threads > ENG_MAX_THREADS )
+        threads = ENG_MAX_THREADS;
+
+    if ( max_depth == 0 || max_depth > ENG_MAX_DEPTH )
+        max_depth = ENG_MAX_DEPTH;
+
+    eng->threads    = threads;
+    eng->max_depth  = max_depth;
+    eng->extra_size = extra_size;
+
+    ok = EngineColumn ( eng, &eng->parent, sizeof ( UINT ) ) &&
+        EngineColumn ( eng, &eng->first, sizeof ( UINT ) ) &&
+        EngineColumn ( eng, &eng->nchild, sizeof ( UINT ) ) &&
+        EngineColumn ( eng, &eng->name, sizeof ( UINT ) ) &&
+        EngineColumn ( eng, &eng->nlen, sizeof ( USHORT ) ) &&
+        EngineColumn ( eng, &eng->depth, sizeof ( USHORT ) ) &&
+        EngineColumn ( eng, &eng->flags, sizeof ( BYTE ) ) &&
+        EngineColumn ( eng, &eng->own, sizeof ( __int64 ) ) &&
+        EngineColumn ( eng, &eng->size, sizeof ( __int64 ) ) &&
+        EngineColumn ( eng, &eng->files, sizeof ( UINT ) ) &&
+        EngineColumn ( eng, &eng->mtime, sizeof ( __int64 ) ) &&
+        EngineColumn ( eng, &eng->tfiles, sizeof ( __int64 ) ) &&
+        EngineColumn ( eng, &eng->tdirs, sizeof ( UINT ) ) &&
+        EngineColumn ( eng, &eng->pending, sizeof ( LONG ) ) &&
+        EngineColumn ( eng, &eng->queue, sizeof ( UINT ) );
+
+    if ( ok && extra_size != 0 )
+        ok = EngineColumn ( eng, &eng->extra, extra_size );
+
+    if ( ok )
+    {
+        eng->names = VirtualAlloc ( NULL, ENG_MAX_CHARS * sizeof ( WCHAR ),
+            MEM_RESERVE, PAGE_READWRITE );
+
+        ok = ( eng->names != NULL );
+    }
+
+    if ( ok )
+    {
+        eng->hSem = CreateSemaphoreW ( NULL, 0, 0x7FFFFFFF, NULL );
+        ok = ( eng->hSem != NULL );
+    }
+
+    InitializeCriticalSection ( &eng->lock );
+
+    if ( !ok )
+        EngineFree ( eng );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: ENGINE * eng : engine to release, after EngineRun is
+//                                done
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void EngineFree ( ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    UINT i;
+
+    if ( eng == NULL )
+        return;
+
+    // placed ones belong to whoever gave the memory
+    for ( i = 0; i < eng->ncols; i++ )
+        if ( !eng->cols[i].placed )
+            VirtualFree ( eng->cols[i].base, 0, MEM_RELEASE );
+
+    for ( i = 0; i < eng->nroots; i++ )
+    {
+        free ( eng->roots[i].path );
+        free ( eng->roots[i].final );
+    }
+
+    if ( eng->names != NULL && !eng->names_placed )
+        VirtualFree ( eng->names, 0, MEM_RELEASE );
+
+    if ( eng->hSem != NULL )
+        CloseHandle ( eng->hSem );
+
+    for ( i = 0; i < 32; i++ )
+    {
+        free ( eng->free_nodes.r[i] );
+        free ( eng->free_chars.r[i] );
+    }
+
+    DeleteCriticalSection ( &eng->lock );
+
+    RtlZeroMemory ( eng, sizeof ( ENGINE ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineAddRoot
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: ENGINE * eng       : engine, before EngineRun
+//    Param.    2: const WCHAR * path : folder to scan
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: add a folder to the scan. The folder is identified by
+//                 volume serial and file index, so the same folder reached
+//                 through another drive letter, a share or a junction is
+//                 recognized later on. Returns the root index, or -1 if
+//                 out of memory or too many roots.
+/*--------------------------------------------------------------------@@-@@-*/
+int EngineAddRoot ( ENGINE * eng, const WCHAR * path )
+/*--------------------------------------------------------------------------*/
+{
+    ENG_ROOT    * r;
+    WCHAR       final[ENG_MAX_PATH];
+    UINT_PTR    len;
+
+    if ( eng == NULL || path == NULL || eng->nroots >= ENG_MAX_ROOTS )
+        return -1;
+
+    len = wcslen ( path );
+
+    if ( len == 0 || len >= ENG_MAX_PATH )
+        return -1;
+
+    r = &eng->roots[eng->nroots];
+    RtlZeroMemory ( r, sizeof ( ENG_ROOT ) );
+
+    r->path = malloc ( ( len + 1 ) * sizeof ( WCHAR ) );
+
+    if ( r->path == NULL )
+        return -1;
+
+    wmemcpy ( r->path, path, len + 1 );
+
+    // erase any trailing backslash, "c:" + "\*" still makes sense
+    if ( len > 1 && r->path[len-1] == L'\\' )
+        r->path[--len] = L'\0';
+
+    r->node     = ENG_NONE;
+    r->inside   = ENG_NONE;
+    r->state    = ENG_ROOT_MISSING;
+
+    if ( EngineFolderId ( r->path, &r->volume, &r->fileid, final,
+            ARRAYSIZE(final) ) )
+    {
+        len         = wcslen ( final );
+        r->final    = malloc ( ( len + 1 ) * sizeof ( WCHAR ) );
+
+        if ( r->final == NULL )
+        {
+            free ( r->path );
+            return -1;
+        }
+
+        wmemcpy ( r->final, final, len + 1 );
+        r->state = ENG_ROOT_WALKED;
+    }
+
+    return (int)eng->nroots++;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineRun
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: ENGINE * eng : engine with its roots added
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: walk all the roots at once, with one pool of workers
+//                 feeding from one queue, so the scan takes about as long
+//                 as the biggest root, not the sum of them. Roots nested
+//                 in other roots are not walked again. Blocks until done,
+//                 returns FALSE if aborted or out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL EngineRun ( ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    ENG_WORKER      * workers;
+    HANDLE          th[ENG_MAX_THREADS];
+    LARGE_INTEGER   li, t0, t1;
+    UINT            i, n, node;
+    ENG_ROOT        * r;
+
+    if ( eng == NULL )
+        return FALSE;
+
+    EngineResolveRoots ( eng );
+
+    // a spill frees slots for reuse, the queue would run past them
+    if ( eng->spill != NULL )
+        eng->breadth = FALSE;
+
+    if ( eng->breadth || eng->hooks.on_weigh == NULL )
+        eng->longest = FALSE;
+
+    EnterCriticalSection ( &eng->lock );
+
+    for ( i = 0; i < eng->nroots; i++ )
+    {
+        r = &eng->roots[i];
+
+        if ( r->state != ENG_ROOT_WALKED )
+            continue;
+
+        if ( !EngineGrow ( eng, 1 ) )
+        {
+            LeaveCriticalSection ( &eng->lock );
+            return FALSE;
+        }
+
+        node = EngineNewNode ( eng, ENG_NONE, r->path,
+            (UINT)wcslen ( r->path ) );
+
+        if ( node == ENG_NONE )
+        {
+            LeaveCriticalSection ( &eng->lock );
+            return FALSE;
+        }
+
+        r->node = node;
+        eng->waiting[0]++;
+
+        if ( eng->longest )
+        {
+            eng->pending[node] = (LONG)eng->hooks.on_weigh (
+                eng->hooks.ctx, 0, ENG_NONE, r->path );
+            EngineHeapPush ( eng, node );
+        }
+        else
+            eng->queue[eng->qlen++] = node;
+    }
+
+    EnginePublish ( eng );
+
+    // first root on top of the stack (at the head already, for breadth)
+    for ( i = 0; !eng->breadth && !eng->longest && i < eng->qlen / 2;
+            i++ )
+    {
+        node                            = eng->queue[i];
+        eng->queue[i]                   = eng->queue[eng->qlen-1-i];
+        eng->queue[eng->qlen-1-i]       = node;
+    }
+
+    n = eng->qlen;
+
+    LeaveCriticalSection ( &eng->lock );
+
+    if ( n == 0 )
+        return TRUE;
+
+    workers = calloc ( eng->threads, sizeof ( ENG_WORKER ) );
+
+    if ( workers == NULL )
+        return FALSE;
+
+    // the bucket starts out full
+    QueryPerformanceFrequency ( &li );
+    eng->gentle.freq        = li.QuadPart;
+    eng->gentle.now         = eng->gentle.rate;
+    eng->gentle.lowest      = eng->gentle.rate;
+    eng->gentle.recent      = 0;
+    eng->gentle.usual       = 0;
+    eng->gentle.changed     = 0;
+    eng->gentle.backoffs    = 0;
+    eng->gentle.opened      = 0;
+
+    QueryPerformanceCounter ( &t0 );
+
+    // nothing owed yet, from now on
+    eng->gentle.due = t0.QuadPart;
+
+    ReleaseSemaphore ( eng->hSem, n, NULL );
+
+    for ( i = 0, n = 0; i < eng->threads; i++ )
+    {
+        workers[n].eng      = eng;
+        workers[n].index    = n;
+
+        th[n] = (HANDLE)_beginthreadex ( NULL, 0, EngineWorker,
+            &workers[n], 0, NULL );
+
+        if ( th[n] != NULL )
+            n++;
+    }
+
+    // no threads at all? do it ourselves
+    if ( n == 0 )
+    {
+        workers[0].eng      = eng;
+        workers[0].index    = 0;
+        EngineWorker ( &workers[0] );
+    }
+    else
+    {
+        WaitForMultipleObjects ( n, th, TRUE, INFINITE );
+
+        for ( i = 0; i < n; i++ )
+            CloseHandle ( th[i] );
+    }
+
+    QueryPerformanceCounter ( &t1 );
+    eng->gentle.ticks = t1.QuadPart - t0.QuadPart;
+
+    for ( i = 0; i < eng->threads; i++ )
+    {
+        free ( workers[i].sub );
+        free ( workers[i].subfl );
+        free ( workers[i].subw );
+    }
+
+    free ( workers );
+
+    return ( eng->abort == 0 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineAbort
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: ENGINE * eng : running engine
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: ask the workers to stop. Safe to call from any thread;
+//                 EngineRun returns as soon as the folders in progress
+//                 are done. Whatever wasn't finished stays not ENG_FINAL.
+/*--------------------------------------------------------------------@@-@@-*/
+void EngineAbort ( ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    if ( eng == NULL || eng->hSem == NULL )
+        return;
+
+    InterlockedExchange ( &eng->abort, 1 );
+    ReleaseSemaphore ( eng->hSem, eng->threads, NULL );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EnginePlace
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: ENGINE * eng : engine, after EngineInit, before EngineRun
+//    Param.    2: void * pcol  : address of a column pointer, or of names
+//    Param.    3: void * at    : reserved memory, room for ENG_MAX_NODES
+//                                elements (ENG_MAX_CHARS for names)
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: move a column (or the name arena) to memory reserved by
+//                 the caller, e.g. a view of a SEC_RESERVE section that
+//                 other processes map too. It's committed as it grows,
+//                 the same as our own, and never freed by EngineFree.
+//                 Returns FALSE if there's no such column or nodes have
+//                 been made already.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL EnginePlace ( ENGINE * eng, void * pcol, void * at )
+/*--------------------------------------------------------------------------*/
+{
+    BYTE    * old;
+    UINT    i;
+
+    if ( eng == NULL || pcol == NULL || at == NULL || eng->committed != 0 ||
+            eng->names_committed != 0 )
+        return FALSE;
+
+    old = *(BYTE **)pcol;
+
+    if ( pcol == (void *)&eng->names )
+    {
+        if ( !eng->names_placed )
+            VirtualFree ( old, 0, MEM_RELEASE );
+
+        eng->names          = at;
+        eng->names_placed   = TRUE;
+
+        return TRUE;
+    }
+
+    for ( i = 0; i < eng->ncols; i++ )
+        if ( eng->cols[i].base == old )
+        {
+            if ( !eng->cols[i].placed )
+                VirtualFree ( old, 0, MEM_RELEASE );
+
+            eng->cols[i].base   = at;
+            eng->cols[i].placed = TRUE;
+            *(BYTE **)pcol      = at;
+
+            return TRUE;
+        }
+
+    return FALSE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineAddNode
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: ENGINE * eng       : engine, not running
+//    Param.    2: UINT parent        : parent node, ENG_NONE for a root
+//    Param.    3: const WCHAR * name : folder name (full path for roots)
+//    Param.    4: UINT len           : name length
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: for trees that aren't walked but put together (merging
+//                 snapshots). Appends a node and counts it in with the
+//                 parent's children, so a folder's subfolders have to be
+//                 added one right after the other, as the walk does.
+//                 own, size, files and mtime start at 0, for the caller
+//                 to fill. Returns the node or ENG_NONE if out of room.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT EngineAddNode ( ENGINE * eng, UINT parent, const WCHAR * name,
+    UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    UINT node;
+
+    if ( eng == NULL || name == NULL ||
+            ( parent != ENG_NONE && parent >= eng->count ) )
+        return ENG_NONE;
+
+    EnterCriticalSection ( &eng->lock );
+
+    node = EngineGrow ( eng, 1 ) ?
+        EngineNewNode ( eng, parent, name, len ) : ENG_NONE;
+
+    if ( node != ENG_NONE && parent != ENG_NONE )
+    {
+        if ( eng->nchild[parent]++ == 0 )
+            eng->first[parent] = node;
+    }
+
+    EnginePublish ( eng );
+    LeaveCriticalSection ( &eng->lock );
+
+    return node;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EnginePath
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const ENGINE * eng : engine
+//    Param.    2: UINT node          : node
+//    Param.    3: WCHAR * buf        : receives the full path
+//    Param.    4: UINT cch           : buf size, in chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: paths are not stored, only names; this puts one back
+//                 together from the parent chain. Returns its length or
+//                 0 if it doesn't fit.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT EnginePath ( const ENGINE * eng, UINT node, WCHAR * buf, UINT cch )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    chain[ENG_MAX_DEPTH+1];
+    UINT    k, len, n;
+
+    if ( eng == NULL || buf == NULL || cch == 0 || node >= eng->count )
+        return 0;
+
+    for ( k = 0, n = node; n != ENG_NONE && k <= ENG_MAX_DEPTH; k++ )
+    {
+        chain[k]    = n;
+        n           = eng->parent[n];
+    }
+
+    buf[0]  = L'\0';
+    len     = 0;
+
+    while ( k-- )
+    {
+        n = chain[k];
+
+        if ( len + eng->nlen[n] + 2 > cch )
+        {
+            buf[0] = L'\0';
+            return 0;
+        }
+
+        if ( len != 0 )
+            buf[len++] = L'\\';
+
+        wmemcpy ( buf + len, eng->names + eng->name[n], eng->nlen[n] );
+        len += eng->nlen[n];
+    }
+
+    buf[len] = L'\0';
+
+    return len;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineFindChild
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const ENGINE * eng : engine
+//    Param.    2: UINT node          : folder to look in
+//    Param.    3: const WCHAR * name : subfolder name
+//    Param.    4: UINT len           : name length, in chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: subfolder by name (case insensitive), ENG_NONE if there's
+//                 no such thing
+/*--------------------------------------------------------------------@@-@@-*/
+UINT EngineFindChild ( const ENGINE * eng, UINT node, const WCHAR * name,
+    UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    UINT i, end;
+
+    if ( eng == NULL || name == NULL || node >= eng->count ||
+            eng->nchild[node] == 0 )
+        return ENG_NONE;
+
+    end = eng->first[node] + eng->nchild[node];
+
+    for ( i = eng->first[node]; i < end; i++ )
+        if ( eng->nlen[i] == len &&
+                _wcsnicmp ( eng->names + eng->name[i], name, len ) == 0 )
+            return i;
+
+    return ENG_NONE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineRootNode
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const ENGINE * eng : engine, after EngineRun
+//    Param.    2: UINT root          : root index
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the node holding a root's totals. For a nested root,
+//                 that's its folder in the enclosing root's tree. Returns
+//                 ENG_NONE if the root wasn't walked (missing, or cut by
+//                 --exclude or the depth limit).
+/*--------------------------------------------------------------------@@-@@-*/
+UINT EngineRootNode ( const ENGINE * eng, UINT root )
+/*--------------------------------------------------------------------------*/
+{
+    const ENG_ROOT  * r;
+    const WCHAR     * p, * q;
+    UINT            chain[ENG_MAX_ROOTS];
+    UINT            k, node;
+
+    if ( eng == NULL || root >= eng->nroots )
+        return ENG_NONE;
+
+    // go out to the root that was actually walked...
+    for ( k = 0; eng->roots[root].state == ENG_ROOT_NESTED; k++ )
+    {
+        if ( k == ENG_MAX_ROOTS )
+            return ENG_NONE;
+
+        chain[k]    = root;
+        root        = eng->roots[root].inside;
+    }
+
+    if ( eng->roots[root].state != ENG_ROOT_WALKED )
+        return ENG_NONE;
+
+    node = eng->roots[root].node;
+
+    // ...and come back in, one folder at a time
+    while ( k-- && node != ENG_NONE )
+    {
+        r = &eng->roots[chain[k]];
+
+        for ( p = r->final + r->rel; node != ENG_NONE && *p; p = q )
+        {
+            for ( q = p; *q && *q != L'\\'; q++ )
+                ;
+
+            if ( q > p )
+                node = EngineFindChild ( eng, node, p, (UINT)( q - p ) );
+
+            if ( *q )
+                q++;
+        }
+    }
+
+    return node;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineRootOf
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const ENGINE * eng : engine
+//    Param.    2: UINT node          : any node
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: index of the (walked) root a node belongs to, or
+//                 ENG_NONE
+/*--------------------------------------------------------------------@@-@@-*/
+UINT EngineRootOf ( const ENGINE * eng, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    UINT i;
+
+    if ( eng == NULL || node >= eng->count )
+        return ENG_NONE;
+
+    while ( eng->parent[node] != ENG_NONE )
+        node = eng->parent[node];
+
+    for ( i = 0; i < eng->nroots; i++ )
+        if ( eng->roots[i].state == ENG_ROOT_WALKED &&
+                eng->roots[i].node == node )
+            return i;
+
+    return ENG_NONE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineExtra
+/*--------------------------------------------------------------------------*/
+//           Type: void *
+//    Param.    1: const ENGINE * eng : engine
+//    Param.    2: UINT node          : node
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the hooks' own per node data (extra_size bytes, zeroed
+//                 when the node is made), NULL if none was asked for
+/*--------------------------------------------------------------------@@-@@-*/
+void * EngineExtra ( const ENGINE * eng, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    if ( eng == NULL || eng->extra == NULL || node >= eng->count )
+        return NULL;
+
+    return eng->extra + (UINT_PTR)node * eng->extra_size;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineRate
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const ENGINE * eng : engine, after EngineRun
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: folders (and archives) opened a second, over the whole
+//                 walk, what a --gentle rate got down to in the end
+/*--------------------------------------------------------------------@@-@@-*/
+UINT EngineRate ( const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    if ( eng == NULL || eng->gentle.ticks <= 0 )
+        return 0;
+
+    return (UINT)( eng->gentle.opened * eng->gentle.freq /
+        eng->gentle.ticks );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineWorker
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT __stdcall
+//    Param.    1: void * param : ENG_WORKER
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: thread function for _beginthreadex. Takes folders off the
+//                 queue until there's nothing left or we're aborted.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT __stdcall EngineWorker ( void * param )
+/*--------------------------------------------------------------------------*/
+{
+    ENG_WORKER      * w;
+    ENGINE          * eng;
+    LARGE_INTEGER   t0, t1;
+    UINT            node;
+
+    w   = (ENG_WORKER *)param;
+    eng = w->eng;
+
+    if ( eng->gentle.background )
+        SetThreadPriority ( GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN );
+
+    for ( ;; )
+    {
+        // what a walk loses to a late big subtree shows up as this
+        QueryPerformanceCounter ( &t0 );
+        WaitForSingleObject ( eng->hSem, INFINITE );
+        QueryPerformanceCounter ( &t1 );
+        InterlockedExchangeAdd64 ( &eng->idle, t1.QuadPart - t0.QuadPart );
+
+        EnterCriticalSection ( &eng->lock );
+
+        if ( eng->done || eng->abort || eng->qlen == 0 )
+        {
+            LeaveCriticalSection ( &eng->lock );
+            break;
+        }
+
+        if ( eng->breadth )
+        {
+            node = eng->queue[eng->qhead++];
+            eng->qlen--;
+        }
+        else if ( eng->longest )
+            node = EngineHeapPop ( eng );
+        else
+            node = eng->queue[--eng->qlen];
+
+        eng->busy++;
+
+        LeaveCriticalSection ( &eng->lock );
+
+        EngineScanDir ( w, node );
+    }
+
+    // may be the thread EngineRun was called on
+    if ( eng->gentle.background )
+        SetThreadPriority ( GetCurrentThread(), THREAD_MODE_BACKGROUND_END );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineScanDir
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENG_WORKER * w : worker
+//    Param.    2: UINT node      : folder to enumerate
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: enumerate one folder, without holding the lock. Then,
+//                 under the lock, make nodes for all its subfolders at
+//                 once, queue them, and if there were none, finish the
+//                 folder and whatever parents were only waiting for it.
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineScanDir ( ENG_WORKER * w, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    ENGINE              * eng;
+    WIN32_FIND_DATAW    ffData;
+    HANDLE              hFind;
+    LARGE_INTEGER       li, t0, t1;
+    __int64             own, newest, t, took;
+    UINT                len, rootlen, root, files, first, i, k, nlen, off;
+    UINT                round;
+    BOOL                err, cut;
+    const WCHAR         * p;
+
+    eng         = w->eng;
+
+    EngineThrottle ( eng );
+
+    if ( eng->flags[node] & ENG_ARCHIVE )
+    {
+        EngineScanArchive ( w, node );
+        return;
+    }
+
+    own         = 0;
+    newest      = 0;
+    took        = -1;
+    files       = 0;
+    err         = FALSE;
+    w->nsub     = 0;
+    w->sub_len  = 0;
+    w->nfin     = 0;
+
+    root        = EngineRootOf ( eng, node );
+    rootlen     = ( root != ENG_NONE ) ?
+                    eng->nlen[eng->roots[root].node] : 0;
+
+    // folders at the depth limit are counted, not opened
+    cut         = ( (UINT)eng->depth[node] + 1 >= eng->max_depth );
+
+    len         = EnginePath ( eng, node, w->path, ENG_MAX_PATH );
+
+    if ( eng->hooks.on_enter != NULL )
+        eng->hooks.on_enter ( eng->hooks.ctx, w->index, node );
+
+    if ( len == 0 || len + 3 >= ENG_MAX_PATH )
+        err = TRUE;
+    else
+    {
+        wmemcpy ( w->path + len, L"\\*", 3 );
+
+        // no short names, bigger batches per call; timed, for --gentle
+        if ( eng->gentle.rate != 0 )
+            QueryPerformanceCounter ( &t0 );
+
+        hFind = FindFirstFileExW ( w->path, FindExInfoBasic, &ffData,
+            FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH );
+
+        if ( eng->gentle.rate != 0 )
+        {
+            QueryPerformanceCounter ( &t1 );
+            took = t1.QuadPart - t0.QuadPart;
+        }
+
+        w->path[len] = L'\0';
+
+        if ( hFind == INVALID_HANDLE_VALUE )
+            err = TRUE;
+        else
+        {
+            do
+            {
+                if ( eng->abort )
+                    break;
+
+                // full path, relative part used by the filter; one too
+                // long to build is matched by its name only
+                nlen = (UINT)wcslen ( ffData.cFileName );
+                p    = NULL;
+
+                if ( len + nlen + 2 < ENG_MAX_PATH )
+                {
+                    w->path[len] = L'\\';
+                    wmemcpy ( w->path + len + 1, ffData.cFileName,
+                        nlen + 1 );
+                    p = w->path + rootlen + 1;
+                }
+
+                if ( ffData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+                {
+                    // skip . and .., excluded folders are never opened
+                    if ( !EngineIsDots ( ffData.cFileName ) && !cut &&
+                        ( eng->filter == NULL || !PatSkipEntry (
+                            eng->filter, ffData.cFileName, p, TRUE ) ) &&
+                        ( eng->hooks.on_subdir == NULL ||
+                          eng->hooks.on_subdir ( eng->hooks.ctx, node,
+                            ffData.cFileName ) ) )
+                    {
+                        if ( !EngineAddSub ( w, node, ffData.cFileName,
+                                0 ) )
+                            err = TRUE;
+                    }
+
+                    w->path[len] = L'\0';
+                }
+                else
+                {
+                    // archives are walked as folders, filtered as such
+                    if ( eng->archives && !cut &&
+                            ArcKind ( ffData.cFileName ) != ARC_NONE )
+                    {
+                        if ( ( eng->filter == NULL || !PatSkipEntry (
+                                eng->filter, ffData.cFileName, p, TRUE ) ) &&
+                            ( eng->hooks.on_subdir == NULL ||
+                              eng->hooks.on_subdir ( eng->hooks.ctx, node,
+                                ffData.cFileName ) ) &&
+                            !EngineAddSub ( w, node, ffData.cFileName,
+                                ENG_ARCHIVE ) )
+                            err = TRUE;
+
+                        w->path[len] = L'\0';
+                        continue;
+                    }
+
+                    if ( eng->filter != NULL && PatSkipEntry (
+                            eng->filter, ffData.cFileName, p, FALSE ) )
+                    {
+                        w->path[len] = L'\0';
+                        continue;
+                    }
+
+                    w->path[len] = L'\0';
+
+                    li.u.HighPart   = ffData.nFileSizeHigh;
+                    li.u.LowPart    = ffData.nFileSizeLow;
+                    own            += li.QuadPart;
+                    files++;
+
+                    t = ( (__int64)ffData.ftLastWriteTime.dwHighDateTime
+                        << 32 ) | ffData.ftLastWriteTime.dwLowDateTime;
+
+                    if ( t > newest )
+                        newest = t;
+
+                    if ( eng->hooks.on_file != NULL )
+                        eng->hooks.on_file ( eng->hooks.ctx, w->index,
+                            node, w->path, &ffData );
+                }
+            }
+            while ( FindNextFileW ( hFind, &ffData ) != 0 );
+
+            FindClose ( hFind );
+        }
+    }
+
+    // before the subfolders are queued, none of them can be final, so
+    // no parent can be either until it has these
+    if ( eng->breadth )
+        EngineRaise ( eng, node, own );
+
+    EnterCriticalSection ( &eng->lock );
+
+    if ( took >= 0 )
+        EngineBackOff ( eng, took );
+
+    // slots a spill gave back first, names and all
+    first = EngineReuse ( eng, w->nsub, w->sub_len, &off );
+
+    if ( first != ENG_NONE )
+    {
+        for ( i = 0, p = w->sub; i < w->nsub; i++, p += nlen + 1 )
+        {
+            nlen = (UINT)wcslen ( p );
+            wmemcpy ( eng->names + off, p, nlen + 1 );
+            EngineSetNode ( eng, first + i, node, off, nlen );
+            eng->flags[first + i] |= w->subfl[i];
+            off += nlen + 1;
+
+            if ( eng->longest )
+                eng->pending[first + i] = (LONG)w->subw[i];
+        }
+
+        k = w->nsub;
+    }
+    else
+    {
+        if ( !EngineGrow ( eng, w->nsub ) )
+        {
+            w->nsub = 0;
+            err     = TRUE;
+        }
+
+        first = eng->count;
+
+        for ( i = 0, k = 0, p = w->sub; i < w->nsub; i++, p += nlen + 1 )
+        {
+            nlen = (UINT)wcslen ( p );
+
+            if ( EngineNewNode ( eng, node, p, nlen ) == ENG_NONE )
+            {
+                err = TRUE;
+                continue;
+            }
+
+            eng->flags[first + k] |= w->subfl[i];
+
+            if ( eng->longest )
+                eng->pending[first + k] = (LONG)w->subw[i];
+
+            k++;
+        }
+    }
+
+    EnginePublish ( eng );
+
+    eng->first[node]    = k ? first : ENG_NONE;
+    eng->nchild[node]   = k;
+    eng->own[node]      = own;
+    eng->size[node]     = own;
+    eng->files[node]    = files;
+    eng->mtime[node]    = newest;
+    eng->tfiles[node]   = files;
+    eng->tdirs[node]    = 0;
+    eng->pending[node]  = k;
+
+    if ( err )
+        eng->flags[node] |= ENG_ERROR;
+
+    // queue them so they come out in enumeration order
+    if ( eng->breadth )
+        for ( i = 0; i < k; i++ )
+            eng->queue[eng->qhead + eng->qlen++] = first + i;
+    else if ( eng->longest )
+        for ( i = 0; i < k; i++ )
+            EngineHeapPush ( eng, first + i );
+    else
+        for ( i = k; i--; )
+            eng->queue[eng->qlen++] = first + i;
+
+    eng->waiting[eng->depth[node] + 1] += k;
+    eng->busy--;
+
+    if ( eng->qlen == 0 && eng->busy == 0 )
+    {
+        // all done, wake everybody up so they can leave
+        eng->done = TRUE;
+        ReleaseSemaphore ( eng->hSem, eng->threads, NULL );
+    }
+    else if ( k != 0 )
+        ReleaseSemaphore ( eng->hSem, k, NULL );
+
+    round = EngineLevelDone ( eng, node );
+
+    LeaveCriticalSection ( &eng->lock );
+
+    // no subfolders, final now and maybe some parents with it. A spill
+    // waits for the rollup and the on_final calls on their way.
+    if ( k == 0 )
+    {
+        InterlockedIncrement ( &eng->finals );
+        EngineFinish ( eng, w, node );
+    }
+
+    InterlockedExchangeAdd64 ( &eng->total_files, files );
+    InterlockedIncrement64 ( &eng->total_dirs );
+
+    if ( root != ENG_NONE )
+    {
+        InterlockedExchangeAdd64 ( &eng->roots[root].files, files );
+        InterlockedIncrement64 ( &eng->roots[root].dirs );
+    }
+
+    if ( eng->hooks.on_final != NULL )
+        for ( i = 0; i < w->nfin; i++ )
+            eng->hooks.on_final ( eng->hooks.ctx, w->fin[i] );
+
+    if ( round != 0 && eng->hooks.on_round != NULL )
+        eng->hooks.on_round ( eng->hooks.ctx, round );
+
+    if ( k == 0 )
+    {
+        InterlockedDecrement ( &eng->finals );
+        EngineSpill ( w );
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineScanArchive
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENG_WORKER * w : worker
+//    Param.    2: UINT node      : an ENG_ARCHIVE node, the archive file
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: EngineScanDir for an archive. Its folders are read from
+//                 the headers (see ArcRead), then made into nodes under
+//                 the lock, level by level so each folder's children
+//                 stay together. They come out final, nothing is queued;
+//                 the archive node is finished like an empty folder. An
+//                 archive that can't be read at all counts as the file
+//                 it is, with ENG_ERROR.
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineScanArchive ( ENG_WORKER * w, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    ENGINE          * eng;
+    ARC_TREE        at;
+    ARC_DIR         * d;
+    UINT            * order;
+    UINT            len, rootlen, root, levels, head, tail, base, first;
+    UINT            i, k, c, n, round;
+    UINT64          files;
+    BOOL            ok;
+
+    eng         = w->eng;
+    w->nfin     = 0;
+
+    RtlZeroMemory ( &at, sizeof ( ARC_TREE ) );
+
+    root        = EngineRootOf ( eng, node );
+    rootlen     = ( root != ENG_NONE ) ?
+                    eng->nlen[eng->roots[root].node] : 0;
+
+    // folder levels inside that still fit under the depth limit
+    levels      = eng->max_depth - 1 - eng->depth[node];
+
+    len         = EnginePath ( eng, node, w->path, ENG_MAX_PATH );
+
+    if ( eng->hooks.on_enter != NULL )
+        eng->hooks.on_enter ( eng->hooks.ctx, w->index, node );
+
+    ok = ( len != 0 && ArcRead ( &at, w->path, ArcKind ( w->path ), levels,
+        eng->filter, w->path + rootlen + 1 ) );
+
+    order = malloc ( ( at.ndirs ? at.ndirs : 1 ) * sizeof ( UINT ) );
+
+    if ( order == NULL )
+        ok = FALSE;
+
+    EnterCriticalSection ( &eng->lock );
+
+    n = ( order != NULL && at.ndirs > 1 ) ? at.ndirs - 1 : 0;
+
+    if ( !EngineGrow ( eng, n ) )
+    {
+        n   = 0;
+        ok  = FALSE;
+    }
+
+    // breadth first, order[j] is the folder of node base + j - 1
+    base    = eng->count;
+    head    = 0;
+    tail    = 0;
+
+    if ( n != 0 )
+        order[tail++] = 0;
+
+    for ( ; head < tail; head++ )
+    {
+        i       = ( head == 0 ) ? node : base + head - 1;
+        first   = eng->count;
+
+        for ( k = 0, c = at.dirs[order[head]].child; c != ENG_NONE;
+                c = at.dirs[c].next )
+        {
+            if ( EngineNewNode ( eng, i, at.names + at.dirs[c].name,
+                    at.dirs[c].nlen ) == ENG_NONE )
+            {
+                ok = FALSE;
+                break;
+            }
+
+            order[tail++] = c;
+            k++;
+        }
+
+        eng->first[i]   = k ? first : ENG_NONE;
+        eng->nchild[i]  = k;
+    }
+
+    for ( i = 1; i < tail; i++ )
+    {
+        d                       = &at.dirs[order[i]];
+        eng->own[base+i-1]      = d->own;
+        eng->size[base+i-1]     = d->size;
+        eng->files[base+i-1]    = d->files;
+        eng->mtime[base+i-1]    = at.disk_time;
+        eng->tfiles[base+i-1]   = d->files;
+        eng->tdirs[base+i-1]    = 0;
+    }
+
+    // children come after their parents, the archive's own are added
+    // to it below
+    for ( i = tail; i-- > 1; )
+    {
+        c = eng->parent[base+i-1];
+
+        if ( c != node )
+        {
+            eng->tfiles[c]  += eng->tfiles[base+i-1];
+            eng->tdirs[c]   += eng->tdirs[base+i-1] + 1;
+        }
+    }
+
+    // sizes out before the flags, see EngineFinish
+    if ( eng->publish != NULL )
+        MemoryBarrier ( );
+
+    for ( i = 1; i < tail; i++ )
+        eng->flags[base+i-1] |= ENG_FINAL | ENG_ARCHIVE;
+
+    EnginePublish ( eng );
+
+    if ( at.ndirs != 0 && ( ok || at.ndirs > 1 || at.dirs[0].files ) )
+    {
+        eng->own[node]      = at.dirs[0].own;
+        eng->size[node]     = at.dirs[0].size;
+        eng->files[node]    = at.dirs[0].files;
+    }
+    else
+    {
+        eng->own[node]      = (__int64)at.disk_size;
+        eng->size[node]     = (__int64)at.disk_size;
+        eng->files[node]    = 1;
+    }
+
+    eng->mtime[node]    = at.disk_time;
+    eng->tfiles[node]   = eng->files[node];
+    eng->tdirs[node]    = 0;
+    eng->pending[node]  = 0;
+
+    for ( i = 0; i < eng->nchild[node]; i++ )
+    {
+        eng->tfiles[node]   += eng->tfiles[eng->first[node] + i];
+        eng->tdirs[node]    += eng->tdirs[eng->first[node] + i] + 1;
+    }
+
+    if ( !ok )
+        eng->flags[node] |= ENG_ERROR;
+
+    eng->busy--;
+
+    if ( eng->qlen == 0 && eng->busy == 0 )
+    {
+        eng->done = TRUE;
+        ReleaseSemaphore ( eng->hSem, eng->threads, NULL );
+    }
+
+    round = EngineLevelDone ( eng, node );
+
+    LeaveCriticalSection ( &eng->lock );
+
+    if ( eng->breadth )
+        EngineRaise ( eng, node, eng->size[node] );
+
+    InterlockedIncrement ( &eng->finals );
+    EngineFinish ( eng, w, node );
+
+    for ( i = 0, files = 0; i < tail; i++ )
+        files += at.dirs[order[i]].files;
+
+    if ( tail == 0 )
+        files = eng->files[node];
+
+    InterlockedExchangeAdd64 ( &eng->total_files, files );
+    InterlockedExchangeAdd64 ( &eng->total_dirs, tail ? tail : 1 );
+
+    if ( root != ENG_NONE )
+    {
+        InterlockedExchangeAdd64 ( &eng->roots[root].files, files );
+        InterlockedExchangeAdd64 ( &eng->roots[root].dirs, tail ? tail : 1 );
+    }
+
+    // children before parents, the archive last
+    if ( eng->hooks.on_final != NULL )
+    {
+        for ( i = tail; i-- > 1; )
+            eng->hooks.on_final ( eng->hooks.ctx, base + i - 1 );
+
+        for ( i = 0; i < w->nfin; i++ )
+            eng->hooks.on_final ( eng->hooks.ctx, w->fin[i] );
+    }
+
+    if ( round != 0 && eng->hooks.on_round != NULL )
+        eng->hooks.on_round ( eng->hooks.ctx, round );
+
+    InterlockedDecrement ( &eng->finals );
+
+    free ( order );
+    ArcFree ( &at );
+
+    EngineSpill ( w );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineFinish
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENGINE * eng   : engine, not locked
+//    Param.    2: ENG_WORKER * w : worker, collects the final nodes
+//    Param.    3: UINT node      : folder with nothing left pending
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: mark a folder final, add its size to the parent's and
+//                 go on up for as long as the parent was waiting only for
+//                 this one. No lock: a parent's size and pending count
+//                 were set before its subfolders were queued, then each
+//                 of them adds its size and counts down, atomically. The
+//                 one taking pending to 0 is the last, and (the
+//                 decrement being a full barrier) sees every size added,
+//                 so it carries on with the parent. The others just go.
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineFinish ( ENGINE * eng, ENG_WORKER * w, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    UINT parent;
+
+    for ( ;; )
+    {
+        // the size is complete, have it out before the flag for the
+        // readers going without the lock
+        if ( eng->publish != NULL )
+            MemoryBarrier ( );
+
+        eng->flags[node] |= ENG_FINAL;
+
+        if ( w->nfin < ARRAYSIZE(w->fin) )
+            w->fin[w->nfin++] = node;
+
+        parent = eng->parent[node];
+
+        if ( parent == ENG_NONE )
+            break;
+
+        // with breadth, it's all there already, see EngineRaise
+        if ( !eng->breadth )
+            InterlockedExchangeAdd64 ( &eng->size[parent],
+                eng->size[node] );
+
+        EngineNewer ( &eng->mtime[parent], eng->mtime[node] );
+        InterlockedExchangeAdd64 ( &eng->tfiles[parent], eng->tfiles[node] );
+        InterlockedExchangeAdd ( (LONG *)&eng->tdirs[parent],
+            eng->tdirs[node] + 1 );
+
+        if ( eng->hooks.on_rollup != NULL )
+            eng->hooks.on_rollup ( eng->hooks.ctx, node, parent );
+
+        if ( InterlockedDecrement ( &eng->pending[parent] ) != 0 )
+            break;
+
+        node = parent;
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineAddSub
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: ENG_WORKER * w     : worker
+//    Param.    2: UINT node          : folder being enumerated
+//    Param.    3: const WCHAR * name : subfolder name
+//    Param.    4: BYTE flags         : ENG_xxx for its node
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: remember a subfolder of the folder being enumerated,
+//                 weighed now if heaviest first, while there's no lock.
+//                 Nodes are made for all of them at the end, in one go.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL EngineAddSub ( ENG_WORKER * w, UINT node, const WCHAR * name,
+    BYTE flags )
+/*--------------------------------------------------------------------------*/
+{
+    ENGINE  * eng;
+    WCHAR   * tmp;
+    BYTE    * fl;
+    UINT    * wt;
+    UINT    len, cap;
+
+    eng = w->eng;
+
+    if ( w->nsub == w->subfl_cap )
+    {
+        cap = w->subfl_cap ? w->subfl_cap * 2 : 1024;
+        fl  = realloc ( w->subfl, cap );
+
+        if ( fl == NULL )
+            return FALSE;
+
+        w->subfl = fl;
+
+        if ( eng->longest )
+        {
+            wt = realloc ( w->subw, cap * sizeof ( UINT ) );
+
+            if ( wt == NULL )
+                return FALSE;
+
+            w->subw = wt;
+        }
+
+        w->subfl_cap = cap;
+    }
+
+    len = (UINT)wcslen ( name ) + 1;
+
+    if ( w->sub_len + len > w->sub_cap )
+    {
+        cap = w->sub_cap ? w->sub_cap * 2 : 16384;
+
+        while ( cap < w->sub_len + len )
+            cap *= 2;
+
+        tmp = realloc ( w->sub, cap * sizeof ( WCHAR ) );
+
+        if ( tmp == NULL )
+            return FALSE;
+
+        w->sub      = tmp;
+        w->sub_cap  = cap;
+    }
+
+    if ( eng->longest )
+        w->subw[w->nsub] = eng->hooks.on_weigh ( eng->hooks.ctx, w->index,
+            node, name );
+
+    wmemcpy ( w->sub + w->sub_len, name, len );
+    w->sub_len += len;
+    w->subfl[w->nsub++] = flags;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineNewNode
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: ENGINE * eng       : engine, locked, grown
+//    Param.    2: UINT parent        : parent node, ENG_NONE for a root
+//    Param.    3: const WCHAR * name : folder name (full path for roots)
+//    Param.    4: UINT len           : name length
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: append a node, returns it or ENG_NONE if out of room
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT EngineNewNode ( ENGINE * eng, UINT parent, const WCHAR * name,
+    UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    UINT node, off;
+
+    if ( eng->count >= eng->committed || len > 0xFFFF )
+        return ENG_NONE;
+
+    off = EngineAddName ( eng, name, len );
+
+    if ( off == ENG_NONE )
+        return ENG_NONE;
+
+    node = eng->count;
+    EngineSetNode ( eng, node, parent, off, len );
+    eng->count++;
+
+    return node;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineSetNode
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENGINE * eng : engine, locked
+//    Param.    2: UINT node    : slot, appended or reused
+//    Param.    3: UINT parent  : parent node, ENG_NONE for a root
+//    Param.    4: UINT off     : its name, already in the arena
+//    Param.    5: UINT len     : name length
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineSetNode ( ENGINE * eng, UINT node, UINT parent, UINT off,
+    UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    eng->parent[node]   = parent;
+    eng->first[node]    = ENG_NONE;
+    eng->nchild[node]   = 0;
+    eng->name[node]     = off;
+    eng->nlen[node]     = (USHORT)len;
+    eng->depth[node]    = ( parent == ENG_NONE ) ? 0 : eng->depth[parent] + 1;
+    eng->flags[node]    = ( parent == ENG_NONE ) ? ENG_TOP : 0;
+    eng->own[node]      = 0;
+    eng->size[node]     = 0;
+    eng->files[node]    = 0;
+    eng->mtime[node]    = 0;
+    eng->tfiles[node]   = 0;
+    eng->tdirs[node]    = 0;
+    eng->pending[node]  = 0;
+
+    if ( eng->extra != NULL )
+        RtlZeroMemory ( eng->extra + (UINT_PTR)node * eng->extra_size,
+            eng->extra_size );
+
+    eng->live++;
+    eng->live_chars += len + 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineReuse
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: ENGINE * eng : engine, locked
+//    Param.    2: UINT n       : subfolders about to be added
+//    Param.    3: UINT chars   : their names, a NUL each counted
+//    Param.    4: UINT * off   : receives where the names go
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: n slots in a row and room for the names from what
+//                 spills gave back. Returns the first slot, or ENG_NONE
+//                 if there's no such thing (or no spilling), and the
+//                 caller appends as usual.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT EngineReuse ( ENGINE * eng, UINT n, UINT chars, UINT * off )
+/*--------------------------------------------------------------------------*/
+{
+    UINT first;
+
+    if ( eng->spill == NULL || n == 0 )
+        return ENG_NONE;
+
+    first = EngineRangeTake ( &eng->free_nodes, n );
+
+    if ( first == ENG_NONE )
+        return ENG_NONE;
+
+    *off = EngineRangeTake ( &eng->free_chars, chars );
+
+    if ( *off == ENG_NONE )
+    {
+        EngineRangePut ( &eng->free_nodes, first, n );
+        return ENG_NONE;
+    }
+
+    return first;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineRelease
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENGINE * eng : engine, locked
+//    Param.    2: UINT node    : final folder, written to the run file
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: give back the slots and names of everything below node.
+//                 A folder's subfolders are one range of slots with their
+//                 names one after the other, so they go back as two
+//                 ranges. Folders spilled before lose their link, the
+//                 new records point where it did.
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineRelease ( ENGINE * eng, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    UINT first, last, n, i;
+
+    if ( eng->flags[node] & ENG_SPILLED )
+    {
+        SpillForget ( eng->spill, eng->first[node] );
+        return;
+    }
+
+    first   = eng->first[node];
+    n       = eng->nchild[node];
+
+    if ( n == 0 )
+        return;
+
+    last = first + n - 1;
+
+    for ( i = first; i <= last; i++ )
+        EngineRelease ( eng, i );
+
+    // lost if out of memory, no harm done
+    EngineRangePut ( &eng->free_chars, eng->name[first],
+        eng->name[last] + eng->nlen[last] + 1 - eng->name[first] );
+    EngineRangePut ( &eng->free_nodes, first, n );
+
+    for ( i = first; i <= last; i++ )
+    {
+        eng->live_chars    -= eng->nlen[i] + 1;
+        eng->flags[i]       = ENG_FREE;
+    }
+
+    eng->live -= n;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineSpill
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENG_WORKER * w : worker, done with a folder
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: --mem-limit. If over it, write the highest folder the
+//                 worker just finished, all below it, to the run file
+//                 and keep only the folder itself, with its totals and
+//                 ENG_SPILLED. Nothing below a final folder changes any
+//                 more, so the writing goes without the engine lock; it
+//                 waits only for on_final calls still reading nodes.
+//                 One spill at a time, the others don't wait for it.
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineSpill ( ENG_WORKER * w )
+/*--------------------------------------------------------------------------*/
+{
+    ENGINE  * eng;
+    SPILL   * sp;
+    UINT    node, link;
+    BOOL    go;
+
+    eng = w->eng;
+    sp  = eng->spill;
+
+    if ( sp == NULL || w->nfin == 0 || !SpillOver ( sp, eng ) ||
+            !TryEnterCriticalSection ( &sp->lock ) )
+        return;
+
+    // another spill may have taken it in the meantime
+    node = w->fin[w->nfin-1];
+
+    EnterCriticalSection ( &eng->lock );
+
+    go = ( eng->nchild[node] != 0 && ( eng->flags[node] & ( ENG_FINAL |
+        ENG_TOP | ENG_SPILLED | ENG_FREE ) ) == ENG_FINAL );
+
+    // finals goes up before a rollup marks anything final, so it's
+    // read after the flag
+    MemoryBarrier ( );
+
+    go = go && eng->finals == 0;
+
+    LeaveCriticalSection ( &eng->lock );
+
+    link = go ? SpillWrite ( sp, eng, node ) : ENG_NONE;
+
+    if ( link != ENG_NONE )
+    {
+        EnterCriticalSection ( &eng->lock );
+
+        EngineRelease ( eng, node );
+
+        eng->first[node]    = link;
+        eng->nchild[node]   = 0;
+        eng->flags[node]   |= ENG_SPILLED;
+
+        LeaveCriticalSection ( &eng->lock );
+    }
+
+    LeaveCriticalSection ( &sp->lock );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineRangePut
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: ENG_RANGES * rs : free ranges
+//    Param.    2: UINT start      : first slot (or char)
+//    Param.    3: UINT len        : how many, not 0
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL EngineRangePut ( ENG_RANGES * rs, UINT start, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  * tmp;
+    UINT    b, cap;
+
+    for ( b = 0; ( len >> b ) > 1; b++ )
+        ;
+
+    if ( rs->n[b] == rs->cap[b] )
+    {
+        cap = rs->cap[b] ? rs->cap[b] * 2 : 256;
+        tmp = realloc ( rs->r[b], (UINT_PTR)cap * sizeof ( UINT64 ) );
+
+        if ( tmp == NULL )
+            return FALSE;
+
+        rs->r[b]    = tmp;
+        rs->cap[b]  = cap;
+    }
+
+    rs->r[b][rs->n[b]++] = ( (UINT64)start << 32 ) | len;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineRangeTake
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: ENG_RANGES * rs : free ranges
+//    Param.    2: UINT len        : how many in a row, not 0
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the last range put in len's bucket, if long enough, else
+//                 one from a bigger bucket (all long enough). What's left
+//                 of it goes back. Returns its start or ENG_NONE.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT EngineRangeTake ( ENG_RANGES * rs, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  r;
+    UINT    b, start;
+
+    for ( b = 0; ( len >> b ) > 1; b++ )
+        ;
+
+    for ( ; b < 32; b++ )
+    {
+        if ( rs->n[b] == 0 )
+            continue;
+
+        r = rs->r[b][rs->n[b]-1];
+
+        if ( (UINT)r < len )
+            continue;
+
+        rs->n[b]--;
+        start = (UINT)( r >> 32 );
+
+        if ( (UINT)r > len )
+            EngineRangePut ( rs, start + len, (UINT)r - len );
+
+        return start;
+    }
+
+    return ENG_NONE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineGrow
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: ENGINE * eng : engine, locked
+//    Param.    2: UINT n       : nodes about to be added
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: commit more of every column if needed. Nothing moves,
+//                 the address space was reserved by EngineInit.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL EngineGrow ( ENGINE * eng, UINT n )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    want, i;
+
+    if ( eng->count + n <= eng->committed )
+        return TRUE;
+
+    if ( n > ENG_MAX_NODES - eng->count )
+        return FALSE;
+
+    want = ( ( eng->count + n + ENG_COMMIT_NODES - 1 ) / ENG_COMMIT_NODES ) *
+        ENG_COMMIT_NODES;
+
+    if ( want > ENG_MAX_NODES )
+        want = ENG_MAX_NODES;
+
+    for ( i = 0; i < eng->ncols; i++ )
+        if ( VirtualAlloc ( eng->cols[i].base +
+                (UINT_PTR)eng->committed * eng->cols[i].elem,
+                (UINT_PTR)( want - eng->committed ) * eng->cols[i].elem,
+                    MEM_COMMIT, PAGE_READWRITE ) == NULL )
+            return FALSE;
+
+    eng->committed = want;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineAddName
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: ENGINE * eng       : engine, locked
+//    Param.    2: const WCHAR * name : name to store
+//    Param.    3: UINT len           : its length
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: copy a name to the arena, NUL terminated. Returns its
+//                 offset, or ENG_NONE if the arena is full.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT EngineAddName ( ENGINE * eng, const WCHAR * name, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    off, want;
+
+    if ( len + 1 > ENG_MAX_CHARS - eng->names_len )
+        return ENG_NONE;
+
+    if ( eng->names_len + len + 1 > eng->names_committed )
+    {
+        want = ( ( eng->names_len + len + ENG_COMMIT_CHARS ) /
+            ENG_COMMIT_CHARS ) * ENG_COMMIT_CHARS;
+
+        if ( want > ENG_MAX_CHARS )
+            want = ENG_MAX_CHARS;
+
+        if ( VirtualAlloc ( eng->names + eng->names_committed,
+                (UINT_PTR)( want - eng->names_committed ) * sizeof ( WCHAR ),
+                    MEM_COMMIT, PAGE_READWRITE ) == NULL )
+            return ENG_NONE;
+
+        eng->names_committed = want;
+    }
+
+    off = eng->names_len;
+
+    wmemcpy ( eng->names + off, name, len );
+    eng->names[off+len] = L'\0';
+    eng->names_len += len + 1;
+
+    return off;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineColumn
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: ENGINE * eng  : engine
+//    Param.    2: void * pbase  : address of the column pointer
+//    Param.    3: UINT elem     : element size
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: reserve room for ENG_MAX_NODES elements and register the
+//                 column, so EngineGrow commits it along with the others
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL EngineColumn ( ENGINE * eng, void * pbase, UINT elem )
+/*--------------------------------------------------------------------------*/
+{
+    BYTE * base;
+
+    if ( eng->ncols >= ENG_MAX_COLS )
+        return FALSE;
+
+    base = VirtualAlloc ( NULL, (UINT_PTR)ENG_MAX_NODES * elem,
+        MEM_RESERVE, PAGE_READWRITE );
+
+    if ( base == NULL )
+        return FALSE;
+
+    *(BYTE **)pbase                 = base;
+    eng->cols[eng->ncols].base      = base;
+    eng->cols[eng->ncols].elem      = elem;
+    eng->ncols++;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineResolveRoots
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENGINE * eng : engine, before the walk
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: find the roots that live inside other roots. Each root's
+//                 parent folders are identified (volume serial + file
+//                 index) and checked against the other roots; the same
+//                 folder given twice is kept only the first time. Paths
+//                 don't matter, so drive letters, shares and junctions
+//                 pointing to the same place are caught as well.
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineResolveRoots ( ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    ENG_ROOT    * r;
+    WCHAR       up[ENG_MAX_PATH];
+    WCHAR       * p;
+    DWORD       volume;
+    UINT64      fileid;
+    UINT        i, j;
+    BOOL        last;
+
+    for ( j = 0; j < eng->nroots; j++ )
+    {
+        r = &eng->roots[j];
+
+        if ( r->state != ENG_ROOT_WALKED )
+            continue;
+
+        // same folder as an earlier root?
+        for ( i = 0; i < j; i++ )
+            if ( eng->roots[i].state != ENG_ROOT_MISSING &&
+                    eng->roots[i].volume == r->volume &&
+                        eng->roots[i].fileid == r->fileid )
+                break;
+
+        if ( i < j )
+        {
+            r->state    = ENG_ROOT_NESTED;
+            r->inside   = i;
+            r->rel      = (UINT)wcslen ( r->final );
+            continue;
+        }
+
+        // walk up from the root, nearest parent first
+        wcsncpy ( up, r->final, ARRAYSIZE(up) - 1 );
+        up[ARRAYSIZE(up)-1] = L'\0';
+
+        for ( last = FALSE; !last && r->state == ENG_ROOT_WALKED; )
+        {
+            p = wcsrchr ( up, L'\\' );
+
+            if ( p == NULL || p - up < 2 )
+                break;
+
+            // keep the backslash of "c:\", it's the last one
+            if ( p - up == 2 && up[1] == L':' )
+            {
+                if ( p[1] == L'\0' )
+                    break;
+
+                p[1] = L'\0';
+                last = TRUE;
+            }
+            else
+                *p = L'\0';
+
+            if ( !EngineFolderId ( up, &volume, &fileid, NULL, 0 ) )
+                continue;
+
+            for ( i = 0; i < eng->nroots; i++ )
+            {
+                if ( i == j || eng->roots[i].state == ENG_ROOT_MISSING ||
+                        eng->roots[i].volume != volume ||
+                            eng->roots[i].fileid != fileid )
+                    continue;
+
+                r->state    = ENG_ROOT_NESTED;
+                r->inside   = i;
+                r->rel      = (UINT)wcslen ( up );
+
+                if ( up[r->rel-1] != L'\\' )
+                    r->rel++;
+
+                break;
+            }
+        }
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineFolderId
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: const WCHAR * path : folder
+//    Param.    2: DWORD * volume     : receives the volume serial
+//    Param.    3: UINT64 * fileid    : receives the file index
+//    Param.    4: WCHAR * final      : receives the resolved path, or NULL
+//    Param.    5: UINT cch           : final size, in chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: Windows' device + inode. Returns FALSE if the folder
+//                 can't be opened.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL EngineFolderId ( const WCHAR * path, DWORD * volume,
+    UINT64 * fileid, WCHAR * final, UINT cch )
+/*--------------------------------------------------------------------------*/
+{
+    BY_HANDLE_FILE_INFORMATION  bhfi;
+    HANDLE                      hDir;
+    WCHAR                       tmp[ENG_MAX_PATH];
+    UINT_PTR                    len;
+    DWORD                       got;
+    BOOL                        ok;
+
+    // a bare "c:" would open the current folder of drive c:
+    len = wcslen ( path );
+
+    if ( len + 2 > ARRAYSIZE(tmp) )
+        return FALSE;
+
+    wmemcpy ( tmp, path, len + 1 );
+
+    if ( len == 2 && tmp[1] == L':' )
+    {
+        tmp[2] = L'\\';
+        tmp[3] = L'\0';
+    }
+
+    hDir = CreateFileW ( tmp, FILE_READ_ATTRIBUTES,
+        FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE, NULL,
+            OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL );
+
+    if ( hDir == INVALID_HANDLE_VALUE )
+        return FALSE;
+
+    ok = GetFileInformationByHandle ( hDir, &bhfi ) &&
+        ( bhfi.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY );
+
+    if ( ok )
+    {
+        *volume = bhfi.dwVolumeSerialNumber;
+        *fileid = ( (UINT64)bhfi.nFileIndexHigh << 32 ) | bhfi.nFileIndexLow;
+    }
+
+    if ( ok && final != NULL )
+    {
+        got = GetFinalPathNameByHandleW ( hDir, final, cch, 0 );
+
+        if ( got == 0 || got >= cch )
+            wcsncpy ( final, tmp, cch ); // shouldn't happen, but be nice
+        else if ( wcsncmp ( final, L"\\\\?\\UNC\\", 8 ) == 0 )
+        {
+            // \\?\UNC\server\share -> \\server\share
+            wmemmove ( final + 2, final + 8, got - 8 + 1 );
+        }
+        else if ( wcsncmp ( final, L"\\\\?\\", 4 ) == 0 )
+            wmemmove ( final, final + 4, got - 4 + 1 );
+
+        final[cch-1] = L'\0';
+    }
+
+    CloseHandle ( hDir );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EnginePublish
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENGINE * eng : engine, locked
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: new nodes are written, let eng->publish readers see
+//                 them. The interlocked store orders it after the node
+//                 data.
+/*--------------------------------------------------------------------@@-@@-*/
+static void EnginePublish ( ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    if ( eng->publish != NULL )
+        InterlockedExchange ( eng->publish, (LONG)eng->count );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineIsDots
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: const WCHAR * name : folder name
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: see if name is . or ..
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL EngineIsDots ( const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    return ( name[0] == L'.' && ( name[1] == L'\0' ||
+        ( name[1] == L'.' && name[2] == L'\0' ) ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineNewer
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: __int64 * at : a parent's mtime, others may be at it
+//    Param.    2: __int64 t    : a subfolder's
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: keep the newer of the two, atomically
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineNewer ( __int64 * at, __int64 t )
+/*--------------------------------------------------------------------------*/
+{
+    __int64 cur, seen;
+
+    for ( cur = *at; t > cur; cur = seen )
+    {
+        seen = InterlockedCompareExchange64 ( at, t, cur );
+
+        if ( seen == cur )
+            break;
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineRaise
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENGINE * eng   : engine, breadth first
+//    Param.    2: UINT node      : folder just enumerated
+//    Param.    3: __int64 bytes  : what was found in it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: add it to every parent up to the root, atomically. A
+//                 level by level walk finishes nothing until the deep
+//                 folders are done, so this is how a folder's size gets
+//                 anywhere before that: each one only ever grows, and is
+//                 the whole once the folder is final, with no rollup.
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineRaise ( ENGINE * eng, UINT node, __int64 bytes )
+/*--------------------------------------------------------------------------*/
+{
+    if ( bytes == 0 )
+        return;
+
+    for ( node = eng->parent[node]; node != ENG_NONE;
+            node = eng->parent[node] )
+        InterlockedExchangeAdd64 ( &eng->size[node], bytes );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineLevelDone
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: ENGINE * eng : engine, locked
+//    Param.    2: UINT node    : folder just enumerated, subfolders queued
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: count it out of its level, and move eng->levels past
+//                 every level with nothing waiting. A level can only be
+//                 empty once the one above it is: the folders in it are
+//                 queued before their parent is counted out. Returns the
+//                 new levels for on_round, 0 if unchanged, not breadth
+//                 first, or the walk is over anyway.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT EngineLevelDone ( ENGINE * eng, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    UINT levels;
+
+    eng->waiting[eng->depth[node]]--;
+
+    for ( levels = eng->levels; levels < eng->max_depth &&
+            eng->waiting[levels] == 0; levels++ )
+        ;
+
+    if ( levels == eng->levels )
+        return 0;
+
+    eng->levels = levels;
+
+    return ( eng->breadth && !eng->done ) ? levels : 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineHeavier
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: const ENGINE * eng : engine, heaviest first
+//    Param.    2: UINT a             : queued folder
+//    Param.    3: UINT b             : another
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: should a be walked before b. Ties go to the newer node,
+//                 deeper most of the time, so a tree with nothing to go
+//                 by is still walked about depth first.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL EngineHeavier ( const ENGINE * eng, UINT a, UINT b )
+/*--------------------------------------------------------------------------*/
+{
+    if ( (UINT)eng->pending[a] != (UINT)eng->pending[b] )
+        return ( (UINT)eng->pending[a] > (UINT)eng->pending[b] );
+
+    return ( a > b );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineHeapPush
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENGINE * eng : engine, locked, heaviest first
+//    Param.    2: UINT node    : folder to queue, its weight in pending
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineHeapPush ( ENGINE * eng, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    UINT i, up;
+
+    for ( i = eng->qlen++; i != 0; i = up )
+    {
+        up = ( i - 1 ) / 2;
+
+        if ( !EngineHeavier ( eng, node, eng->queue[up] ) )
+            break;
+
+        eng->queue[i] = eng->queue[up];
+    }
+
+    eng->queue[i] = node;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineHeapPop
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: ENGINE * eng : engine, locked, heaviest first, qlen > 0
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: take the heaviest folder off the queue
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT EngineHeapPop ( ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    UINT top, last, i, c;
+
+    top     = eng->queue[0];
+    last    = eng->queue[--eng->qlen];
+
+    for ( i = 0; ( c = 2 * i + 1 ) < eng->qlen; i = c )
+    {
+        if ( c + 1 < eng->qlen &&
+                EngineHeavier ( eng, eng->queue[c+1], eng->queue[c] ) )
+            c++;
+
+        if ( !EngineHeavier ( eng, eng->queue[c], last ) )
+            break;
+
+        eng->queue[i] = eng->queue[c];
+    }
+
+    eng->queue[i] = last;
+
+    return top;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineThrottle
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENGINE * eng : engine
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: count a folder about to be opened and, with a --gentle
+//                 rate, wait for its token. Each caller moves the time the
+//                 next one is due by a token's worth (from now, if that's
+//                 past), without a lock; the one it took is good a
+//                 bucket's worth of tokens early. Sleeps in short bits,
+//                 so an abort doesn't have to wait for it.
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineThrottle ( ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    ENG_GENTLE      * g;
+    LARGE_INTEGER   li;
+    __int64         step, due, next, at, ms;
+    UINT            now;
+
+    g = &eng->gentle;
+
+    InterlockedIncrement64 ( &g->opened );
+
+    now = g->now;
+
+    if ( now == 0 )
+        return;
+
+    step = g->freq / now;
+
+    if ( step == 0 )
+        step = 1;
+
+    QueryPerformanceCounter ( &li );
+
+    do
+    {
+        due     = g->due;
+        next    = ( ( due > li.QuadPart ) ? due : li.QuadPart ) + step;
+    }
+    while ( InterlockedCompareExchange64 ( &g->due, next, due ) != due );
+
+    at = next - step * eng->threads;
+
+    while ( at > li.QuadPart && !eng->abort )
+    {
+        ms = ( at - li.QuadPart ) * 1000 / g->freq;
+        Sleep ( ( ms < 1 ) ? 1 : ( ms > 100 ) ? 100 : (DWORD)ms );
+        QueryPerformanceCounter ( &li );
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: EngineBackOff
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: ENGINE * eng   : engine, locked, with a --gentle rate
+//    Param.    2: __int64 took   : how long a folder took to open, ticks
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: move the rate by what the opens take: halved while they
+//                 are ENG_GENTLE_SLOW times slower than usual, up a 16th
+//                 of it otherwise, once every ENG_GENTLE_EVERY ms at
+//                 most. The first ENG_GENTLE_FIRST opens only show what's
+//                 usual. That doesn't take in the slow ones unless the
+//                 rate is as low as it goes, so a busy disk doesn't
+//                 become the norm but a slower part of the tree can.
+/*--------------------------------------------------------------------@@-@@-*/
+static void EngineBackOff ( ENGINE * eng, __int64 took )
+/*--------------------------------------------------------------------------*/
+{
+    ENG_GENTLE      * g;
+    LARGE_INTEGER   li;
+    UINT            now, least, step;
+    BOOL            slow;
+
+    g       = &eng->gentle;
+    least   = ( g->rate >= 16 ) ? g->rate / 16 : 1;
+    step    = least;
+
+    g->recent   = g->recent ? g->recent + ( took - g->recent ) / 8 : took;
+    slow        = ( g->opened > ENG_GENTLE_FIRST &&
+                    g->recent > g->usual * ENG_GENTLE_SLOW );
+
+    if ( !slow || g->now == least )
+        g->usual = g->usual ? g->usual + ( took - g->usual ) / 256 : took;
+
+    QueryPerformanceCounter ( &li );
+
+    if ( li.QuadPart - g->changed < g->freq * ENG_GENTLE_EVERY / 1000 )
+        return;
+
+    if ( slow )
+        now = ( g->now / 2 > least ) ? g->now / 2 : least;
+    else
+        now = ( g->now + step < g->rate ) ? g->now + step : g->rate;
+
+    if ( now == g->now )
+        return;
+
+    if ( now < g->now )
+        g->backoffs++;
+
+    if ( now < g->lowest )
+        g->lowest = now;
+
+    g->now      = now;
+    g->changed  = li.QuadPart;
+}
@@ -0,0 +1,263 @@
+
+// engine.h - parallel folder crawler shared by fsize and wfsize
+
+#ifndef _ENGINE_H
+#define _ENGINE_H
+
+#include <windows.h>
+#include "pattern.h"
+
+// address space reserved up front for the node columns and the names,
+// only what's used gets committed. Reserving keeps every column at a
+// fixed address, so readers never see it move under them.
+#ifdef _WIN64
+    #define ENG_MAX_NODES   (1U << 27)
+    #define ENG_MAX_CHARS   (1U << 31)
+#else
+    #define ENG_MAX_NODES   (1U << 21)
+    #define ENG_MAX_CHARS   (1U << 25)
+#endif
+
+#define ENG_COMMIT_NODES    65536       // nodes committed at a time
+#define ENG_COMMIT_CHARS    (1U << 20)  // name chars committed at a time
+
+#define ENG_MAX_THREADS     64
+#define ENG_MAX_ROOTS       256
+#define ENG_MAX_COLS        16
+#define ENG_MAX_PATH        1024        // longest path we walk, in chars
+#define ENG_MAX_DEPTH       (ENG_MAX_PATH/2)
+#define ENG_NONE            ((UINT)-1)
+
+// node flags
+#define ENG_FINAL           0x01    // size holds the whole subtree
+#define ENG_ERROR           0x02    // folder couldn't be opened
+#define ENG_TOP             0x04    // a root, its name is the full path
+#define ENG_ARCHIVE         0x08    // a .zip/.tar/.tar.gz or a folder in
+                                    // one, see eng->archives
+#define ENG_SPILLED         0x10    // subfolders moved out to the run
+                                    // file, first is the spill link
+#define ENG_FREE            0x20    // slot given back, see eng->spill
+
+// root state, see EngineRun
+#define ENG_ROOT_WALKED     0       // has its own tree
+#define ENG_ROOT_NESTED     1       // lives inside another root's tree
+#define ENG_ROOT_MISSING    2       // couldn't be opened at all
+
+// --gentle back-off, see EngineBackOff
+#define ENG_GENTLE_EVERY    100     // ms between rate changes, at most
+#define ENG_GENTLE_SLOW     2       // folders opening this many times
+                                    // slower than usual is contention
+#define ENG_GENTLE_FIRST    64      // opens it takes to know what's usual
+
+typedef struct _engine ENGINE;
+
+// called by the workers, from any thread:
+// - on_enter: just before a folder is enumerated
+// - on_subdir: a subfolder found in node, past the filter; FALSE leaves
+//   it out altogether (no node, not walked)
+// - on_file: for each file counted (after --exclude/--include)
+// - on_rollup: a final node is being added to its parent, without a
+//   lock; other subfolders of the same parent may be at it at the same
+//   time, so add atomically (merging per folder stats)
+// - on_final: a node and all below it are done, outside the lock.
+//   Children are always final before their parent.
+// - on_round: with eng->breadth, every folder less deep than levels
+//   has been enumerated; once per level, outside the lock
+// - on_weigh: with eng->longest, about how many folders walking a
+//   subfolder found in node will take (itself included, 0 if there's
+//   no telling); node is ENG_NONE for the roots, name their path then,
+//   before any worker starts. Outside the lock, none of node's
+//   subfolders has a node yet
+typedef struct _eng_hooks
+{
+    void        * ctx;
+    void        ( * on_enter )  ( void * ctx, UINT worker, UINT node );
+    BOOL        ( * on_subdir ) ( void * ctx, UINT node,
+                                    const WCHAR * name );
+    void        ( * on_file )   ( void * ctx, UINT worker, UINT node,
+                                    const WCHAR * dir,
+                                    const WIN32_FIND_DATAW * fd );
+    void        ( * on_rollup ) ( void * ctx, UINT node, UINT parent );
+    void        ( * on_final )  ( void * ctx, UINT node );
+    void        ( * on_round )  ( void * ctx, UINT levels );
+    UINT        ( * on_weigh )  ( void * ctx, UINT worker, UINT node,
+                                    const WCHAR * name );
+} ENG_HOOKS;
+
+// node slots or name chars given back after a spill, for reuse. Bucket
+// b holds ranges 2^b to 2^(b+1)-1 long, as start << 32 | length.
+typedef struct _eng_ranges
+{
+    UINT64      * r[32];
+    UINT        n[32];
+    UINT        cap[32];
+} ENG_RANGES;
+
+// one column of the node table, for committing them all in one go
+typedef struct _eng_column
+{
+    BYTE        * base;
+    UINT        elem;       // element size, in bytes
+    BOOL        placed;     // lives in memory given by EnginePlace
+} ENG_COLUMN;
+
+// optional, --gentle: stay out of the way of everybody else's I/O.
+// Folder opens go through a token bucket (as GCRA: one time, when the
+// next token is due, moved on atomically by each open), rate tokens a
+// second, as many as there are workers at once after a pause. A slow
+// open is the disk being busy with somebody else's work: when opens
+// take ENG_GENTLE_SLOW times as long as they usually do, the rate is
+// halved, down to a 16th, and then creeps back a 16th at a time.
+typedef struct _eng_gentle
+{
+    BOOL        background; // workers in background mode, low I/O and
+                            // CPU priority
+    UINT        rate;       // folders opened a second at most, 0 for
+                            // no limit (and no back-off)
+    volatile UINT now;      // the rate, backed off
+    volatile LONG64 due;    // QueryPerformanceCounter time the next
+                            // open is due at
+    __int64     freq;       // QueryPerformanceFrequency
+    __int64     recent;     // open time, averaged over the last few
+    __int64     usual;      // and over a lot more, both in ticks
+    __int64     changed;    // when now last changed
+    UINT        backoffs;   // times it was halved
+    UINT        lowest;     // lowest it went
+    volatile LONG64 opened; // folders opened, for EngineRate
+    __int64     ticks;      // how long EngineRun took
+} ENG_GENTLE;
+
+typedef struct _eng_root
+{
+    WCHAR       * path;     // as given, no trailing backslash
+    WCHAR       * final;    // resolved, for nesting checks
+    DWORD       volume;     // volume serial number...
+    UINT64      fileid;     // ...and file index, identify the folder
+    UINT        state;      // ENG_ROOT_xxx
+    UINT        node;       // root node, if walked
+    UINT        inside;     // root it's nested in, if nested
+    UINT        rel;        // where the path below that root starts
+                            // in final[]
+    volatile LONG64 files;  // files and folders counted under it
+    volatile LONG64 dirs;
+} ENG_ROOT;
+
+// the crawler. Folders are nodes, kept as parallel arrays (columns)
+// indexed by node number; files are only counted. The subfolders of a
+// folder are always allocated together, so each node's children are
+// the range first .. first+nchild-1.
+struct _engine
+{
+    UINT        * parent;   // ENG_NONE for roots
+    UINT        * first;    // first subfolder
+    UINT        * nchild;   // how many subfolders
+    UINT        * name;     // offset of the NUL terminated name
+    USHORT      * nlen;     // name length, in chars
+    USHORT      * depth;    // 0 for roots
+    BYTE        * flags;    // ENG_xxx
+    __int64     * own;      // bytes of the files right inside
+    __int64     * size;     // own plus all below, once ENG_FINAL
+    UINT        * files;    // files right inside
+    __int64     * mtime;    // newest file write time (FILETIME) of
+                            // all below, once ENG_FINAL; 0 if none
+    __int64     * tfiles;   // files right inside and all below, and
+    UINT        * tdirs;    // folders below, both once ENG_FINAL
+    LONG        * pending;  // subfolders not final yet, atomic; with
+                            // longest, its weight while it's queued
+    BYTE        * extra;    // extra_size bytes per node, for the hooks
+    UINT        extra_size;
+    BOOL        age;        // extra starts with an AGE_HIST (--age), which
+                            // snapshots and exports keep
+
+    ENG_COLUMN  cols[ENG_MAX_COLS];
+    UINT        ncols;
+
+    volatile UINT count;    // nodes in use
+    UINT        committed;  // nodes committed
+    UINT        live;       // count, less the slots given back
+    UINT64      live_chars; // names of those, NULs included
+
+    WCHAR       * names;    // name arena
+    UINT        names_len;
+    UINT        names_committed;
+    BOOL        names_placed;
+
+    // optional, count is stored here (a full barrier) after each batch
+    // of new nodes, for readers that don't take the lock. Nodes below
+    // it have parent, name, nlen and depth set for good; size and
+    // files are there once flags has ENG_FINAL.
+    volatile LONG * publish;
+
+    UINT        * queue;    // folders waiting for a worker, LIFO, or
+    UINT        qhead;      // with breadth FIFO from qhead, or with
+    UINT        qlen;       // longest a heap, heaviest on top (a
+                            // folder is only ever queued once)
+    UINT        busy;       // workers holding a folder
+    HANDLE      hSem;       // one count per queued folder
+    BOOL        done;
+
+    ENG_ROOT    roots[ENG_MAX_ROOTS];
+    UINT        nroots;
+
+    CRITICAL_SECTION lock;  // queue and allocation
+    UINT        threads;
+    UINT        max_depth;  // folders this deep are not opened
+    const PAT_FILTER * filter; // optional --exclude/--include
+    BOOL        archives;   // walk into archives as if they were folders
+
+    // optional, walk level by level: every folder at one depth is
+    // enumerated before any deeper one, and a folder's size goes up to
+    // all its parents as soon as it's enumerated, so a size not final
+    // yet is what's been found below so far, a lower bound that only
+    // grows. Not with spill, which takes finished subtrees away.
+    BOOL        breadth;
+    UINT        waiting[ENG_MAX_DEPTH+1];   // queued or being enumerated,
+                                            // per depth
+    volatile UINT levels;   // depths done, see on_round
+
+    // optional, heaviest first: the folders that will take the longest
+    // to walk, by hooks.on_weigh (say, from the last walk's folder
+    // counts), are handed out first, so one big subtree found late
+    // doesn't keep a single worker busy while the rest sit idle. Same
+    // weight, the newest folder first, as without it. Not with breadth.
+    BOOL        longest;
+
+    ENG_GENTLE  gentle;     // optional, set background and rate
+
+    // optional, --mem-limit (see spill.h). Over the limit, finished
+    // subtrees go out to a run file and their slots are reused; nodes
+    // then come and go, readers have to wait for the walk to end.
+    struct _spill * spill;
+    ENG_RANGES  free_nodes;
+    ENG_RANGES  free_chars;
+    volatile LONG finals;   // workers between finishing nodes and
+                            // their on_final calls
+    ENG_HOOKS   hooks;
+
+    volatile LONG64 idle;   // QueryPerformanceCounter ticks the
+                            // workers spent waiting for a folder
+    volatile LONG   abort;
+    volatile LONG64 total_files;
+    volatile LONG64 total_dirs;
+};
+
+BOOL    EngineInit      ( ENGINE * eng, UINT threads, UINT max_depth,
+                            UINT extra_size );
+void    EngineFree      ( ENGINE * eng );
+int     EngineAddRoot   ( ENGINE * eng, const WCHAR * path );
+BOOL    EngineRun       ( ENGINE * eng );
+void    EngineAbort     ( ENGINE * eng );
+BOOL    EnginePlace     ( ENGINE * eng, void * pcol, void * at );
+UINT    EngineAddNode   ( ENGINE * eng, UINT parent, const WCHAR * name,
+                            UINT len );
+
+UINT    EnginePath      ( const ENGINE * eng, UINT node, WCHAR * buf,
+                            UINT cch );
+UINT    EngineFindChild ( const ENGINE * eng, UINT node,
+                            const WCHAR * name, UINT len );
+UINT    EngineRootNode  ( const ENGINE * eng, UINT root );
+UINT    EngineRootOf    ( const ENGINE * eng, UINT node );
+void    * EngineExtra   ( const ENGINE * eng, UINT node );
+UINT    EngineRate      ( const ENGINE * eng );
+
+#endif // _ENGINE_H
@@ -0,0 +1,502 @@
+
+// export.c - writing an engine's folders out to a text file, UTF-8
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "export.h"
+#include "agehist.h"
+#include "utf8.h"
+#include <windows.h>
+#include <process.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+// one row can't take more than this, whatever the path
+#define EXPORT_ROW_MAX      ( UTF8_MAX(ENG_MAX_PATH) + 512 )
+
+// one export, shared by the workers
+typedef struct _export_job
+{
+    const ENGINE    * eng;
+    const UINT      * nodes;    // NULL for node order
+    UINT            count;
+    EXPORT_COLS     cols;
+    UINT            format;     // EXPORT_xxx
+    UINT            nchunks;
+    HANDLE          hFile;
+    LONG            next;       // next chunk to format
+    LONG volatile   turn;       // chunk whose offset is next to give out
+    __int64         offset;     // where that chunk goes in the file
+    LONG volatile   ok;         // cleared by any failure
+} EXPORT_JOB;
+
+static UINT __stdcall   ExportWorker    ( void * param );
+static BOOL             ExportChunk     ( EXPORT_JOB * job, UINT k,
+                                            WCHAR * path, char ** buf,
+                                            UINT_PTR * cap, UINT_PTR * used );
+static UINT_PTR         ExportRow       ( const EXPORT_JOB * job,
+                                            UINT node, WCHAR * path,
+                                            char * out );
+static char             * ExportText    ( char * p, const char * s );
+static char             * ExportNumber  ( char * p, UINT64 v );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExportFile
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const ENGINE * eng       : finished walk or snapshot
+//    Param.    2: const UINT * nodes       : folders to write, or NULL
+//                                            for the first count ones in
+//                                            node order
+//    Param.    3: UINT count               : how many
+//    Param.    4: const EXPORT_COLS * cols : columns over or beside the
+//                                            engine's, may be NULL
+//    Param.    5: UINT format              : EXPORT_xxx
+//    Param.    6: UINT threads             : workers, 0 for one per CPU,
+//                                            1 to do it all right here
+//    Param.    7: const WCHAR * fname      : file to (over)write
+//    Param.    8: UINT64 * bytes           : receives its size, may be
+//                                            NULL
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one row per folder, UTF-8; CSV and TSV start with a
+//                 byte order mark so a spreadsheet doesn't take them for
+//                 the ANSI code page. With eng->age (a snapshot of an
+//                 --age walk) the bytes in each age bucket follow, by
+//                 last write and by last access. The rows are cut in
+//                 chunks of EXPORT_CHUNK and every worker formats whole
+//                 chunks into its own buffer (no printf, the path
+//                 transcoded in place, see utf8.c). A formatted chunk's
+//                 place in the file is where the one before it ends, so
+//                 chunks take their offsets in order, each as soon as
+//                 the one before has its size, and are written there
+//                 without waiting for anything else. The file is the same whatever the
+//                 number of workers.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ExportFile ( const ENGINE * eng, const UINT * nodes, UINT count,
+    const EXPORT_COLS * cols, UINT format, UINT threads,
+    const WCHAR * fname, UINT64 * bytes )
+/*--------------------------------------------------------------------------*/
+{
+    static const char * const hdr[] =
+    {
+        "\xEF\xBB\xBF\"Folder\",\"Bytes\",\"Own bytes\",\"Files\","
+            "\"All files\",\"All folders\"",
+        "\xEF\xBB\xBF" "Folder\tBytes\tOwn bytes\tFiles\tAll files\t"
+            "All folders",
+        ""
+    };
+
+    // the buckets, as gAgeDays has them
+    static const char * const agehdr[] =
+    {
+        ",\"Written <30d\",\"Written 30-90d\",\"Written 90d-1y\","
+            "\"Written >1y\",\"Accessed <30d\",\"Accessed 30-90d\","
+            "\"Accessed 90d-1y\",\"Accessed >1y\"",
+        "\tWritten <30d\tWritten 30-90d\tWritten 90d-1y\tWritten >1y\t"
+            "Accessed <30d\tAccessed 30-90d\tAccessed 90d-1y\t"
+            "Accessed >1y",
+        ""
+    };
+
+    EXPORT_JOB  job;
+    SYSTEM_INFO si;
+    HANDLE      th[EXPORT_MAX_THREADS];
+    char        head[512], * p;
+    DWORD       written, len;
+    UINT        i, n;
+
+    if ( bytes != NULL )
+        *bytes = 0;
+
+    if ( eng == NULL || fname == NULL || format > EXPORT_JSON ||
+        ( nodes == NULL && count > eng->count ) )
+        return FALSE;
+
+    RtlZeroMemory ( &job, sizeof ( job ) );
+
+    job.eng     = eng;
+    job.nodes   = nodes;
+    job.count   = count;
+    job.format  = format;
+
+    if ( cols != NULL )
+        job.cols = *cols;
+    job.nchunks = ( count + EXPORT_CHUNK - 1 ) / EXPORT_CHUNK;
+    job.ok      = TRUE;
+
+    job.hFile = CreateFileW ( fname, GENERIC_WRITE, FILE_SHARE_READ, NULL,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+
+    if ( job.hFile == INVALID_HANDLE_VALUE )
+        return FALSE;
+
+    p = head;
+
+    if ( format != EXPORT_JSON )
+    {
+        p = ExportText ( p, hdr[format] );
+
+        if ( eng->age )
+            p = ExportText ( p, agehdr[format] );
+
+        p = ExportText ( p, "\r\n" );
+    }
+
+    len         = (DWORD)( p - head );
+    job.offset  = len;
+
+    if ( len != 0 && ( !WriteFile ( job.hFile, head, len, &written,
+            NULL ) || written != len ) )
+        job.ok = FALSE;
+
+    if ( threads == 0 )
+    {
+        GetSystemInfo ( &si );
+        threads = si.dwNumberOfProcessors;
+    }
+
+    if ( threads > EXPORT_MAX_THREADS )
+        threads = EXPORT_MAX_THREADS;
+
+    if ( threads > job.nchunks )
+        threads = job.nchunks;
+
+    n = 0;
+
+    if ( threads > 1 )
+        for ( i = 0; i < threads; i++ )
+        {
+            th[n] = (HANDLE)_beginthreadex ( NULL, 0, ExportWorker, &job,
+                0, NULL );
+
+            if ( th[n] != NULL )
+                n++;
+        }
+
+    if ( n == 0 )
+        ExportWorker ( &job );
+    else
+    {
+        WaitForMultipleObjects ( n, th, TRUE, INFINITE );
+
+        for ( i = 0; i < n; i++ )
+            CloseHandle ( th[i] );
+    }
+
+    // a worker that couldn't start its buffers took no chunk
+    if ( (UINT)job.turn != job.nchunks )
+        job.ok = FALSE;
+
+    CloseHandle ( job.hFile );
+
+    if ( !job.ok )
+        DeleteFileW ( fname );
+    else if ( bytes != NULL )
+        *bytes = (UINT64)job.offset;
+
+    return job.ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExportFormat
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const WCHAR * fname : file to export to
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: EXPORT_xxx by its extension: .tsv and .txt are TSV,
+//                 .json, .jsonl and .ndjson JSON lines, anything else CSV
+/*--------------------------------------------------------------------@@-@@-*/
+UINT ExportFormat ( const WCHAR * fname )
+/*--------------------------------------------------------------------------*/
+{
+    const WCHAR * ext;
+
+    ext = ( fname != NULL ) ? wcsrchr ( fname, L'.' ) : NULL;
+
+    if ( ext == NULL )
+        return EXPORT_CSV;
+
+    if ( lstrcmpiW ( ext, L".tsv" ) == 0 || lstrcmpiW ( ext, L".txt" ) == 0 )
+        return EXPORT_TSV;
+
+    if ( lstrcmpiW ( ext, L".json" ) == 0 ||
+        lstrcmpiW ( ext, L".jsonl" ) == 0 ||
+        lstrcmpiW ( ext, L".ndjson" ) == 0 )
+        return EXPORT_JSON;
+
+    return EXPORT_CSV;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExportWorker
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT __stdcall
+//    Param.    1: void * param : EXPORT_JOB
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: thread function for _beginthreadex. Takes chunks off
+//                 the shared counter, formats one, waits for the chunk
+//                 before it to have taken its offset (it's being
+//                 formatted by another worker right now, so not for
+//                 long), takes the next one and writes the chunk there.
+//                 A chunk that failed still takes its turn, so nobody
+//                 waits forever, and clears job->ok.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT __stdcall ExportWorker ( void * param )
+/*--------------------------------------------------------------------------*/
+{
+    EXPORT_JOB  * job;
+    OVERLAPPED  ov;
+    WCHAR       * path;
+    char        * buf;
+    UINT_PTR    cap, used;
+    __int64     off;
+    DWORD       written;
+    UINT        k;
+    BOOL        ok;
+
+    job     = (EXPORT_JOB *)param;
+    cap     = EXPORT_BUF;
+    buf     = malloc ( cap );
+    path    = malloc ( ENG_MAX_PATH * sizeof ( WCHAR ) );
+
+    if ( buf == NULL || path == NULL )
+    {
+        free ( buf );
+        free ( path );
+        return FALSE;
+    }
+
+    while ( ( k = (UINT)( InterlockedIncrement ( &job->next ) - 1 ) )
+            < job->nchunks )
+    {
+        ok = job->ok && ExportChunk ( job, k, path, &buf, &cap, &used );
+
+        while ( job->turn != (LONG)k )
+            SwitchToThread ( );
+
+        off         = job->offset;
+        job->offset += ok ? used : 0;
+
+        InterlockedExchange ( &job->turn, k + 1 );
+
+        if ( ok )
+        {
+            RtlZeroMemory ( &ov, sizeof ( ov ) );
+
+            ov.Offset       = (DWORD)off;
+            ov.OffsetHigh   = (DWORD)( off >> 32 );
+
+            ok = WriteFile ( job->hFile, buf, (DWORD)used, &written, &ov ) &&
+                written == used;
+        }
+
+        if ( !ok )
+            InterlockedExchange ( &job->ok, FALSE );
+    }
+
+    free ( buf );
+    free ( path );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExportChunk
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: EXPORT_JOB * job : export
+//    Param.    2: UINT k           : chunk to format
+//    Param.    3: WCHAR * path     : scratch, ENG_MAX_PATH chars
+//    Param.    4: char ** buf      : the worker's buffer, grown if needed
+//    Param.    5: UINT_PTR * cap   : its size
+//    Param.    6: UINT_PTR * used  : receives the chunk's length
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: FALSE if out of memory
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ExportChunk ( EXPORT_JOB * job, UINT k, WCHAR * path,
+    char ** buf, UINT_PTR * cap, UINT_PTR * used )
+/*--------------------------------------------------------------------------*/
+{
+    char    * tmp;
+    UINT    i, end;
+
+    i       = k * EXPORT_CHUNK;
+    end     = ( job->count - i > EXPORT_CHUNK ) ? i + EXPORT_CHUNK :
+        job->count;
+    *used   = 0;
+
+    for ( ; i < end; i++ )
+    {
+        if ( *cap - *used < EXPORT_ROW_MAX )
+        {
+            tmp = realloc ( *buf, *cap * 2 );
+
+            if ( tmp == NULL )
+                return FALSE;
+
+            *buf    = tmp;
+            *cap    *= 2;
+        }
+
+        *used += ExportRow ( job, ( job->nodes != NULL ) ?
+            job->nodes[i] : i, path, *buf + *used );
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExportRow
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT_PTR
+//    Param.    1: const EXPORT_JOB * job : export
+//    Param.    2: UINT node              : folder to write
+//    Param.    3: WCHAR * path           : scratch, ENG_MAX_PATH chars
+//    Param.    4: char * out             : receives the row,
+//                                          EXPORT_ROW_MAX bytes at most
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: returns the bytes the row took
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT_PTR ExportRow ( const EXPORT_JOB * job, UINT node,
+    WCHAR * path, char * out )
+/*--------------------------------------------------------------------------*/
+{
+    // what goes before the path, then before each number, then at the
+    // end, per format
+    static const char * const sep[][7] =
+    {
+        { "\"", "\",", ",", ",", ",", ",", "\r\n" },
+        { "", "\t", "\t", "\t", "\t", "\t", "\r\n" },
+        { "{\"folder\":\"", "\",\"bytes\":", ",\"own\":", ",\"files\":",
+            ",\"all_files\":", ",\"all_folders\":", "}\n" }
+    };
+
+    // and for the age buckets: before the first by last write, between
+    // two, before the first by last access, after the last
+    static const char * const agesep[][4] =
+    {
+        { ",", ",", ",", "" },
+        { "\t", "\t", "\t", "" },
+        { ",\"written\":[", ",", "],\"accessed\":[", "]" }
+    };
+
+    static const UINT mode[] = { UTF8_CSV, UTF8_TSV, UTF8_JSON };
+
+    const ENGINE        * eng;
+    const AGE_HIST      * ah;
+    const char * const  * s;
+    char                * p;
+    __int64             size;
+    UINT                len, b;
+
+    eng     = job->eng;
+    s       = sep[job->format];
+    size    = eng->size[node];
+
+    if ( job->cols.fresh != NULL && job->cols.fresh[node] >= 0 )
+        size = job->cols.fresh[node];
+
+    len = EnginePath ( eng, node, path, ENG_MAX_PATH );
+
+    p   = ExportText ( out, s[0] );
+    p   += Utf8Encode ( path, len, p, mode[job->format] );
+    p   = ExportText ( p, s[1] );
+    p   = ExportNumber ( p, (UINT64)size );
+    p   = ExportText ( p, s[2] );
+    p   = ExportNumber ( p, (UINT64)eng->own[node] );
+    p   = ExportText ( p, s[3] );
+    p   = ExportNumber ( p, eng->files[node] );
+    p   = ExportText ( p, s[4] );
+    p   = ExportNumber ( p, (UINT64)eng->tfiles[node] );
+    p   = ExportText ( p, s[5] );
+    p   = ExportNumber ( p, eng->tdirs[node] );
+
+    if ( eng->age )
+    {
+        ah  = (const AGE_HIST *)( eng->extra + (UINT_PTR)node *
+                eng->extra_size );
+        p   = ExportText ( p, agesep[job->format][0] );
+
+        for ( b = 0; b < AGE_BUCKETS; b++ )
+        {
+            p   = ExportText ( p, b ? agesep[job->format][1] : "" );
+            p   = ExportNumber ( p, (UINT64)ah->mbytes[b] );
+        }
+
+        p   = ExportText ( p, agesep[job->format][2] );
+
+        for ( b = 0; b < AGE_BUCKETS; b++ )
+        {
+            p   = ExportText ( p, b ? agesep[job->format][1] : "" );
+            p   = ExportNumber ( p, (UINT64)ah->abytes[b] );
+        }
+
+        p   = ExportText ( p, agesep[job->format][3] );
+    }
+
+    p   = ExportText ( p, s[6] );
+
+    return (UINT_PTR)( p - out );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExportText
+/*--------------------------------------------------------------------------*/
+//           Type: static char *
+//    Param.    1: char * p       : where it goes
+//    Param.    2: const char * s : 0 ended
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: copy without the 0, returns the end
+/*--------------------------------------------------------------------@@-@@-*/
+static char * ExportText ( char * p, const char * s )
+/*--------------------------------------------------------------------------*/
+{
+    while ( *s != '\0' )
+        *p++ = *s++;
+
+    return p;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExportNumber
+/*--------------------------------------------------------------------------*/
+//           Type: static char *
+//    Param.    1: char * p : where the digits go
+//    Param.    2: UINT64 v : number
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: decimal, returns the end
+/*--------------------------------------------------------------------@@-@@-*/
+static char * ExportNumber ( char * p, UINT64 v )
+/*--------------------------------------------------------------------------*/
+{
+    char    tmp[20];
+    UINT    n;
+
+    n = 0;
+
+    do
+    {
+        tmp[n++]    = (char)( '0' + v % 10 );
+        v           /= 10;
+    }
+    while ( v != 0 );
+
+    while ( n != 0 )
+        *p++ = tmp[--n];
+
+    return p;
+}
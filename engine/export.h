@@ -0,0 +1,34 @@
+
+// export.h - writing an engine's folders out to a text file, UTF-8
+
+#ifndef _EXPORT_H
+#define _EXPORT_H
+
+#include <windows.h>
+#include "engine.h"
+
+// formats
+#define EXPORT_CSV          0       // "path",bytes,own,files,... with a
+                                    // header line, for a spreadsheet
+#define EXPORT_TSV          1       // the same, tab separated, unquoted
+#define EXPORT_JSON         2       // JSON lines, an object per folder
+
+#define EXPORT_CHUNK        8192    // rows a worker formats at a time
+#define EXPORT_BUF          (1U << 20)  // a worker's buffer to start with
+#define EXPORT_MAX_THREADS  64
+
+// what to write other than the engine's own columns, all optional
+typedef struct _export_cols
+{
+    const __int64   * fresh;    // sizes to write instead of eng->size,
+                                // where not negative: a snapshot on
+                                // screen with the new walk's sizes
+} EXPORT_COLS;
+
+BOOL    ExportFile      ( const ENGINE * eng, const UINT * nodes,
+                            UINT count, const EXPORT_COLS * cols,
+                            UINT format, UINT threads,
+                            const WCHAR * fname, UINT64 * bytes );
+UINT    ExportFormat    ( const WCHAR * fname );
+
+#endif // _EXPORT_H
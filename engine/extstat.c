@@ -0,0 +1,383 @@
+
+// extstat.c - per-extension size histogram (--by-ext)
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "extstat.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <wctype.h>
+
+static EXT_ENTRY    * ExtFind   ( EXT_TABLE * et, const WCHAR * ext,
+                                    UINT len, UINT hash );
+static BOOL         ExtGrow     ( EXT_TABLE * et );
+static int          ExtCompare  ( const void * a, const void * b );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExtTableInit
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: EXT_TABLE * et : table to set up
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: allocate slots and name arena. Returns FALSE if out of
+//                 memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ExtTableInit ( EXT_TABLE * et )
+/*--------------------------------------------------------------------------*/
+{
+    if ( et == NULL )
+        return FALSE;
+
+    RtlZeroMemory ( et, sizeof ( EXT_TABLE ) );
+
+    et->nslots      = EXT_DEFAULT_SLOTS;
+    et->arena_cap   = EXT_DEFAULT_SLOTS * 8;
+    et->slots       = calloc ( et->nslots, sizeof ( EXT_ENTRY ) );
+    et->arena       = malloc ( et->arena_cap * sizeof ( WCHAR ) );
+
+    if ( et->slots == NULL || et->arena == NULL )
+    {
+        ExtTableFree ( et );
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExtTableFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: EXT_TABLE * et : table to release
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void ExtTableFree ( EXT_TABLE * et )
+/*--------------------------------------------------------------------------*/
+{
+    if ( et == NULL )
+        return;
+
+    free ( et->slots );
+    free ( et->arena );
+
+    RtlZeroMemory ( et, sizeof ( EXT_TABLE ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExtTableAdd
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: EXT_TABLE * et       : table
+//    Param.    2: const WCHAR * fname  : file name, straight from the
+//                                        enumeration buffer
+//    Param.    3: __int64 size         : file size
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: account a file. The extension is picked and lowercased
+//                 right from fname into a small stack buffer, so nothing
+//                 gets allocated unless it's an extension we never saw.
+//                 A leading dot (".profile") is not an extension.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ExtTableAdd ( EXT_TABLE * et, const WCHAR * fname, __int64 size )
+/*--------------------------------------------------------------------------*/
+{
+    const WCHAR     * p, * dot;
+    WCHAR           ext[EXT_MAX_LEN+1];
+    UINT            len, hash;
+    EXT_ENTRY       * ee;
+
+    if ( et == NULL || fname == NULL || et->slots == NULL )
+        return FALSE;
+
+    dot = NULL;
+
+    for ( p = fname; *p; p++ )
+        if ( *p == L'.' )
+            dot = p;
+
+    len     = 0;
+    hash    = 2166136261u; // FNV-1a
+
+    if ( dot != NULL && dot != fname && ( p - dot - 1 ) <= EXT_MAX_LEN )
+    {
+        for ( p = dot + 1; *p; p++ )
+        {
+            ext[len] = ( *p < 128 ) ?
+                ( ( *p >= L'A' && *p <= L'Z' ) ? *p + 32 : *p ) :
+                    (WCHAR)towlower ( *p );
+
+            hash = ( hash ^ ext[len] ) * 16777619u;
+            len++;
+        }
+    }
+
+    ext[len] = L'\0';
+
+    if ( hash == 0 )
+        hash = 1;
+
+    ee = ExtFind ( et, ext, len, hash );
+
+    if ( ee == NULL )
+        return FALSE;
+
+    ee->bytes   += size;
+    ee->files   += 1;
+    et->bytes   += size;
+    et->files   += 1;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExtTableMerge
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: EXT_TABLE * dst       : table to merge into
+//    Param.    2: const EXT_TABLE * src : table to merge from
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: add all of src's counters to dst, e.g. a subfolder's (or
+//                 a worker's) table into the root one
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ExtTableMerge ( EXT_TABLE * dst, const EXT_TABLE * src )
+/*--------------------------------------------------------------------------*/
+{
+    UINT        i;
+    EXT_ENTRY   * se, * de;
+
+    if ( dst == NULL || src == NULL || src->slots == NULL )
+        return FALSE;
+
+    for ( i = 0; i < src->nslots; i++ )
+    {
+        se = &src->slots[i];
+
+        if ( se->hash == 0 )
+            continue;
+
+        de = ExtFind ( dst, src->arena + se->name, se->len, se->hash );
+
+        if ( de == NULL )
+            return FALSE;
+
+        de->bytes += se->bytes;
+        de->files += se->files;
+    }
+
+    dst->bytes += src->bytes;
+    dst->files += src->files;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExtTableSorted
+/*--------------------------------------------------------------------------*/
+//           Type: EXT_ENTRY *
+//    Param.    1: const EXT_TABLE * et : table
+//    Param.    2: UINT * count         : receives the number of entries
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: returns a copy of the used entries, biggest first, for
+//                 reporting. Free it with free(). NULL if empty or out of
+//                 memory.
+/*--------------------------------------------------------------------@@-@@-*/
+EXT_ENTRY * ExtTableSorted ( const EXT_TABLE * et, UINT * count )
+/*--------------------------------------------------------------------------*/
+{
+    EXT_ENTRY   * out;
+    UINT        i, n;
+
+    if ( count != NULL )
+        *count = 0;
+
+    if ( et == NULL || count == NULL || et->count == 0 )
+        return NULL;
+
+    out = malloc ( et->count * sizeof ( EXT_ENTRY ) );
+
+    if ( out == NULL )
+        return NULL;
+
+    for ( i = 0, n = 0; i < et->nslots; i++ )
+        if ( et->slots[i].hash != 0 )
+            out[n++] = et->slots[i];
+
+    qsort ( out, n, sizeof ( EXT_ENTRY ), ExtCompare );
+
+    *count = n;
+
+    return out;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExtEntryName
+/*--------------------------------------------------------------------------*/
+//           Type: const WCHAR *
+//    Param.    1: const EXT_TABLE * et : table the entry came from
+//    Param.    2: const EXT_ENTRY * ee : entry
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the interned extension, "" for files without one
+/*--------------------------------------------------------------------@@-@@-*/
+const WCHAR * ExtEntryName ( const EXT_TABLE * et, const EXT_ENTRY * ee )
+/*--------------------------------------------------------------------------*/
+{
+    if ( et == NULL || ee == NULL )
+        return L"";
+
+    return et->arena + ee->name;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExtFind
+/*--------------------------------------------------------------------------*/
+//           Type: static EXT_ENTRY *
+//    Param.    1: EXT_TABLE * et    : table
+//    Param.    2: const WCHAR * ext : lowercase extension
+//    Param.    3: UINT len          : its length
+//    Param.    4: UINT hash         : its hash (never 0)
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: linear probing lookup; interns the extension and takes
+//                 a new slot if it's not there yet. Keeps the load factor
+//                 under 3/4. NULL if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+static EXT_ENTRY * ExtFind ( EXT_TABLE * et, const WCHAR * ext,
+    UINT len, UINT hash )
+/*--------------------------------------------------------------------------*/
+{
+    UINT        i, mask;
+    EXT_ENTRY   * ee;
+    WCHAR       * tmp;
+
+    mask = et->nslots - 1;
+
+    for ( i = hash & mask; ; i = ( i + 1 ) & mask )
+    {
+        ee = &et->slots[i];
+
+        if ( ee->hash == 0 )
+            break;
+
+        if ( ee->hash == hash && ee->len == len &&
+                wmemcmp ( et->arena + ee->name, ext, len ) == 0 )
+            return ee;
+    }
+
+    // new one, make room first if needed and look for a free slot again
+    if ( ( et->count + 1 ) * 4 > et->nslots * 3 )
+    {
+        if ( !ExtGrow ( et ) )
+            return NULL;
+
+        return ExtFind ( et, ext, len, hash );
+    }
+
+    if ( et->arena_len + len + 1 > et->arena_cap )
+    {
+        tmp = realloc ( et->arena,
+            ( et->arena_cap * 2 + len + 1 ) * sizeof ( WCHAR ) );
+
+        if ( tmp == NULL )
+            return NULL;
+
+        et->arena       = tmp;
+        et->arena_cap   = et->arena_cap * 2 + len + 1;
+    }
+
+    wmemcpy ( et->arena + et->arena_len, ext, len );
+    et->arena[et->arena_len + len] = L'\0';
+
+    ee->hash    = hash;
+    ee->name    = et->arena_len;
+    ee->len     = len;
+    ee->bytes   = 0;
+    ee->files   = 0;
+
+    et->arena_len += len + 1;
+    et->count++;
+
+    return ee;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExtGrow
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: EXT_TABLE * et : table
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: double the slots and rehash. Names stay where they are.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ExtGrow ( EXT_TABLE * et )
+/*--------------------------------------------------------------------------*/
+{
+    EXT_ENTRY   * nslots;
+    UINT        i, j, mask;
+
+    nslots = calloc ( et->nslots * 2, sizeof ( EXT_ENTRY ) );
+
+    if ( nslots == NULL )
+        return FALSE;
+
+    mask = et->nslots * 2 - 1;
+
+    for ( i = 0; i < et->nslots; i++ )
+    {
+        if ( et->slots[i].hash == 0 )
+            continue;
+
+        for ( j = et->slots[i].hash & mask; nslots[j].hash != 0;
+                j = ( j + 1 ) & mask )
+            ;
+
+        nslots[j] = et->slots[i];
+    }
+
+    free ( et->slots );
+
+    et->slots   = nslots;
+    et->nslots *= 2;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ExtCompare
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const void * a : EXT_ENTRY
+//    Param.    2: const void * b : EXT_ENTRY
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, biggest first
+/*--------------------------------------------------------------------@@-@@-*/
+static int ExtCompare ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    __int64 i1, i2;
+
+    i1 = ((const EXT_ENTRY *)a)->bytes;
+    i2 = ((const EXT_ENTRY *)b)->bytes;
+
+    if ( i1 < i2 )
+        return 1;
+
+    if ( i1 > i2 )
+        return -1;
+
+    return 0;
+}
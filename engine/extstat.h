@@ -0,0 +1,48 @@
+
+// extstat.h - per-extension size histogram (--by-ext)
+
+#ifndef _EXTSTAT_H
+#define _EXTSTAT_H
+
+#include <windows.h>
+
+// longer "extensions" are not really extensions, count them as none
+#define EXT_MAX_LEN         16
+
+// initial number of slots, must be a power of 2
+#define EXT_DEFAULT_SLOTS   256
+
+// one extension, name is interned in the table's arena
+typedef struct _ext_entry
+{
+    UINT        hash;       // 0 marks a free slot
+    UINT        name;       // offset of the lowercase ext in the arena
+    UINT        len;        // ext length, in chars (0 = no extension)
+    __int64     bytes;      // total size of files with this ext
+    UINT_PTR    files;      // how many of them
+} EXT_ENTRY;
+
+// open addressing hash table, keyed by the lowercase extension. Meant
+// to be owned by a single walker (one per thread) and merged at the end.
+typedef struct _ext_table
+{
+    EXT_ENTRY   * slots;
+    UINT        nslots;     // always a power of 2
+    UINT        count;      // slots in use
+    WCHAR       * arena;    // interned names, each one NUL terminated
+    UINT        arena_len;
+    UINT        arena_cap;
+    __int64     bytes;      // grand totals, for percentages
+    UINT_PTR    files;
+} EXT_TABLE;
+
+BOOL        ExtTableInit    ( EXT_TABLE * et );
+void        ExtTableFree    ( EXT_TABLE * et );
+BOOL        ExtTableAdd     ( EXT_TABLE * et, const WCHAR * fname,
+                                __int64 size );
+BOOL        ExtTableMerge   ( EXT_TABLE * dst, const EXT_TABLE * src );
+EXT_ENTRY   * ExtTableSorted ( const EXT_TABLE * et, UINT * count );
+
+const WCHAR * ExtEntryName  ( const EXT_TABLE * et, const EXT_ENTRY * ee );
+
+#endif // _EXTSTAT_H
@@ -0,0 +1,903 @@
+
+// history.c - folder sizes over many scans, as size changes chained per
+// folder
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "history.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+#define HIST_REC_MAX        30              // three varints at most
+#define HIST_IO_CHUNK       (64*1024*1024)  // biggest single read/write
+#define HIST_NAME_MAX       ( ENG_MAX_PATH + 16 )
+
+// where things start in a file with nodes folders
+typedef struct _hist_layout
+{
+    UINT64      scans;
+    UINT64      last[2];    // by the header's slot
+    UINT64      head[2];
+    UINT64      born;
+    UINT64      rec;
+} HIST_LAYOUT;
+
+// one record, decoded
+typedef struct _hist_rec
+{
+    UINT        scan;
+    __int64     delta;
+    UINT64      back;       // 0 for the folder's first
+} HIST_REC;
+
+static void             HistLayout      ( UINT nodes, HIST_LAYOUT * lay );
+static BOOL             HistName        ( const WCHAR * fname,
+                                            const WCHAR * ext, WCHAR * buf );
+static BOOL             HistBase        ( const WCHAR * fname, UINT gen,
+                                            WCHAR * buf );
+static UINT             * HistMatch     ( const SNAPSHOT * base,
+                                            const ENGINE * other );
+static UINT             HistPut         ( BYTE * p, UINT scan,
+                                            __int64 delta, UINT64 back );
+static void             HistRecord      ( const BYTE * p, HIST_REC * rec );
+static UINT64           HistGet         ( const BYTE ** p );
+static BOOL             HistIo          ( HANDLE hFile, UINT64 off,
+                                            void * data, UINT64 len,
+                                            BOOL write );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistAdd
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const WCHAR * fname    : history file, made if missing
+//    Param.    2: const WCHAR * snapname : snapshot of a newer scan
+//    Param.    3: UINT * changed         : receives how many folders
+//                                          changed size, may be NULL
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: add a scan. Its folders are matched to the base's by
+//                 (parent, name), a probe each, and only those whose
+//                 size differs from the last scan get a record, appended
+//                 at the end of the file and pointing back at the
+//                 folder's record before; a folder gone from the scan
+//                 goes to 0. The per folder arrays go to the slot not in
+//                 use and the header, written last once the rest is on
+//                 disk, switches to them, so a failed or cut short add
+//                 leaves the file as it was. The first add makes the
+//                 history with the scan as its base, and every
+//                 HIST_REBASE_DAYS (or when the scan table is full) it's
+//                 compacted on the new scan, which also picks up the
+//                 folders the old base didn't have.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL HistAdd ( const WCHAR * fname, const WCHAR * snapname, UINT * changed )
+/*--------------------------------------------------------------------------*/
+{
+    HIST_HEADER hdr;
+    HIST_LAYOUT lay;
+    SNAPSHOT    base, scan;
+    WCHAR       bname[HIST_NAME_MAX];
+    __int64     * last, * cur;
+    UINT64      * head, prev, pos, used;
+    UINT        * map;
+    BYTE        * rec;
+    HANDLE      hFile;
+    UINT        b, s, n, k;
+    BOOL        ok, rebase;
+
+    if ( changed != NULL )
+        *changed = 0;
+
+    if ( fname == NULL || snapname == NULL )
+        return FALSE;
+
+    if ( GetFileAttributesW ( fname ) == INVALID_FILE_ATTRIBUTES )
+        return HistCompact ( fname, snapname, HIST_KEEP_DAYS );
+
+    hFile = CreateFileW ( fname, GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+    if ( hFile == INVALID_HANDLE_VALUE )
+        return FALSE;
+
+    RtlZeroMemory ( &base, sizeof ( base ) );
+    RtlZeroMemory ( &scan, sizeof ( scan ) );
+
+    last    = NULL;
+    cur     = NULL;
+    head    = NULL;
+    map     = NULL;
+    rec     = NULL;
+    n       = 0;
+
+    // the base has to be the one the header names, scanned when it says
+    ok = HistIo ( hFile, 0, &hdr, sizeof ( hdr ), FALSE ) &&
+        hdr.magic == HIST_MAGIC && hdr.version >= HIST_VERSION_MIN &&
+        hdr.version <= HIST_VERSION && hdr.nscans != 0 &&
+        hdr.nscans <= HIST_MAX_SCANS && hdr.slot <= 1 &&
+        HistBase ( fname, hdr.gen, bname ) && SnapOpen ( &base, bname ) &&
+        base.eng.count == hdr.nodes && base.scanned == hdr.based &&
+        SnapOpen ( &scan, snapname );
+
+    if ( ok )
+    {
+        n = hdr.nodes;
+        HistLayout ( n, &lay );
+
+        // only newer scans, in order
+        ok = HistIo ( hFile, lay.scans + ( hdr.nscans - 1 ) *
+            sizeof ( UINT64 ), &prev, sizeof ( prev ), FALSE ) &&
+            scan.scanned > prev;
+    }
+
+    if ( ok )
+    {
+        last    = malloc ( (UINT_PTR)n * sizeof ( __int64 ) + 1 );
+        cur     = calloc ( (UINT_PTR)n + 1, sizeof ( __int64 ) );
+        head    = malloc ( (UINT_PTR)n * sizeof ( UINT64 ) + 1 );
+        rec     = malloc ( (UINT_PTR)n * HIST_REC_MAX + 1 );
+        map     = HistMatch ( &base, &scan.eng );
+
+        ok = last != NULL && cur != NULL && head != NULL && rec != NULL &&
+            map != NULL &&
+            HistIo ( hFile, lay.last[hdr.slot], last, (UINT64)n *
+                sizeof ( __int64 ), FALSE ) &&
+            HistIo ( hFile, lay.head[hdr.slot], head, (UINT64)n *
+                sizeof ( UINT64 ), FALSE );
+    }
+
+    if ( ok )
+    {
+        for ( s = 0; s < scan.eng.count; s++ )
+            if ( map[s] != ENG_NONE )
+                cur[map[s]] = scan.eng.size[s];
+
+        k       = hdr.nscans;
+        used    = 0;
+
+        for ( b = 0; b < n; b++ )
+        {
+            if ( cur[b] == last[b] )
+                continue;
+
+            pos     = hdr.end + used;
+            used    += HistPut ( rec + used, k, cur[b] - last[b],
+                ( head[b] != 0 ) ? pos - head[b] : 0 );
+            head[b] = pos;
+            last[b] = cur[b];
+
+            if ( changed != NULL )
+                (*changed)++;
+        }
+
+        // nothing the header points at is written over, until it's
+        // written itself the file reads as before
+        hdr.slot ^= 1;
+
+        ok = HistIo ( hFile, hdr.end, rec, used, TRUE ) &&
+            HistIo ( hFile, lay.last[hdr.slot], last, (UINT64)n *
+                sizeof ( __int64 ), TRUE ) &&
+            HistIo ( hFile, lay.head[hdr.slot], head, (UINT64)n *
+                sizeof ( UINT64 ), TRUE ) &&
+            HistIo ( hFile, lay.scans + (UINT64)k * sizeof ( UINT64 ),
+                &scan.scanned, sizeof ( UINT64 ), TRUE ) &&
+            FlushFileBuffers ( hFile );
+
+        hdr.nscans++;
+        hdr.end     += used;
+        hdr.version = HIST_VERSION;
+
+        ok = ok && HistIo ( hFile, 0, &hdr, sizeof ( hdr ), TRUE );
+    }
+
+    rebase = ok && ( hdr.nscans == HIST_MAX_SCANS ||
+        scan.scanned - hdr.based > HIST_REBASE_DAYS * HIST_DAY );
+
+    free ( last );
+    free ( cur );
+    free ( head );
+    free ( rec );
+    free ( map );
+
+    SnapClose ( &scan );
+    SnapClose ( &base );
+    CloseHandle ( hFile );
+
+    if ( rebase )
+        ok = HistCompact ( fname, snapname, HIST_KEEP_DAYS );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistCompact
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const WCHAR * fname    : history file, made if missing
+//    Param.    2: const WCHAR * snapname : the newest scan's snapshot
+//    Param.    3: UINT keep_days         : drop the scans older than this
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: rebase the history on snapname: its folders become the
+//                 ones tracked, each carrying over the records of the
+//                 same folder in the old base that are still within
+//                 keep_days, renumbered and laid out oldest first. The
+//                 rest is dropped, so the file only grows with what
+//                 changes inside the window. The scan is added too if
+//                 it's newer than the last one in. The new base is the
+//                 next generation, under a name of its own; the new
+//                 file is written aside and renamed over the old one,
+//                 which is what switches bases, and only then is the
+//                 old base deleted. A crash anywhere leaves the old
+//                 history with its own base, or the new with its.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL HistCompact ( const WCHAR * fname, const WCHAR * snapname,
+    UINT keep_days )
+/*--------------------------------------------------------------------------*/
+{
+    HISTORY     h;
+    SNAPSHOT    scan;
+    HIST_HEADER hdr;
+    HIST_LAYOUT lay;
+    HIST_REC    r, * chain;
+    WCHAR       bname[HIST_NAME_MAX], tname[HIST_NAME_MAX];
+    WCHAR       btname[HIST_NAME_MAX], oname[HIST_NAME_MAX];
+    UINT64      * scans, * head, cutoff, pos, used, cap;
+    __int64     * last, v;
+    UINT        * born, * map;
+    BYTE        * rec, * tmp;
+    HANDLE      hFile;
+    UINT        f, k, i, m, o, nscans, gen;
+    BOOL        old, append, ok;
+
+    if ( fname == NULL || snapname == NULL ||
+            !HistName ( fname, L".tmp", tname ) ||
+            !HistName ( fname, L".snap.tmp", btname ) )
+        return FALSE;
+
+    if ( !SnapOpen ( &scan, snapname ) )
+        return FALSE;
+
+    old     = HistOpen ( &h, fname );
+    gen     = old ? h.hdr.gen + 1 : 0;
+
+    if ( !HistBase ( fname, gen, bname ) ||
+            ( old && !HistBase ( fname, h.hdr.gen, oname ) ) )
+    {
+        if ( old )
+            HistClose ( &h );
+
+        SnapClose ( &scan );
+        return FALSE;
+    }
+
+    cutoff  = ( scan.scanned > keep_days * (UINT64)HIST_DAY ) ?
+        scan.scanned - keep_days * (UINT64)HIST_DAY : 0;
+    f       = 0;
+    append  = TRUE;
+    ok      = TRUE;
+    nscans  = 1;
+
+    if ( old )
+    {
+        while ( f < h.hdr.nscans && h.scans[f] < cutoff )
+            f++;
+
+        append  = ( scan.scanned > h.scans[h.hdr.nscans-1] );
+        ok      = ( scan.scanned >= h.scans[h.hdr.nscans-1] );
+
+        if ( h.hdr.nscans - f + append > HIST_MAX_SCANS )
+            f = h.hdr.nscans + append - HIST_MAX_SCANS;
+
+        nscans = h.hdr.nscans - f + append;
+    }
+
+    k   = nscans - 1;   // the scan's own
+    cap = 1U << 20;
+    HistLayout ( scan.eng.count, &lay );
+
+    scans   = calloc ( HIST_MAX_SCANS, sizeof ( UINT64 ) );
+    last    = malloc ( (UINT_PTR)scan.eng.count * sizeof ( __int64 ) + 1 );
+    head    = malloc ( (UINT_PTR)scan.eng.count * sizeof ( UINT64 ) + 1 );
+    born    = calloc ( (UINT_PTR)scan.eng.count + 2, sizeof ( UINT ) );
+    chain   = malloc ( ( HIST_MAX_SCANS + 1 ) * sizeof ( HIST_REC ) );
+    rec     = malloc ( cap );
+    map     = old ? HistMatch ( &h.base, &scan.eng ) : NULL;
+
+    ok = ok && scans != NULL && last != NULL && head != NULL &&
+        born != NULL && chain != NULL && rec != NULL &&
+        ( map != NULL || !old );
+
+    used = 0;
+
+    if ( ok )
+    {
+        for ( i = f; old && i < h.hdr.nscans; i++ )
+            scans[i-f] = h.scans[i];
+
+        scans[k] = scan.scanned;
+
+        for ( i = 0; i < scan.eng.count && ok; i++ )
+        {
+            v       = scan.eng.size[i];
+            last[i] = v;
+            head[i] = 0;
+            born[i] = k;
+            o       = ( map != NULL ) ? map[i] : ENG_NONE;
+
+            if ( o == ENG_NONE )
+                continue;
+
+            born[i] = ( h.born[o] > f ) ? h.born[o] - f : 0;
+            m       = 0;
+
+            if ( append && v != h.last[o] )
+            {
+                chain[m].scan   = k;
+                chain[m].delta  = v - h.last[o];
+                m++;
+            }
+
+            // newest first; a change at the first scan kept is from
+            // before it, not needed any more
+            for ( pos = h.head[o]; pos != 0 && m <= HIST_MAX_SCANS; )
+            {
+                HistRecord ( h.view + pos, &r );
+
+                if ( r.scan <= f )
+                    break;
+
+                chain[m].scan   = r.scan - f;
+                chain[m].delta  = r.delta;
+                m++;
+
+                pos = ( r.back != 0 && r.back < pos ) ? pos - r.back : 0;
+            }
+
+            if ( cap - used < (UINT64)m * HIST_REC_MAX )
+            {
+                cap = ( cap + (UINT64)m * HIST_REC_MAX ) * 2;
+                tmp = realloc ( rec, (UINT_PTR)cap );
+
+                if ( tmp == NULL )
+                {
+                    ok = FALSE;
+                    break;
+                }
+
+                rec = tmp;
+            }
+
+            while ( m-- )
+            {
+                pos     = lay.rec + used;
+                used    += HistPut ( rec + used, chain[m].scan,
+                    chain[m].delta, ( head[i] != 0 ) ? pos - head[i] : 0 );
+                head[i] = pos;
+            }
+        }
+    }
+
+    if ( ok )
+    {
+        RtlZeroMemory ( &hdr, sizeof ( hdr ) );
+
+        hdr.magic   = HIST_MAGIC;
+        hdr.version = HIST_VERSION;
+        hdr.nodes   = scan.eng.count;
+        hdr.nscans  = nscans;
+        hdr.gen     = gen;
+        hdr.based   = scan.scanned;
+        hdr.end     = lay.rec + used;
+
+        hFile = CreateFileW ( tname, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL, NULL );
+
+        ok = ( hFile != INVALID_HANDLE_VALUE );
+
+        if ( ok )
+        {
+            ok = HistIo ( hFile, 0, &hdr, sizeof ( hdr ), TRUE ) &&
+                HistIo ( hFile, lay.scans, scans, HIST_MAX_SCANS *
+                    sizeof ( UINT64 ), TRUE ) &&
+                HistIo ( hFile, lay.last[0], last, (UINT64)hdr.nodes *
+                    sizeof ( __int64 ), TRUE ) &&
+                HistIo ( hFile, lay.head[0], head, (UINT64)hdr.nodes *
+                    sizeof ( UINT64 ), TRUE ) &&
+                HistIo ( hFile, lay.last[1], last, (UINT64)hdr.nodes *
+                    sizeof ( __int64 ), TRUE ) &&
+                HistIo ( hFile, lay.head[1], head, (UINT64)hdr.nodes *
+                    sizeof ( UINT64 ), TRUE ) &&
+                HistIo ( hFile, lay.born, born, lay.rec - lay.born,
+                    TRUE ) &&
+                HistIo ( hFile, lay.rec, rec, used, TRUE );
+
+            CloseHandle ( hFile );
+        }
+
+        ok = ok && CopyFileW ( snapname, btname, FALSE );
+    }
+
+    free ( scans );
+    free ( last );
+    free ( head );
+    free ( born );
+    free ( chain );
+    free ( rec );
+    free ( map );
+
+    if ( old )
+        HistClose ( &h );
+
+    SnapClose ( &scan );
+
+    // the new base first, under its own name, the old history doesn't
+    // know it; then the history, which switches to it
+    ok = ok && MoveFileExW ( btname, bname, MOVEFILE_REPLACE_EXISTING ) &&
+        MoveFileExW ( tname, fname, MOVEFILE_REPLACE_EXISTING );
+
+    if ( !ok )
+    {
+        DeleteFileW ( tname );
+        DeleteFileW ( btname );
+    }
+    else if ( old )
+    {
+        // and the old base, or one a crash before this kept
+        DeleteFileW ( oname );
+
+        if ( gen >= 2 && HistBase ( fname, gen - 2, oname ) )
+            DeleteFileW ( oname );
+    }
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistOpen
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: HISTORY * h         : receives the mapped history
+//    Param.    2: const WCHAR * fname : file from HistAdd
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: map it and its base read-only; nothing is read here.
+//                 FALSE if either is missing or doesn't look right.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL HistOpen ( HISTORY * h, const WCHAR * fname )
+/*--------------------------------------------------------------------------*/
+{
+    HIST_LAYOUT     lay;
+    LARGE_INTEGER   fsize;
+    WCHAR           bname[HIST_NAME_MAX];
+
+    if ( h == NULL )
+        return FALSE;
+
+    RtlZeroMemory ( h, sizeof ( HISTORY ) );
+
+    if ( fname == NULL )
+        return FALSE;
+
+    h->hFile = CreateFileW ( fname, GENERIC_READ, FILE_SHARE_READ |
+        FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+    if ( h->hFile == INVALID_HANDLE_VALUE )
+    {
+        h->hFile = NULL;
+        return FALSE;
+    }
+
+    if ( !GetFileSizeEx ( h->hFile, &fsize ) ||
+            fsize.QuadPart < (LONGLONG)sizeof ( HIST_HEADER ) ||
+            (UINT64)fsize.QuadPart > (SIZE_T)-1 )
+    {
+        HistClose ( h );
+        return FALSE;
+    }
+
+    h->hMap = CreateFileMappingW ( h->hFile, NULL, PAGE_READONLY, 0, 0,
+        NULL );
+
+    if ( h->hMap != NULL )
+        h->view = MapViewOfFile ( h->hMap, FILE_MAP_READ, 0, 0, 0 );
+
+    if ( h->view == NULL )
+    {
+        HistClose ( h );
+        return FALSE;
+    }
+
+    h->hdr = *(const HIST_HEADER *)h->view;
+    HistLayout ( h->hdr.nodes, &lay );
+
+    // the base has to be the one the header names, scanned when it says
+    if ( h->hdr.magic != HIST_MAGIC || h->hdr.version < HIST_VERSION_MIN ||
+            h->hdr.version > HIST_VERSION ||
+            h->hdr.nscans == 0 || h->hdr.nscans > HIST_MAX_SCANS ||
+            h->hdr.slot > 1 ||
+            h->hdr.nodes > ENG_MAX_NODES || h->hdr.end < lay.rec ||
+            h->hdr.end > (UINT64)fsize.QuadPart ||
+            !HistBase ( fname, h->hdr.gen, bname ) ||
+            !SnapOpen ( &h->base, bname ) ||
+            h->base.eng.count != h->hdr.nodes ||
+            h->base.scanned != h->hdr.based )
+    {
+        HistClose ( h );
+        return FALSE;
+    }
+
+    h->scans    = (const UINT64 *)( h->view + lay.scans );
+    h->last     = (const __int64 *)( h->view + lay.last[h->hdr.slot] );
+    h->head     = (const UINT64 *)( h->view + lay.head[h->hdr.slot] );
+    h->born     = (const UINT *)( h->view + lay.born );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistSeries
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const HISTORY * h  : from HistOpen
+//    Param.    2: const WCHAR * path : folder, as walked
+//    Param.    3: UINT64 since       : FILETIME of the oldest scan wanted
+//    Param.    4: HIST_POINT * pts   : receives the sizes, newest first
+//    Param.    5: UINT max           : room in pts
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the folder's size at every scan since then, from its
+//                 size at the last one going back through its own
+//                 records only, so what's read is a few pages whatever
+//                 the size of the history. Returns how many, 0 if the
+//                 base doesn't have the folder.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT HistSeries ( const HISTORY * h, const WCHAR * path, UINT64 since,
+    HIST_POINT * pts, UINT max )
+/*--------------------------------------------------------------------------*/
+{
+    HIST_REC    r;
+    UINT64      pos;
+    __int64     v;
+    UINT        node, s, n;
+
+    if ( h == NULL || h->view == NULL || path == NULL || pts == NULL )
+        return 0;
+
+    node = PathIdxLookup ( &h->base.idx, &h->base.eng, path );
+
+    if ( node == ENG_NONE )
+        return 0;
+
+    v   = h->last[node];
+    pos = h->head[node];
+    n   = 0;
+
+    if ( pos != 0 )
+        HistRecord ( h->view + pos, &r );
+
+    for ( s = h->hdr.nscans; s > h->born[node] && n < max; )
+    {
+        s--;
+
+        if ( h->scans[s] < since )
+            break;
+
+        pts[n].when = h->scans[s];
+        pts[n].size = v;
+        n++;
+
+        if ( pos == 0 || r.scan != s )
+            continue;
+
+        v   -= r.delta;
+        pos = ( r.back != 0 && r.back < pos ) ? pos - r.back : 0;
+
+        if ( pos != 0 )
+            HistRecord ( h->view + pos, &r );
+    }
+
+    return n;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistClose
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: HISTORY * h : from HistOpen
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void HistClose ( HISTORY * h )
+/*--------------------------------------------------------------------------*/
+{
+    if ( h == NULL )
+        return;
+
+    SnapClose ( &h->base );
+
+    if ( h->view != NULL )
+        UnmapViewOfFile ( h->view );
+
+    if ( h->hMap != NULL )
+        CloseHandle ( h->hMap );
+
+    if ( h->hFile != NULL )
+        CloseHandle ( h->hFile );
+
+    RtlZeroMemory ( h, sizeof ( HISTORY ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistLayout
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: UINT nodes        : folders in the base
+//    Param.    2: HIST_LAYOUT * lay : receives the offsets
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void HistLayout ( UINT nodes, HIST_LAYOUT * lay )
+/*--------------------------------------------------------------------------*/
+{
+    lay->scans      = sizeof ( HIST_HEADER );
+    lay->last[0]    = lay->scans + HIST_MAX_SCANS * sizeof ( UINT64 );
+    lay->head[0]    = lay->last[0] + (UINT64)nodes * sizeof ( __int64 );
+    lay->last[1]    = lay->head[0] + (UINT64)nodes * sizeof ( UINT64 );
+    lay->head[1]    = lay->last[1] + (UINT64)nodes * sizeof ( __int64 );
+    lay->born       = lay->head[1] + (UINT64)nodes * sizeof ( UINT64 );
+    lay->rec        = lay->born + ( ( (UINT64)nodes * sizeof ( UINT ) +
+        7 ) & ~(UINT64)7 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistName
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: const WCHAR * fname : history file
+//    Param.    2: const WCHAR * ext   : what to add
+//    Param.    3: WCHAR * buf         : receives it, HIST_NAME_MAX chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL HistName ( const WCHAR * fname, const WCHAR * ext, WCHAR * buf )
+/*--------------------------------------------------------------------------*/
+{
+    UINT_PTR    flen, elen;
+
+    flen = wcslen ( fname );
+    elen = wcslen ( ext );
+
+    if ( flen + elen + 1 > HIST_NAME_MAX )
+        return FALSE;
+
+    wmemcpy ( buf, fname, flen );
+    wmemcpy ( buf + flen, ext, elen + 1 );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistBase
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: const WCHAR * fname : history file
+//    Param.    2: UINT gen            : the base's generation
+//    Param.    3: WCHAR * buf         : receives its name, HIST_NAME_MAX
+//                                       chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: fname.snap for generation 0, as histories before
+//                 generations named it, fname.<gen>.snap after
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL HistBase ( const WCHAR * fname, UINT gen, WCHAR * buf )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR   ext[24], * p;
+
+    if ( gen == 0 )
+        return HistName ( fname, L".snap", buf );
+
+    // the digits backwards from the end, then the dot before them
+    p = ext + ARRAYSIZE ( ext ) - 6;
+    wmemcpy ( p, L".snap", 6 );
+
+    do
+    {
+        *--p    = (WCHAR)( L'0' + gen % 10 );
+        gen     /= 10;
+    }
+    while ( gen != 0 );
+
+    *--p = L'.';
+
+    return HistName ( fname, p, buf );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistMatch
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT *
+//    Param.    1: const SNAPSHOT * base : base snapshot
+//    Param.    2: const ENGINE * other  : another scan of the same roots
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: for every folder in other, the same one in base or
+//                 ENG_NONE; malloc'd, free it. Parents come before their
+//                 subfolders, so each is one probe under its parent's
+//                 match.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT * HistMatch ( const SNAPSHOT * base, const ENGINE * other )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    * map;
+    UINT    i, p;
+
+    map = malloc ( (UINT_PTR)other->count * sizeof ( UINT ) + 1 );
+
+    if ( map == NULL )
+        return NULL;
+
+    for ( i = 0; i < other->count; i++ )
+    {
+        p = other->parent[i];
+
+        if ( p != ENG_NONE && ( p >= i || map[p] == ENG_NONE ) )
+            map[i] = ENG_NONE;
+        else
+            map[i] = PathIdxChild ( &base->idx, &base->eng,
+                ( p == ENG_NONE ) ? ENG_NONE : map[p],
+                other->names + other->name[i], other->nlen[i] );
+    }
+
+    return map;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistPut
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: BYTE * p      : where the record goes
+//    Param.    2: UINT scan     : scan it's for
+//    Param.    3: __int64 delta : size change at that scan
+//    Param.    4: UINT64 back   : bytes back to the folder's record before
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: 7 bits a byte, the top one set on all but the last;
+//                 the change zigzagged (0, -1, 1, -2 ...) so a small one
+//                 takes few bytes either way. Returns the bytes taken.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT HistPut ( BYTE * p, UINT scan, __int64 delta, UINT64 back )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  v[3];
+    UINT    i, n;
+
+    v[0]    = scan;
+    v[1]    = ( (UINT64)delta << 1 ) ^ (UINT64)( delta >> 63 );
+    v[2]    = back;
+    n       = 0;
+
+    for ( i = 0; i < 3; i++ )
+    {
+        while ( v[i] >= 0x80 )
+        {
+            p[n++]  = (BYTE)( v[i] | 0x80 );
+            v[i]    >>= 7;
+        }
+
+        p[n++] = (BYTE)v[i];
+    }
+
+    return n;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistRecord
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const BYTE * p : record
+//    Param.    2: HIST_REC * rec : receives it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void HistRecord ( const BYTE * p, HIST_REC * rec )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  z;
+
+    rec->scan   = (UINT)HistGet ( &p );
+    z           = HistGet ( &p );
+    rec->delta  = (__int64)( ( z >> 1 ) ^ ( 0 - ( z & 1 ) ) );
+    rec->back   = HistGet ( &p );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistGet
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT64
+//    Param.    1: const BYTE ** p : varint, moved past it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT64 HistGet ( const BYTE ** p )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  v;
+    UINT    shift;
+    BYTE    b;
+
+    v       = 0;
+    shift   = 0;
+
+    do
+    {
+        b       = *(*p)++;
+        v       |= (UINT64)( b & 0x7F ) << shift;
+        shift   += 7;
+    }
+    while ( ( b & 0x80 ) && shift < 64 );
+
+    return v;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: HistIo
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: HANDLE hFile : file
+//    Param.    2: UINT64 off   : where
+//    Param.    3: void * data  : bytes
+//    Param.    4: UINT64 len   : how many, may be past 4 GB
+//    Param.    5: BOOL write   : TRUE to write them, FALSE to read
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL HistIo ( HANDLE hFile, UINT64 off, void * data, UINT64 len,
+    BOOL write )
+/*--------------------------------------------------------------------------*/
+{
+    OVERLAPPED  ov;
+    DWORD       chunk, done;
+    BOOL        ok;
+
+    while ( len != 0 )
+    {
+        chunk = ( len > HIST_IO_CHUNK ) ? HIST_IO_CHUNK : (DWORD)len;
+
+        RtlZeroMemory ( &ov, sizeof ( ov ) );
+
+        ov.Offset       = (DWORD)off;
+        ov.OffsetHigh   = (DWORD)( off >> 32 );
+
+        ok = write ? WriteFile ( hFile, data, chunk, &done, &ov ) :
+            ReadFile ( hFile, data, chunk, &done, &ov );
+
+        if ( !ok || done != chunk )
+            return FALSE;
+
+        data    = (BYTE *)data + chunk;
+        off     += chunk;
+        len     -= chunk;
+    }
+
+    return TRUE;
+}
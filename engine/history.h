@@ -0,0 +1,76 @@
+
+// history.h - folder sizes over many scans: one base snapshot and, per
+// scan, only the folders whose size changed, chained per folder
+
+#ifndef _HISTORY_H
+#define _HISTORY_H
+
+#include <windows.h>
+#include "engine.h"
+#include "snap.h"
+
+#define HIST_MAGIC          0x54534948  // "HIST"
+#define HIST_VERSION        3
+#define HIST_VERSION_MIN    2           // still read, its base is gen 0
+#define HIST_MAX_SCANS      4096        // room in the scan table
+#define HIST_REBASE_DAYS    30          // HistAdd compacts on a scan this
+                                        // much newer than the base
+#define HIST_KEEP_DAYS      730         // what that compaction keeps
+#define HIST_DAY            864000000000LL  // FILETIME units
+
+// File layout: this header, the scan table (HIST_MAX_SCANS FILETIMEs),
+// then twice over per base folder its size as of the last scan (__int64)
+// and where its newest record is (UINT64, 0 for none), then per folder
+// the first scan it was in (UINT), then the records. Of the two pairs of
+// arrays the header's slot is the current one; an add writes the other
+// and the header flips to it last, so a crash leaves the old one. A
+// record is three LEB128 varints: the scan, the size change at it
+// (zigzag) and how many bytes back the folder's record before it is (0
+// for none). The base snapshot, whose node numbers these are, is the
+// file's name with .<gen>.snap added (.snap for generation 0) and was
+// scanned at based: a rebase writes a new generation and the history
+// switches to it in one rename, so a history never goes with a base
+// other than its own, and one that doesn't match is not read.
+typedef struct _hist_header
+{
+    UINT32      magic;      // HIST_MAGIC
+    UINT32      version;    // HIST_VERSION
+    UINT32      nodes;      // folders in the base
+    UINT32      nscans;
+    UINT32      slot;       // last[] and head[] in use, 0 or 1
+    UINT32      gen;        // the base's generation, see above
+    UINT64      based;      // FILETIME of the base scan
+    UINT64      end;        // the records end here
+} HIST_HEADER;
+
+// A history in use, mapped read-only
+typedef struct _history
+{
+    SNAPSHOT        base;
+    HIST_HEADER     hdr;
+    const UINT64    * scans;
+    const __int64   * last;
+    const UINT64    * head;
+    const UINT      * born;
+    HANDLE          hFile;
+    HANDLE          hMap;
+    const BYTE      * view;
+} HISTORY;
+
+// one folder's size at one scan
+typedef struct _hist_point
+{
+    UINT64      when;       // FILETIME of the scan
+    __int64     size;
+} HIST_POINT;
+
+BOOL    HistAdd         ( const WCHAR * fname, const WCHAR * snapname,
+                            UINT * changed );
+BOOL    HistCompact     ( const WCHAR * fname, const WCHAR * snapname,
+                            UINT keep_days );
+BOOL    HistOpen        ( HISTORY * h, const WCHAR * fname );
+UINT    HistSeries      ( const HISTORY * h, const WCHAR * path,
+                            UINT64 since, HIST_POINT * pts, UINT max );
+void    HistClose       ( HISTORY * h );
+
+#endif // _HISTORY_H
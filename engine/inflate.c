@@ -0,0 +1,590 @@
+
+// inflate.c - streaming gzip (RFC 1952) / DEFLATE (RFC 1951) decoder,
+// reads a file and hands the bytes out as asked, keeping only the 32 KB
+// window. Decoding is done bit by bit on canonical codes, the way
+// Mark Adler's puff.c does it: slower than zlib, but small and simple.
+// The CRC isn't checked, we only ever want sizes out of it.
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "inflate.h"
+#include <windows.h>
+
+#define INF_HEADER          0   // next is a block header
+#define INF_STORED          1   // in a stored block
+#define INF_CODES           2   // in a compressed block
+#define INF_DONE            3   // end of a gzip member
+#define INF_END             4   // end of the file
+
+#define INF_MASK            ( INF_WINDOW - 1 )
+
+static const USHORT gLenBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+
+static const BYTE gLenExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+static const USHORT gDistBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577 };
+
+static const BYTE gDistExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// order of the code length code lengths in a dynamic block
+static const BYTE gClOrder[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+static int              InfByte         ( INFLATE * z );
+static UINT             InfBits         ( INFLATE * z, UINT need );
+static int              InfDecode       ( INFLATE * z, const INF_HUFF * h );
+static int              InfBuild        ( INF_HUFF * h, const BYTE * length,
+                                            UINT n );
+static BOOL             InfGzipHeader   ( INFLATE * z );
+static BOOL             InfBlockHeader  ( INFLATE * z );
+static BOOL             InfDynamic      ( INFLATE * z );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: InflateInit
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: INFLATE * z   : decoder to set up
+//    Param.    2: HANDLE hFile  : gzip file, at its start
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: read the gzip header. Returns FALSE if it isn't one.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL InflateInit ( INFLATE * z, HANDLE hFile )
+/*--------------------------------------------------------------------------*/
+{
+    if ( z == NULL || hFile == NULL || hFile == INVALID_HANDLE_VALUE )
+        return FALSE;
+
+    RtlZeroMemory ( z, sizeof ( INFLATE ) );
+
+    z->hFile = hFile;
+
+    return InfGzipHeader ( z );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: InflateRead
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: INFLATE * z : from InflateInit
+//    Param.    2: BYTE * out  : where to put them, NULL to skip them
+//    Param.    3: UINT n      : bytes wanted
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the next n bytes of the uncompressed stream, going on
+//                 through concatenated gzip members. Returns how many
+//                 there were, less than n only at the end or on bad data
+//                 (then z->error is set).
+/*--------------------------------------------------------------------@@-@@-*/
+UINT InflateRead ( INFLATE * z, BYTE * out, UINT n )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    done, len, dist;
+    int     sym, b;
+
+    done = 0;
+
+    while ( done < n && !z->error )
+    {
+        // a match being copied out of the window
+        if ( z->copy_len != 0 )
+        {
+            b = z->window[( z->wpos - z->copy_dist ) & INF_MASK];
+            z->copy_len--;
+        }
+        else if ( z->state == INF_HEADER )
+        {
+            if ( !InfBlockHeader ( z ) )
+                z->error = TRUE;
+
+            continue;
+        }
+        else if ( z->state == INF_STORED )
+        {
+            if ( z->stored == 0 )
+            {
+                z->state = z->last ? INF_DONE : INF_HEADER;
+                continue;
+            }
+
+            b = InfByte ( z );
+
+            if ( b < 0 )
+            {
+                z->error = TRUE;
+                continue;
+            }
+
+            z->stored--;
+        }
+        else if ( z->state == INF_CODES )
+        {
+            sym = InfDecode ( z, &z->lencode );
+
+            if ( sym < 0 || sym > 285 )
+            {
+                z->error = TRUE;
+                continue;
+            }
+
+            if ( sym == 256 )
+            {
+                z->state = z->last ? INF_DONE : INF_HEADER;
+                continue;
+            }
+
+            if ( sym > 256 )
+            {
+                sym    -= 257;
+                len     = gLenBase[sym] + InfBits ( z, gLenExtra[sym] );
+                sym     = InfDecode ( z, &z->distcode );
+
+                if ( sym < 0 || sym > 29 )
+                {
+                    z->error = TRUE;
+                    continue;
+                }
+
+                dist = gDistBase[sym] + InfBits ( z, gDistExtra[sym] );
+
+                if ( dist > z->total )
+                {
+                    z->error = TRUE;
+                    continue;
+                }
+
+                z->copy_len     = len;
+                z->copy_dist    = dist;
+                continue;
+            }
+
+            b = sym;
+        }
+        else if ( z->state == INF_DONE )
+        {
+            // the member's trailer (CRC and size), then maybe another one
+            z->bitbuf   = 0;
+            z->bitcnt   = 0;
+
+            for ( len = 0; len < 8; len++ )
+                InfByte ( z );
+
+            if ( !InfGzipHeader ( z ) )
+                z->state = INF_END;
+
+            continue;
+        }
+        else
+            break;
+
+        z->window[z->wpos++ & INF_MASK] = (BYTE)b;
+        z->total++;
+
+        if ( out != NULL )
+            out[done] = (BYTE)b;
+
+        done++;
+    }
+
+    return done;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: InfByte
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: INFLATE * z : decoder
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: next compressed byte, -1 at the end of the file
+/*--------------------------------------------------------------------@@-@@-*/
+static int InfByte ( INFLATE * z )
+/*--------------------------------------------------------------------------*/
+{
+    DWORD got;
+
+    if ( z->in_pos == z->in_len )
+    {
+        if ( !ReadFile ( z->hFile, z->in, INF_INBUF, &got, NULL ) ||
+                got == 0 )
+            return -1;
+
+        z->in_pos   = 0;
+        z->in_len   = got;
+    }
+
+    return z->in[z->in_pos++];
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: InfBits
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: INFLATE * z : decoder
+//    Param.    2: UINT need   : how many bits, up to 16
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: next bits of the stream, LSB first. Running out sets
+//                 z->error.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT InfBits ( INFLATE * z, UINT need )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    val;
+    int     b;
+
+    val = z->bitbuf;
+
+    while ( z->bitcnt < need )
+    {
+        b = InfByte ( z );
+
+        if ( b < 0 )
+        {
+            z->error = TRUE;
+            return 0;
+        }
+
+        val         |= (UINT)b << z->bitcnt;
+        z->bitcnt   += 8;
+    }
+
+    z->bitbuf   = val >> need;
+    z->bitcnt  -= need;
+
+    return val & ( ( 1U << need ) - 1 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: InfDecode
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: INFLATE * z         : decoder
+//    Param.    2: const INF_HUFF * h  : code to decode with
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one symbol, a bit at a time: codes of one length are
+//                 consecutive numbers, so the first code of each length
+//                 and the count tell if we're there yet. -1 if no code
+//                 matches.
+/*--------------------------------------------------------------------@@-@@-*/
+static int InfDecode ( INFLATE * z, const INF_HUFF * h )
+/*--------------------------------------------------------------------------*/
+{
+    int     code, first, count, index;
+    UINT    len;
+
+    code    = 0;
+    first   = 0;
+    index   = 0;
+
+    for ( len = 1; len < 16; len++ )
+    {
+        code   |= (int)InfBits ( z, 1 );
+        count   = h->count[len];
+
+        if ( z->error )
+            return -1;
+
+        if ( code - count < first )
+            return h->symbol[index + ( code - first )];
+
+        index  += count;
+        first  += count;
+        first <<= 1;
+        code  <<= 1;
+    }
+
+    return -1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: InfBuild
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: INF_HUFF * h        : code to fill
+//    Param.    2: const BYTE * length : code length per symbol, 0 = unused
+//    Param.    3: UINT n              : symbols
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: canonical code from the lengths. Returns 0 for a
+//                 complete code, > 0 if incomplete, < 0 if the lengths
+//                 ask for more codes than there can be.
+/*--------------------------------------------------------------------@@-@@-*/
+static int InfBuild ( INF_HUFF * h, const BYTE * length, UINT n )
+/*--------------------------------------------------------------------------*/
+{
+    USHORT  offs[16];
+    UINT    len, sym;
+    int     left;
+
+    RtlZeroMemory ( h->count, sizeof ( h->count ) );
+
+    for ( sym = 0; sym < n; sym++ )
+        h->count[length[sym]]++;
+
+    if ( h->count[0] == n )
+        return 0;
+
+    left = 1;
+
+    for ( len = 1; len < 16; len++ )
+    {
+        left <<= 1;
+        left  -= h->count[len];
+
+        if ( left < 0 )
+            return left;
+    }
+
+    offs[1] = 0;
+
+    for ( len = 1; len < 15; len++ )
+        offs[len+1] = offs[len] + h->count[len];
+
+    for ( sym = 0; sym < n; sym++ )
+        if ( length[sym] != 0 )
+            h->symbol[offs[length[sym]]++] = (USHORT)sym;
+
+    return left;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: InfGzipHeader
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: INFLATE * z : decoder, at a member's start
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: skip past a gzip member header, FALSE if there's none
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL InfGzipHeader ( INFLATE * z )
+/*--------------------------------------------------------------------------*/
+{
+    int     flags, b;
+    UINT    i, xlen;
+
+    if ( InfByte ( z ) != 0x1F || InfByte ( z ) != 0x8B ||
+            InfByte ( z ) != 8 )
+        return FALSE;
+
+    flags = InfByte ( z );
+
+    // mtime, extra flags, OS
+    for ( i = 0; i < 6; i++ )
+        InfByte ( z );
+
+    if ( flags & 4 )
+    {
+        xlen  = (UINT)InfByte ( z );
+        xlen |= (UINT)InfByte ( z ) << 8;
+
+        for ( i = 0; i < xlen; i++ )
+            InfByte ( z );
+    }
+
+    // file name, comment
+    for ( i = 8; i <= 16; i += 8 )
+        if ( flags & i )
+            do
+                b = InfByte ( z );
+            while ( b > 0 );
+
+    if ( flags & 2 )
+    {
+        InfByte ( z );
+        InfByte ( z );
+    }
+
+    if ( flags < 0 || InfByte ( z ) < 0 )
+        return FALSE;
+
+    // one too many, give it back
+    z->in_pos--;
+
+    z->state    = INF_HEADER;
+    z->last     = FALSE;
+    z->total    = 0;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: InfBlockHeader
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: INFLATE * z : decoder, at a block's start
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: read a block header and get ready for its data. FALSE
+//                 on bad data.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL InfBlockHeader ( INFLATE * z )
+/*--------------------------------------------------------------------------*/
+{
+    BYTE    length[288+30];
+    UINT    type, len, i;
+
+    z->last = InfBits ( z, 1 );
+    type    = InfBits ( z, 2 );
+
+    if ( z->error )
+        return FALSE;
+
+    if ( type == 0 )
+    {
+        // byte aligned, then LEN and its complement
+        z->bitbuf   = 0;
+        z->bitcnt   = 0;
+        len         = InfBits ( z, 16 );
+
+        if ( z->error || ( len ^ 0xFFFF ) != InfBits ( z, 16 ) )
+            return FALSE;
+
+        z->stored   = len;
+        z->state    = INF_STORED;
+
+        return TRUE;
+    }
+
+    if ( type == 1 )
+    {
+        for ( i = 0; i < 144; i++ )
+            length[i] = 8;
+
+        for ( ; i < 256; i++ )
+            length[i] = 9;
+
+        for ( ; i < 280; i++ )
+            length[i] = 7;
+
+        for ( ; i < 288; i++ )
+            length[i] = 8;
+
+        InfBuild ( &z->lencode, length, 288 );
+
+        for ( i = 0; i < 30; i++ )
+            length[i] = 5;
+
+        InfBuild ( &z->distcode, length, 30 );
+
+        z->state = INF_CODES;
+
+        return TRUE;
+    }
+
+    if ( type == 2 && InfDynamic ( z ) )
+    {
+        z->state = INF_CODES;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: InfDynamic
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: INFLATE * z : decoder, past a dynamic block's type
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: read the block's codes, themselves Huffman coded with
+//                 runs. FALSE on bad data.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL InfDynamic ( INFLATE * z )
+/*--------------------------------------------------------------------------*/
+{
+    BYTE        length[288+30];
+    INF_HUFF    lencode;
+    UINT        nlen, ndist, ncode, i, rep;
+    int         sym, err;
+    BYTE        prev;
+
+    nlen    = InfBits ( z, 5 ) + 257;
+    ndist   = InfBits ( z, 5 ) + 1;
+    ncode   = InfBits ( z, 4 ) + 4;
+
+    if ( z->error || nlen > 286 || ndist > 30 )
+        return FALSE;
+
+    RtlZeroMemory ( length, sizeof ( length ) );
+
+    for ( i = 0; i < ncode; i++ )
+        length[gClOrder[i]] = (BYTE)InfBits ( z, 3 );
+
+    // the code length code has to be complete
+    if ( z->error || InfBuild ( &lencode, length, 19 ) != 0 )
+        return FALSE;
+
+    for ( i = 0; i < nlen + ndist; )
+    {
+        sym = InfDecode ( z, &lencode );
+
+        if ( sym < 0 )
+            return FALSE;
+
+        if ( sym < 16 )
+        {
+            length[i++] = (BYTE)sym;
+            continue;
+        }
+
+        prev = 0;
+
+        if ( sym == 16 )
+        {
+            if ( i == 0 )
+                return FALSE;
+
+            prev    = length[i-1];
+            rep     = 3 + InfBits ( z, 2 );
+        }
+        else if ( sym == 17 )
+            rep = 3 + InfBits ( z, 3 );
+        else
+            rep = 11 + InfBits ( z, 7 );
+
+        if ( z->error || i + rep > nlen + ndist )
+            return FALSE;
+
+        while ( rep-- )
+            length[i++] = prev;
+    }
+
+    // no end of block code, no block
+    if ( length[256] == 0 )
+        return FALSE;
+
+    // incomplete codes are only allowed with a single length
+    err = InfBuild ( &z->lencode, length, nlen );
+
+    if ( err < 0 || ( err > 0 &&
+            nlen != z->lencode.count[0] + z->lencode.count[1] ) )
+        return FALSE;
+
+    err = InfBuild ( &z->distcode, length + nlen, ndist );
+
+    if ( err < 0 || ( err > 0 &&
+            ndist != z->distcode.count[0] + z->distcode.count[1] ) )
+        return FALSE;
+
+    return TRUE;
+}
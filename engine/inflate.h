@@ -0,0 +1,46 @@
+
+// inflate.h - streaming gzip (RFC 1952) / DEFLATE (RFC 1951) decoder,
+// reads a file and hands the bytes out as asked, keeping only the 32 KB
+// window
+
+#ifndef _INFLATE_H
+#define _INFLATE_H
+
+#include <windows.h>
+
+#define INF_WINDOW          32768       // DEFLATE's longest distance
+#define INF_INBUF           65536       // compressed bytes read at a time
+
+// canonical Huffman code, as counts per length and symbols in order
+typedef struct _inf_huff
+{
+    USHORT      count[16];
+    USHORT      symbol[288];
+} INF_HUFF;
+
+// decoder state, big (about 100 KB), keep it off the stack
+typedef struct _inflate
+{
+    HANDLE      hFile;
+    BYTE        in[INF_INBUF];
+    UINT        in_pos;
+    UINT        in_len;
+    UINT        bitbuf;     // bits read, not used yet
+    UINT        bitcnt;
+    BYTE        window[INF_WINDOW];
+    UINT        wpos;       // bytes out, mod 2^32
+    UINT64      total;      // bytes out of this gzip member
+    int         state;      // INF_xxx, in inflate.c
+    BOOL        last;       // in the final block
+    UINT        stored;     // stored block bytes left
+    UINT        copy_len;   // match being copied out
+    UINT        copy_dist;
+    INF_HUFF    lencode;
+    INF_HUFF    distcode;
+    BOOL        error;      // bad data or read error
+} INFLATE;
+
+BOOL    InflateInit     ( INFLATE * z, HANDLE hFile );
+UINT    InflateRead     ( INFLATE * z, BYTE * out, UINT n );
+
+#endif // _INFLATE_H
@@ -0,0 +1,450 @@
+
+// nav.c - drill-down navigation over an engine's tree
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "nav.h"
+#include <windows.h>
+#include <stdlib.h>
+
+static BOOL             NavShow         ( NAV * nav, UINT top );
+static BOOL             NavInsert       ( NAV * nav, UINT at, UINT node,
+                                            UINT level );
+static int              NavCompare      ( const void * a, const void * b );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavInit
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: NAV * nav          : to set up
+//    Param.    2: const ENGINE * eng : tree to go through, done walking
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: no rows yet, NavGo ( nav, ENG_NONE ) for the roots
+/*--------------------------------------------------------------------@@-@@-*/
+void NavInit ( NAV * nav, const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    if ( nav == NULL )
+        return;
+
+    RtlZeroMemory ( nav, sizeof ( NAV ) );
+
+    nav->eng = eng;
+    nav->top = ENG_NONE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: NAV * nav : from NavInit
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void NavFree ( NAV * nav )
+/*--------------------------------------------------------------------------*/
+{
+    if ( nav == NULL )
+        return;
+
+    free ( nav->rows );
+    free ( nav->items );
+    RtlZeroMemory ( nav, sizeof ( NAV ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavGo
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: NAV * nav : navigation
+//    Param.    2: UINT node : folder to go to, ENG_NONE for the roots
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the rows become node's subfolders, all closed. Goes on
+//                 the history after the current folder, dropping what
+//                 was forward of it, like a browser does. Returns FALSE
+//                 if out of memory or node isn't a folder.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL NavGo ( NAV * nav, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    if ( nav == NULL || nav->eng == NULL ||
+            ( node != ENG_NONE && node >= nav->eng->count ) )
+        return FALSE;
+
+    if ( !NavShow ( nav, node ) )
+        return FALSE;
+
+    if ( nav->nhist != 0 )
+    {
+        if ( nav->hist[nav->hpos] == node )
+            return TRUE;
+
+        nav->nhist = nav->hpos + 1;
+    }
+
+    // full, the oldest goes
+    if ( nav->nhist == NAV_MAX_HISTORY )
+    {
+        MoveMemory ( nav->hist, nav->hist + 1,
+            ( NAV_MAX_HISTORY - 1 ) * sizeof ( UINT ) );
+        nav->nhist--;
+    }
+
+    nav->hist[nav->nhist]   = node;
+    nav->hpos               = nav->nhist++;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavBack
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: NAV * nav : navigation
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: back to the folder before on the history. FALSE if
+//                 there's none (or out of memory, the rows stay).
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL NavBack ( NAV * nav )
+/*--------------------------------------------------------------------------*/
+{
+    if ( nav == NULL || nav->hpos == 0 ||
+            !NavShow ( nav, nav->hist[nav->hpos-1] ) )
+        return FALSE;
+
+    nav->hpos--;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavForward
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: NAV * nav : navigation
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: undoes a NavBack
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL NavForward ( NAV * nav )
+/*--------------------------------------------------------------------------*/
+{
+    if ( nav == NULL || nav->hpos + 1 >= nav->nhist ||
+            !NavShow ( nav, nav->hist[nav->hpos+1] ) )
+        return FALSE;
+
+    nav->hpos++;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavUp
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: NAV * nav : navigation
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: go to the parent of the current folder, the roots
+//                 being above the roots. FALSE if already there.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL NavUp ( NAV * nav )
+/*--------------------------------------------------------------------------*/
+{
+    if ( nav == NULL || nav->eng == NULL || nav->top == ENG_NONE )
+        return FALSE;
+
+    return NavGo ( nav, nav->eng->parent[nav->top] );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavExpand
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: NAV * nav : navigation
+//    Param.    2: UINT row  : row to open
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: put the row's subfolders right below it, biggest
+//                 first. FALSE if it's open already, has none or out of
+//                 memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL NavExpand ( NAV * nav, UINT row )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    count;
+
+    if ( nav == NULL || row >= nav->count || nav->rows[row].open )
+        return FALSE;
+
+    count = nav->count;
+
+    if ( !NavInsert ( nav, row + 1, nav->rows[row].node,
+            nav->rows[row].level + 1u ) )
+        return FALSE;
+
+    nav->rows[row].open = ( nav->count != count );
+
+    return nav->rows[row].open;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavCollapse
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: NAV * nav : navigation
+//    Param.    2: UINT row  : row to close
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: take away the rows below it, however deep they were
+//                 opened. FALSE if it wasn't open.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL NavCollapse ( NAV * nav, UINT row )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    end, level;
+
+    if ( nav == NULL || row >= nav->count || !nav->rows[row].open )
+        return FALSE;
+
+    level = nav->rows[row].level;
+
+    for ( end = row + 1; end < nav->count &&
+            nav->rows[end].level > level; end++ )
+        ;
+
+    MoveMemory ( nav->rows + row + 1, nav->rows + end,
+        ( nav->count - end ) * sizeof ( NAV_ROW ) );
+
+    nav->count              -= end - row - 1;
+    nav->rows[row].open     = 0;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavParentRow
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const NAV * nav : navigation
+//    Param.    2: UINT row        : a row
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the open row it's under, ENG_NONE for level 0 rows
+/*--------------------------------------------------------------------@@-@@-*/
+UINT NavParentRow ( const NAV * nav, UINT row )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    level;
+
+    if ( nav == NULL || row >= nav->count || nav->rows[row].level == 0 )
+        return ENG_NONE;
+
+    level = nav->rows[row].level;
+
+    while ( row-- )
+        if ( nav->rows[row].level < level )
+            return row;
+
+    return ENG_NONE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavShare
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const ENGINE * eng : tree
+//    Param.    2: UINT node          : folder
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: node's part of its parent's size, in hundredths of a
+//                 percent. A root's is of all the roots together.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT NavShare ( const ENGINE * eng, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    __int64 whole;
+    UINT    i;
+
+    if ( eng == NULL || node >= eng->count || eng->size[node] <= 0 )
+        return 0;
+
+    if ( eng->parent[node] != ENG_NONE )
+        whole = eng->size[eng->parent[node]];
+    else
+    {
+        // roots are the first nodes, few of them
+        whole = 0;
+
+        for ( i = 0; i < eng->count && ( eng->flags[i] & ENG_TOP ); i++ )
+            whole += eng->size[i];
+    }
+
+    if ( whole <= 0 )
+        return 0;
+
+    // size * 10000 overflows past 900 TB, that's far enough
+    return (UINT)( ( eng->size[node] * 10000 + whole / 2 ) / whole );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavShow
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: NAV * nav : navigation
+//    Param.    2: UINT top  : folder, ENG_NONE for the roots
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: rows for top, the history isn't touched
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL NavShow ( NAV * nav, UINT top )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    count;
+
+    count       = nav->count;
+    nav->count  = 0;
+
+    if ( !NavInsert ( nav, 0, top, 0 ) )
+    {
+        nav->count = count;
+        return FALSE;
+    }
+
+    nav->top = top;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavInsert
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: NAV * nav  : navigation
+//    Param.    2: UINT at    : row they go at, the rest move down
+//    Param.    3: UINT node  : folder, ENG_NONE for the roots
+//    Param.    4: UINT level : theirs
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: node's subfolders as rows, sorted by size. A spilled
+//                 folder (--mem-limit) has nothing below it in memory,
+//                 so shows none. FALSE if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL NavInsert ( NAV * nav, UINT at, UINT node, UINT level )
+/*--------------------------------------------------------------------------*/
+{
+    const ENGINE    * eng;
+    NAV_ITEM        * items;
+    NAV_ROW         * rows;
+    UINT            first, n, cap, i;
+
+    eng = nav->eng;
+
+    if ( node == ENG_NONE )
+    {
+        for ( n = 0; n < eng->count && ( eng->flags[n] & ENG_TOP ); n++ )
+            ;
+
+        first = 0;
+    }
+    else if ( eng->flags[node] & ENG_SPILLED )
+    {
+        first   = 0;
+        n       = 0;
+    }
+    else
+    {
+        first   = eng->first[node];
+        n       = eng->nchild[node];
+    }
+
+    if ( n == 0 )
+        return TRUE;
+
+    if ( n > nav->items_cap )
+    {
+        items = realloc ( nav->items, (size_t)n * sizeof ( NAV_ITEM ) );
+
+        if ( items == NULL )
+            return FALSE;
+
+        nav->items      = items;
+        nav->items_cap  = n;
+    }
+
+    if ( nav->count + n > nav->cap )
+    {
+        for ( cap = nav->cap ? nav->cap : 256; cap < nav->count + n; )
+            cap *= 2;
+
+        rows = realloc ( nav->rows, (size_t)cap * sizeof ( NAV_ROW ) );
+
+        if ( rows == NULL )
+            return FALSE;
+
+        nav->rows   = rows;
+        nav->cap    = cap;
+    }
+
+    for ( i = 0; i < n; i++ )
+    {
+        nav->items[i].size  = eng->size[first+i];
+        nav->items[i].node  = first + i;
+    }
+
+    qsort ( nav->items, n, sizeof ( NAV_ITEM ), NavCompare );
+
+    MoveMemory ( nav->rows + at + n, nav->rows + at,
+        ( nav->count - at ) * sizeof ( NAV_ROW ) );
+
+    for ( i = 0; i < n; i++ )
+    {
+        nav->rows[at+i].node    = nav->items[i].node;
+        nav->rows[at+i].level   = (USHORT)level;
+        nav->rows[at+i].open    = 0;
+    }
+
+    nav->count += n;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: NavCompare
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const void * a : NAV_ITEM
+//    Param.    2: const void * b : NAV_ITEM
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, biggest first, then in walk order
+/*--------------------------------------------------------------------@@-@@-*/
+static int NavCompare ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    const NAV_ITEM  * i1, * i2;
+
+    i1 = (const NAV_ITEM *)a;
+    i2 = (const NAV_ITEM *)b;
+
+    if ( i1->size != i2->size )
+        return ( i1->size > i2->size ) ? -1 : 1;
+
+    return ( i1->node > i2->node ) - ( i1->node < i2->node );
+}
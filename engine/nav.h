@@ -0,0 +1,57 @@
+
+// nav.h - drill-down navigation over an engine's tree: the folders on
+// screen as rows, a folder's subfolders put under it only once opened
+
+#ifndef _NAV_H
+#define _NAV_H
+
+#include "engine.h"
+
+#define NAV_MAX_HISTORY     256     // folders gone to, for back/forward
+
+// one row on screen
+typedef struct _nav_row
+{
+    UINT        node;
+    USHORT      level;      // 0 for the subfolders of nav->top
+    USHORT      open;       // its subfolders are the rows below it
+} NAV_ROW;
+
+// a folder's subfolders while they're sorted
+typedef struct _nav_item
+{
+    __int64     size;
+    UINT        node;
+    UINT        pad;
+} NAV_ITEM;
+
+// Nothing is built for the whole tree: the engine already keeps each
+// folder's subfolders together (first, nchild), so going to a folder or
+// opening one costs what it has right below it, biggest first, however
+// big the tree is.
+typedef struct _nav
+{
+    const ENGINE * eng;
+    NAV_ROW     * rows;
+    UINT        count;
+    UINT        cap;
+    NAV_ITEM    * items;    // scratch
+    UINT        items_cap;
+    UINT        top;        // folder gone to, ENG_NONE for the roots
+    UINT        hist[NAV_MAX_HISTORY];
+    UINT        nhist;      // folders in hist
+    UINT        hpos;       // top is hist[hpos]
+} NAV;
+
+void    NavInit         ( NAV * nav, const ENGINE * eng );
+void    NavFree         ( NAV * nav );
+BOOL    NavGo           ( NAV * nav, UINT node );
+BOOL    NavBack         ( NAV * nav );
+BOOL    NavForward      ( NAV * nav );
+BOOL    NavUp           ( NAV * nav );
+BOOL    NavExpand       ( NAV * nav, UINT row );
+BOOL    NavCollapse     ( NAV * nav, UINT row );
+UINT    NavParentRow    ( const NAV * nav, UINT row );
+UINT    NavShare        ( const ENGINE * eng, UINT node );
+
+#endif // _NAV_H
@@ -0,0 +1,263 @@
+
+// pathidx.c - (parent, name) hash index over an engine's nodes
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "pathidx.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <wctype.h>
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PathIdxBuild
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: PATH_INDEX * pi    : index to fill
+//    Param.    2: const ENGINE * eng : engine, done walking
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: index every node, one pass. Returns FALSE if out of
+//                 memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL PathIdxBuild ( PATH_INDEX * pi, const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    nslots, mask, i, j;
+
+    if ( pi == NULL || eng == NULL )
+        return FALSE;
+
+    RtlZeroMemory ( pi, sizeof ( PATH_INDEX ) );
+
+    for ( nslots = 16; nslots < eng->count * 2; nslots *= 2 )
+        if ( nslots >= 0x80000000u )
+            return FALSE;
+
+    pi->slots = malloc ( (UINT_PTR)nslots * sizeof ( UINT ) );
+
+    if ( pi->slots == NULL )
+        return FALSE;
+
+    // all ones is ENG_NONE
+    FillMemory ( pi->slots, (UINT_PTR)nslots * sizeof ( UINT ), 0xFF );
+
+    pi->nslots  = nslots;
+    mask        = nslots - 1;
+
+    for ( i = 0; i < eng->count; i++ )
+    {
+        j = PathIdxHash ( eng->parent[i], eng->names + eng->name[i],
+            eng->nlen[i] ) & mask;
+
+        while ( pi->slots[j] != ENG_NONE )
+            j = ( j + 1 ) & mask;
+
+        pi->slots[j] = i;
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PathIdxFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: PATH_INDEX * pi : index from PathIdxBuild
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void PathIdxFree ( PATH_INDEX * pi )
+/*--------------------------------------------------------------------------*/
+{
+    if ( pi == NULL )
+        return;
+
+    free ( pi->slots );
+    RtlZeroMemory ( pi, sizeof ( PATH_INDEX ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PathIdxHash
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: UINT parent        : parent node, ENG_NONE for roots
+//    Param.    2: const WCHAR * name : name, need not be NUL terminated
+//    Param.    3: UINT len           : its length
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: FNV-1a over the parent and the lowercased name, names
+//                 compare case insensitive. Part of the snapshot format,
+//                 don't change it without bumping SNAP_VERSION.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT PathIdxHash ( UINT parent, const WCHAR * name, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    hash, i;
+
+    hash = 2166136261u;
+
+    for ( i = 0; i < 4; i++, parent >>= 8 )
+        hash = ( hash ^ ( parent & 0xFF ) ) * 16777619u;
+
+    for ( i = 0; i < len; i++ )
+        hash = ( hash ^ (UINT)towlower ( name[i] ) ) * 16777619u;
+
+    // FNV's low bits are weak, we mask them
+    return hash ^ ( hash >> 15 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PathIdxChild
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const PATH_INDEX * pi : index
+//    Param.    2: const ENGINE * eng    : the engine it was built for
+//    Param.    3: UINT parent           : folder
+//    Param.    4: const WCHAR * name    : subfolder name
+//    Param.    5: UINT len              : its length
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: subfolder by name (case insensitive), ENG_NONE if
+//                 there's no such thing. Same as EngineFindChild, without
+//                 going through all the siblings.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT PathIdxChild ( const PATH_INDEX * pi, const ENGINE * eng, UINT parent,
+    const WCHAR * name, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    mask, j, node;
+
+    if ( pi == NULL || pi->nslots == 0 || eng == NULL || name == NULL )
+        return ENG_NONE;
+
+    mask = pi->nslots - 1;
+
+    for ( j = PathIdxHash ( parent, name, len ) & mask; ;
+            j = ( j + 1 ) & mask )
+    {
+        node = pi->slots[j];
+
+        if ( node == ENG_NONE )
+            return ENG_NONE;
+
+        if ( eng->parent[node] == parent && eng->nlen[node] == len &&
+                _wcsnicmp ( eng->names + eng->name[node], name, len ) == 0 )
+            return node;
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PathIdxLookup
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const PATH_INDEX * pi : index
+//    Param.    2: const ENGINE * eng    : the engine it was built for
+//    Param.    3: const WCHAR * path    : full folder path
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: folder by full path. Picks the deepest root holding it
+//                 (roots are the first nodes, few of them), then hashes
+//                 its way down one component per level. Returns ENG_NONE
+//                 if it's not in the tree.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT PathIdxLookup ( const PATH_INDEX * pi, const ENGINE * eng,
+    const WCHAR * path )
+/*--------------------------------------------------------------------------*/
+{
+    const WCHAR * root, * p, * q;
+    UINT        i, len, best, blen;
+
+    if ( pi == NULL || eng == NULL || path == NULL )
+        return ENG_NONE;
+
+    best = ENG_NONE;
+    blen = 0;
+
+    for ( i = 0; i < eng->count && ( eng->flags[i] & ENG_TOP ); i++ )
+    {
+        root    = eng->names + eng->name[i];
+        len     = eng->nlen[i];
+
+        if ( len > blen && _wcsnicmp ( path, root, len ) == 0 &&
+                ( path[len] == L'\0' || path[len] == L'\\' ||
+                  root[len-1] == L'\\' ) )
+        {
+            best = i;
+            blen = len;
+        }
+    }
+
+    p = path + blen;
+
+    while ( best != ENG_NONE && *p != L'\0' )
+    {
+        while ( *p == L'\\' )
+            p++;
+
+        for ( q = p; *q != L'\0' && *q != L'\\'; q++ )
+            ;
+
+        if ( q != p )
+            best = PathIdxChild ( pi, eng, best, p, (UINT)( q - p ) );
+
+        p = q;
+    }
+
+    return best;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PathIdxMatch
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const PATH_INDEX * pi : index
+//    Param.    2: const ENGINE * eng    : the engine it was built for
+//    Param.    3: const ENGINE * other  : another walk of the same roots
+//    Param.    4: UINT node             : folder in other
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the folder in eng with the same path as node in other,
+//                 ENG_NONE if eng doesn't have it. No path is built, the
+//                 names are taken from other's columns as they are, one
+//                 probe per level. Only node and its parents are read,
+//                 so other may still be walking.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT PathIdxMatch ( const PATH_INDEX * pi, const ENGINE * eng,
+    const ENGINE * other, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    chain[ENG_MAX_DEPTH+1];
+    UINT    k, n, match;
+
+    if ( pi == NULL || eng == NULL || other == NULL ||
+            node >= other->count )
+        return ENG_NONE;
+
+    for ( k = 0, n = node; n != ENG_NONE && k <= ENG_MAX_DEPTH; k++ )
+    {
+        chain[k]    = n;
+        n           = other->parent[n];
+    }
+
+    // roots have no parent in either, and the same full path as name
+    match = ENG_NONE;
+
+    while ( k-- )
+    {
+        n       = chain[k];
+        match   = PathIdxChild ( pi, eng, match,
+            other->names + other->name[n], other->nlen[n] );
+
+        if ( match == ENG_NONE )
+            break;
+    }
+
+    return match;
+}
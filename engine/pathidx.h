@@ -0,0 +1,31 @@
+
+// pathidx.h - (parent, name) hash index over an engine's nodes
+
+#ifndef _PATHIDX_H
+#define _PATHIDX_H
+
+#include <windows.h>
+#include "engine.h"
+
+// Open addressing, keyed by the parent node and the case folded name,
+// holding node numbers (ENG_NONE marks a free slot). Nothing but the
+// slots is stored, the keys are read back from the engine's columns,
+// so the index is 4 bytes per slot and can live in a snapshot as is.
+typedef struct _path_index
+{
+    UINT        * slots;
+    UINT        nslots;     // always a power of 2, at least twice the
+                            // nodes, so probes stay short
+} PATH_INDEX;
+
+BOOL    PathIdxBuild    ( PATH_INDEX * pi, const ENGINE * eng );
+void    PathIdxFree     ( PATH_INDEX * pi );
+UINT    PathIdxHash     ( UINT parent, const WCHAR * name, UINT len );
+UINT    PathIdxChild    ( const PATH_INDEX * pi, const ENGINE * eng,
+                            UINT parent, const WCHAR * name, UINT len );
+UINT    PathIdxLookup   ( const PATH_INDEX * pi, const ENGINE * eng,
+                            const WCHAR * path );
+UINT    PathIdxMatch    ( const PATH_INDEX * pi, const ENGINE * eng,
+                            const ENGINE * other, UINT node );
+
+#endif // _PATHIDX_H
@@ -0,0 +1,594 @@
+
+// pattern.c - compiled glob sets for --exclude / --include
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "pattern.h"
+#include <windows.h>
+#include <wctype.h>
+
+// glob token types, used only while compiling
+typedef enum {
+    TOK_CHAR,
+    TOK_ANY,
+    TOK_STAR,
+    TOK_SET
+} PAT_TOK_TYPE;
+
+typedef struct _pat_tok
+{
+    PAT_TOK_TYPE    type;
+    WCHAR           c;          // TOK_CHAR: the (lowercase) char
+    BOOL            negate;     // TOK_SET: [!...]
+    UINT64          set[2];     // TOK_SET: ASCII members bitmap
+} PAT_TOK;
+
+static WCHAR    PatLower        ( WCHAR c );
+static void     PatSetBit       ( UINT64 * mask, UINT bit );
+static UINT64   * PatWideMask   ( PAT_SET * ps, WCHAR c );
+static const WCHAR * PatParseSet ( const WCHAR * p, PAT_TOK * tok );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatSetInit
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: PAT_SET * ps : set to clear
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: empty set, matches nothing
+/*--------------------------------------------------------------------@@-@@-*/
+void PatSetInit ( PAT_SET * ps )
+/*--------------------------------------------------------------------------*/
+{
+    if ( ps != NULL )
+        RtlZeroMemory ( ps, sizeof ( PAT_SET ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatSetAdd
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: PAT_SET * ps       : set to add to
+//    Param.    2: const WCHAR * glob : pattern, supports * ? [abc] [a-z]
+//                                      and [!abc]
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: compile one more glob into the set's automaton. Each
+//                 token gets its own state bit, placed right after the
+//                 previous pattern. Returns FALSE if the glob is empty,
+//                 malformed or there's no more room in the state vector.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL PatSetAdd ( PAT_SET * ps, const WCHAR * glob )
+/*--------------------------------------------------------------------------*/
+{
+    PAT_TOK         toks[MAX_PATH];
+    UINT            ntok, i, bit, c;
+    const WCHAR     * p;
+    UINT64          * wm;
+
+    if ( ps == NULL || glob == NULL )
+        return FALSE;
+
+    ntok = 0;
+    p = glob;
+
+    // a leading separator only says "relative to the root", we're
+    // anchored anyway
+    while ( *p == L'\\' || *p == L'/' )
+        p++;
+
+    while ( *p )
+    {
+        if ( ntok >= ARRAYSIZE(toks) )
+            return FALSE;
+
+        RtlZeroMemory ( &toks[ntok], sizeof ( PAT_TOK ) );
+
+        switch ( *p )
+        {
+            case L'*':
+                // a run of stars is a single star
+                if ( ntok == 0 || toks[ntok-1].type != TOK_STAR )
+                    toks[ntok++].type = TOK_STAR;
+
+                p++;
+                break;
+
+            case L'?':
+                toks[ntok++].type = TOK_ANY;
+                p++;
+                break;
+
+            case L'[':
+                toks[ntok].type = TOK_SET;
+                p = PatParseSet ( p+1, &toks[ntok] );
+
+                if ( p == NULL )
+                    return FALSE;
+
+                ntok++;
+                break;
+
+            default:
+                toks[ntok].type = TOK_CHAR;
+                toks[ntok].c = ( *p == L'/' ) ? L'\\' : PatLower ( *p );
+                ntok++;
+                p++;
+                break;
+        }
+    }
+
+    if ( ntok == 0 || ps->nbits + ntok > PAT_MAX_BITS )
+        return FALSE;
+
+    bit = ps->nbits;
+
+    PatSetBit ( ps->first, bit );
+    PatSetBit ( ps->final, bit + ntok - 1 );
+
+    // a leading star may match nothing at all
+    if ( toks[0].type == TOK_STAR )
+        PatSetBit ( ps->start, bit );
+
+    for ( i = 0; i < ntok; i++, bit++ )
+    {
+        switch ( toks[i].type )
+        {
+            case TOK_STAR:
+                PatSetBit ( ps->star, bit );
+                // fall through, a star eats anything
+
+            case TOK_ANY:
+                for ( c = 1; c < 128; c++ )
+                    PatSetBit ( ps->ascii[c], bit );
+
+                PatSetBit ( ps->wild, bit );
+                break;
+
+            case TOK_SET:
+                for ( c = 1; c < 128; c++ )
+                {
+                    if ( ( ( toks[i].set[c >> 6] >> ( c & 63 ) ) & 1 )
+                            != (UINT64)toks[i].negate )
+                        PatSetBit ( ps->ascii[c], bit );
+                }
+
+                if ( toks[i].negate )
+                    PatSetBit ( ps->wild, bit );
+
+                break;
+
+            case TOK_CHAR:
+            default:
+                c = toks[i].c;
+
+                if ( c < 128 )
+                {
+                    PatSetBit ( ps->ascii[c], bit );
+
+                    // case insensitive, the table does the folding
+                    if ( c >= L'a' && c <= L'z' )
+                        PatSetBit ( ps->ascii[c - 32], bit );
+                }
+                else
+                {
+                    wm = PatWideMask ( ps, (WCHAR)c );
+
+                    if ( wm == NULL )
+                        return FALSE;
+
+                    PatSetBit ( wm, bit );
+                }
+
+                break;
+        }
+    }
+
+    ps->nbits   = bit;
+    ps->nwords  = ( bit + 63 ) / 64;
+    ps->npat++;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatSetMatch
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const PAT_SET * ps : compiled set
+//    Param.    2: const WCHAR * s    : name or relative path
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: run s through the automaton, TRUE if any pattern of the
+//                 set matches the whole string. Bails out as soon as no
+//                 pattern is alive anymore, so most names are rejected
+//                 after a char or two.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL PatSetMatch ( const PAT_SET * ps, const WCHAR * s )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64          d[PAT_MAX_WORDS];
+    UINT64          tmp[PAT_MAX_WORDS];
+    const UINT64    * b;
+    UINT64          w, carry, alive, inject;
+    UINT            i, j, n;
+    WCHAR           c;
+
+    if ( ps == NULL || s == NULL || ps->npat == 0 )
+        return FALSE;
+
+    n = ps->nwords;
+
+    for ( i = 0; i < n; i++ )
+        d[i] = ps->start[i];
+
+    // the first char may start any pattern, afterwards patterns
+    // can only be continued, never restarted
+    inject = ~(UINT64)0;
+
+    while ( ( c = *s++ ) != L'\0' )
+    {
+        if ( c < 128 )
+            b = ps->ascii[c];
+        else
+        {
+            c = PatLower ( c );
+
+            for ( i = 0; i < n; i++ )
+                tmp[i] = ps->wild[i];
+
+            for ( j = 0; j < ps->nwide; j++ )
+            {
+                if ( ps->wide[j] == c )
+                {
+                    for ( i = 0; i < n; i++ )
+                        tmp[i] |= ps->widemask[j][i];
+
+                    break;
+                }
+            }
+
+            b = tmp;
+        }
+
+        // shift every live token to the next one, keep the
+        // stars looping on themselves
+        carry = 0;
+        alive = 0;
+
+        for ( i = 0; i < n; i++ )
+        {
+            w       = ( ( d[i] << 1 ) | carry ) & ~ps->first[i];
+            carry   = d[i] >> 63;
+            w       = ( ( w | ( ps->first[i] & inject ) ) & b[i] )
+                        | ( d[i] & ps->star[i] );
+            d[i]    = w;
+        }
+
+        // a star can also match nothing: enter it as soon as the
+        // token before it has matched
+        carry = 0;
+
+        for ( i = 0; i < n; i++ )
+        {
+            w       = d[i];
+            d[i]   |= ( ( w << 1 ) | carry ) & ~ps->first[i] & ps->star[i];
+            carry   = w >> 63;
+            alive  |= d[i];
+        }
+
+        if ( alive == 0 )
+            return FALSE;
+
+        inject = 0;
+    }
+
+    for ( i = 0; i < n; i++ )
+        if ( d[i] & ps->final[i] )
+            return TRUE;
+
+    return FALSE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatFilterInit
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: PAT_FILTER * pf : filter to clear
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: no excludes, no includes, everything goes
+/*--------------------------------------------------------------------@@-@@-*/
+void PatFilterInit ( PAT_FILTER * pf )
+/*--------------------------------------------------------------------------*/
+{
+    if ( pf == NULL )
+        return;
+
+    PatSetInit ( &pf->excl_name );
+    PatSetInit ( &pf->excl_path );
+    PatSetInit ( &pf->incl_name );
+    PatSetInit ( &pf->incl_path );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatFilterAdd
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: PAT_FILTER * pf     : filter to add to
+//    Param.    2: const WCHAR * globs : one or more globs, separated by ';'
+//    Param.    3: BOOL include        : TRUE for --include, FALSE for
+//                                       --exclude
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: sort the globs into name or path sets and compile them.
+//                 Returns FALSE on the first glob that didn't make it.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL PatFilterAdd ( PAT_FILTER * pf, const WCHAR * globs, BOOL include )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR       buf[MAX_PATH];
+    UINT        len;
+    BOOL        ispath;
+    PAT_SET     * ps;
+
+    if ( pf == NULL || globs == NULL )
+        return FALSE;
+
+    while ( *globs )
+    {
+        len     = 0;
+        ispath  = FALSE;
+
+        while ( *globs == L' ' || *globs == L';' )
+            globs++;
+
+        while ( *globs && *globs != L';' )
+        {
+            if ( len >= ARRAYSIZE(buf) - 1 )
+                return FALSE;
+
+            if ( *globs == L'\\' || *globs == L'/' )
+                ispath = TRUE;
+
+            buf[len++] = *globs++;
+        }
+
+        // trim trailing blanks and a trailing separator ("cache\")
+        while ( len && ( buf[len-1] == L' ' || buf[len-1] == L'\\'
+                || buf[len-1] == L'/' ) )
+            len--;
+
+        if ( len == 0 )
+            continue;
+
+        buf[len] = L'\0';
+
+        // "dir\" became "dir", which is a plain name again
+        ispath = ispath && ( wcspbrk ( buf, L"\\/" ) != NULL );
+
+        if ( include )
+            ps = ispath ? &pf->incl_path : &pf->incl_name;
+        else
+            ps = ispath ? &pf->excl_path : &pf->excl_name;
+
+        if ( !PatSetAdd ( ps, buf ) )
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatFilterActive
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const PAT_FILTER * pf : filter
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: TRUE if there's anything at all to match against
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL PatFilterActive ( const PAT_FILTER * pf )
+/*--------------------------------------------------------------------------*/
+{
+    if ( pf == NULL )
+        return FALSE;
+
+    return ( pf->excl_name.npat || pf->excl_path.npat ||
+        pf->incl_name.npat || pf->incl_path.npat );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatFilterNeedsPath
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const PAT_FILTER * pf : filter
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: TRUE if some glob wants the relative path, so the caller
+//                 knows if it has to bother building one
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL PatFilterNeedsPath ( const PAT_FILTER * pf )
+/*--------------------------------------------------------------------------*/
+{
+    if ( pf == NULL )
+        return FALSE;
+
+    return ( pf->excl_path.npat || pf->incl_path.npat );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatSkipEntry
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const PAT_FILTER * pf : filter
+//    Param.    2: const WCHAR * name    : entry name, as enumerated
+//    Param.    3: const WCHAR * relpath : path relative to the scan root,
+//                                         NULL to match the name only
+//    Param.    4: BOOL isdir            : entry is a folder
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: TRUE if the entry should be left out. Excludes apply to
+//                 files and folders (an excluded folder is never opened),
+//                 includes only to files, since we have to go into folders
+//                 to find the files that match.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL PatSkipEntry ( const PAT_FILTER * pf, const WCHAR * name,
+    const WCHAR * relpath, BOOL isdir )
+/*--------------------------------------------------------------------------*/
+{
+    if ( pf == NULL || name == NULL )
+        return FALSE;
+
+    if ( pf->excl_name.npat && PatSetMatch ( &pf->excl_name, name ) )
+        return TRUE;
+
+    if ( relpath != NULL && pf->excl_path.npat &&
+            PatSetMatch ( &pf->excl_path, relpath ) )
+        return TRUE;
+
+    if ( isdir || ( pf->incl_name.npat == 0 && pf->incl_path.npat == 0 ) )
+        return FALSE;
+
+    if ( pf->incl_name.npat && PatSetMatch ( &pf->incl_name, name ) )
+        return FALSE;
+
+    if ( relpath != NULL && pf->incl_path.npat &&
+            PatSetMatch ( &pf->incl_path, relpath ) )
+        return FALSE;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatLower
+/*--------------------------------------------------------------------------*/
+//           Type: static WCHAR
+//    Param.    1: WCHAR c : char to fold
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: lowercase a single char, ASCII inline, the rest by asking
+//                 the CRT (keeps fsize off user32)
+/*--------------------------------------------------------------------@@-@@-*/
+static WCHAR PatLower ( WCHAR c )
+/*--------------------------------------------------------------------------*/
+{
+    if ( c < 128 )
+        return ( c >= L'A' && c <= L'Z' ) ? c + 32 : c;
+
+    return (WCHAR)towlower ( c );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatSetBit
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: UINT64 * mask  : state mask, PAT_MAX_WORDS long
+//    Param.    2: UINT bit       : bit to set, below PAT_MAX_BITS (the
+//                                  pattern was checked to fit)
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void PatSetBit ( UINT64 * mask, UINT bit )
+/*--------------------------------------------------------------------------*/
+{
+    mask[bit >> 6] |= (UINT64)1 << ( bit & 63 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatWideMask
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT64 *
+//    Param.    1: PAT_SET * ps : set
+//    Param.    2: WCHAR c      : lowercase non-ASCII char
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: find (or make room for) the token mask of a non-ASCII
+//                 literal. NULL if the wide table is full.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT64 * PatWideMask ( PAT_SET * ps, WCHAR c )
+/*--------------------------------------------------------------------------*/
+{
+    UINT i;
+
+    for ( i = 0; i < ps->nwide; i++ )
+        if ( ps->wide[i] == c )
+            return ps->widemask[i];
+
+    if ( ps->nwide >= PAT_MAX_WIDE )
+        return NULL;
+
+    ps->wide[ps->nwide] = c;
+
+    return ps->widemask[ps->nwide++];
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PatParseSet
+/*--------------------------------------------------------------------------*/
+//           Type: static const WCHAR *
+//    Param.    1: const WCHAR * p : points right after the '['
+//    Param.    2: PAT_TOK * tok   : token to fill
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: parse a [abc], [a-z] or [!abc] char class. Only ASCII
+//                 members are honoured. Returns the char past the ']' or
+//                 NULL if there's no closing bracket.
+/*--------------------------------------------------------------------@@-@@-*/
+static const WCHAR * PatParseSet ( const WCHAR * p, PAT_TOK * tok )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR   lo, hi, c;
+
+    if ( *p == L'!' || *p == L'^' )
+    {
+        tok->negate = TRUE;
+        p++;
+    }
+
+    // a ']' right at the start is a member, not the end
+    if ( *p == L']' )
+    {
+        tok->set[L']' >> 6] |= (UINT64)1 << ( L']' & 63 );
+        p++;
+    }
+
+    while ( *p && *p != L']' )
+    {
+        lo = hi = *p++;
+
+        if ( *p == L'-' && p[1] && p[1] != L']' )
+        {
+            hi = p[1];
+            p += 2;
+        }
+
+        for ( c = lo; c <= hi && c < 128; c++ )
+        {
+            tok->set[c >> 6] |= (UINT64)1 << ( c & 63 );
+
+            if ( c >= L'a' && c <= L'z' )
+                tok->set[(c-32) >> 6] |= (UINT64)1 << ( (c-32) & 63 );
+
+            if ( c >= L'A' && c <= L'Z' )
+                tok->set[(c+32) >> 6] |= (UINT64)1 << ( (c+32) & 63 );
+        }
+    }
+
+    if ( *p != L']' )
+        return NULL;
+
+    return p+1;
+}
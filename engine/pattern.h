@@ -0,0 +1,63 @@
+
+// pattern.h - compiled glob sets for --exclude / --include
+
+#ifndef _PATTERN_H
+#define _PATTERN_H
+
+#include <windows.h>
+
+// every glob token (char, '?', '*' or [set]) takes one bit of the
+// automaton state; all patterns of a set share the same state vector,
+// so this is the total number of tokens a set can hold (64 per word)
+#define PAT_MAX_WORDS   16
+#define PAT_MAX_BITS    (PAT_MAX_WORDS*64)
+
+// distinct non-ASCII literal chars a set can hold
+#define PAT_MAX_WIDE    32
+
+// a bunch of globs compiled into a single bit-parallel (shift-and)
+// automaton. Matching costs one table lookup per char and state word,
+// no matter how many patterns were added. Matching is case insensitive
+// and anchored (the whole string must match).
+typedef struct _pat_set
+{
+    UINT        npat;                           // patterns compiled in
+    UINT        nbits;                          // state bits in use
+    UINT        nwords;                         // state words in use
+    UINT        nwide;                          // wide literals in use
+    UINT64      first[PAT_MAX_WORDS];           // 1st token of each pat.
+    UINT64      start[PAT_MAX_WORDS];           // active before 1st char
+    UINT64      star[PAT_MAX_WORDS];            // '*' tokens (self loop)
+    UINT64      final[PAT_MAX_WORDS];           // last token of each pat.
+    UINT64      wild[PAT_MAX_WORDS];            // tokens taking any
+                                                // non-ASCII char
+    UINT64      ascii[128][PAT_MAX_WORDS];      // per char token masks
+    WCHAR       wide[PAT_MAX_WIDE];             // non-ASCII literals...
+    UINT64      widemask[PAT_MAX_WIDE][PAT_MAX_WORDS]; // ...and masks
+} PAT_SET;
+
+// the whole --exclude/--include configuration. Globs holding a path
+// separator are matched against the path relative to the scan root,
+// the rest against the bare entry name.
+typedef struct _pat_filter
+{
+    PAT_SET     excl_name;
+    PAT_SET     excl_path;
+    PAT_SET     incl_name;
+    PAT_SET     incl_path;
+} PAT_FILTER;
+
+void    PatSetInit      ( PAT_SET * ps );
+BOOL    PatSetAdd       ( PAT_SET * ps, const WCHAR * glob );
+BOOL    PatSetMatch     ( const PAT_SET * ps, const WCHAR * s );
+
+void    PatFilterInit   ( PAT_FILTER * pf );
+BOOL    PatFilterAdd    ( PAT_FILTER * pf, const WCHAR * globs,
+                            BOOL include );
+BOOL    PatFilterActive ( const PAT_FILTER * pf );
+BOOL    PatFilterNeedsPath ( const PAT_FILTER * pf );
+
+BOOL    PatSkipEntry    ( const PAT_FILTER * pf, const WCHAR * name,
+                            const WCHAR * relpath, BOOL isdir );
+
+#endif // _PATTERN_H
@@ -0,0 +1,1028 @@
+
+// pred.c - filter expressions over an engine's folders (--where)
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "pred.h"
+#include "colstat.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#define PRED_DAY            864000000000LL  // one FILETIME day
+#define PRED_FAR            ( (__int64)1 << 62 ) // bigger numbers clamp
+
+// what the number after a field is in
+#define PRED_UNIT_NONE      0
+#define PRED_UNIT_BYTES     1   // K M G T P, 1024 based
+#define PRED_UNIT_DAYS      2   // h d w m y, days if none
+
+// the expression being compiled
+typedef struct _pred_parse
+{
+    PRED        * pr;
+    const WCHAR * s;        // all of it
+    const WCHAR * p;        // what's next
+    UINT        nest;       // brackets and nots we're in
+} PRED_PARSE;
+
+// field names, in PRED_COL_xxx order; age is last, it reads mtime
+static const WCHAR * const gPredFields[] =
+{
+    L"size", L"own", L"files", L"dirs", L"depth", L"age", L"allfiles",
+    L"alldirs"
+};
+
+static UINT             PredOr          ( PRED_PARSE * ps );
+static UINT             PredAnd         ( PRED_PARSE * ps );
+static UINT             PredUnary       ( PRED_PARSE * ps );
+static UINT             PredTerm        ( PRED_PARSE * ps );
+static UINT             PredCompare     ( PRED_PARSE * ps, UINT col );
+static BOOL             PredNumber      ( PRED_PARSE * ps, UINT unit,
+                                            __int64 * v );
+static BOOL             PredText        ( PRED_PARSE * ps, WCHAR * buf,
+                                            UINT cch );
+static BOOL             PredGlobs       ( PRED * pr, WCHAR * globs );
+static BOOL             PredPath        ( PRED * pr, WCHAR * path );
+static BOOL             PredWord        ( PRED_PARSE * ps, const WCHAR * w );
+static void             PredSpace       ( PRED_PARSE * ps );
+static UINT             PredAdd         ( PRED * pr, UINT kind, UINT col,
+                                            UINT a, UINT b, __int64 lo,
+                                            __int64 hi );
+static BOOL             PredUnder       ( PRED * pr, const ENGINE * eng,
+                                            UINT k );
+static void             PredEval        ( const PRED * pr,
+                                            const ENGINE * eng, UINT step,
+                                            UINT base, UINT n,
+                                            const BYTE * act, BYTE * out,
+                                            BYTE * tmp );
+static void             PredRange       ( const PRED_OP * op,
+                                            const ENGINE * eng, UINT base,
+                                            UINT n, const BYTE * act,
+                                            BYTE * out );
+static BOOL             PredHit         ( PRED * pr, UINT node );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredCompile
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: PRED * pr          : receives the plan
+//    Param.    2: const WCHAR * expr : the expression
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: compile something like
+//                 "size>100G and age>1y and path:d:\proj and depth>3".
+//                 Terms are size, own (bytes, K M G T), files, dirs
+//                 (subfolders right inside), depth, age (days since the
+//                 newest file below was written, or h w m y), allfiles
+//                 and alldirs (everything below) compared
+//                 with < <= > >= = !=, then name:<globs> and
+//                 path:<folder> (it and all below), quoted if they have
+//                 blanks; and, or, not and brackets put them together,
+//                 a missing "and" is assumed. Ages count from now.
+//                 Returns FALSE with pr->err at the trouble if it
+//                 doesn't make sense; PredFree it either way.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL PredCompile ( PRED * pr, const WCHAR * expr )
+/*--------------------------------------------------------------------------*/
+{
+    PRED_PARSE  ps;
+    FILETIME    ft;
+    UINT        root;
+
+    if ( pr == NULL )
+        return FALSE;
+
+    RtlZeroMemory ( pr, sizeof ( PRED ) );
+
+    if ( expr == NULL )
+        return FALSE;
+
+    GetSystemTimeAsFileTime ( &ft );
+    pr->now = ( (__int64)ft.dwHighDateTime << 32 ) | ft.dwLowDateTime;
+
+    ps.pr   = pr;
+    ps.s    = expr;
+    ps.p    = expr;
+    ps.nest = 0;
+
+    root = PredOr ( &ps );
+    PredSpace ( &ps );
+
+    if ( root == ENG_NONE || *ps.p != L'\0' )
+    {
+        pr->err = (UINT)( ps.p - ps.s );
+        return FALSE;
+    }
+
+    pr->root = root;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredRun
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: PRED * pr          : compiled plan, gets the hits
+//    Param.    2: const ENGINE * eng : a finished walk or a snapshot
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: every folder through the plan, PRED_BLOCK at a time,
+//                 the ones it keeps into pr->hits, in node order. Each
+//                 step is one loop over one column, without branches
+//                 but for the name globs, which only look at what's
+//                 still in. Not for a walk that spilled, its folders
+//                 are in the snapshot, not in memory. FALSE if out of
+//                 memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL PredRun ( PRED * pr, const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    BYTE    * act, * out;
+    UINT    base, n, i, k;
+
+    if ( pr == NULL || eng == NULL || pr->nops == 0 || eng->spill != NULL )
+        return FALSE;
+
+    pr->nhits = 0;
+
+    // the top call's own two, then two more per level down
+    if ( pr->masks == NULL )
+        pr->masks = malloc ( ( pr->nops + 1 ) * 2 * PRED_BLOCK );
+
+    if ( pr->masks == NULL )
+        return FALSE;
+
+    for ( k = 0; k < pr->npaths; k++ )
+        if ( !PredUnder ( pr, eng, k ) )
+            return FALSE;
+
+    act = pr->masks;
+    out = act + PRED_BLOCK;
+
+    for ( base = 0; base < eng->count; base += n )
+    {
+        n = eng->count - base;
+
+        if ( n > PRED_BLOCK )
+            n = PRED_BLOCK;
+
+        FillMemory ( act, n, 1 );
+        PredEval ( pr, eng, pr->root, base, n, act, out, out + PRED_BLOCK );
+
+        for ( i = 0; i < n; i++ )
+            if ( out[i] && !PredHit ( pr, base + i ) )
+                return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: PRED * pr : from PredCompile
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void PredFree ( PRED * pr )
+/*--------------------------------------------------------------------------*/
+{
+    UINT k;
+
+    if ( pr == NULL )
+        return;
+
+    for ( k = 0; k < PRED_MAX_TERMS; k++ )
+    {
+        free ( pr->paths[k] );
+        free ( pr->under[k] );
+    }
+
+    free ( pr->sets );
+    free ( pr->masks );
+    free ( pr->hits );
+
+    RtlZeroMemory ( pr, sizeof ( PRED ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredOr
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: PRED_PARSE * ps : parser
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: a or b or ..., returns its step or ENG_NONE
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT PredOr ( PRED_PARSE * ps )
+/*--------------------------------------------------------------------------*/
+{
+    UINT a, b;
+
+    a = PredAnd ( ps );
+
+    while ( a != ENG_NONE &&
+            ( PredWord ( ps, L"or" ) || PredWord ( ps, L"||" ) ) )
+    {
+        b = PredAnd ( ps );
+        a = ( b != ENG_NONE ) ?
+            PredAdd ( ps->pr, PRED_OR, 0, a, b, 0, 0 ) : ENG_NONE;
+    }
+
+    return a;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredAnd
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: PRED_PARSE * ps : parser
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: a and b and ..., the "and" may be left out
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT PredAnd ( PRED_PARSE * ps )
+/*--------------------------------------------------------------------------*/
+{
+    const WCHAR * at;
+    UINT        a, b;
+
+    a = PredUnary ( ps );
+
+    while ( a != ENG_NONE )
+    {
+        if ( !PredWord ( ps, L"and" ) && !PredWord ( ps, L"&&" ) )
+        {
+            at = ps->p;
+
+            if ( *ps->p == L'\0' || *ps->p == L')' ||
+                    PredWord ( ps, L"or" ) || PredWord ( ps, L"||" ) )
+            {
+                ps->p = at;
+                break;
+            }
+        }
+
+        b = PredUnary ( ps );
+        a = ( b != ENG_NONE ) ?
+            PredAdd ( ps->pr, PRED_AND, 0, a, b, 0, 0 ) : ENG_NONE;
+    }
+
+    return a;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredUnary
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: PRED_PARSE * ps : parser
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: not x, ( ... ) or a term
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT PredUnary ( PRED_PARSE * ps )
+/*--------------------------------------------------------------------------*/
+{
+    UINT a;
+
+    // nesting costs no step, keep it from going through the stack
+    if ( ps->nest >= PRED_MAX_OPS )
+        return ENG_NONE;
+
+    a = ENG_NONE;
+    ps->nest++;
+
+    if ( PredWord ( ps, L"not" ) || PredWord ( ps, L"!" ) )
+    {
+        a = PredUnary ( ps );
+
+        if ( a != ENG_NONE )
+            a = PredAdd ( ps->pr, PRED_NOT, 0, a, 0, 0, 0 );
+    }
+    else if ( PredWord ( ps, L"(" ) )
+    {
+        a = PredOr ( ps );
+
+        if ( a != ENG_NONE && !PredWord ( ps, L")" ) )
+            a = ENG_NONE;
+    }
+    else
+        a = PredTerm ( ps );
+
+    ps->nest--;
+
+    return a;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredTerm
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: PRED_PARSE * ps : parser
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: name:..., path:... or a field compared to a number
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT PredTerm ( PRED_PARSE * ps )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR   text[ENG_MAX_PATH];
+    UINT    col;
+
+    if ( PredWord ( ps, L"name:" ) )
+    {
+        if ( !PredText ( ps, text, ARRAYSIZE(text) ) ||
+                !PredGlobs ( ps->pr, text ) )
+            return ENG_NONE;
+
+        return PredAdd ( ps->pr, PRED_NAME, ps->pr->nsets - 1, 0, 0, 0, 0 );
+    }
+
+    if ( PredWord ( ps, L"path:" ) )
+    {
+        if ( !PredText ( ps, text, ARRAYSIZE(text) ) ||
+                !PredPath ( ps->pr, text ) )
+            return ENG_NONE;
+
+        return PredAdd ( ps->pr, PRED_PATH, ps->pr->npaths - 1, 0, 0, 0, 0 );
+    }
+
+    for ( col = 0; col < ARRAYSIZE(gPredFields); col++ )
+        if ( PredWord ( ps, gPredFields[col] ) )
+            return PredCompare ( ps, col );
+
+    return ENG_NONE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredCompare
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: PRED_PARSE * ps : parser, past the field name
+//    Param.    2: UINT col        : PRED_COL_xxx, PRED_COL_MTIME for age
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: any comparison becomes a range, so running it is one
+//                 compare per folder whatever the operator; != is the
+//                 range of = negated. An age range is an mtime range the
+//                 other way around, mtime being now - age.
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT PredCompare ( PRED_PARSE * ps, UINT col )
+/*--------------------------------------------------------------------------*/
+{
+    // longer ones first, "<" would take the start of "<="
+    static const WCHAR * const ops[] =
+    {
+        L"<=", L">=", L"!=", L"<>", L"==", L"<", L">", L"="
+    };
+
+    __int64 v, lo, hi, t;
+    UINT    op, a, unit;
+
+    for ( op = 0; op < ARRAYSIZE(ops) && !PredWord ( ps, ops[op] ); op++ )
+        ;
+
+    if ( col <= PRED_COL_OWN )
+        unit = PRED_UNIT_BYTES;
+    else if ( col == PRED_COL_MTIME )
+        unit = PRED_UNIT_DAYS;
+    else
+        unit = PRED_UNIT_NONE;
+
+    if ( op == ARRAYSIZE(ops) || !PredNumber ( ps, unit, &v ) )
+        return ENG_NONE;
+
+    lo = LLONG_MIN;
+    hi = LLONG_MAX;
+
+    switch ( op )
+    {
+        case 0:     hi = v;             break;
+        case 1:     lo = v;             break;
+        case 5:     hi = v - 1;         break;
+        case 6:     lo = v + 1;         break;
+        default:    lo = v; hi = v;     break;
+    }
+
+    if ( col == PRED_COL_MTIME )
+    {
+        if ( lo < -PRED_FAR )
+            lo = -PRED_FAR;
+
+        if ( hi > PRED_FAR )
+            hi = PRED_FAR;
+
+        t   = lo;
+        lo  = ps->pr->now - hi;
+        hi  = ps->pr->now - t;
+    }
+
+    a = PredAdd ( ps->pr, ( lo <= hi ) ? PRED_RANGE : PRED_FALSE, col, 0, 0,
+        lo, hi );
+
+    if ( a != ENG_NONE && ( op == 2 || op == 3 ) )
+        a = PredAdd ( ps->pr, PRED_NOT, 0, a, 0, 0, 0 );
+
+    return a;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredNumber
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PRED_PARSE * ps : parser
+//    Param.    2: UINT unit       : PRED_UNIT_xxx
+//    Param.    3: __int64 * v     : receives bytes, a count or, for days,
+//                                   FILETIME units
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: a number, fractions allowed ("1.5G", "2y"), with its
+//                 unit letter if it takes one
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL PredNumber ( PRED_PARSE * ps, UINT unit, __int64 * v )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR   * end;
+    double  d, mult;
+    WCHAR   c;
+
+    PredSpace ( ps );
+
+    if ( !iswdigit ( *ps->p ) && *ps->p != L'.' )
+        return FALSE;
+
+    d       = wcstod ( ps->p, &end );
+    ps->p   = end;
+    c       = (WCHAR)towlower ( *ps->p );
+    mult    = 1.0;
+
+    if ( unit == PRED_UNIT_BYTES && c != L'\0' && wcschr ( L"kmgtp", c ) )
+    {
+        mult = (double)( (__int64)1 << ( 10 * ( wcschr ( L"kmgtp", c ) -
+            L"kmgtp" + 1 ) ) );
+        ps->p++;
+
+        if ( *ps->p == L'b' || *ps->p == L'B' )
+            ps->p++;
+    }
+    else if ( unit == PRED_UNIT_BYTES && c == L'b' )
+        ps->p++;
+    else if ( unit == PRED_UNIT_DAYS )
+    {
+        mult = (double)PRED_DAY;
+
+        if ( c == L'h' )
+            mult /= 24.0;
+        else if ( c == L'w' )
+            mult *= 7.0;
+        else if ( c == L'm' )
+            mult *= 30.0;
+        else if ( c == L'y' )
+            mult *= 365.0;
+
+        if ( c != L'\0' && wcschr ( L"dhwmy", c ) )
+            ps->p++;
+    }
+
+    if ( iswalnum ( *ps->p ) || *ps->p == L'.' )
+        return FALSE;
+
+    d *= mult;
+    *v = ( d < (double)PRED_FAR ) ? (__int64)d : PRED_FAR;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredText
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PRED_PARSE * ps : parser, past the "name:" or "path:"
+//    Param.    2: WCHAR * buf     : receives the text
+//    Param.    3: UINT cch        : its size, in chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: up to a blank or a closing bracket, or between ' or "
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL PredText ( PRED_PARSE * ps, WCHAR * buf, UINT cch )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR   quote;
+    UINT    len;
+
+    quote = ( *ps->p == L'\'' || *ps->p == L'"' ) ? *ps->p++ : L'\0';
+
+    for ( len = 0; *ps->p != L'\0' && len + 1 < cch; ps->p++ )
+    {
+        if ( quote ? ( *ps->p == quote ) :
+                ( iswspace ( *ps->p ) || *ps->p == L')' ) )
+            break;
+
+        buf[len++] = *ps->p;
+    }
+
+    buf[len] = L'\0';
+
+    if ( quote )
+    {
+        if ( *ps->p != quote )
+            return FALSE;
+
+        ps->p++;
+    }
+
+    return ( len != 0 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredGlobs
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PRED * pr     : plan
+//    Param.    2: WCHAR * globs : ';' separated, cut up in place
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one more glob set, any of them matching the name will do
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL PredGlobs ( PRED * pr, WCHAR * globs )
+/*--------------------------------------------------------------------------*/
+{
+    PAT_SET * ps;
+    WCHAR   * g, * next;
+    UINT    c, w;
+
+    if ( pr->nsets == PRED_MAX_TERMS )
+        return FALSE;
+
+    if ( pr->sets == NULL )
+        pr->sets = malloc ( PRED_MAX_TERMS * sizeof ( PAT_SET ) );
+
+    if ( pr->sets == NULL )
+        return FALSE;
+
+    ps = &pr->sets[pr->nsets];
+    PatSetInit ( ps );
+
+    for ( g = globs; g != NULL; g = next )
+    {
+        next = wcschr ( g, L';' );
+
+        if ( next != NULL )
+            *next++ = L'\0';
+
+        if ( *g != L'\0' && !PatSetAdd ( ps, g ) )
+            return FALSE;
+    }
+
+    if ( ps->npat == 0 )
+        return FALSE;
+
+    // the last char has to take some pattern's last token: "*.git"
+    // turns most names away on their last char, without the automaton
+    for ( c = 0; c < 128; c++ )
+        for ( w = 0, pr->last[pr->nsets][c] = 0; w < ps->nwords; w++ )
+            if ( ps->ascii[c][w] & ps->final[w] )
+                pr->last[pr->nsets][c] = 1;
+
+    pr->nsets++;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredPath
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PRED * pr    : plan
+//    Param.    2: WCHAR * path : folder, may be relative, may end in \*
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one more path term, kept full and without the trailing
+//                 backslash, as the roots are
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL PredPath ( PRED * pr, WCHAR * path )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR       full[ENG_MAX_PATH];
+    UINT_PTR    len;
+
+    if ( pr->npaths == PRED_MAX_TERMS )
+        return FALSE;
+
+    len = wcslen ( path );
+
+    while ( len != 0 && path[len-1] == L'*' )
+        path[--len] = L'\0';
+
+    if ( len == 0 || !GetFullPathNameW ( path, ARRAYSIZE(full), full,
+            NULL ) )
+        return FALSE;
+
+    len = wcslen ( full );
+
+    while ( len != 0 && full[len-1] == L'\\' )
+        full[--len] = L'\0';
+
+    pr->paths[pr->npaths] = _wcsdup ( full );
+
+    if ( pr->paths[pr->npaths] == NULL )
+        return FALSE;
+
+    pr->npaths++;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredWord
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PRED_PARSE * ps  : parser
+//    Param.    2: const WCHAR * w  : keyword or symbol
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: take w if it's next (case insensitive, a word only if
+//                 it isn't the start of a longer one)
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL PredWord ( PRED_PARSE * ps, const WCHAR * w )
+/*--------------------------------------------------------------------------*/
+{
+    UINT_PTR len;
+
+    PredSpace ( ps );
+
+    len = wcslen ( w );
+
+    if ( _wcsnicmp ( ps->p, w, len ) != 0 )
+        return FALSE;
+
+    if ( iswalpha ( w[len-1] ) && ( iswalnum ( ps->p[len] ) ||
+            ps->p[len] == L'_' ) )
+        return FALSE;
+
+    ps->p += len;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredSpace
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: PRED_PARSE * ps : parser
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void PredSpace ( PRED_PARSE * ps )
+/*--------------------------------------------------------------------------*/
+{
+    while ( iswspace ( *ps->p ) )
+        ps->p++;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredAdd
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: PRED * pr       : plan
+//    Param.    2: UINT kind       : PRED_xxx
+//    Param.    3: UINT col        : see PRED_OP
+//    Param.    4: UINT a          : operand steps
+//    Param.    5: UINT b          :
+//    Param.    6: __int64 lo      : PRED_RANGE bounds
+//    Param.    7: __int64 hi      :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: append a step, returns it or ENG_NONE if the plan is
+//                 full
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT PredAdd ( PRED * pr, UINT kind, UINT col, UINT a, UINT b,
+    __int64 lo, __int64 hi )
+/*--------------------------------------------------------------------------*/
+{
+    PRED_OP * op;
+
+    if ( pr->nops == PRED_MAX_OPS )
+        return ENG_NONE;
+
+    op          = &pr->ops[pr->nops];
+    op->kind    = kind;
+    op->col     = col;
+    op->a       = a;
+    op->b       = b;
+    op->lo      = lo;
+    op->hi      = hi;
+
+    return pr->nops++;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredUnder
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PRED * pr          : plan
+//    Param.    2: const ENGINE * eng : what it's about to run on
+//    Param.    3: UINT k             : path term
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: a byte per folder, set if it's the term's folder or
+//                 below it. The folder is looked up one level at a time
+//                 from the root it's in (or, if it's above some roots,
+//                 those are marked), then one pass down the node order
+//                 hands the mark down: a subfolder's node always comes
+//                 after its parent's, in a walk and in a snapshot.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL PredUnder ( PRED * pr, const ENGINE * eng, UINT k )
+/*--------------------------------------------------------------------------*/
+{
+    const WCHAR * path, * name, * rest, * q;
+    BYTE        * under;
+    UINT        root, node, len, plen, i, lo;
+
+    under = realloc ( pr->under[k], eng->count ? eng->count : 1 );
+
+    if ( under == NULL )
+        return FALSE;
+
+    pr->under[k] = under;
+    RtlZeroMemory ( under, eng->count );
+
+    path    = pr->paths[k];
+    plen    = (UINT)wcslen ( path );
+    lo      = eng->count;
+
+    // the roots are the first nodes
+    for ( root = 0; root < eng->count && ( eng->flags[root] & ENG_TOP );
+            root++ )
+    {
+        name    = eng->names + eng->name[root];
+        len     = eng->nlen[root];
+        node    = ENG_NONE;
+
+        if ( plen <= len )
+        {
+            // the root itself, or a folder above it
+            if ( _wcsnicmp ( name, path, plen ) == 0 &&
+                    ( plen == len || name[plen] == L'\\' ) )
+                node = root;
+        }
+        else if ( _wcsnicmp ( name, path, len ) == 0 &&
+                path[len] == L'\\' )
+        {
+            for ( node = root, rest = path + len + 1;
+                    node != ENG_NONE && *rest != L'\0'; rest = q )
+            {
+                q = wcschr ( rest, L'\\' );
+
+                if ( q == NULL )
+                    q = rest + wcslen ( rest );
+
+                node = EngineFindChild ( eng, node, rest,
+                    (UINT)( q - rest ) );
+
+                if ( *q == L'\\' )
+                    q++;
+            }
+        }
+
+        if ( node != ENG_NONE )
+        {
+            under[node] = 1;
+
+            if ( node < lo )
+                lo = node;
+        }
+    }
+
+    // past the roots, every node has a parent
+    for ( i = ( lo + 1 > root ) ? lo + 1 : root; i < eng->count; i++ )
+        under[i] |= under[eng->parent[i]];
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredEval
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const PRED * pr    : plan
+//    Param.    2: const ENGINE * eng : folders
+//    Param.    3: UINT step          : step to run
+//    Param.    4: UINT base          : first folder of the block
+//    Param.    5: UINT n             : folders in it
+//    Param.    6: const BYTE * act   : 1 for the folders to decide
+//    Param.    7: BYTE * out         : receives 1 for the ones in, 0 for
+//                                      the rest (and where act is 0)
+//    Param.    8: BYTE * tmp         : scratch, two blocks for this
+//                                      level, the rest for below
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one step over one block. and runs b on what a let
+//                 through, or runs b on what a didn't, so the costly
+//                 terms see as few folders as they can.
+/*--------------------------------------------------------------------@@-@@-*/
+static void PredEval ( const PRED * pr, const ENGINE * eng, UINT step,
+    UINT base, UINT n, const BYTE * act, BYTE * out, BYTE * tmp )
+/*--------------------------------------------------------------------------*/
+{
+    const PRED_OP   * op;
+    const BYTE      * under, * last;
+    const PAT_SET   * ps;
+    const WCHAR     * name;
+    BYTE            * t1, * t2;
+    UINT            i, len;
+
+    // nothing left to decide, as after a size test few folders pass
+    for ( i = 0; i < n && act[i] == 0; i++ )
+        ;
+
+    if ( i == n )
+    {
+        RtlZeroMemory ( out, n );
+        return;
+    }
+
+    op  = &pr->ops[step];
+    t1  = tmp;
+    t2  = tmp + PRED_BLOCK;
+    tmp = t2 + PRED_BLOCK;
+
+    switch ( op->kind )
+    {
+        case PRED_AND:
+            PredEval ( pr, eng, op->a, base, n, act, t1, tmp );
+            PredEval ( pr, eng, op->b, base, n, t1, out, tmp );
+            break;
+
+        case PRED_OR:
+            PredEval ( pr, eng, op->a, base, n, act, out, tmp );
+
+            for ( i = 0; i < n; i++ )
+                t1[i] = act[i] & ( out[i] ^ 1 );
+
+            PredEval ( pr, eng, op->b, base, n, t1, t2, tmp );
+
+            for ( i = 0; i < n; i++ )
+                out[i] |= t2[i];
+
+            break;
+
+        case PRED_NOT:
+            PredEval ( pr, eng, op->a, base, n, act, t1, tmp );
+
+            for ( i = 0; i < n; i++ )
+                out[i] = act[i] & ( t1[i] ^ 1 );
+
+            break;
+
+        case PRED_RANGE:
+            PredRange ( op, eng, base, n, act, out );
+            break;
+
+        case PRED_NAME:
+            ps      = &pr->sets[op->col];
+            last    = pr->last[op->col];
+
+            for ( i = 0; i < n; i++ )
+            {
+                out[i] = 0;
+
+                if ( act[i] == 0 )
+                    continue;
+
+                name    = eng->names + eng->name[base+i];
+                len     = eng->nlen[base+i];
+
+                if ( len != 0 && name[len-1] < 128 && !last[name[len-1]] )
+                    continue;
+
+                out[i] = (BYTE)PatSetMatch ( ps, name );
+            }
+
+            break;
+
+        case PRED_PATH:
+            under = pr->under[op->col] + base;
+
+            for ( i = 0; i < n; i++ )
+                out[i] = act[i] & under[i];
+
+            break;
+
+        default:
+            RtlZeroMemory ( out, n );
+            break;
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredRange
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const PRED_OP * op : a PRED_RANGE step
+//    Param.    2: const ENGINE * eng : folders
+//    Param.    3: UINT base          : first folder of the block
+//    Param.    4: UINT n             : folders in it
+//    Param.    5: const BYTE * act   : 1 for the folders to decide
+//    Param.    6: BYTE * out         : receives the answers
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one of the colstat.c loops over the step's column
+/*--------------------------------------------------------------------@@-@@-*/
+static void PredRange ( const PRED_OP * op, const ENGINE * eng, UINT base,
+    UINT n, const BYTE * act, BYTE * out )
+/*--------------------------------------------------------------------------*/
+{
+    switch ( op->col )
+    {
+        case PRED_COL_SIZE:
+            ColRange64 ( eng->size + base, act, n, op->lo, op->hi, out );
+            break;
+
+        case PRED_COL_OWN:
+            ColRange64 ( eng->own + base, act, n, op->lo, op->hi, out );
+            break;
+
+        case PRED_COL_MTIME:
+            ColRange64 ( eng->mtime + base, act, n, op->lo, op->hi, out );
+            break;
+
+        case PRED_COL_TFILES:
+            ColRange64 ( eng->tfiles + base, act, n, op->lo, op->hi, out );
+            break;
+
+        case PRED_COL_FILES:
+            ColRange32 ( eng->files + base, act, n, op->lo, op->hi, out );
+            break;
+
+        case PRED_COL_DIRS:
+            ColRange32 ( eng->nchild + base, act, n, op->lo, op->hi, out );
+            break;
+
+        case PRED_COL_TDIRS:
+            ColRange32 ( eng->tdirs + base, act, n, op->lo, op->hi, out );
+            break;
+
+        default:
+            ColRange16 ( eng->depth + base, act, n, op->lo, op->hi, out );
+            break;
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: PredHit
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PRED * pr : plan
+//    Param.    2: UINT node : folder that's in
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL PredHit ( PRED * pr, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    * tmp;
+    UINT    cap;
+
+    if ( pr->nhits == pr->cap )
+    {
+        cap = pr->cap ? pr->cap * 2 : 4096;
+        tmp = realloc ( pr->hits, (UINT_PTR)cap * sizeof ( UINT ) );
+
+        if ( tmp == NULL )
+            return FALSE;
+
+        pr->hits    = tmp;
+        pr->cap     = cap;
+    }
+
+    pr->hits[pr->nhits++] = node;
+
+    return TRUE;
+}
@@ -0,0 +1,73 @@
+
+// pred.h - filter expressions over an engine's folders (--where), compiled
+// to a plan that's run column by column
+
+#ifndef _PRED_H
+#define _PRED_H
+
+#include <windows.h>
+#include "engine.h"
+#include "pattern.h"
+
+#define PRED_MAX_OPS        64      // plan steps in one expression
+#define PRED_MAX_TERMS      8       // name: and path: terms, each
+#define PRED_BLOCK          1024    // folders run through a plan at a time
+
+// plan steps
+#define PRED_FALSE          0
+#define PRED_AND            1
+#define PRED_OR             2
+#define PRED_NOT            3
+#define PRED_RANGE          4       // lo <= column <= hi
+#define PRED_NAME           5       // name matches a glob set
+#define PRED_PATH           6       // the folder is or is below a path
+
+// what a PRED_RANGE reads
+#define PRED_COL_SIZE       0       // size
+#define PRED_COL_OWN        1       // own
+#define PRED_COL_FILES      2       // files
+#define PRED_COL_DIRS       3       // nchild
+#define PRED_COL_DEPTH      4       // depth
+#define PRED_COL_MTIME      5       // mtime, what age compiles to
+#define PRED_COL_TFILES     6       // tfiles
+#define PRED_COL_TDIRS      7       // tdirs
+
+// One step. AND and OR run b only on the folders a left undecided, so a
+// name glob after a size test only sees what passed it.
+typedef struct _pred_op
+{
+    UINT        kind;       // PRED_xxx
+    UINT        col;        // PRED_COL_xxx, or which name/path term
+    UINT        a, b;       // operand steps
+    __int64     lo, hi;     // PRED_RANGE bounds, inclusive
+} PRED_OP;
+
+// A compiled --where. Steps come before the ones using them, root is
+// the last. Running it goes PRED_BLOCK folders at a time: each step
+// fills a byte per folder from one column in a plain loop, and the
+// folders that are in come out in node order.
+typedef struct _pred
+{
+    PRED_OP     ops[PRED_MAX_OPS];
+    UINT        nops;
+    UINT        root;
+    PAT_SET     * sets;     // name: globs, one set per term
+    UINT        nsets;
+    BYTE        last[PRED_MAX_TERMS][128]; // may a name matching the
+                            // set end in this (ASCII) char
+    WCHAR       * paths[PRED_MAX_TERMS]; // path: folders, full
+    UINT        npaths;
+    BYTE        * under[PRED_MAX_TERMS]; // per node, for PredRun
+    BYTE        * masks;    // scratch, two blocks per nesting level
+    __int64     now;        // FILETIME ages are counted from
+    UINT        * hits;
+    UINT        nhits;
+    UINT        cap;
+    UINT        err;        // where compiling gave up, in chars
+} PRED;
+
+BOOL    PredCompile     ( PRED * pr, const WCHAR * expr );
+BOOL    PredRun         ( PRED * pr, const ENGINE * eng );
+void    PredFree        ( PRED * pr );
+
+#endif // _PRED_H
@@ -0,0 +1,367 @@
+
+// proto.c - fsize --serve wire protocol, framing and client side
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "proto.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+static BOOL     ProtoReadAll    ( HANDLE hPipe, void * buf, UINT len );
+static BOOL     ProtoWriteAll   ( HANDLE hPipe, const void * buf, UINT len );
+static BOOL     ProtoReserve    ( PROTO_BUF * pb, UINT len );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoBufInit
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: PROTO_BUF * pb : buffer to set up
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void ProtoBufInit ( PROTO_BUF * pb )
+/*--------------------------------------------------------------------------*/
+{
+    if ( pb != NULL )
+        RtlZeroMemory ( pb, sizeof ( PROTO_BUF ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoBufFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: PROTO_BUF * pb : buffer to release
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void ProtoBufFree ( PROTO_BUF * pb )
+/*--------------------------------------------------------------------------*/
+{
+    if ( pb == NULL )
+        return;
+
+    free ( pb->data );
+    RtlZeroMemory ( pb, sizeof ( PROTO_BUF ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoPut
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: PROTO_BUF * pb    : message being built
+//    Param.    2: const void * data : bytes to append
+//    Param.    3: UINT len          : how many
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: append to the body. Returns FALSE if out of memory or
+//                 the body would pass PROTO_MAX_MSG.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ProtoPut ( PROTO_BUF * pb, const void * data, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    if ( pb == NULL || !ProtoReserve ( pb, pb->len + len ) )
+        return FALSE;
+
+    CopyMemory ( pb->data + pb->len, data, len );
+    pb->len += len;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoPutRec
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: PROTO_BUF * pb         : reply being built
+//    Param.    2: const PROTO_REC * rec  : record, nlen filled in
+//    Param.    3: const WCHAR * name     : nlen chars of name
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: append one record and its name.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ProtoPutRec ( PROTO_BUF * pb, const PROTO_REC * rec, const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    if ( rec == NULL || name == NULL )
+        return FALSE;
+
+    return ProtoPut ( pb, rec, sizeof ( PROTO_REC ) ) &&
+        ProtoPut ( pb, name, rec->nlen * sizeof ( WCHAR ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoNextRec
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const PROTO_BUF * pb : received reply
+//    Param.    2: UINT * pos           : read position, start past the
+//                                        PROTO_RESP
+//    Param.    3: PROTO_REC * rec      : receives the record
+//    Param.    4: const WCHAR ** name  : receives a pointer to its name,
+//                                        inside pb, not NUL terminated
+//                                        and maybe not aligned
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: walk the records of a reply. Returns FALSE at the end or
+//                 on a record that doesn't fit in the body.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ProtoNextRec ( const PROTO_BUF * pb, UINT * pos, PROTO_REC * rec,
+    const WCHAR ** name )
+/*--------------------------------------------------------------------------*/
+{
+    if ( pb == NULL || pos == NULL || rec == NULL || name == NULL )
+        return FALSE;
+
+    if ( *pos + sizeof ( PROTO_REC ) > pb->len )
+        return FALSE;
+
+    CopyMemory ( rec, pb->data + *pos, sizeof ( PROTO_REC ) );
+    *pos += sizeof ( PROTO_REC );
+
+    if ( rec->nlen > ( pb->len - *pos ) / sizeof ( WCHAR ) )
+        return FALSE;
+
+    *name   = (const WCHAR *)( pb->data + *pos );
+    *pos   += rec->nlen * sizeof ( WCHAR );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoSend
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: HANDLE hPipe         : connected pipe
+//    Param.    2: const PROTO_BUF * pb : message body
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: write the length prefix, then the body.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ProtoSend ( HANDLE hPipe, const PROTO_BUF * pb )
+/*--------------------------------------------------------------------------*/
+{
+    UINT32 len;
+
+    if ( pb == NULL )
+        return FALSE;
+
+    len = pb->len;
+
+    return ProtoWriteAll ( hPipe, &len, sizeof ( len ) ) &&
+        ProtoWriteAll ( hPipe, pb->data, len );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoRecv
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: HANDLE hPipe   : connected pipe
+//    Param.    2: PROTO_BUF * pb : receives the body
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: read one whole message. Returns FALSE when the other end
+//                 goes away or sends something bigger than PROTO_MAX_MSG.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ProtoRecv ( HANDLE hPipe, PROTO_BUF * pb )
+/*--------------------------------------------------------------------------*/
+{
+    UINT32 len;
+
+    if ( pb == NULL )
+        return FALSE;
+
+    pb->len = 0;
+
+    if ( !ProtoReadAll ( hPipe, &len, sizeof ( len ) ) )
+        return FALSE;
+
+    if ( !ProtoReserve ( pb, len ) || !ProtoReadAll ( hPipe, pb->data, len ) )
+        return FALSE;
+
+    pb->len = len;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoConnect
+/*--------------------------------------------------------------------------*/
+//           Type: HANDLE
+//    Param.    1: const WCHAR * pipe : pipe name, NULL for the default
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: open the server's pipe, waiting up to PROTO_TIMEOUT if
+//                 it's busy with another client. Returns
+//                 INVALID_HANDLE_VALUE if there's no server.
+/*--------------------------------------------------------------------@@-@@-*/
+HANDLE ProtoConnect ( const WCHAR * pipe )
+/*--------------------------------------------------------------------------*/
+{
+    HANDLE  hPipe;
+
+    if ( pipe == NULL )
+        pipe = PROTO_PIPE_NAME;
+
+    for ( ;; )
+    {
+        hPipe = CreateFileW ( pipe, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+            OPEN_EXISTING, 0, NULL );
+
+        if ( hPipe != INVALID_HANDLE_VALUE )
+            return hPipe;
+
+        if ( GetLastError() != ERROR_PIPE_BUSY ||
+                !WaitNamedPipeW ( pipe, PROTO_TIMEOUT ) )
+            return INVALID_HANDLE_VALUE;
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoCall
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: HANDLE hPipe       : from ProtoConnect
+//    Param.    2: UINT op            : PROTO_xxx request
+//    Param.    3: UINT count         : for PROTO_TOP
+//    Param.    4: const WCHAR * path : folder, may be NULL for PROTO_QUIT
+//    Param.    5: PROTO_BUF * reply  : receives the reply body
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one request, one reply. The connection stays open, so
+//                 a client can ask many times for the price of one
+//                 connect. Returns FALSE if the server went away or the
+//                 reply is too short to hold a PROTO_RESP.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ProtoCall ( HANDLE hPipe, UINT op, UINT count, const WCHAR * path,
+    PROTO_BUF * reply )
+/*--------------------------------------------------------------------------*/
+{
+    PROTO_BUF   req;
+    PROTO_REQ   hdr;
+    BOOL        ok;
+
+    hdr.op      = op;
+    hdr.count   = count;
+
+    ProtoBufInit ( &req );
+
+    ok = ProtoPut ( &req, &hdr, sizeof ( hdr ) );
+
+    if ( ok && path != NULL )
+        ok = ProtoPut ( &req, path, (UINT)wcslen ( path ) * sizeof ( WCHAR ) );
+
+    ok = ok && ProtoSend ( hPipe, &req ) && ProtoRecv ( hPipe, reply ) &&
+        reply->len >= sizeof ( PROTO_RESP );
+
+    ProtoBufFree ( &req );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoReserve
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PROTO_BUF * pb : buffer
+//    Param.    2: UINT len       : bytes it must be able to hold
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: grow by doubling, never past PROTO_MAX_MSG.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ProtoReserve ( PROTO_BUF * pb, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    BYTE    * tmp;
+    UINT    cap;
+
+    if ( len > PROTO_MAX_MSG )
+        return FALSE;
+
+    if ( len <= pb->cap && pb->data != NULL )
+        return TRUE;
+
+    cap = pb->cap ? pb->cap : 4096;
+
+    while ( cap < len )
+        cap *= 2;
+
+    tmp = realloc ( pb->data, cap );
+
+    if ( tmp == NULL )
+        return FALSE;
+
+    pb->data    = tmp;
+    pb->cap     = cap;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoReadAll
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: HANDLE hPipe : pipe
+//    Param.    2: void * buf   : destination
+//    Param.    3: UINT len     : bytes wanted
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: byte mode pipes may hand a message over in pieces.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ProtoReadAll ( HANDLE hPipe, void * buf, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    DWORD   got;
+
+    while ( len != 0 )
+    {
+        if ( !ReadFile ( hPipe, buf, len, &got, NULL ) || got == 0 )
+            return FALSE;
+
+        buf  = (BYTE *)buf + got;
+        len -= got;
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ProtoWriteAll
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: HANDLE hPipe     : pipe
+//    Param.    2: const void * buf : source
+//    Param.    3: UINT len         : bytes to write
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ProtoWriteAll ( HANDLE hPipe, const void * buf, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    DWORD   put;
+
+    while ( len != 0 )
+    {
+        if ( !WriteFile ( hPipe, buf, len, &put, NULL ) || put == 0 )
+            return FALSE;
+
+        buf  = (const BYTE *)buf + put;
+        len -= put;
+    }
+
+    return TRUE;
+}
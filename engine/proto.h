@@ -0,0 +1,82 @@
+
+// proto.h - fsize --serve wire protocol, over a local named pipe
+
+#ifndef _PROTO_H
+#define _PROTO_H
+
+#include <windows.h>
+
+#define PROTO_PIPE_NAME     L"\\\\.\\pipe\\fsize"
+#define PROTO_MAX_MSG       (16*1024*1024)  // longest message body, bytes
+#define PROTO_MAX_TOP       1000            // most folders a PROTO_TOP gets
+#define PROTO_TIMEOUT       2000            // ms to wait for a busy server
+
+// Every message, both ways, is a UINT32 byte count followed by that many
+// bytes of body, little endian. A request body is a PROTO_REQ followed
+// by the folder path (UTF-16, no NUL, up to the end of the body). A reply
+// body is a PROTO_RESP followed by count records, each a PROTO_REC and
+// its name (UTF-16, nlen chars, no NUL). Records are not aligned, copy
+// them out (see ProtoNextRec).
+
+// requests
+#define PROTO_SIZE          1   // the folder itself, name is its full path
+#define PROTO_CHILDREN      2   // its subfolders, biggest first, bare names
+#define PROTO_TOP           3   // count biggest folders below it, full paths
+#define PROTO_SCAN          4   // walk it again now, then as PROTO_SIZE
+#define PROTO_DROP          5   // forget the tree rooted there
+#define PROTO_QUIT          6   // stop the server
+
+// reply status
+#define PROTO_OK            0
+#define PROTO_NOTFOUND      1   // not in the tree (excluded or too deep)
+#define PROTO_NOROOT        2   // couldn't be scanned
+#define PROTO_BADREQ        3
+#define PROTO_NOMEM         4
+
+typedef struct _proto_req
+{
+    UINT32      op;         // PROTO_xxx request
+    UINT32      count;      // for PROTO_TOP, else 0
+} PROTO_REQ;
+
+typedef struct _proto_resp
+{
+    UINT32      status;     // PROTO_xxx status
+    UINT32      count;      // records following
+    UINT64      scanned;    // FILETIME the tree was walked, UTC
+} PROTO_RESP;
+
+typedef struct _proto_rec
+{
+    INT64       size;       // folder and everything below
+    INT64       own;        // files right inside
+    UINT32      folders;    // subfolders right inside
+    UINT32      files;      // files right inside
+    UINT32      nlen;       // name length, in chars
+    UINT32      reserved;
+} PROTO_REC;
+
+// a growable message buffer
+typedef struct _proto_buf
+{
+    BYTE        * data;
+    UINT        len;
+    UINT        cap;
+} PROTO_BUF;
+
+void    ProtoBufInit    ( PROTO_BUF * pb );
+void    ProtoBufFree    ( PROTO_BUF * pb );
+BOOL    ProtoPut        ( PROTO_BUF * pb, const void * data, UINT len );
+BOOL    ProtoPutRec     ( PROTO_BUF * pb, const PROTO_REC * rec,
+                            const WCHAR * name );
+BOOL    ProtoNextRec    ( const PROTO_BUF * pb, UINT * pos, PROTO_REC * rec,
+                            const WCHAR ** name );
+
+BOOL    ProtoSend       ( HANDLE hPipe, const PROTO_BUF * pb );
+BOOL    ProtoRecv       ( HANDLE hPipe, PROTO_BUF * pb );
+
+HANDLE  ProtoConnect    ( const WCHAR * pipe );
+BOOL    ProtoCall       ( HANDLE hPipe, UINT op, UINT count,
+                            const WCHAR * path, PROTO_BUF * reply );
+
+#endif // _PROTO_H
@@ -0,0 +1,621 @@
+
+// search.c - finding folders by part of their name or path
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "search.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <wctype.h>
+
+static UINT             SearchTrigram   ( const WCHAR * lower,
+                                            const WCHAR * s );
+static UINT             SearchNext      ( const BYTE ** p, UINT prev );
+static BOOL             SearchIntersect ( SEARCH * s, const WCHAR * seg,
+                                            UINT slen, UINT * ncand );
+static BOOL             SearchMatch     ( const SEARCH * s, UINT node,
+                                            UINT slen, BOOL path );
+static BOOL             SearchFind      ( const WCHAR * lower,
+                                            const WCHAR * hay, UINT hlen,
+                                            const WCHAR * q, UINT qlen );
+static BOOL             SearchHit       ( SEARCH * s, UINT node );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchBuild
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: SEARCH_INDEX * si  : index to fill
+//    Param.    2: const ENGINE * eng : engine, done walking
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: index every name, two passes: the first one counts
+//                 how many bytes each bucket takes, the second one
+//                 writes them in place. Names shorter than 3 chars have
+//                 no trigram, queries that short go through all of them
+//                 anyway. Returns FALSE if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL SearchBuild ( SEARCH_INDEX * si, const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    UINT            * last;
+    UINT64          * cur;
+    const WCHAR     * name;
+    BYTE            * p;
+    UINT            node, len, i, b, delta;
+    UINT64          total;
+    BOOL            pass;
+
+    if ( si == NULL || eng == NULL )
+        return FALSE;
+
+    RtlZeroMemory ( si, sizeof ( SEARCH_INDEX ) );
+
+    si->eng     = eng;
+    si->nodes   = eng->count;
+    si->lower   = malloc ( 65536 * sizeof ( WCHAR ) );
+    si->count   = calloc ( SEARCH_BUCKETS, sizeof ( UINT ) );
+    si->off     = calloc ( SEARCH_BUCKETS + 1, sizeof ( UINT64 ) );
+    last        = malloc ( SEARCH_BUCKETS * sizeof ( UINT ) );
+    cur         = malloc ( SEARCH_BUCKETS * sizeof ( UINT64 ) );
+
+    if ( si->lower == NULL || si->count == NULL || si->off == NULL ||
+            last == NULL || cur == NULL )
+    {
+        free ( last );
+        free ( cur );
+        SearchFreeIndex ( si );
+        return FALSE;
+    }
+
+    for ( i = 0; i < 65536; i++ )
+        si->lower[i] = (WCHAR)towlower ( (WCHAR)i );
+
+    // pass FALSE sizes the buckets, TRUE fills them
+    for ( pass = FALSE; ; pass = TRUE )
+    {
+        // all ones, so the first delta in a bucket is node + 1
+        FillMemory ( last, SEARCH_BUCKETS * sizeof ( UINT ), 0xFF );
+
+        for ( node = 0; node < si->nodes; node++ )
+        {
+            if ( eng->flags[node] & ENG_FREE )
+                continue;
+
+            name    = eng->names + eng->name[node];
+            len     = eng->nlen[node];
+
+            for ( i = 0; i + 3 <= len; i++ )
+            {
+                b = SearchTrigram ( si->lower, name + i );
+
+                // a trigram twice in a name is one posting
+                if ( last[b] == node )
+                    continue;
+
+                delta   = node - last[b];
+                last[b] = node;
+
+                if ( !pass )
+                {
+                    si->count[b]++;
+
+                    do
+                    {
+                        si->off[b+1]++;
+                        delta >>= 7;
+                    }
+                    while ( delta != 0 );
+
+                    continue;
+                }
+
+                p = si->post + cur[b];
+
+                while ( delta >= 0x80 )
+                {
+                    *p++    = (BYTE)( delta | 0x80 );
+                    delta   >>= 7;
+                }
+
+                *p++    = (BYTE)delta;
+                cur[b]  = (UINT64)( p - si->post );
+            }
+        }
+
+        if ( pass )
+            break;
+
+        for ( b = 0; b < SEARCH_BUCKETS; b++ )
+        {
+            si->off[b+1]    += si->off[b];
+            cur[b]          = si->off[b];
+        }
+
+        total       = si->off[SEARCH_BUCKETS];
+        si->post    = ( (size_t)total == total ) ?
+            malloc ( total ? (size_t)total : 1 ) : NULL;
+
+        if ( si->post == NULL )
+        {
+            free ( last );
+            free ( cur );
+            SearchFreeIndex ( si );
+            return FALSE;
+        }
+    }
+
+    free ( last );
+    free ( cur );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchFreeIndex
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SEARCH_INDEX * si : from SearchBuild
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void SearchFreeIndex ( SEARCH_INDEX * si )
+/*--------------------------------------------------------------------------*/
+{
+    if ( si == NULL )
+        return;
+
+    free ( si->lower );
+    free ( si->count );
+    free ( si->off );
+    free ( si->post );
+    RtlZeroMemory ( si, sizeof ( SEARCH_INDEX ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchInit
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SEARCH * s             : to set up
+//    Param.    2: const SEARCH_INDEX * si : index to search through
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void SearchInit ( SEARCH * s, const SEARCH_INDEX * si )
+/*--------------------------------------------------------------------------*/
+{
+    if ( s == NULL )
+        return;
+
+    RtlZeroMemory ( s, sizeof ( SEARCH ) );
+    s->si = si;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SEARCH * s : from SearchInit
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void SearchFree ( SEARCH * s )
+/*--------------------------------------------------------------------------*/
+{
+    if ( s == NULL )
+        return;
+
+    free ( s->hits );
+    free ( s->scratch );
+    RtlZeroMemory ( s, sizeof ( SEARCH ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchRun
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: SEARCH * s          : search box
+//    Param.    2: const WCHAR * query : what's typed in it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: folders matching query, case insensitive, into
+//                 s->hits. Without a backslash, the folders whose name
+//                 holds it; with one, those whose path holds it, ending
+//                 in their own name ("src\eng" finds c:\work\src\engine,
+//                 not what's below it). The candidates come from the
+//                 rarest trigrams of the part after the last backslash
+//                 and are checked one by one. An empty query has no
+//                 hits. Returns FALSE if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL SearchRun ( SEARCH * s, const WCHAR * query )
+/*--------------------------------------------------------------------------*/
+{
+    const SEARCH_INDEX  * si;
+    WCHAR               q[ENG_MAX_PATH];
+    UINT                qlen, slen, ncand, node, i, n;
+    BOOL                path, grew;
+
+    if ( s == NULL || s->si == NULL || query == NULL )
+        return FALSE;
+
+    si = s->si;
+
+    for ( qlen = 0; query[qlen] != L'\0' && qlen < ARRAYSIZE(q) - 1;
+            qlen++ )
+        q[qlen] = si->lower[(WORD)query[qlen]];
+
+    // a path never ends in one
+    while ( qlen != 0 && q[qlen-1] == L'\\' )
+        qlen--;
+
+    q[qlen] = L'\0';
+    path    = ( wmemchr ( q, L'\\', qlen ) != NULL );
+
+    for ( slen = 0; slen < qlen && q[qlen-slen-1] != L'\\'; slen++ )
+        ;
+
+    // more typed to the same name: what didn't match still doesn't
+    grew = s->valid && s->qlen != 0 && !path &&
+        wmemchr ( s->query, L'\\', s->qlen ) == NULL &&
+            wcsstr ( q, s->query ) != NULL;
+
+    wmemcpy ( s->query, q, qlen + 1 );
+    s->qlen     = qlen;
+    s->valid    = FALSE;
+
+    if ( qlen == 0 )
+    {
+        s->nhits = 0;
+        return TRUE;
+    }
+
+    if ( grew )
+    {
+        for ( i = 0, n = 0; i < s->nhits; i++ )
+            if ( SearchMatch ( s, s->hits[i], slen, FALSE ) )
+                s->hits[n++] = s->hits[i];
+
+        s->nhits = n;
+        s->valid = TRUE;
+
+        return TRUE;
+    }
+
+    s->nhits = 0;
+
+    if ( slen < 3 )
+    {
+        // no trigram to go by, every name is looked at
+        for ( node = 0; node < si->nodes; node++ )
+            if ( SearchMatch ( s, node, slen, path ) &&
+                    !SearchHit ( s, node ) )
+                return FALSE;
+    }
+    else
+    {
+        if ( !SearchIntersect ( s, q + qlen - slen, slen, &ncand ) )
+            return FALSE;
+
+        for ( i = 0; i < ncand; i++ )
+            if ( SearchMatch ( s, s->scratch[i], slen, path ) &&
+                    !SearchHit ( s, s->scratch[i] ) )
+                return FALSE;
+    }
+
+    s->valid = TRUE;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchTrigram
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: const WCHAR * lower : case folding table
+//    Param.    2: const WCHAR * s     : 3 chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: bucket of a trigram, lowercased
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT SearchTrigram ( const WCHAR * lower, const WCHAR * s )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    h;
+
+    h = ( (UINT)lower[(WORD)s[0]] | ( (UINT)lower[(WORD)s[1]] << 16 ) ) *
+        0x9E3779B1u;
+    h ^= (UINT)lower[(WORD)s[2]] * 0x85EBCA77u;
+
+    // the top bits are the best mixed
+    return ( h ^ ( h >> 15 ) ) * 0xC2B2AE3Du >> ( 32 - SEARCH_BITS );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchNext
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: const BYTE ** p : posting list, moved past the entry
+//    Param.    2: UINT prev       : node before, ENG_NONE at the start
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: next node on a posting list
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT SearchNext ( const BYTE ** p, UINT prev )
+/*--------------------------------------------------------------------------*/
+{
+    const BYTE  * q;
+    UINT        delta, shift;
+
+    q       = *p;
+    delta   = *q & 0x7F;
+    shift   = 7;
+
+    while ( *q++ & 0x80 )
+    {
+        delta |= (UINT)( *q & 0x7F ) << shift;
+        shift += 7;
+    }
+
+    *p = q;
+
+    return prev + delta;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchIntersect
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: SEARCH * s        : search box
+//    Param.    2: const WCHAR * seg : part after the last backslash,
+//                                     lowercased, 3 chars at least
+//    Param.    3: UINT slen         : its length
+//    Param.    4: UINT * ncand      : receives the candidates found
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: nodes on all of the SEARCH_MAX_LISTS shortest posting
+//                 lists of seg's trigrams, into s->scratch. The shortest
+//                 one is decoded, the others only thin it out, walked
+//                 side by side with it. Returns FALSE if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL SearchIntersect ( SEARCH * s, const WCHAR * seg, UINT slen,
+    UINT * ncand )
+/*--------------------------------------------------------------------------*/
+{
+    const SEARCH_INDEX  * si;
+    const BYTE          * p, * end;
+    UINT                lists[SEARCH_MAX_LISTS];
+    UINT                nlists, b, i, j, k, n, node, prev, * cand;
+
+    si      = s->si;
+    nlists  = 0;
+    *ncand  = 0;
+
+    // the shortest lists, no bucket twice
+    for ( i = 0; i + 3 <= slen; i++ )
+    {
+        b = SearchTrigram ( si->lower, seg + i );
+
+        for ( j = 0; j < nlists && lists[j] != b; j++ )
+            ;
+
+        if ( j < nlists )
+            continue;
+
+        if ( nlists < SEARCH_MAX_LISTS )
+            lists[nlists++] = b;
+        else if ( si->count[b] < si->count[lists[nlists-1]] )
+            lists[nlists-1] = b;
+        else
+            continue;
+
+        for ( j = nlists - 1; j > 0 &&
+                si->count[lists[j]] < si->count[lists[j-1]]; j-- )
+        {
+            k           = lists[j];
+            lists[j]    = lists[j-1];
+            lists[j-1]  = k;
+        }
+    }
+
+    n = si->count[lists[0]];
+
+    if ( n == 0 )
+        return TRUE;
+
+    if ( n > s->scratch_cap )
+    {
+        cand = realloc ( s->scratch, (size_t)n * sizeof ( UINT ) );
+
+        if ( cand == NULL )
+            return FALSE;
+
+        s->scratch      = cand;
+        s->scratch_cap  = n;
+    }
+
+    cand = s->scratch;
+    p    = si->post + si->off[lists[0]];
+    prev = ENG_NONE;
+
+    for ( i = 0; i < n; i++ )
+        cand[i] = prev = SearchNext ( &p, prev );
+
+    for ( k = 1; k < nlists && n != 0; k++ )
+    {
+        p       = si->post + si->off[lists[k]];
+        end     = si->post + si->off[lists[k]+1];
+        node    = ENG_NONE;
+        prev    = ENG_NONE;
+
+        for ( i = 0, j = 0; i < n; i++ )
+        {
+            while ( ( node == ENG_NONE || node < cand[i] ) && p < end )
+                node = prev = SearchNext ( &p, prev );
+
+            if ( node == cand[i] )
+                cand[j++] = cand[i];
+            else if ( node < cand[i] || node == ENG_NONE )
+                break;
+        }
+
+        n = j;
+    }
+
+    *ncand = n;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchMatch
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: const SEARCH * s : search box, s->query set
+//    Param.    2: UINT node        : candidate
+//    Param.    3: UINT slen        : query's part after the last
+//                                    backslash, in chars
+//    Param.    4: BOOL path        : the query has a backslash
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: does node match? A path query has its last part right
+//                 after a backslash, so (roots aside, their name is a
+//                 whole path) the name has to start with it; only then
+//                 is the path put together and looked through, from
+//                 where a match would still reach into the name.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL SearchMatch ( const SEARCH * s, UINT node, UINT slen,
+    BOOL path )
+/*--------------------------------------------------------------------------*/
+{
+    const SEARCH_INDEX  * si;
+    const ENGINE        * eng;
+    const WCHAR         * name, * seg;
+    WCHAR               buf[ENG_MAX_PATH];
+    UINT                nlen, plen, from, i;
+
+    si      = s->si;
+    eng     = si->eng;
+
+    if ( eng->flags[node] & ENG_FREE )
+        return FALSE;
+
+    name    = eng->names + eng->name[node];
+    nlen    = eng->nlen[node];
+
+    if ( !path )
+        return SearchFind ( si->lower, name, nlen, s->query, s->qlen );
+
+    if ( !( eng->flags[node] & ENG_TOP ) )
+    {
+        if ( nlen < slen )
+            return FALSE;
+
+        seg = s->query + s->qlen - slen;
+
+        for ( i = 0; i < slen; i++ )
+            if ( si->lower[(WORD)name[i]] != seg[i] )
+                return FALSE;
+    }
+
+    plen = EnginePath ( eng, node, buf, ARRAYSIZE(buf) );
+
+    if ( plen < s->qlen )
+        return FALSE;
+
+    from = ( plen > nlen + s->qlen ) ? plen - nlen - s->qlen + 1 : 0;
+
+    return SearchFind ( si->lower, buf + from, plen - from, s->query,
+        s->qlen );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchFind
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: const WCHAR * lower : case folding table
+//    Param.    2: const WCHAR * hay   : text
+//    Param.    3: UINT hlen           : its length
+//    Param.    4: const WCHAR * q     : lowercased
+//    Param.    5: UINT qlen           : its length, not 0
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: is q in hay, case insensitive? The first and last
+//                 char are checked before the rest, which throws out
+//                 nearly every position with two loads.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL SearchFind ( const WCHAR * lower, const WCHAR * hay,
+    UINT hlen, const WCHAR * q, UINT qlen )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    i, j, last;
+    WCHAR   c0, c1;
+
+    if ( qlen > hlen )
+        return FALSE;
+
+    last    = hlen - qlen;
+    c0      = q[0];
+    c1      = q[qlen-1];
+
+    for ( i = 0; i <= last; i++ )
+    {
+        if ( lower[(WORD)hay[i]] != c0 ||
+                lower[(WORD)hay[i+qlen-1]] != c1 )
+            continue;
+
+        for ( j = 1; j + 1 < qlen &&
+                lower[(WORD)hay[i+j]] == q[j]; j++ )
+            ;
+
+        if ( j + 1 >= qlen )
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SearchHit
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: SEARCH * s : search box
+//    Param.    2: UINT node  : matching folder
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: add it to the hits, FALSE if out of memory
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL SearchHit ( SEARCH * s, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    * hits;
+    UINT    cap;
+
+    if ( s->nhits == s->cap )
+    {
+        cap     = s->cap ? s->cap * 2 : 1024;
+        hits    = realloc ( s->hits, (size_t)cap * sizeof ( UINT ) );
+
+        if ( hits == NULL )
+            return FALSE;
+
+        s->hits = hits;
+        s->cap  = cap;
+    }
+
+    s->hits[s->nhits++] = node;
+
+    return TRUE;
+}
@@ -0,0 +1,52 @@
+
+// search.h - finding folders by part of their name or path, through a
+// trigram index over an engine's names
+
+#ifndef _SEARCH_H
+#define _SEARCH_H
+
+#include <windows.h>
+#include "engine.h"
+
+#define SEARCH_BITS         18
+#define SEARCH_BUCKETS      (1U << SEARCH_BITS) // trigram hash buckets
+#define SEARCH_MAX_LISTS    3           // posting lists intersected
+
+// Every name's lowercased trigrams, hashed into buckets. A bucket holds
+// the nodes having one of its trigrams, ascending, each stored as the
+// difference from the one before, 7 bits a byte; most take one byte.
+// Hash collisions only add candidates, they're all checked anyway.
+typedef struct _search_index
+{
+    const ENGINE * eng;
+    UINT        nodes;      // eng->count when built
+    UINT        * count;    // nodes per bucket
+    UINT64      * off;      // where each bucket starts in post,
+                            // SEARCH_BUCKETS + 1 of them
+    BYTE        * post;
+    WCHAR       * lower;    // case folding table, 64K chars
+} SEARCH_INDEX;
+
+// One search box. The hits are for query, in node order; a query that
+// only grew (more typed at either end) is answered by checking the
+// hits of the one before it again, without the index.
+typedef struct _search
+{
+    const SEARCH_INDEX * si;
+    UINT        * hits;
+    UINT        nhits;
+    UINT        cap;
+    UINT        * scratch;  // candidates while intersecting
+    UINT        scratch_cap;
+    WCHAR       query[ENG_MAX_PATH]; // lowercased
+    UINT        qlen;
+    BOOL        valid;      // hits are query's
+} SEARCH;
+
+BOOL    SearchBuild     ( SEARCH_INDEX * si, const ENGINE * eng );
+void    SearchFreeIndex ( SEARCH_INDEX * si );
+void    SearchInit      ( SEARCH * s, const SEARCH_INDEX * si );
+void    SearchFree      ( SEARCH * s );
+BOOL    SearchRun       ( SEARCH * s, const WCHAR * query );
+
+#endif // _SEARCH_H
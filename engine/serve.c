@@ -0,0 +1,754 @@
+
+// serve.c - fsize --serve, keeps walked trees in memory and answers
+// proto.h requests about them
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "serve.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+#if !defined(PIPE_REJECT_REMOTE_CLIENTS)
+    #define PIPE_REJECT_REMOTE_CLIENTS 0x00000008
+#endif
+
+// a folder and its size, for sorting
+typedef struct _serve_pick
+{
+    __int64     size;
+    UINT        node;
+} SERVE_PICK;
+
+static UINT     ServeAnswer     ( SERVER * sv, const PROTO_REQ * hdr,
+                                    const WCHAR * path, PROTO_BUF * reply,
+                                    PROTO_RESP * resp );
+static int      ServeFind       ( SERVER * sv, const WCHAR * path,
+                                    UINT * node );
+static int      ServeExact      ( const SERVER * sv, const WCHAR * path );
+static void     ServeDrop       ( SERVER * sv, int t );
+static BOOL     ServePutNode    ( PROTO_BUF * pb, const ENGINE * eng,
+                                    UINT node, BOOL full );
+static BOOL     ServeChildren   ( PROTO_BUF * pb, const ENGINE * eng,
+                                    UINT node, UINT * count );
+static BOOL     ServeTop        ( PROTO_BUF * pb, const ENGINE * eng,
+                                    UINT node, UINT * count );
+static void     ServeSift       ( SERVE_PICK * heap, UINT n, UINT i );
+static int      ServeCompare    ( const void * a, const void * b );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeInit
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SERVER * sv               : server to set up
+//    Param.    2: UINT threads              : workers per scan, 0 = default
+//    Param.    3: UINT max_depth            : folders this deep not opened
+//    Param.    4: const PAT_FILTER * filter : --exclude/--include, or NULL
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void ServeInit ( SERVER * sv, UINT threads, UINT max_depth,
+    const PAT_FILTER * filter )
+/*--------------------------------------------------------------------------*/
+{
+    if ( sv == NULL )
+        return;
+
+    RtlZeroMemory ( sv, sizeof ( SERVER ) );
+
+    sv->threads     = threads;
+    sv->max_depth   = max_depth;
+    sv->filter      = filter;
+
+    ProtoBufInit ( &sv->in );
+    ProtoBufInit ( &sv->out );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SERVER * sv : server to release
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void ServeFree ( SERVER * sv )
+/*--------------------------------------------------------------------------*/
+{
+    if ( sv == NULL )
+        return;
+
+    while ( sv->ntrees != 0 )
+        ServeDrop ( sv, sv->ntrees - 1 );
+
+    ProtoBufFree ( &sv->in );
+    ProtoBufFree ( &sv->out );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeScan
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: SERVER * sv        : server
+//    Param.    2: const WCHAR * path : folder to walk
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: walk a folder and keep its tree. A tree already rooted
+//                 there is replaced once the new walk is done, a failed
+//                 one leaves it be; if all slots are taken, the one
+//                 queried longest ago goes. A folder inside a tree we
+//                 have gets its own, fresher tree, lookups prefer the
+//                 deepest root. Returns the tree index or -1 if the
+//                 folder can't be opened.
+/*--------------------------------------------------------------------@@-@@-*/
+int ServeScan ( SERVER * sv, const WCHAR * path )
+/*--------------------------------------------------------------------------*/
+{
+    SERVE_TREE  * st;
+    FILETIME    ft;
+    UINT        i, lru;
+    int         t;
+
+    if ( sv == NULL || path == NULL )
+        return -1;
+
+    st = calloc ( 1, sizeof ( SERVE_TREE ) );
+
+    if ( st == NULL )
+        return -1;
+
+    if ( !EngineInit ( &st->eng, sv->threads, sv->max_depth, 0 ) )
+    {
+        free ( st );
+        return -1;
+    }
+
+    st->eng.filter = sv->filter;
+
+    if ( EngineAddRoot ( &st->eng, path ) < 0 ||
+            st->eng.roots[0].state != ENG_ROOT_WALKED ||
+            !EngineRun ( &st->eng ) ||
+            !PathIdxBuild ( &st->idx, &st->eng ) )
+    {
+        EngineFree ( &st->eng );
+        free ( st );
+        return -1;
+    }
+
+    GetSystemTimeAsFileTime ( &ft );
+
+    st->root    = st->eng.roots[0].path;
+    st->rlen    = (UINT)wcslen ( st->root );
+    st->scanned = ( (UINT64)ft.dwHighDateTime << 32 ) | ft.dwLowDateTime;
+    st->used    = sv->clock;
+
+    // a walk that failed above left the old tree alone
+    t = ServeExact ( sv, path );
+
+    if ( t >= 0 )
+    {
+        PathIdxFree ( &sv->trees[t]->idx );
+        EngineFree ( &sv->trees[t]->eng );
+        free ( sv->trees[t] );
+
+        sv->trees[t] = st;
+
+        return t;
+    }
+
+    if ( sv->ntrees == SERVE_MAX_TREES )
+    {
+        for ( i = 1, lru = 0; i < sv->ntrees; i++ )
+            if ( sv->trees[i]->used < sv->trees[lru]->used )
+                lru = i;
+
+        ServeDrop ( sv, lru );
+    }
+
+    sv->trees[sv->ntrees] = st;
+
+    return (int)sv->ntrees++;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeHandle
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: SERVER * sv          : server
+//    Param.    2: const PROTO_BUF * req : request body
+//    Param.    3: PROTO_BUF * reply     : receives the reply body
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: answer one request. A folder no tree knows about is
+//                 walked first (the only slow answer), anything under a
+//                 known root comes straight from memory. Always leaves a
+//                 valid reply in reply; returns FALSE if its status isn't
+//                 PROTO_OK.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ServeHandle ( SERVER * sv, const PROTO_BUF * req, PROTO_BUF * reply )
+/*--------------------------------------------------------------------------*/
+{
+    PROTO_REQ   hdr;
+    PROTO_RESP  resp;
+    WCHAR       path[ENG_MAX_PATH];
+    UINT        len;
+
+    sv->clock++;
+
+    RtlZeroMemory ( &resp, sizeof ( resp ) );
+    reply->len = 0;
+
+    // room for the header, filled in at the end
+    if ( !ProtoPut ( reply, &resp, sizeof ( resp ) ) )
+        return FALSE;
+
+    resp.status = PROTO_BADREQ;
+
+    if ( req->len >= sizeof ( hdr ) && 
+            ( req->len - sizeof ( hdr ) ) / sizeof ( WCHAR ) < ARRAYSIZE(path) )
+    {
+        CopyMemory ( &hdr, req->data, sizeof ( hdr ) );
+
+        len = ( req->len - sizeof ( hdr ) ) / sizeof ( WCHAR );
+
+        CopyMemory ( path, req->data + sizeof ( hdr ), 
+            len * sizeof ( WCHAR ) );
+        path[len] = L'\0';
+
+        // same as EngineAddRoot does, so "c:\work\" finds "c:\work"
+        if ( len > 1 && path[len-1] == L'\\' )
+            path[--len] = L'\0';
+
+        resp.status = ServeAnswer ( sv, &hdr, path, reply, &resp );
+    }
+
+    // on error, drop whatever records got in
+    if ( resp.status != PROTO_OK )
+    {
+        resp.count  = 0;
+        reply->len  = sizeof ( resp );
+    }
+
+    CopyMemory ( reply->data, &resp, sizeof ( resp ) );
+
+    return ( resp.status == PROTO_OK );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeRun
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: SERVER * sv        : server, maybe with some trees in
+//    Param.    2: const WCHAR * pipe : pipe name, NULL for the default
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: serve clients, one at a time, until one asks us to quit.
+//                 A client keeps its connection for as many requests as
+//                 it likes; others wait in WaitNamedPipe meanwhile. Only
+//                 local clients are let in. Returns FALSE if the pipe
+//                 can't be created (another server already runs?).
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ServeRun ( SERVER * sv, const WCHAR * pipe )
+/*--------------------------------------------------------------------------*/
+{
+    HANDLE  hPipe;
+
+    if ( sv == NULL )
+        return FALSE;
+
+    if ( pipe == NULL )
+        pipe = PROTO_PIPE_NAME;
+
+    hPipe = CreateNamedPipeW ( pipe, PIPE_ACCESS_DUPLEX |
+        FILE_FLAG_FIRST_PIPE_INSTANCE, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE |
+        PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 64*1024, 64*1024, 0,
+        NULL );
+
+    if ( hPipe == INVALID_HANDLE_VALUE )
+        return FALSE;
+
+    while ( !sv->quit )
+    {
+        if ( ConnectNamedPipe ( hPipe, NULL ) ||
+                GetLastError() == ERROR_PIPE_CONNECTED )
+        {
+            while ( !sv->quit && ProtoRecv ( hPipe, &sv->in ) )
+            {
+                ServeHandle ( sv, &sv->in, &sv->out );
+
+                if ( !ProtoSend ( hPipe, &sv->out ) )
+                    break;
+            }
+
+            FlushFileBuffers ( hPipe );
+        }
+
+        DisconnectNamedPipe ( hPipe );
+    }
+
+    CloseHandle ( hPipe );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeAnswer
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: SERVER * sv           : server
+//    Param.    2: const PROTO_REQ * hdr : request
+//    Param.    3: const WCHAR * path    : its folder, no trailing backslash
+//    Param.    4: PROTO_BUF * reply     : records go here
+//    Param.    5: PROTO_RESP * resp     : count and scanned filled in here
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the work behind ServeHandle, returns the PROTO_xxx status
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT ServeAnswer ( SERVER * sv, const PROTO_REQ * hdr,
+    const WCHAR * path, PROTO_BUF * reply, PROTO_RESP * resp )
+/*--------------------------------------------------------------------------*/
+{
+    SERVE_TREE  * st;
+    UINT        node;
+    int         t;
+
+    if ( hdr->op == PROTO_QUIT )
+    {
+        sv->quit = TRUE;
+        return PROTO_OK;
+    }
+
+    if ( path[0] == L'\0' )
+        return PROTO_BADREQ;
+
+    if ( hdr->op == PROTO_DROP )
+    {
+        t = ServeExact ( sv, path );
+
+        if ( t < 0 )
+            return PROTO_NOTFOUND;
+
+        ServeDrop ( sv, t );
+
+        return PROTO_OK;
+    }
+
+    if ( hdr->op < PROTO_SIZE || hdr->op > PROTO_SCAN )
+        return PROTO_BADREQ;
+
+    t = ( hdr->op == PROTO_SCAN ) ? -1 : ServeFind ( sv, path, &node );
+
+    // never seen it, or asked to: walk it now
+    if ( t < 0 )
+    {
+        if ( ServeScan ( sv, path ) < 0 )
+            return PROTO_NOROOT;
+
+        t = ServeFind ( sv, path, &node );
+    }
+
+    st              = sv->trees[t];
+    st->used        = sv->clock;
+    resp->scanned   = st->scanned;
+
+    if ( node == ENG_NONE )
+        return PROTO_NOTFOUND;
+
+    switch ( hdr->op )
+    {
+        case PROTO_CHILDREN:
+
+            if ( !ServeChildren ( reply, &st->eng, node, &resp->count ) )
+                return PROTO_NOMEM;
+
+            break;
+
+        case PROTO_TOP:
+
+            resp->count = hdr->count;
+
+            if ( !ServeTop ( reply, &st->eng, node, &resp->count ) )
+                return PROTO_NOMEM;
+
+            break;
+
+        default:
+            resp->count = 1;
+
+            if ( !ServePutNode ( reply, &st->eng, node, TRUE ) )
+                return PROTO_NOMEM;
+
+            break;
+    }
+
+    return PROTO_OK;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeFind
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: SERVER * sv        : server
+//    Param.    2: const WCHAR * path : full folder path, no trailing backslash
+//    Param.    3: UINT * node        : receives its node, or ENG_NONE
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: pick the tree with the deepest root holding path, then
+//                 walk down to it one component at a time. Returns the
+//                 tree index or -1 if no root holds it. Each step is one
+//                 hash probe, however many siblings there are.
+/*--------------------------------------------------------------------@@-@@-*/
+static int ServeFind ( SERVER * sv, const WCHAR * path, UINT * node )
+/*--------------------------------------------------------------------------*/
+{
+    const SERVE_TREE    * st;
+    const WCHAR         * p, * q;
+    UINT                i;
+    int                 t;
+
+    *node   = ENG_NONE;
+    t       = -1;
+
+    for ( i = 0; i < sv->ntrees; i++ )
+    {
+        st = sv->trees[i];
+
+        if ( _wcsnicmp ( path, st->root, st->rlen ) == 0 &&
+                ( path[st->rlen] == L'\0' || path[st->rlen] == L'\\' ||
+                  st->root[st->rlen-1] == L'\\' ) &&
+                ( t < 0 || st->rlen > sv->trees[t]->rlen ) )
+            t = (int)i;
+    }
+
+    if ( t < 0 )
+        return -1;
+
+    st      = sv->trees[t];
+    *node   = st->eng.roots[0].node;
+    p       = path + st->rlen;
+
+    while ( *node != ENG_NONE && *p != L'\0' )
+    {
+        while ( *p == L'\\' )
+            p++;
+
+        for ( q = p; *q != L'\0' && *q != L'\\'; q++ )
+            ;
+
+        if ( q != p )
+            *node = PathIdxChild ( &st->idx, &st->eng, *node, p,
+                (UINT)( q - p ) );
+
+        p = q;
+    }
+
+    return t;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeExact
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const SERVER * sv  : server
+//    Param.    2: const WCHAR * path : folder, no trailing backslash
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the tree rooted right at path, or -1
+/*--------------------------------------------------------------------@@-@@-*/
+static int ServeExact ( const SERVER * sv, const WCHAR * path )
+/*--------------------------------------------------------------------------*/
+{
+    UINT i;
+
+    for ( i = 0; i < sv->ntrees; i++ )
+        if ( _wcsicmp ( sv->trees[i]->root, path ) == 0 )
+            return (int)i;
+
+    return -1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeDrop
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: SERVER * sv : server
+//    Param.    2: int t       : tree to forget
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void ServeDrop ( SERVER * sv, int t )
+/*--------------------------------------------------------------------------*/
+{
+    PathIdxFree ( &sv->trees[t]->idx );
+    EngineFree ( &sv->trees[t]->eng );
+    free ( sv->trees[t] );
+
+    sv->trees[t] = sv->trees[--sv->ntrees];
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServePutNode
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PROTO_BUF * pb     : reply
+//    Param.    2: const ENGINE * eng : tree
+//    Param.    3: UINT node          : folder
+//    Param.    4: BOOL full          : full path, or just the name
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ServePutNode ( PROTO_BUF * pb, const ENGINE * eng, UINT node,
+    BOOL full )
+/*--------------------------------------------------------------------------*/
+{
+    PROTO_REC   rec;
+    WCHAR       buf[ENG_MAX_PATH];
+
+    RtlZeroMemory ( &rec, sizeof ( rec ) );
+
+    rec.size    = eng->size[node];
+    rec.own     = eng->own[node];
+    rec.folders = eng->nchild[node];
+    rec.files   = eng->files[node];
+
+    if ( !full )
+    {
+        rec.nlen = eng->nlen[node];
+        return ProtoPutRec ( pb, &rec, eng->names + eng->name[node] );
+    }
+
+    rec.nlen = EnginePath ( eng, node, buf, ARRAYSIZE(buf) );
+
+    return ProtoPutRec ( pb, &rec, buf );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeChildren
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PROTO_BUF * pb     : reply
+//    Param.    2: const ENGINE * eng : tree
+//    Param.    3: UINT node          : folder
+//    Param.    4: UINT * count       : receives the records put in
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: its subfolders, biggest first. They're allocated
+//                 together, so it's a single range of nodes.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ServeChildren ( PROTO_BUF * pb, const ENGINE * eng, UINT node,
+    UINT * count )
+/*--------------------------------------------------------------------------*/
+{
+    SERVE_PICK  * picks;
+    UINT        i, n;
+    BOOL        ok;
+
+    n       = eng->nchild[node];
+    *count  = 0;
+
+    if ( n == 0 )
+        return TRUE;
+
+    picks = malloc ( n * sizeof ( SERVE_PICK ) );
+
+    if ( picks == NULL )
+        return FALSE;
+
+    for ( i = 0; i < n; i++ )
+    {
+        picks[i].node = eng->first[node] + i;
+        picks[i].size = eng->size[picks[i].node];
+    }
+
+    qsort ( picks, n, sizeof ( SERVE_PICK ), ServeCompare );
+
+    for ( i = 0, ok = TRUE; i < n && ok; i++ )
+        ok = ServePutNode ( pb, eng, picks[i].node, FALSE );
+
+    free ( picks );
+
+    *count = n;
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeTop
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: PROTO_BUF * pb     : reply
+//    Param.    2: const ENGINE * eng : tree
+//    Param.    3: UINT node          : folder
+//    Param.    4: UINT * count       : in: how many wanted, out: put in
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the biggest folders anywhere below node, biggest first.
+//                 One pass over the subtree keeping the best ones in a
+//                 min-heap, so it costs the subtree size, not a sort of
+//                 it.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ServeTop ( PROTO_BUF * pb, const ENGINE * eng, UINT node,
+    UINT * count )
+/*--------------------------------------------------------------------------*/
+{
+    SERVE_PICK  * heap;
+    UINT        * stack, * tmp;
+    UINT        want, n, sp, cap, i, cur;
+    BOOL        ok;
+
+    want = *count;
+
+    if ( want == 0 || want > PROTO_MAX_TOP )
+        want = PROTO_MAX_TOP;
+
+    *count  = 0;
+    cap     = 1024;
+    heap    = malloc ( want * sizeof ( SERVE_PICK ) );
+    stack   = malloc ( cap * sizeof ( UINT ) );
+
+    if ( heap == NULL || stack == NULL )
+    {
+        free ( heap );
+        free ( stack );
+        return FALSE;
+    }
+
+    n           = 0;
+    sp          = 0;
+    stack[sp++] = node;
+    ok          = TRUE;
+
+    while ( sp != 0 && ok )
+    {
+        cur = stack[--sp];
+
+        if ( cur != node )
+        {
+            if ( n < want )
+            {
+                heap[n].size = eng->size[cur];
+                heap[n].node = cur;
+
+                if ( ++n == want )
+                    for ( i = want / 2; i-- != 0; )
+                        ServeSift ( heap, n, i );
+            }
+            else if ( eng->size[cur] > heap[0].size )
+            {
+                heap[0].size = eng->size[cur];
+                heap[0].node = cur;
+                ServeSift ( heap, n, 0 );
+            }
+        }
+
+        if ( sp + eng->nchild[cur] > cap )
+        {
+            while ( sp + eng->nchild[cur] > cap )
+                cap *= 2;
+
+            tmp = realloc ( stack, cap * sizeof ( UINT ) );
+
+            if ( tmp == NULL )
+            {
+                ok = FALSE;
+                break;
+            }
+
+            stack = tmp;
+        }
+
+        for ( i = 0; i < eng->nchild[cur]; i++ )
+            stack[sp++] = eng->first[cur] + i;
+    }
+
+    if ( ok )
+    {
+        qsort ( heap, n, sizeof ( SERVE_PICK ), ServeCompare );
+
+        for ( i = 0; i < n && ok; i++ )
+            ok = ServePutNode ( pb, eng, heap[i].node, TRUE );
+
+        *count = n;
+    }
+
+    free ( heap );
+    free ( stack );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeSift
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: SERVE_PICK * heap : min-heap by size
+//    Param.    2: UINT n            : its length
+//    Param.    3: UINT i            : element to push down
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void ServeSift ( SERVE_PICK * heap, UINT n, UINT i )
+/*--------------------------------------------------------------------------*/
+{
+    SERVE_PICK  tmp;
+    UINT        c;
+
+    for ( ;; )
+    {
+        c = 2 * i + 1;
+
+        if ( c >= n )
+            break;
+
+        if ( c + 1 < n && heap[c+1].size < heap[c].size )
+            c++;
+
+        if ( heap[i].size <= heap[c].size )
+            break;
+
+        tmp     = heap[i];
+        heap[i] = heap[c];
+        heap[c] = tmp;
+        i       = c;
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ServeCompare
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const void * a : SERVE_PICK
+//    Param.    2: const void * b : SERVE_PICK
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, biggest first
+/*--------------------------------------------------------------------@@-@@-*/
+static int ServeCompare ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    const SERVE_PICK * pa = a;
+    const SERVE_PICK * pb = b;
+
+    if ( pa->size != pb->size )
+        return ( pa->size < pb->size ) ? 1 : -1;
+
+    return ( pa->node < pb->node ) ? -1 : ( pa->node > pb->node );
+}
@@ -0,0 +1,51 @@
+
+// serve.h - fsize --serve, keeps walked trees in memory and answers
+// proto.h requests about them
+
+#ifndef _SERVE_H
+#define _SERVE_H
+
+#include <windows.h>
+#include "engine.h"
+#include "proto.h"
+#include "pathidx.h"
+
+// every tree reserves its own node columns, go easy on 32 bit
+#ifdef _WIN64
+    #define SERVE_MAX_TREES 32
+#else
+    #define SERVE_MAX_TREES 4
+#endif
+
+typedef struct _serve_tree
+{
+    ENGINE      eng;        // one root, walked
+    PATH_INDEX  idx;        // for looking folders up by path
+    const WCHAR * root;     // its path, eng.roots[0].path
+    UINT        rlen;
+    UINT64      scanned;    // FILETIME of the walk, UTC
+    UINT64      used;       // sv->clock at the last query, for eviction
+} SERVE_TREE;
+
+typedef struct _server
+{
+    SERVE_TREE  * trees[SERVE_MAX_TREES];
+    UINT        ntrees;
+    UINT        threads;    // passed on to EngineInit
+    UINT        max_depth;
+    const PAT_FILTER * filter; // optional --exclude/--include
+    UINT64      clock;      // requests served
+    BOOL        quit;       // PROTO_QUIT seen
+    PROTO_BUF   in;         // request being served
+    PROTO_BUF   out;        // its reply
+} SERVER;
+
+void    ServeInit       ( SERVER * sv, UINT threads, UINT max_depth,
+                            const PAT_FILTER * filter );
+void    ServeFree       ( SERVER * sv );
+int     ServeScan       ( SERVER * sv, const WCHAR * path );
+BOOL    ServeHandle     ( SERVER * sv, const PROTO_BUF * req,
+                            PROTO_BUF * reply );
+BOOL    ServeRun        ( SERVER * sv, const WCHAR * pipe );
+
+#endif // _SERVE_H
@@ -0,0 +1,541 @@
+
+// shard.c - splitting one walk over several fsize processes, and putting
+// their snapshots back together
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "shard.h"
+#include "pathidx.h"
+#include "agehist.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+// a folder in one of the snapshots being merged
+typedef struct _shard_src
+{
+    UINT        part;
+    UINT        node;
+} SHARD_SRC;
+
+// ShardMerge's state. src holds, for every merged folder in order, the
+// folders it was made of; start[n] is where node n's begin.
+typedef struct _shard_merge
+{
+    SNAPSHOT    * in;
+    UINT        nin;
+    ENGINE      out;
+    SHARD_SRC   * src;
+    UINT        nsrc;
+    UINT        src_cap;
+    SHARD_SRC   * cand;     // subfolders of one merged folder, all parts
+    UINT        ncand;
+    UINT        cand_cap;
+    UINT        * start;
+    UINT        start_cap;
+} SHARD_MERGE;
+
+static const ENGINE     * gPlanEng;     // for the qsort callbacks
+static const SNAPSHOT   * gMergeIn;
+
+static int __cdecl      ShardBySize     ( const void * a, const void * b );
+static int __cdecl      ShardByName     ( const void * a, const void * b );
+static BOOL             ShardPush       ( SHARD_SRC ** arr, UINT * n,
+                                            UINT * cap, UINT part,
+                                            UINT node );
+static BOOL             ShardEmit       ( SHARD_MERGE * m, UINT parent );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShardPlanInit
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: SHARD_PLAN * sp       : plan to fill
+//    Param.    2: UINT index            : this shard, 0 based
+//    Param.    3: UINT count            : how many shards
+//    Param.    4: UINT depth            : where the tree is cut, >= 1
+//    Param.    5: const SNAPSHOT * prev : older walk of the same roots,
+//                                         or NULL
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: with a snapshot, deal its folders at depth out biggest
+//                 first, each to the shard with the fewest bytes so far.
+//                 Ties go by node number, so every shard process comes up
+//                 with the same plan from the same file. Returns FALSE on
+//                 bad numbers or no memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ShardPlanInit ( SHARD_PLAN * sp, UINT index, UINT count, UINT depth,
+    const SNAPSHOT * prev )
+/*--------------------------------------------------------------------------*/
+{
+    const ENGINE    * pe;
+    UINT64          load[SHARD_MAX];
+    UINT            * list;
+    UINT            i, k, n, best;
+
+    if ( sp == NULL || count == 0 || count > SHARD_MAX || index >= count ||
+            depth == 0 )
+        return FALSE;
+
+    RtlZeroMemory ( sp, sizeof ( SHARD_PLAN ) );
+
+    sp->index   = index;
+    sp->count   = count;
+    sp->depth   = depth;
+
+    if ( prev == NULL || prev->view == NULL || count == 1 )
+        return TRUE;
+
+    pe          = &prev->eng;
+    sp->owner   = malloc ( (UINT_PTR)pe->count * sizeof ( USHORT ) + 1 );
+    list        = malloc ( (UINT_PTR)pe->count * sizeof ( UINT ) + 1 );
+
+    if ( sp->owner == NULL || list == NULL )
+    {
+        free ( list );
+        ShardPlanFree ( sp );
+        return FALSE;
+    }
+
+    sp->prev = prev;
+    FillMemory ( sp->owner, (UINT_PTR)pe->count * sizeof ( USHORT ), 0xFF );
+
+    for ( i = 0, n = 0; i < pe->count; i++ )
+        if ( pe->depth[i] == depth )
+            list[n++] = i;
+
+    gPlanEng = pe;
+    qsort ( list, n, sizeof ( UINT ), ShardBySize );
+
+    RtlZeroMemory ( load, sizeof ( load ) );
+
+    for ( i = 0; i < n; i++ )
+    {
+        for ( k = 1, best = 0; k < count; k++ )
+            if ( load[k] < load[best] )
+                best = k;
+
+        sp->owner[list[i]]  = (USHORT)best;
+        load[best]         += (UINT64)pe->size[list[i]];
+    }
+
+    free ( list );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShardPlanFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SHARD_PLAN * sp : from ShardPlanInit
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void ShardPlanFree ( SHARD_PLAN * sp )
+/*--------------------------------------------------------------------------*/
+{
+    if ( sp == NULL )
+        return;
+
+    free ( sp->owner );
+    RtlZeroMemory ( sp, sizeof ( SHARD_PLAN ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShardOwns
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const SHARD_PLAN * sp : plan
+//    Param.    2: const ENGINE * eng    : engine walking
+//    Param.    3: UINT parent           : folder being enumerated
+//    Param.    4: const WCHAR * name    : subfolder found in it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: is the subfolder this shard's to walk. Only folders at
+//                 the cut are looked at, by their path: the planned owner
+//                 if the snapshot has them, else a hash of the path below
+//                 the root (and the root's number), so it doesn't matter
+//                 where the volume is mounted. Safe from any worker.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ShardOwns ( const SHARD_PLAN * sp, const ENGINE * eng, UINT parent,
+    const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR   path[ENG_MAX_PATH];
+    UINT    len, nlen, root, rootlen, node;
+
+    if ( sp == NULL || sp->count <= 1 ||
+            (UINT)eng->depth[parent] + 1 != sp->depth )
+        return TRUE;
+
+    len     = EnginePath ( eng, parent, path, ENG_MAX_PATH );
+    nlen    = (UINT)wcslen ( name );
+
+    // too long to walk anyway, somebody has to count it as an error
+    if ( len == 0 || len + nlen + 2 > ENG_MAX_PATH )
+        return ( sp->index == 0 );
+
+    path[len] = L'\\';
+    wmemcpy ( path + len + 1, name, nlen + 1 );
+    len += nlen + 1;
+
+    if ( sp->owner != NULL )
+    {
+        node = PathIdxLookup ( &sp->prev->idx, &sp->prev->eng, path );
+
+        if ( node != ENG_NONE && sp->owner[node] != SHARD_HASH )
+            return ( sp->owner[node] == sp->index );
+    }
+
+    root    = EngineRootOf ( eng, parent );
+    rootlen = ( root != ENG_NONE ) ? eng->nlen[eng->roots[root].node] : 0;
+
+    return ( PathIdxHash ( root, path + rootlen, len - rootlen ) %
+        sp->count == sp->index );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShardMerge
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: const WCHAR * fname : snapshot to write
+//    Param.    2: WCHAR ** parts      : the shards' snapshots
+//    Param.    3: UINT nparts         : how many
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one tree out of the shards' partial ones. Folders are
+//                 matched by path, level by level: a merged folder's
+//                 subfolders are those of all the folders it came from,
+//                 put together by name, so each level is one merge of the
+//                 parts' sibling lists. Folders above the cut show up in
+//                 every part with the same files, their own bytes are
+//                 taken once; then the sizes are rolled up again, all the
+//                 way to the roots, and the age histograms if every part
+//                 has them. Returns the folders written, 0 if a part
+//                 can't be read or the result can't be saved.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT ShardMerge ( const WCHAR * fname, WCHAR ** parts, UINT nparts )
+/*--------------------------------------------------------------------------*/
+{
+    SHARD_MERGE     m;
+    PATH_INDEX      pi;
+    const ENGINE    * e;
+    UINT64          scanned;
+    UINT            p, i, o, s, c, count;
+    BOOL            ok, age;
+
+    if ( fname == NULL || parts == NULL || nparts == 0 )
+        return 0;
+
+    RtlZeroMemory ( &m, sizeof ( SHARD_MERGE ) );
+
+    m.in    = calloc ( nparts, sizeof ( SNAPSHOT ) );
+    m.nin   = nparts;
+
+    if ( m.in == NULL )
+        return 0;
+
+    ok      = TRUE;
+    age     = TRUE;
+    scanned = (UINT64)-1;
+
+    for ( p = 0; ok && p < nparts; p++ )
+    {
+        ok = SnapOpen ( &m.in[p], parts[p] );
+
+        // the oldest part says how fresh the whole is
+        if ( ok && m.in[p].scanned < scanned )
+            scanned = m.in[p].scanned;
+
+        age = age && m.in[p].eng.age;
+    }
+
+    if ( !ok || !EngineInit ( &m.out, 1, 0, age ? sizeof ( AGE_HIST ) :
+            0 ) )
+    {
+        for ( p = 0; p < nparts; p++ )
+            SnapClose ( &m.in[p] );
+
+        free ( m.in );
+        return 0;
+    }
+
+    m.out.age = age;
+
+    // the roots of all the parts, as the children of nothing
+    for ( p = 0; ok && p < nparts; p++ )
+    {
+        e = &m.in[p].eng;
+
+        for ( i = 0; ok && i < e->count && ( e->flags[i] & ENG_TOP ); i++ )
+            ok = ShardPush ( &m.cand, &m.ncand, &m.cand_cap, p, i );
+    }
+
+    ok = ok && ShardEmit ( &m, ENG_NONE );
+
+    // breadth first, out.count grows as we go
+    for ( o = 0; ok && o < m.out.count; o++ )
+    {
+        m.ncand = 0;
+
+        for ( s = m.start[o]; ok && s < m.start[o+1]; s++ )
+        {
+            e = &m.in[m.src[s].part].eng;
+
+            for ( i = 0; ok && i < e->nchild[m.src[s].node]; i++ )
+            {
+                c   = e->first[m.src[s].node] + i;
+                ok  = ShardPush ( &m.cand, &m.ncand, &m.cand_cap,
+                        m.src[s].part, c );
+            }
+        }
+
+        ok = ok && ShardEmit ( &m, o );
+    }
+
+    // the names are copied, the parts can go (fname may be one of them)
+    for ( p = 0; p < nparts; p++ )
+        SnapClose ( &m.in[p] );
+
+    // children always come after their parent
+    for ( o = m.out.count; ok && o--; )
+    {
+        m.out.flags[o] |= ENG_FINAL;
+
+        if ( m.out.parent[o] != ENG_NONE )
+        {
+            m.out.size[m.out.parent[o]]     += m.out.size[o];
+            m.out.tfiles[m.out.parent[o]]   += m.out.tfiles[o];
+            m.out.tdirs[m.out.parent[o]]    += m.out.tdirs[o] + 1;
+
+            if ( age )
+                AgeHistMerge ( EngineExtra ( &m.out, m.out.parent[o] ),
+                    EngineExtra ( &m.out, o ) );
+        }
+    }
+
+    count = 0;
+
+    if ( ok && PathIdxBuild ( &pi, &m.out ) )
+    {
+        if ( SnapSave ( &m.out, &pi, scanned, fname ) )
+            count = m.out.count;
+
+        PathIdxFree ( &pi );
+    }
+
+    free ( m.in );
+    free ( m.src );
+    free ( m.cand );
+    free ( m.start );
+    EngineFree ( &m.out );
+
+    return count;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShardEmit
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: SHARD_MERGE * m : merge, m->cand holds the subfolders
+//    Param.    2: UINT parent     : merged folder they go in
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: sort the candidates by name and make one merged folder
+//                 per name, remembering what went into it. Its own bytes
+//                 and files come from the first part that has it, its
+//                 mtime from the part with the newest. So do its own
+//                 files' ages: that part's histogram less its subfolders'
+//                 there, ShardMerge adds up the merged ones after.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ShardEmit ( SHARD_MERGE * m, UINT parent )
+/*--------------------------------------------------------------------------*/
+{
+    const ENGINE    * e, * f;
+    const WCHAR     * name;
+    const AGE_HIST  * sub;
+    AGE_HIST        * ah;
+    SHARD_SRC       * c;
+    UINT            * tmp;
+    UINT            i, j, k, b, node, cap;
+
+    gMergeIn = m->in;
+    qsort ( m->cand, m->ncand, sizeof ( SHARD_SRC ), ShardByName );
+
+    for ( i = 0; i < m->ncand; i = j )
+    {
+        c       = &m->cand[i];
+        e       = &m->in[c->part].eng;
+        node    = EngineAddNode ( &m->out, parent, e->names + e->name[c->node],
+                    e->nlen[c->node] );
+
+        if ( node == ENG_NONE )
+            return FALSE;
+
+        if ( node + 2 > m->start_cap )
+        {
+            cap = m->start_cap ? m->start_cap * 2 : 65536;
+            tmp = realloc ( m->start, (UINT_PTR)cap * sizeof ( UINT ) );
+
+            if ( tmp == NULL )
+                return FALSE;
+
+            m->start        = tmp;
+            m->start_cap    = cap;
+        }
+
+        m->start[node]      = m->nsrc;
+        m->out.own[node]    = e->own[c->node];
+        m->out.size[node]   = e->own[c->node];
+        m->out.files[node]  = e->files[c->node];
+        m->out.tfiles[node] = e->files[c->node];
+
+        if ( m->out.age )
+        {
+            ah = EngineExtra ( &m->out, node );
+            CopyMemory ( ah, EngineExtra ( e, c->node ), sizeof ( AGE_HIST ) );
+
+            for ( k = 0; k < e->nchild[c->node]; k++ )
+            {
+                sub = EngineExtra ( e, e->first[c->node] + k );
+
+                for ( b = 0; b < AGE_BUCKETS; b++ )
+                {
+                    ah->mbytes[b] -= sub->mbytes[b];
+                    ah->abytes[b] -= sub->abytes[b];
+                }
+            }
+        }
+
+        name = e->names + e->name[c->node];
+
+        for ( j = i; j < m->ncand; j++ )
+        {
+            c = &m->cand[j];
+            f = &m->in[c->part].eng;
+
+            if ( _wcsicmp ( name, f->names + f->name[c->node] ) != 0 )
+                break;
+
+            m->out.flags[node] |= f->flags[c->node] & ENG_ERROR;
+
+            // the newest below is the newest any part saw
+            if ( f->mtime[c->node] > m->out.mtime[node] )
+                m->out.mtime[node] = f->mtime[c->node];
+
+            if ( !ShardPush ( &m->src, &m->nsrc, &m->src_cap, c->part,
+                    c->node ) )
+                return FALSE;
+        }
+
+        m->start[node+1] = m->nsrc;
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShardPush
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: SHARD_SRC ** arr : growing array
+//    Param.    2: UINT * n         : in use
+//    Param.    3: UINT * cap       : allocated
+//    Param.    4: UINT part        : snapshot...
+//    Param.    5: UINT node        : ...and folder in it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ShardPush ( SHARD_SRC ** arr, UINT * n, UINT * cap, UINT part,
+    UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    SHARD_SRC   * tmp;
+    UINT        want;
+
+    if ( *n == *cap )
+    {
+        want    = *cap ? *cap * 2 : 4096;
+        tmp     = realloc ( *arr, (UINT_PTR)want * sizeof ( SHARD_SRC ) );
+
+        if ( tmp == NULL )
+            return FALSE;
+
+        *arr    = tmp;
+        *cap    = want;
+    }
+
+    (*arr)[*n].part = part;
+    (*arr)[*n].node = node;
+    (*n)++;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShardBySize
+/*--------------------------------------------------------------------------*/
+//           Type: static int __cdecl
+//    Param.    1: const void * a : node in gPlanEng
+//    Param.    2: const void * b : another
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, biggest first, then by node number
+/*--------------------------------------------------------------------@@-@@-*/
+static int __cdecl ShardBySize ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    x, y;
+
+    x = *(const UINT *)a;
+    y = *(const UINT *)b;
+
+    if ( gPlanEng->size[x] != gPlanEng->size[y] )
+        return ( gPlanEng->size[x] > gPlanEng->size[y] ) ? -1 : 1;
+
+    return ( x < y ) ? -1 : ( x > y );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShardByName
+/*--------------------------------------------------------------------------*/
+//           Type: static int __cdecl
+//    Param.    1: const void * a : SHARD_SRC, in gMergeIn
+//    Param.    2: const void * b : another
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, by name (case insensitive), then by
+//                 part, so the first part's folder leads its group
+/*--------------------------------------------------------------------@@-@@-*/
+static int __cdecl ShardByName ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    const SHARD_SRC * x, * y;
+    const ENGINE    * ex, * ey;
+    int             r;
+
+    x   = a;
+    y   = b;
+    ex  = &gMergeIn[x->part].eng;
+    ey  = &gMergeIn[y->part].eng;
+
+    r = _wcsicmp ( ex->names + ex->name[x->node],
+        ey->names + ey->name[y->node] );
+
+    if ( r != 0 )
+        return r;
+
+    if ( x->part != y->part )
+        return ( x->part < y->part ) ? -1 : 1;
+
+    return ( x->node < y->node ) ? -1 : ( x->node > y->node );
+}
@@ -0,0 +1,38 @@
+
+// shard.h - splitting one walk over several fsize processes, and putting
+// their snapshots back together
+
+#ifndef _SHARD_H
+#define _SHARD_H
+
+#include <windows.h>
+#include "engine.h"
+#include "snap.h"
+
+#define SHARD_MAX           256
+#define SHARD_HASH          0xFFFF  // owner not planned, hash the path
+
+// Which folders one shard walks. The tree is cut at depth (1 = the
+// roots' subfolders): every shard walks the folders above it, each
+// folder at it goes to exactly one shard, with all below. The owner is
+// planned from an older snapshot, if given, so the shards get about the
+// same bytes each; folders it doesn't know go by a hash of their path.
+// All shards must be given the same roots, count, depth and snapshot.
+typedef struct _shard_plan
+{
+    UINT        index;      // this shard, 0 based
+    UINT        count;      // of this many
+    UINT        depth;
+    const SNAPSHOT * prev;  // optional, sizes to balance by
+    USHORT      * owner;    // per prev node, SHARD_HASH if not planned
+} SHARD_PLAN;
+
+BOOL    ShardPlanInit   ( SHARD_PLAN * sp, UINT index, UINT count,
+                            UINT depth, const SNAPSHOT * prev );
+void    ShardPlanFree   ( SHARD_PLAN * sp );
+BOOL    ShardOwns       ( const SHARD_PLAN * sp, const ENGINE * eng,
+                            UINT parent, const WCHAR * name );
+UINT    ShardMerge      ( const WCHAR * fname, WCHAR ** parts,
+                            UINT nparts );
+
+#endif // _SHARD_H
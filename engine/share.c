@@ -0,0 +1,394 @@
+
+// share.c - a walk's node columns in a named shared section, for viewers
+// in other processes to read as the nodes come in
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "share.h"
+#include <windows.h>
+#include <strsafe.h>
+#include <wchar.h>
+
+#define SHARE_ALIGN         4096    // columns start on a page
+
+static void             ShareLayout     ( UINT64 * off, UINT64 * total );
+static BOOL             ShareName       ( WCHAR * buf, UINT cch,
+                                            const WCHAR * name );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShareCreate
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: SHARE * sh        : receives the section
+//    Param.    2: ENGINE * eng      : engine, after EngineInit, before
+//                                     EngineRun
+//    Param.    3: const WCHAR * name: what viewers open it by
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: make a pagefile backed section, reserved only, big
+//                 enough for all the columns at ENG_MAX_NODES, and move
+//                 the engine's columns into it. The engine commits pages
+//                 as it grows, as it would its own, so there's no copy:
+//                 what the walk writes is what the viewers read. Returns
+//                 FALSE if the name is taken or the section can't be had.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ShareCreate ( SHARE * sh, ENGINE * eng, const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR       full[MAX_PATH];
+    UINT64      off[SNAP_SECTIONS], total;
+    BYTE        * view;
+    FILETIME    ft;
+    BOOL        ok;
+
+    if ( sh == NULL || eng == NULL || !ShareName ( full, MAX_PATH, name ) )
+        return FALSE;
+
+    RtlZeroMemory ( sh, sizeof ( SHARE ) );
+    ShareLayout ( off, &total );
+
+    if ( total > (SIZE_T)-1 )
+        return FALSE;
+
+    sh->hMap = CreateFileMappingW ( INVALID_HANDLE_VALUE, NULL,
+        PAGE_READWRITE | SEC_RESERVE, (DWORD)( total >> 32 ), (DWORD)total,
+        full );
+
+    if ( sh->hMap != NULL && GetLastError ( ) == ERROR_ALREADY_EXISTS )
+    {
+        ShareFree ( sh );
+        return FALSE;
+    }
+
+    if ( sh->hMap != NULL )
+        sh->hdr = MapViewOfFile ( sh->hMap, FILE_MAP_WRITE, 0, 0, 0 );
+
+    view = (BYTE *)sh->hdr;
+
+    if ( view == NULL || VirtualAlloc ( view, sizeof ( SHARE_HEADER ),
+            MEM_COMMIT, PAGE_READWRITE ) == NULL )
+    {
+        ShareFree ( sh );
+        return FALSE;
+    }
+
+    ok = EnginePlace ( eng, &eng->parent, view + off[SNAP_PARENT] ) &&
+        EnginePlace ( eng, &eng->first, view + off[SNAP_FIRST] ) &&
+        EnginePlace ( eng, &eng->nchild, view + off[SNAP_NCHILD] ) &&
+        EnginePlace ( eng, &eng->name, view + off[SNAP_NAME] ) &&
+        EnginePlace ( eng, &eng->nlen, view + off[SNAP_NLEN] ) &&
+        EnginePlace ( eng, &eng->depth, view + off[SNAP_DEPTH] ) &&
+        EnginePlace ( eng, &eng->flags, view + off[SNAP_FLAGS] ) &&
+        EnginePlace ( eng, &eng->own, view + off[SNAP_OWN] ) &&
+        EnginePlace ( eng, &eng->size, view + off[SNAP_SIZE] ) &&
+        EnginePlace ( eng, &eng->files, view + off[SNAP_FILES] ) &&
+        EnginePlace ( eng, &eng->mtime, view + off[SNAP_MTIME] ) &&
+        EnginePlace ( eng, &eng->tfiles, view + off[SNAP_TFILES] ) &&
+        EnginePlace ( eng, &eng->tdirs, view + off[SNAP_TDIRS] ) &&
+        EnginePlace ( eng, &eng->names, view + off[SNAP_NAMES] );
+
+    // a half placed engine is no good to anyone, the caller gives up
+    // on it too
+    if ( !ok )
+    {
+        ShareFree ( sh );
+        return FALSE;
+    }
+
+    GetSystemTimeAsFileTime ( &ft );
+
+    CopyMemory ( sh->hdr->off, off, sizeof ( off ) );
+    sh->hdr->version    = SHARE_VERSION;
+    sh->hdr->max_nodes  = ENG_MAX_NODES;
+    sh->hdr->pid        = GetCurrentProcessId ( );
+    sh->hdr->scanned    = ( (UINT64)ft.dwHighDateTime << 32 ) |
+                            ft.dwLowDateTime;
+
+    // viewers check the magic first, it goes out after the rest
+    InterlockedExchange ( (LONG *)&sh->hdr->magic, SHARE_MAGIC );
+
+    eng->publish = &sh->hdr->count;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShareDone
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SHARE * sh        : from ShareCreate
+//    Param.    2: const ENGINE * eng: its engine, done walking
+//    Param.    3: BOOL ok           : EngineRun's answer
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: put the totals in and tell the viewers it's over.
+/*--------------------------------------------------------------------@@-@@-*/
+void ShareDone ( SHARE * sh, const ENGINE * eng, BOOL ok )
+/*--------------------------------------------------------------------------*/
+{
+    if ( sh == NULL || sh->hdr == NULL || eng == NULL )
+        return;
+
+    sh->hdr->files  = (UINT64)eng->total_files;
+    sh->hdr->dirs   = (UINT64)eng->total_dirs;
+
+    InterlockedExchange ( &sh->hdr->count, (LONG)eng->count );
+    InterlockedExchange ( &sh->hdr->state, ok ? SHARE_DONE : SHARE_ABORTED );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShareFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SHARE * sh : from ShareCreate
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the engine placed in it can't be used after this, free
+//                 it first. Viewers still mapping the section keep it.
+/*--------------------------------------------------------------------@@-@@-*/
+void ShareFree ( SHARE * sh )
+/*--------------------------------------------------------------------------*/
+{
+    if ( sh == NULL )
+        return;
+
+    if ( sh->hdr != NULL )
+        UnmapViewOfFile ( sh->hdr );
+
+    if ( sh->hMap != NULL )
+        CloseHandle ( sh->hMap );
+
+    RtlZeroMemory ( sh, sizeof ( SHARE ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShareOpen
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: SHARE_VIEW * sv   : receives the view
+//    Param.    2: const WCHAR * name: as given to ShareCreate
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: map a walk read-only and point the columns at it, with
+//                 no nodes yet; ShareSync brings them in. Returns FALSE if
+//                 there's no such walk or it doesn't look right.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ShareOpen ( SHARE_VIEW * sv, const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR               full[MAX_PATH];
+    UINT64              off[SNAP_SECTIONS], total;
+    const BYTE          * view;
+    ENGINE              * eng;
+    MEMORY_BASIC_INFORMATION mbi;
+    UINT                i;
+
+    if ( sv == NULL || !ShareName ( full, MAX_PATH, name ) )
+        return FALSE;
+
+    RtlZeroMemory ( sv, sizeof ( SHARE_VIEW ) );
+
+    sv->hMap = OpenFileMappingW ( FILE_MAP_READ, FALSE, full );
+
+    if ( sv->hMap != NULL )
+        sv->hdr = MapViewOfFile ( sv->hMap, FILE_MAP_READ, 0, 0, 0 );
+
+    // the walker may have the section but not the header yet
+    if ( sv->hdr == NULL ||
+            VirtualQuery ( sv->hdr, &mbi, sizeof ( mbi ) ) == 0 ||
+            mbi.State != MEM_COMMIT || sv->hdr->magic != SHARE_MAGIC )
+    {
+        ShareClose ( sv );
+        return FALSE;
+    }
+
+    MemoryBarrier ( );
+    ShareLayout ( off, &total );
+
+    // same build on both ends, same layout
+    if ( sv->hdr->version != SHARE_VERSION ||
+            sv->hdr->max_nodes != ENG_MAX_NODES )
+    {
+        ShareClose ( sv );
+        return FALSE;
+    }
+
+    for ( i = 0; i < SNAP_SECTIONS; i++ )
+        if ( sv->hdr->off[i] != off[i] )
+        {
+            ShareClose ( sv );
+            return FALSE;
+        }
+
+    view    = (const BYTE *)sv->hdr;
+    eng     = &sv->eng;
+
+    eng->parent     = (UINT *)( view + off[SNAP_PARENT] );
+    eng->first      = (UINT *)( view + off[SNAP_FIRST] );
+    eng->nchild     = (UINT *)( view + off[SNAP_NCHILD] );
+    eng->name       = (UINT *)( view + off[SNAP_NAME] );
+    eng->nlen       = (USHORT *)( view + off[SNAP_NLEN] );
+    eng->depth      = (USHORT *)( view + off[SNAP_DEPTH] );
+    eng->flags      = (BYTE *)( view + off[SNAP_FLAGS] );
+    eng->own        = (__int64 *)( view + off[SNAP_OWN] );
+    eng->size       = (__int64 *)( view + off[SNAP_SIZE] );
+    eng->files      = (UINT *)( view + off[SNAP_FILES] );
+    eng->mtime      = (__int64 *)( view + off[SNAP_MTIME] );
+    eng->tfiles     = (__int64 *)( view + off[SNAP_TFILES] );
+    eng->tdirs      = (UINT *)( view + off[SNAP_TDIRS] );
+    eng->names      = (WCHAR *)( view + off[SNAP_NAMES] );
+
+    // no handle is fine, we just won't notice it dying
+    sv->hProc = OpenProcess ( SYNCHRONIZE, FALSE, sv->hdr->pid );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShareSync
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: SHARE_VIEW * sv : from ShareOpen
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: catch up with the walker: sv->eng.count goes to the
+//                 published count, nodes from the old count on are new.
+//                 Returns the SHARE_xxx state as it was before the count
+//                 was read, so once it's not SHARE_RUNNING this count is
+//                 the last. A node's size can be read once its flags have
+//                 ENG_FINAL, with a MemoryBarrier in between.
+/*--------------------------------------------------------------------@@-@@-*/
+int ShareSync ( SHARE_VIEW * sv )
+/*--------------------------------------------------------------------------*/
+{
+    int     state;
+    LONG    count;
+
+    if ( sv == NULL || sv->hdr == NULL )
+        return SHARE_GONE;
+
+    state = sv->hdr->state;
+
+    // it had no time to say it's done
+    if ( state == SHARE_RUNNING && sv->hProc != NULL &&
+            WaitForSingleObject ( sv->hProc, 0 ) == WAIT_OBJECT_0 )
+        state = SHARE_GONE;
+
+    MemoryBarrier ( );
+    count = sv->hdr->count;
+    MemoryBarrier ( );
+
+    if ( (UINT)count <= sv->hdr->max_nodes )
+    {
+        sv->eng.count       = (UINT)count;
+        sv->eng.committed   = (UINT)count;
+    }
+
+    return state;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShareClose
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SHARE_VIEW * sv : from ShareOpen
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void ShareClose ( SHARE_VIEW * sv )
+/*--------------------------------------------------------------------------*/
+{
+    if ( sv == NULL )
+        return;
+
+    if ( sv->hdr != NULL )
+        UnmapViewOfFile ( sv->hdr );
+
+    if ( sv->hMap != NULL )
+        CloseHandle ( sv->hMap );
+
+    if ( sv->hProc != NULL )
+        CloseHandle ( sv->hProc );
+
+    RtlZeroMemory ( sv, sizeof ( SHARE_VIEW ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShareLayout
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: UINT64 * off   : receives SNAP_SECTIONS offsets
+//    Param.    2: UINT64 * total : receives the section size
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: where the columns go, the same for every walker and
+//                 viewer of one build.
+/*--------------------------------------------------------------------@@-@@-*/
+static void ShareLayout ( UINT64 * off, UINT64 * total )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  size[SNAP_SECTIONS], pos;
+    UINT    i;
+
+    size[SNAP_PARENT]   = sizeof ( UINT );
+    size[SNAP_FIRST]    = sizeof ( UINT );
+    size[SNAP_NCHILD]   = sizeof ( UINT );
+    size[SNAP_NAME]     = sizeof ( UINT );
+    size[SNAP_NLEN]     = sizeof ( USHORT );
+    size[SNAP_DEPTH]    = sizeof ( USHORT );
+    size[SNAP_FLAGS]    = sizeof ( BYTE );
+    size[SNAP_OWN]      = sizeof ( __int64 );
+    size[SNAP_SIZE]     = sizeof ( __int64 );
+    size[SNAP_FILES]    = sizeof ( UINT );
+    size[SNAP_MTIME]    = sizeof ( __int64 );
+    size[SNAP_TFILES]   = sizeof ( __int64 );
+    size[SNAP_TDIRS]    = sizeof ( UINT );
+
+    for ( i = 0; i <= SNAP_TDIRS; i++ )
+        size[i] *= ENG_MAX_NODES;
+
+    size[SNAP_NAMES]    = (UINT64)ENG_MAX_CHARS * sizeof ( WCHAR );
+    size[SNAP_SLOTS]    = 0;
+    size[SNAP_AGE]      = 0;
+
+    pos = ( sizeof ( SHARE_HEADER ) + SHARE_ALIGN - 1 ) &
+            ~(UINT64)( SHARE_ALIGN - 1 );
+
+    for ( i = 0; i < SNAP_SECTIONS; i++ )
+    {
+        off[i]  = pos;
+        pos     = ( pos + size[i] + SHARE_ALIGN - 1 ) &
+                    ~(UINT64)( SHARE_ALIGN - 1 );
+    }
+
+    *total = pos;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShareName
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: WCHAR * buf        : receives the object name
+//    Param.    2: UINT cch           : its size, in chars
+//    Param.    3: const WCHAR * name : what the user called it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL ShareName ( WCHAR * buf, UINT cch, const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    if ( name == NULL || *name == L'\0' || wcschr ( name, L'\\' ) != NULL )
+        return FALSE;
+
+    return SUCCEEDED ( StringCchPrintfW ( buf, cch, L"%ls%ls",
+        SHARE_PREFIX, name ) );
+}
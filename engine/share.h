@@ -0,0 +1,63 @@
+
+// share.h - a walk's node columns in a named shared section, for viewers
+// in other processes to read as the nodes come in
+
+#ifndef _SHARE_H
+#define _SHARE_H
+
+#include <windows.h>
+#include "engine.h"
+#include "snap.h"
+
+#define SHARE_MAGIC         0x52414853  // "SHAR"
+#define SHARE_VERSION       4
+#define SHARE_PREFIX        L"Local\\fsize-"
+
+#define SHARE_RUNNING       0
+#define SHARE_DONE          1   // walked all the way
+#define SHARE_ABORTED       2
+#define SHARE_GONE          3   // the walker died, not in the header
+
+// Section layout: this header, then the columns at off[], the same
+// SNAP_xxx sections a snapshot has (no SNAP_SLOTS or SNAP_AGE), each
+// with room for max_nodes. Only what's below count is committed and
+// meant to be read.
+typedef struct _share_header
+{
+    UINT32          magic;      // SHARE_MAGIC, set last
+    UINT32          version;    // SHARE_VERSION
+    UINT32          max_nodes;
+    UINT32          pid;        // the walker
+    volatile LONG   count;      // published nodes, see ENGINE.publish
+    volatile LONG   state;      // SHARE_xxx
+    UINT64          scanned;    // FILETIME the walk started, UTC
+    UINT64          files;      // totals, once state is SHARE_DONE
+    UINT64          dirs;
+    UINT64          off[SNAP_SECTIONS];
+} SHARE_HEADER;
+
+// the walker's end
+typedef struct _share
+{
+    SHARE_HEADER    * hdr;      // start of the view
+    HANDLE          hMap;
+} SHARE;
+
+// A viewer's end. eng has its columns pointing into the read-only view
+// and count as of the last ShareSync; never EngineFree it.
+typedef struct _share_view
+{
+    ENGINE          eng;
+    const SHARE_HEADER * hdr;
+    HANDLE          hMap;
+    HANDLE          hProc;      // the walker, to tell if it's gone
+} SHARE_VIEW;
+
+BOOL    ShareCreate     ( SHARE * sh, ENGINE * eng, const WCHAR * name );
+void    ShareDone       ( SHARE * sh, const ENGINE * eng, BOOL ok );
+void    ShareFree       ( SHARE * sh );
+BOOL    ShareOpen       ( SHARE_VIEW * sv, const WCHAR * name );
+int     ShareSync       ( SHARE_VIEW * sv );
+void    ShareClose      ( SHARE_VIEW * sv );
+
+#endif // _SHARE_H
@@ -0,0 +1,413 @@
+
+// snap.c - scan snapshots, written after a walk, mapped read-only later
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "snap.h"
+#include "agehist.h"
+#include <windows.h>
+#include <wchar.h>
+
+#define SNAP_ALIGN(x)       ( ( (x) + 7 ) & ~(UINT64)7 )
+#define SNAP_CHUNK          (64*1024*1024)  // biggest single WriteFile
+#define SNAP_AGE_RUN        128             // histograms put together
+                                            // for one WriteFile
+#define SNAP_HEADER_V3      ( sizeof ( SNAP_HEADER ) - sizeof ( UINT64 ) )
+
+static BOOL     SnapWrite       ( HANDLE hFile, const void * data,
+                                    UINT64 len );
+static BOOL     SnapWriteAge    ( HANDLE hFile, const ENGINE * eng );
+static void     SnapLengths     ( const SNAP_HEADER * hdr, UINT64 * len );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SnapSave
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const ENGINE * eng    : engine, done walking
+//    Param.    2: const PATH_INDEX * pi : its index, from PathIdxBuild
+//    Param.    3: UINT64 scanned        : FILETIME of the walk
+//    Param.    4: const WCHAR * fname   : file to write
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: dump the columns, names and index as they are in
+//                 memory, and with eng->age the histograms out of the
+//                 extra data. Goes to fname.tmp first and is renamed over
+//                 fname only when complete, so a reader never sees half
+//                 a snapshot.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL SnapSave ( const ENGINE * eng, const PATH_INDEX * pi, UINT64 scanned,
+    const WCHAR * fname )
+/*--------------------------------------------------------------------------*/
+{
+    static const BYTE   zero[8] = { 0 };
+    SNAP_HEADER         hdr;
+    const void          * src[SNAP_SECTIONS];
+    UINT64              len[SNAP_SECTIONS];
+    WCHAR               tmp[ENG_MAX_PATH+8];
+    HANDLE              hFile;
+    UINT_PTR            flen;
+    UINT                i;
+    BOOL                ok;
+
+    if ( eng == NULL || pi == NULL || fname == NULL )
+        return FALSE;
+
+    flen = wcslen ( fname );
+
+    if ( flen + 5 > ARRAYSIZE(tmp) )
+        return FALSE;
+
+    wmemcpy ( tmp, fname, flen );
+    wmemcpy ( tmp + flen, L".tmp", 5 );
+
+    RtlZeroMemory ( &hdr, sizeof ( hdr ) );
+
+    hdr.magic       = SNAP_MAGIC;
+    hdr.version     = SNAP_VERSION;
+    hdr.count       = eng->count;
+    hdr.names_len   = eng->names_len;
+    hdr.nslots      = pi->nslots;
+    hdr.flags       = eng->age ? SNAP_HAS_AGE : 0;
+    hdr.scanned     = scanned;
+
+    src[SNAP_PARENT]    = eng->parent;
+    src[SNAP_FIRST]     = eng->first;
+    src[SNAP_NCHILD]    = eng->nchild;
+    src[SNAP_NAME]      = eng->name;
+    src[SNAP_NLEN]      = eng->nlen;
+    src[SNAP_DEPTH]     = eng->depth;
+    src[SNAP_FLAGS]     = eng->flags;
+    src[SNAP_OWN]       = eng->own;
+    src[SNAP_SIZE]      = eng->size;
+    src[SNAP_FILES]     = eng->files;
+    src[SNAP_MTIME]     = eng->mtime;
+    src[SNAP_TFILES]    = eng->tfiles;
+    src[SNAP_TDIRS]     = eng->tdirs;
+    src[SNAP_NAMES]     = eng->names;
+    src[SNAP_SLOTS]     = pi->slots;
+    src[SNAP_AGE]       = NULL;     // strided, see SnapWriteAge
+
+    SnapLengths ( &hdr, len );
+    SnapLayout ( &hdr );
+
+    hFile = CreateFileW ( tmp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+
+    if ( hFile == INVALID_HANDLE_VALUE )
+        return FALSE;
+
+    ok  = SnapWrite ( hFile, &hdr, sizeof ( hdr ) ) &&
+        SnapWrite ( hFile, zero, SNAP_ALIGN ( sizeof ( hdr ) ) -
+            sizeof ( hdr ) );
+
+    for ( i = 0; i < SNAP_SECTIONS && ok; i++ )
+        ok = ( ( i == SNAP_AGE && len[i] != 0 ) ?
+            SnapWriteAge ( hFile, eng ) : SnapWrite ( hFile, src[i],
+            len[i] ) ) &&
+            SnapWrite ( hFile, zero, SNAP_ALIGN ( len[i] ) - len[i] );
+
+    CloseHandle ( hFile );
+
+    if ( ok )
+        ok = MoveFileExW ( tmp, fname, MOVEFILE_REPLACE_EXISTING );
+
+    if ( !ok )
+        DeleteFileW ( tmp );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SnapOpen
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: SNAPSHOT * snap    : receives the mapped snapshot
+//    Param.    2: const WCHAR * fname: file from SnapSave
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: map the file read-only and point the columns at it.
+//                 Nothing is read or copied here, pages come in as
+//                 they're touched. The header and section bounds are
+//                 checked against the file size; the nodes themselves
+//                 are trusted, as written by SnapSave. A version 3 file
+//                 is read too, as one without SNAP_AGE. Returns FALSE if
+//                 the file can't be mapped or doesn't look right.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL SnapOpen ( SNAPSHOT * snap, const WCHAR * fname )
+/*--------------------------------------------------------------------------*/
+{
+    const SNAP_HEADER   * hdr;
+    SNAP_HEADER         h;
+    LARGE_INTEGER       fsize;
+    UINT64              need[SNAP_SECTIONS];
+    ENGINE              * eng;
+    UINT_PTR            hlen;
+    UINT                i;
+
+    if ( snap == NULL || fname == NULL )
+        return FALSE;
+
+    RtlZeroMemory ( snap, sizeof ( SNAPSHOT ) );
+
+    snap->hFile = CreateFileW ( fname, GENERIC_READ, FILE_SHARE_READ |
+        FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+    if ( snap->hFile == INVALID_HANDLE_VALUE )
+    {
+        snap->hFile = NULL;
+        return FALSE;
+    }
+
+    if ( !GetFileSizeEx ( snap->hFile, &fsize ) ||
+            fsize.QuadPart < (LONGLONG)SNAP_HEADER_V3 ||
+            (UINT64)fsize.QuadPart > (SIZE_T)-1 )
+    {
+        SnapClose ( snap );
+        return FALSE;
+    }
+
+    snap->hMap = CreateFileMappingW ( snap->hFile, NULL, PAGE_READONLY,
+        0, 0, NULL );
+
+    if ( snap->hMap != NULL )
+        snap->view = MapViewOfFile ( snap->hMap, FILE_MAP_READ, 0, 0, 0 );
+
+    if ( snap->view == NULL )
+    {
+        SnapClose ( snap );
+        return FALSE;
+    }
+
+    // a copy, so an older header reads as one with empty sections after
+    hlen = ( ( (const SNAP_HEADER *)snap->view )->version ==
+        SNAP_VERSION_MIN ) ? SNAP_HEADER_V3 : sizeof ( SNAP_HEADER );
+
+    if ( (UINT64)fsize.QuadPart < hlen )
+    {
+        SnapClose ( snap );
+        return FALSE;
+    }
+
+    RtlZeroMemory ( &h, sizeof ( h ) );
+    CopyMemory ( &h, snap->view, hlen );
+
+    if ( h.version == SNAP_VERSION_MIN )
+        h.flags = 0;
+
+    hdr = &h;
+
+    SnapLengths ( hdr, need );
+
+    // the index needs a free slot to stop a probe
+    if ( hdr->magic != SNAP_MAGIC || hdr->version < SNAP_VERSION_MIN ||
+            hdr->version > SNAP_VERSION ||
+            hdr->file_size != (UINT64)fsize.QuadPart ||
+            hdr->count > ENG_MAX_NODES || hdr->nslots <= hdr->count ||
+            ( hdr->nslots & ( hdr->nslots - 1 ) ) != 0 )
+    {
+        SnapClose ( snap );
+        return FALSE;
+    }
+
+    for ( i = 0; i < SNAP_SECTIONS; i++ )
+        if ( ( hdr->off[i] & 7 ) != 0 || hdr->off[i] > hdr->file_size ||
+                need[i] > hdr->file_size - hdr->off[i] )
+        {
+            SnapClose ( snap );
+            return FALSE;
+        }
+
+    eng = &snap->eng;
+
+    eng->parent     = (UINT *)( snap->view + hdr->off[SNAP_PARENT] );
+    eng->first      = (UINT *)( snap->view + hdr->off[SNAP_FIRST] );
+    eng->nchild     = (UINT *)( snap->view + hdr->off[SNAP_NCHILD] );
+    eng->name       = (UINT *)( snap->view + hdr->off[SNAP_NAME] );
+    eng->nlen       = (USHORT *)( snap->view + hdr->off[SNAP_NLEN] );
+    eng->depth      = (USHORT *)( snap->view + hdr->off[SNAP_DEPTH] );
+    eng->flags      = (BYTE *)( snap->view + hdr->off[SNAP_FLAGS] );
+    eng->own        = (__int64 *)( snap->view + hdr->off[SNAP_OWN] );
+    eng->size       = (__int64 *)( snap->view + hdr->off[SNAP_SIZE] );
+    eng->files      = (UINT *)( snap->view + hdr->off[SNAP_FILES] );
+    eng->mtime      = (__int64 *)( snap->view + hdr->off[SNAP_MTIME] );
+    eng->tfiles     = (__int64 *)( snap->view + hdr->off[SNAP_TFILES] );
+    eng->tdirs      = (UINT *)( snap->view + hdr->off[SNAP_TDIRS] );
+    eng->names      = (WCHAR *)( snap->view + hdr->off[SNAP_NAMES] );
+    eng->count      = hdr->count;
+    eng->committed  = hdr->count;
+    eng->names_len  = hdr->names_len;
+
+    if ( hdr->flags & SNAP_HAS_AGE )
+    {
+        eng->extra      = (BYTE *)( snap->view + hdr->off[SNAP_AGE] );
+        eng->extra_size = sizeof ( AGE_HIST );
+        eng->age        = TRUE;
+    }
+
+    snap->idx.slots     = (UINT *)( snap->view + hdr->off[SNAP_SLOTS] );
+    snap->idx.nslots    = hdr->nslots;
+    snap->scanned       = hdr->scanned;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SnapClose
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SNAPSHOT * snap : from SnapOpen
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void SnapClose ( SNAPSHOT * snap )
+/*--------------------------------------------------------------------------*/
+{
+    if ( snap == NULL )
+        return;
+
+    if ( snap->view != NULL )
+        UnmapViewOfFile ( snap->view );
+
+    if ( snap->hMap != NULL )
+        CloseHandle ( snap->hMap );
+
+    if ( snap->hFile != NULL )
+        CloseHandle ( snap->hFile );
+
+    RtlZeroMemory ( snap, sizeof ( SNAPSHOT ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SnapLayout
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SNAP_HEADER * hdr : count, names_len and nslots set
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: fill in the section offsets and the file size, for
+//                 anything writing a snapshot
+/*--------------------------------------------------------------------@@-@@-*/
+void SnapLayout ( SNAP_HEADER * hdr )
+/*--------------------------------------------------------------------------*/
+{
+    UINT64  len[SNAP_SECTIONS];
+    UINT64  pos;
+    UINT    i;
+
+    SnapLengths ( hdr, len );
+
+    pos = SNAP_ALIGN ( sizeof ( SNAP_HEADER ) );
+
+    for ( i = 0; i < SNAP_SECTIONS; i++ )
+    {
+        hdr->off[i] = pos;
+        pos         = SNAP_ALIGN ( pos + len[i] );
+    }
+
+    hdr->file_size = pos;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SnapLengths
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const SNAP_HEADER * hdr : counts
+//    Param.    2: UINT64 * len            : SNAP_SECTIONS byte counts
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void SnapLengths ( const SNAP_HEADER * hdr, UINT64 * len )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    i;
+
+    len[SNAP_PARENT]    = sizeof ( UINT );
+    len[SNAP_FIRST]     = sizeof ( UINT );
+    len[SNAP_NCHILD]    = sizeof ( UINT );
+    len[SNAP_NAME]      = sizeof ( UINT );
+    len[SNAP_NLEN]      = sizeof ( USHORT );
+    len[SNAP_DEPTH]     = sizeof ( USHORT );
+    len[SNAP_FLAGS]     = sizeof ( BYTE );
+    len[SNAP_OWN]       = sizeof ( __int64 );
+    len[SNAP_SIZE]      = sizeof ( __int64 );
+    len[SNAP_FILES]     = sizeof ( UINT );
+    len[SNAP_MTIME]     = sizeof ( __int64 );
+    len[SNAP_TFILES]    = sizeof ( __int64 );
+    len[SNAP_TDIRS]     = sizeof ( UINT );
+
+    for ( i = 0; i <= SNAP_TDIRS; i++ )
+        len[i] *= hdr->count;
+
+    len[SNAP_NAMES]     = (UINT64)hdr->names_len * sizeof ( WCHAR );
+    len[SNAP_SLOTS]     = (UINT64)hdr->nslots * sizeof ( UINT );
+    len[SNAP_AGE]       = ( hdr->flags & SNAP_HAS_AGE ) ?
+                            (UINT64)hdr->count * sizeof ( AGE_HIST ) : 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SnapWrite
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: HANDLE hFile      : file
+//    Param.    2: const void * data : bytes
+//    Param.    3: UINT64 len        : how many, may be past 4 GB
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL SnapWrite ( HANDLE hFile, const void * data, UINT64 len )
+/*--------------------------------------------------------------------------*/
+{
+    DWORD   chunk, put;
+
+    while ( len != 0 )
+    {
+        chunk = ( len > SNAP_CHUNK ) ? SNAP_CHUNK : (DWORD)len;
+
+        if ( !WriteFile ( hFile, data, chunk, &put, NULL ) || put != chunk )
+            return FALSE;
+
+        data = (const BYTE *)data + chunk;
+        len -= chunk;
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SnapWriteAge
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: HANDLE hFile       : file
+//    Param.    2: const ENGINE * eng : engine with eng->age
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the SNAP_AGE section, every node's histogram taken out
+//                 of its extra data, SNAP_AGE_RUN at a time
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL SnapWriteAge ( HANDLE hFile, const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    AGE_HIST    run[SNAP_AGE_RUN];
+    UINT        i, n;
+
+    for ( i = 0; i < eng->count; i += n )
+    {
+        for ( n = 0; n < SNAP_AGE_RUN && i + n < eng->count; n++ )
+            CopyMemory ( &run[n], eng->extra + (UINT_PTR)( i + n ) *
+                eng->extra_size, sizeof ( AGE_HIST ) );
+
+        if ( !SnapWrite ( hFile, run, n * sizeof ( AGE_HIST ) ) )
+            return FALSE;
+    }
+
+    return TRUE;
+}
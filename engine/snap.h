@@ -0,0 +1,75 @@
+
+// snap.h - scan snapshots, written after a walk, mapped read-only later
+
+#ifndef _SNAP_H
+#define _SNAP_H
+
+#include <windows.h>
+#include "engine.h"
+#include "pathidx.h"
+
+#define SNAP_MAGIC          0x50414E53  // "SNAP"
+#define SNAP_VERSION        4
+#define SNAP_VERSION_MIN    3           // still read, no SNAP_AGE
+
+// sections of the file, each one an array starting at an 8 byte
+// aligned offset from the start of the file
+#define SNAP_PARENT         0   // UINT per node
+#define SNAP_FIRST          1   // UINT per node
+#define SNAP_NCHILD         2   // UINT per node
+#define SNAP_NAME           3   // UINT per node
+#define SNAP_NLEN           4   // USHORT per node
+#define SNAP_DEPTH          5   // USHORT per node
+#define SNAP_FLAGS          6   // BYTE per node
+#define SNAP_OWN            7   // __int64 per node
+#define SNAP_SIZE           8   // __int64 per node
+#define SNAP_FILES          9   // UINT per node
+#define SNAP_MTIME          10  // __int64 per node
+#define SNAP_TFILES         11  // __int64 per node
+#define SNAP_TDIRS          12  // UINT per node
+#define SNAP_NAMES          13  // names_len WCHARs
+#define SNAP_SLOTS          14  // nslots UINTs, the PATH_INDEX
+#define SNAP_AGE            15  // AGE_HIST per node, with SNAP_HAS_AGE,
+                                // else empty
+#define SNAP_SECTIONS       16
+
+// header flags
+#define SNAP_HAS_AGE        1   // the walk had --age
+
+// File layout: this header, then the sections. Offsets, never pointers,
+// so the file can be mapped anywhere and used in place. A version 3
+// header ends before off[SNAP_AGE].
+typedef struct _snap_header
+{
+    UINT32      magic;      // SNAP_MAGIC
+    UINT32      version;    // SNAP_VERSION
+    UINT32      count;      // nodes
+    UINT32      names_len;  // chars in the name arena
+    UINT32      nslots;     // path index slots
+    UINT32      flags;      // SNAP_HAS_xxx
+    UINT64      scanned;    // FILETIME of the walk, UTC
+    UINT64      file_size;  // whole file, a short write shows up here
+    UINT64      off[SNAP_SECTIONS];
+} SNAP_HEADER;
+
+// A snapshot in use. eng has its columns pointing into the read-only
+// view and can be handed to anything taking a const ENGINE *; never
+// EngineFree it, SnapClose does the cleanup. With SNAP_HAS_AGE, eng.age
+// is set and eng.extra is the SNAP_AGE section.
+typedef struct _snapshot
+{
+    ENGINE      eng;
+    PATH_INDEX  idx;
+    UINT64      scanned;
+    HANDLE      hFile;
+    HANDLE      hMap;
+    const BYTE  * view;
+} SNAPSHOT;
+
+BOOL    SnapSave        ( const ENGINE * eng, const PATH_INDEX * pi,
+                            UINT64 scanned, const WCHAR * fname );
+BOOL    SnapOpen        ( SNAPSHOT * snap, const WCHAR * fname );
+void    SnapLayout      ( SNAP_HEADER * hdr );
+void    SnapClose       ( SNAPSHOT * snap );
+
+#endif // _SNAP_H
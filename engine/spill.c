@@ -0,0 +1,667 @@
+
+// spill.c - --mem-limit, finished subtrees moved out to a run file and
+// the snapshot put together from it
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "spill.h"
+#include "snap.h"
+#include "pathidx.h"
+#include "agehist.h"
+#include <windows.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+#define SPILL_ALIGN(x)      ( ( (x) + 7 ) & ~(UINT64)7 )
+#define SPILL_RECLEN(sp,nlen) ( sizeof ( SPILL_REC ) + (sp)->age_len + \
+                                SPILL_ALIGN ( (UINT64)(nlen) * \
+                                sizeof ( WCHAR ) ) )
+#define SPILL_MEM           ( (UINT64)1 << 63 ) // a node still in memory
+#define SPILL_SKIP          FIELD_OFFSET ( SPILL_REC, skip )
+
+static BOOL             SpillEmit       ( SPILL * sp, const ENGINE * eng,
+                                            UINT node, UINT64 * nodes,
+                                            UINT64 * chars );
+static BOOL             SpillPut        ( SPILL * sp, const void * data,
+                                            UINT len );
+static BOOL             SpillFlush      ( SPILL * sp );
+static BOOL             SpillWriteAt    ( HANDLE hFile, UINT64 off,
+                                            const void * data, UINT len );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SpillInit
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: SPILL * sp         : to set up
+//    Param.    2: ENGINE * eng       : engine, before EngineRun
+//    Param.    3: UINT64 limit       : bytes of nodes and names to keep
+//    Param.    4: const WCHAR * fname: run file, made anew, gone on close
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: make the run file and hook it to the engine. From then
+//                 on its snapshot has to come from SpillSave. Returns
+//                 FALSE if the file or the buffer can't be had.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL SpillInit ( SPILL * sp, ENGINE * eng, UINT64 limit,
+    const WCHAR * fname )
+/*--------------------------------------------------------------------------*/
+{
+    UINT i;
+
+    if ( sp == NULL || eng == NULL || fname == NULL )
+        return FALSE;
+
+    RtlZeroMemory ( sp, sizeof ( SPILL ) );
+
+    sp->limit       = limit;
+    sp->free_link   = ENG_NONE;
+    sp->node_bytes  = 0;
+    sp->age_len     = eng->age ? sizeof ( AGE_HIST ) : 0;
+
+    for ( i = 0; i < eng->ncols; i++ )
+        sp->node_bytes += eng->cols[i].elem;
+
+    sp->buf = malloc ( SPILL_BUF );
+
+    if ( sp->buf == NULL )
+        return FALSE;
+
+    // temporary, the cache keeps it if it can
+    sp->hFile = CreateFileW ( fname, GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY |
+        FILE_FLAG_DELETE_ON_CLOSE, NULL );
+
+    if ( sp->hFile == INVALID_HANDLE_VALUE )
+    {
+        free ( sp->buf );
+        sp->hFile = NULL;
+        return FALSE;
+    }
+
+    InitializeCriticalSection ( &sp->lock );
+    eng->spill = sp;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SpillFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SPILL * sp : from SpillInit, or zeroed
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void SpillFree ( SPILL * sp )
+/*--------------------------------------------------------------------------*/
+{
+    if ( sp == NULL || sp->hFile == NULL )
+        return;
+
+    CloseHandle ( sp->hFile );
+    DeleteCriticalSection ( &sp->lock );
+    free ( sp->buf );
+    free ( sp->links );
+    RtlZeroMemory ( sp, sizeof ( SPILL ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SpillOver
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: const SPILL * sp    : spill
+//    Param.    2: const ENGINE * eng  : its engine
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the nodes and names in memory take more than the
+//                 limit. Read without the lock, it's only a hint.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL SpillOver ( const SPILL * sp, const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    return ( !sp->failed && (UINT64)eng->live * sp->node_bytes +
+        eng->live_chars * sizeof ( WCHAR ) > sp->limit );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SpillWrite
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: SPILL * sp         : spill, locked
+//    Param.    2: const ENGINE * eng : engine, node is final
+//    Param.    3: UINT node          : folder
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: append everything below node to the run file. Returns
+//                 the link to keep in eng->first[node], or ENG_NONE if
+//                 out of memory or disk; after a failed write nothing
+//                 more is spilled and the walk just goes on in memory.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT SpillWrite ( SPILL * sp, const ENGINE * eng, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    SPILL_LINK  * tmp;
+    UINT64      off, nodes, chars;
+    UINT        link, cap, i;
+    BOOL        ok;
+
+    if ( sp == NULL || sp->failed )
+        return ENG_NONE;
+
+    if ( sp->free_link == ENG_NONE && sp->nlinks == sp->links_cap )
+    {
+        cap = sp->links_cap ? sp->links_cap * 2 : 1024;
+        tmp = realloc ( sp->links, (UINT_PTR)cap * sizeof ( SPILL_LINK ) );
+
+        if ( tmp == NULL )
+            return ENG_NONE;
+
+        sp->links       = tmp;
+        sp->links_cap   = cap;
+    }
+
+    off     = sp->len;
+    nodes   = 0;
+    chars   = 0;
+    ok      = TRUE;
+
+    for ( i = 0; i < eng->nchild[node] && ok; i++ )
+        ok = SpillEmit ( sp, eng, eng->first[node] + i, &nodes, &chars );
+
+    if ( !ok )
+    {
+        sp->failed = TRUE;
+        return ENG_NONE;
+    }
+
+    if ( sp->free_link != ENG_NONE )
+    {
+        link            = sp->free_link;
+        sp->free_link   = sp->links[link].next;
+    }
+    else
+        link = sp->nlinks++;
+
+    sp->links[link].off     = off;
+    sp->links[link].nchild  = eng->nchild[node];
+    sp->links[link].next    = ENG_NONE;
+
+    sp->nodes  += nodes;
+    sp->chars  += chars;
+    sp->spills++;
+
+    return link;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SpillForget
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: SPILL * sp : spill
+//    Param.    2: UINT link  : no longer kept by any node
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void SpillForget ( SPILL * sp, UINT link )
+/*--------------------------------------------------------------------------*/
+{
+    if ( sp == NULL || link >= sp->nlinks )
+        return;
+
+    sp->links[link].next    = sp->free_link;
+    sp->free_link           = link;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SpillSave
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: SPILL * sp          : spill, the walk is done
+//    Param.    2: const ENGINE * eng  : its engine
+//    Param.    3: UINT64 scanned      : FILETIME of the walk
+//    Param.    4: const WCHAR * fname : snapshot to write
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: SnapSave for a walk that spilled. The snapshot file is
+//                 made at its final size and mapped, the run file mapped
+//                 read-only, and the tree is laid out breadth first
+//                 straight into the snapshot's columns: node i's children
+//                 get the next free numbers, and until their turn comes,
+//                 their own column holds where they are (a node in
+//                 memory, or a record). So nothing the size of the tree
+//                 is ever allocated; the pages are the files', the system
+//                 writes them out as it needs to.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL SpillSave ( SPILL * sp, const ENGINE * eng, UINT64 scanned,
+    const WCHAR * fname )
+/*--------------------------------------------------------------------------*/
+{
+    SNAP_HEADER     hdr;
+    const BYTE      * run;
+    const SPILL_REC * rec;
+    const WCHAR     * name;
+    BYTE            * view;
+    UINT            * parent, * first, * nchild, * nameoff, * files;
+    UINT            * tdirs;
+    UINT            * slots;
+    AGE_HIST        * age;
+    USHORT          * nlen, * depth;
+    BYTE            * flags;
+    __int64         * own, * size, * mtime, * tfiles;
+    HANDLE          hOut, hMapOut, hMapRun;
+    WCHAR           tmp[ENG_MAX_PATH+8];
+    UINT64          total, chars, src, next, npos;
+    UINT            count, nslots, mask, i, n, k, kids, m, j;
+    UINT_PTR        flen;
+    BOOL            ok, mem;
+
+    if ( sp == NULL || eng == NULL || fname == NULL || sp->failed ||
+            !SpillFlush ( sp ) )
+        return FALSE;
+
+    total   = (UINT64)eng->live + sp->nodes;
+    chars   = eng->live_chars + sp->chars;
+
+    if ( total >= ENG_NONE || chars >= ENG_NONE )
+        return FALSE;
+
+    count = (UINT)total;
+
+    for ( nslots = 16; nslots < count * 2; nslots *= 2 )
+        if ( nslots >= 0x80000000u )
+            return FALSE;
+
+    flen = wcslen ( fname );
+
+    if ( flen + 5 > ARRAYSIZE(tmp) )
+        return FALSE;
+
+    wmemcpy ( tmp, fname, flen );
+    wmemcpy ( tmp + flen, L".tmp", 5 );
+
+    RtlZeroMemory ( &hdr, sizeof ( hdr ) );
+
+    hdr.magic       = SNAP_MAGIC;
+    hdr.version     = SNAP_VERSION;
+    hdr.count       = count;
+    hdr.names_len   = (UINT)chars;
+    hdr.nslots      = nslots;
+    hdr.flags       = sp->age_len ? SNAP_HAS_AGE : 0;
+    hdr.scanned     = scanned;
+
+    SnapLayout ( &hdr );
+
+    if ( hdr.file_size > (SIZE_T)-1 )
+        return FALSE;
+
+    run         = NULL;
+    view        = NULL;
+    hMapRun     = NULL;
+    hMapOut     = NULL;
+
+    if ( sp->len != 0 )
+    {
+        hMapRun = CreateFileMappingW ( sp->hFile, NULL, PAGE_READONLY,
+            0, 0, NULL );
+
+        if ( hMapRun != NULL )
+            run = MapViewOfFile ( hMapRun, FILE_MAP_READ, 0, 0, 0 );
+
+        if ( run == NULL )
+        {
+            if ( hMapRun != NULL )
+                CloseHandle ( hMapRun );
+
+            return FALSE;
+        }
+    }
+
+    hOut = CreateFileW ( tmp, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+
+    if ( hOut != INVALID_HANDLE_VALUE )
+    {
+        // the mapping makes the file this big
+        hMapOut = CreateFileMappingW ( hOut, NULL, PAGE_READWRITE,
+            (DWORD)( hdr.file_size >> 32 ), (DWORD)hdr.file_size, NULL );
+
+        if ( hMapOut != NULL )
+            view = MapViewOfFile ( hMapOut, FILE_MAP_WRITE, 0, 0, 0 );
+    }
+
+    ok = ( view != NULL );
+
+    if ( ok )
+    {
+        parent  = (UINT *)( view + hdr.off[SNAP_PARENT] );
+        first   = (UINT *)( view + hdr.off[SNAP_FIRST] );
+        nchild  = (UINT *)( view + hdr.off[SNAP_NCHILD] );
+        nameoff = (UINT *)( view + hdr.off[SNAP_NAME] );
+        nlen    = (USHORT *)( view + hdr.off[SNAP_NLEN] );
+        depth   = (USHORT *)( view + hdr.off[SNAP_DEPTH] );
+        flags   = view + hdr.off[SNAP_FLAGS];
+        own     = (__int64 *)( view + hdr.off[SNAP_OWN] );
+        size    = (__int64 *)( view + hdr.off[SNAP_SIZE] );
+        files   = (UINT *)( view + hdr.off[SNAP_FILES] );
+        mtime   = (__int64 *)( view + hdr.off[SNAP_MTIME] );
+        tfiles  = (__int64 *)( view + hdr.off[SNAP_TFILES] );
+        tdirs   = (UINT *)( view + hdr.off[SNAP_TDIRS] );
+        slots   = (UINT *)( view + hdr.off[SNAP_SLOTS] );
+        age     = (AGE_HIST *)( view + hdr.off[SNAP_AGE] );
+
+        FillMemory ( slots, (UINT_PTR)nslots * sizeof ( UINT ), 0xFF );
+
+        // the roots keep their numbers, they're never spilled
+        for ( n = 0; n < eng->count && ( eng->flags[n] & ENG_TOP ) &&
+                n < count; n++ )
+        {
+            parent[n]   = ENG_NONE;
+            depth[n]    = 0;
+            own[n]      = (__int64)( SPILL_MEM | n );
+        }
+
+        mask    = nslots - 1;
+        npos    = 0;
+    }
+
+    for ( i = 0; ok && i < n; i++ )
+    {
+        src = (UINT64)own[i];
+        mem = ( ( src & SPILL_MEM ) != 0 );
+
+        if ( mem )
+        {
+            m           = (UINT)src;
+            own[i]      = eng->own[m];
+            size[i]     = eng->size[m];
+            files[i]    = eng->files[m];
+            mtime[i]    = eng->mtime[m];
+            tfiles[i]   = eng->tfiles[m];
+            tdirs[i]    = eng->tdirs[m];
+            flags[i]    = eng->flags[m];
+            nlen[i]     = eng->nlen[m];
+            name        = eng->names + eng->name[m];
+
+            if ( sp->age_len != 0 )
+                CopyMemory ( &age[i], eng->extra + (UINT_PTR)m *
+                    eng->extra_size, sizeof ( AGE_HIST ) );
+
+            if ( eng->flags[m] & ENG_SPILLED )
+            {
+                kids    = sp->links[eng->first[m]].nchild;
+                next    = sp->links[eng->first[m]].off;
+                mem     = FALSE;
+            }
+            else
+            {
+                kids    = eng->nchild[m];
+                next    = eng->first[m];
+            }
+        }
+        else
+        {
+            if ( src + sizeof ( SPILL_REC ) > sp->len )
+            {
+                ok = FALSE;
+                break;
+            }
+
+            rec         = (const SPILL_REC *)( run + src );
+            own[i]      = rec->own;
+            size[i]     = rec->size;
+            files[i]    = rec->files;
+            mtime[i]    = rec->mtime;
+            tfiles[i]   = rec->tfiles;
+            tdirs[i]    = rec->tdirs;
+            flags[i]    = rec->flags;
+            nlen[i]     = rec->nlen;
+            name        = (const WCHAR *)( (const BYTE *)( rec + 1 ) +
+                            sp->age_len );
+            kids        = rec->nchild;
+            next        = ( rec->child == SPILL_INLINE ) ?
+                            src + SPILL_RECLEN ( sp, rec->nlen ) :
+                            rec->child;
+
+            if ( sp->age_len != 0 )
+                CopyMemory ( &age[i], rec + 1, sizeof ( AGE_HIST ) );
+        }
+
+        if ( kids > count - n || npos + nlen[i] + 1 > chars )
+        {
+            ok = FALSE;
+            break;
+        }
+
+        flags[i]   &= ~( ENG_SPILLED | ENG_FREE );
+        nameoff[i]  = (UINT)npos;
+
+        wmemcpy ( (WCHAR *)( view + hdr.off[SNAP_NAMES] ) + npos, name,
+            nlen[i] );
+        ( (WCHAR *)( view + hdr.off[SNAP_NAMES] ) )[npos + nlen[i]] = L'\0';
+        npos += nlen[i] + 1;
+
+        first[i]    = kids ? n : ENG_NONE;
+        nchild[i]   = kids;
+
+        // the children wait their turn with where they are in own
+        for ( k = 0; k < kids; k++, n++ )
+        {
+            parent[n]   = i;
+            depth[n]    = depth[i] + 1;
+
+            if ( mem )
+                own[n] = (__int64)( SPILL_MEM | ( next + k ) );
+            else if ( next + sizeof ( SPILL_REC ) <= sp->len )
+            {
+                own[n]  = (__int64)next;
+                next   += ( (const SPILL_REC *)( run + next ) )->skip;
+            }
+            else
+                ok = FALSE;
+        }
+
+        for ( j = PathIdxHash ( parent[i], name, nlen[i] ) & mask;
+                slots[j] != ENG_NONE; j = ( j + 1 ) & mask )
+            ;
+
+        slots[j] = i;
+    }
+
+    // every node once, or the run file is no good
+    if ( ok && ( n != count || npos != chars ) )
+        ok = FALSE;
+
+    if ( ok )
+        CopyMemory ( view, &hdr, sizeof ( hdr ) );
+
+    if ( view != NULL )
+        UnmapViewOfFile ( view );
+
+    if ( hMapOut != NULL )
+        CloseHandle ( hMapOut );
+
+    if ( hOut != INVALID_HANDLE_VALUE )
+        CloseHandle ( hOut );
+
+    if ( run != NULL )
+        UnmapViewOfFile ( run );
+
+    if ( hMapRun != NULL )
+        CloseHandle ( hMapRun );
+
+    if ( ok )
+        ok = MoveFileExW ( tmp, fname, MOVEFILE_REPLACE_EXISTING );
+
+    if ( !ok )
+        DeleteFileW ( tmp );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SpillEmit
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: SPILL * sp         : spill, locked
+//    Param.    2: const ENGINE * eng : engine
+//    Param.    3: UINT node          : final folder
+//    Param.    4: UINT64 * nodes     : records written, added to
+//    Param.    5: UINT64 * chars     : their name chars, added to
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: node's record, then its subtree, depth first. The
+//                 record's skip is only known at the end and patched in,
+//                 in the buffer or, if that's been written out, in the
+//                 file. A folder spilled before gets a record pointing
+//                 where its subfolders already are.
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL SpillEmit ( SPILL * sp, const ENGINE * eng, UINT node,
+    UINT64 * nodes, UINT64 * chars )
+/*--------------------------------------------------------------------------*/
+{
+    static const BYTE   zero[8] = { 0 };
+    SPILL_REC           rec;
+    UINT64              at;
+    UINT                i, pad;
+
+    RtlZeroMemory ( &rec, sizeof ( rec ) );
+
+    rec.own     = eng->own[node];
+    rec.size    = eng->size[node];
+    rec.files   = eng->files[node];
+    rec.mtime   = eng->mtime[node];
+    rec.tfiles  = eng->tfiles[node];
+    rec.tdirs   = eng->tdirs[node];
+    rec.nlen    = eng->nlen[node];
+    rec.flags   = eng->flags[node] & ~ENG_SPILLED;
+
+    if ( eng->flags[node] & ENG_SPILLED )
+    {
+        rec.child   = sp->links[eng->first[node]].off;
+        rec.nchild  = sp->links[eng->first[node]].nchild;
+        rec.skip    = SPILL_RECLEN ( sp, rec.nlen );
+    }
+    else
+    {
+        rec.child   = SPILL_INLINE;
+        rec.nchild  = eng->nchild[node];
+    }
+
+    at  = sp->len;
+    pad = (UINT)( SPILL_RECLEN ( sp, rec.nlen ) - sizeof ( SPILL_REC ) -
+        sp->age_len ) - rec.nlen * sizeof ( WCHAR );
+
+    if ( !SpillPut ( sp, &rec, sizeof ( rec ) ) ||
+            ( sp->age_len != 0 && !SpillPut ( sp, eng->extra +
+                (UINT_PTR)node * eng->extra_size, sp->age_len ) ) ||
+            !SpillPut ( sp, eng->names + eng->name[node],
+                rec.nlen * sizeof ( WCHAR ) ) ||
+            !SpillPut ( sp, zero, pad ) )
+        return FALSE;
+
+    ( *nodes )++;
+    *chars += rec.nlen + 1;
+
+    if ( rec.child != SPILL_INLINE )
+        return TRUE;
+
+    for ( i = 0; i < rec.nchild; i++ )
+        if ( !SpillEmit ( sp, eng, eng->first[node] + i, nodes, chars ) )
+            return FALSE;
+
+    // a record never straddles the buffer, see SpillPut
+    rec.skip = sp->len - at;
+
+    if ( at >= sp->base )
+        CopyMemory ( sp->buf + ( at - sp->base ) + SPILL_SKIP, &rec.skip,
+            sizeof ( UINT64 ) );
+    else if ( !SpillWriteAt ( sp->hFile, at + SPILL_SKIP, &rec.skip,
+            sizeof ( UINT64 ) ) )
+        return FALSE;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SpillPut
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: SPILL * sp        : spill
+//    Param.    2: const void * data : bytes to append
+//    Param.    3: UINT len          : how many, up to SPILL_BUF
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: into the buffer, which is written out first if it
+//                 wouldn't fit, so what's put in one go stays together
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL SpillPut ( SPILL * sp, const void * data, UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    if ( sp->len - sp->base + len > SPILL_BUF && !SpillFlush ( sp ) )
+        return FALSE;
+
+    CopyMemory ( sp->buf + ( sp->len - sp->base ), data, len );
+    sp->len += len;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SpillFlush
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: SPILL * sp : spill
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL SpillFlush ( SPILL * sp )
+/*--------------------------------------------------------------------------*/
+{
+    if ( sp->len == sp->base )
+        return TRUE;
+
+    if ( !SpillWriteAt ( sp->hFile, sp->base, sp->buf,
+            (UINT)( sp->len - sp->base ) ) )
+        return FALSE;
+
+    sp->base = sp->len;
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SpillWriteAt
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: HANDLE hFile      : file
+//    Param.    2: UINT64 off        : where to
+//    Param.    3: const void * data : what
+//    Param.    4: UINT len          : how many bytes
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL SpillWriteAt ( HANDLE hFile, UINT64 off, const void * data,
+    UINT len )
+/*--------------------------------------------------------------------------*/
+{
+    LARGE_INTEGER   li;
+    DWORD           done;
+
+    li.QuadPart = (LONGLONG)off;
+
+    return ( SetFilePointerEx ( hFile, li, NULL, FILE_BEGIN ) &&
+        WriteFile ( hFile, data, len, &done, NULL ) && done == len );
+}
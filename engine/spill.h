@@ -0,0 +1,74 @@
+
+// spill.h - --mem-limit, finished subtrees moved out to a run file and
+// the snapshot put together from it
+
+#ifndef _SPILL_H
+#define _SPILL_H
+
+#include <windows.h>
+#include "engine.h"
+
+#define SPILL_INLINE        ((UINT64)-1)    // children right after it
+#define SPILL_BUF           (1U << 20)      // run file write buffer
+
+// Run file record, one per folder moved out, 8 byte aligned, followed by
+// its AGE_HIST if the engine keeps them (eng->age) and its name (no NUL,
+// padded to 8). A subtree is written depth first: the
+// record, then its subfolders' subtrees one after the other, unless
+// child says they were moved out earlier and sit elsewhere.
+typedef struct _spill_rec
+{
+    __int64     own;
+    __int64     size;
+    __int64     mtime;
+    __int64     tfiles;
+    UINT64      skip;       // bytes of this record and its subtree
+    UINT64      child;      // offset of the first subfolder, or
+                            // SPILL_INLINE
+    UINT        files;
+    UINT        nchild;
+    UINT        tdirs;
+    USHORT      nlen;
+    BYTE        flags;      // ENG_xxx, as it was in memory
+    BYTE        pad;
+} SPILL_REC;
+
+// where a folder's subfolders went; an ENG_SPILLED node has its number
+// in eng->first
+typedef struct _spill_link
+{
+    UINT64      off;        // first subfolder's record
+    UINT        nchild;
+    UINT        next;       // free list
+} SPILL_LINK;
+
+typedef struct _spill
+{
+    HANDLE      hFile;      // the run file, deleted on close
+    UINT64      len;        // bytes in it, buffered ones included
+    BYTE        * buf;      // what's not written yet, from base on
+    UINT64      base;
+    SPILL_LINK  * links;
+    UINT        nlinks;
+    UINT        links_cap;
+    UINT        free_link;  // ENG_NONE if none
+    UINT64      nodes;      // folders in the run file
+    UINT64      chars;      // their names, a NUL each counted
+    UINT64      limit;      // bytes of nodes and names kept in memory
+    UINT        node_bytes; // all the columns of one node
+    UINT        age_len;    // AGE_HIST after each record, or 0
+    UINT        spills;     // subtrees moved out so far
+    BOOL        failed;     // a write failed, nothing more goes out
+    CRITICAL_SECTION lock;  // one spill at a time
+} SPILL;
+
+BOOL    SpillInit       ( SPILL * sp, ENGINE * eng, UINT64 limit,
+                            const WCHAR * fname );
+void    SpillFree       ( SPILL * sp );
+BOOL    SpillOver       ( const SPILL * sp, const ENGINE * eng );
+UINT    SpillWrite      ( SPILL * sp, const ENGINE * eng, UINT node );
+void    SpillForget     ( SPILL * sp, UINT link );
+BOOL    SpillSave       ( SPILL * sp, const ENGINE * eng, UINT64 scanned,
+                            const WCHAR * fname );
+
+#endif // _SPILL_H
@@ -0,0 +1,502 @@
+
+// treemap.c - squarified treemap layout over a tree of sizes
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "treemap.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int              TmFolder        ( TREEMAP * tm, uint32_t node,
+                                            uint32_t depth, float x,
+                                            float y, float w, float h );
+static int              TmInside        ( TREEMAP * tm, uint32_t node,
+                                            uint32_t depth, float x,
+                                            float y, float w, float h );
+static void             TmSquarify      ( TM_ITEM * it, uint32_t n,
+                                            float x, float y, float w,
+                                            float h );
+static int              TmRect          ( TREEMAP * tm, uint32_t node,
+                                            uint32_t depth, uint32_t kind,
+                                            float x, float y, float w,
+                                            float h );
+static int              TmPush          ( TREEMAP * tm, int64_t size,
+                                            uint32_t node, uint32_t kind );
+static int              TmCompare       ( const void * a, const void * b );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TreemapInit
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: TREEMAP * tm          : to set up
+//    Param.    2: const TM_TREE * tree  : tree to lay out, copied; NULL
+//                                         to fill tm->tree in later
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: defaults for a screen in pixels, change them before
+//                 TreemapLayout as needed
+/*--------------------------------------------------------------------@@-@@-*/
+void TreemapInit ( TREEMAP * tm, const TM_TREE * tree )
+/*--------------------------------------------------------------------------*/
+{
+    if ( tm == NULL )
+        return;
+
+    memset ( tm, 0, sizeof ( TREEMAP ) );
+
+    if ( tree != NULL )
+        tm->tree    = *tree;
+
+    tm->min_side    = 4.0f;
+    tm->pad         = 2.0f;
+    tm->head        = 0.0f;
+    tm->max_depth   = TM_MAX_DEPTH;
+    tm->max_rects   = 1000000;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TreemapFree
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: TREEMAP * tm : from TreemapInit
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void TreemapFree ( TREEMAP * tm )
+/*--------------------------------------------------------------------------*/
+{
+    if ( tm == NULL )
+        return;
+
+    free ( tm->rects );
+    free ( tm->items );
+    memset ( tm, 0, sizeof ( TREEMAP ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TreemapLayout
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: TREEMAP * tm : treemap
+//    Param.    2: uint32_t top : folder filling the viewport
+//    Param.    3: float x      : viewport
+//    Param.    4: float y      :
+//    Param.    5: float w      :
+//    Param.    6: float h      :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: lay top and what's below it out again, into tm->rects.
+//                 Zooming is just another call with another top. Sizes
+//                 are read as they are, so a walk still going shows what
+//                 it has so far. Returns 0 if out of memory, with what
+//                 was laid out until then.
+/*--------------------------------------------------------------------@@-@@-*/
+int TreemapLayout ( TREEMAP * tm, uint32_t top, float x, float y, float w,
+    float h )
+/*--------------------------------------------------------------------------*/
+{
+    if ( tm == NULL || tm->tree.size == NULL || top >= tm->tree.count )
+        return 0;
+
+    tm->count   = 0;
+    tm->nitems  = 0;
+    tm->cut     = 0;
+
+    if ( w <= 0.0f || h <= 0.0f )
+        return 1;
+
+    return TmFolder ( tm, top, 0, x, y, w, h );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TreemapHit
+/*--------------------------------------------------------------------------*/
+//           Type: const TM_RECT *
+//    Param.    1: const TREEMAP * tm : laid out treemap
+//    Param.    2: float x            : point
+//    Param.    3: float y            :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: innermost rectangle holding the point, NULL if none.
+//                 Parents come before their insides, so it's the last
+//                 one that does.
+/*--------------------------------------------------------------------@@-@@-*/
+const TM_RECT * TreemapHit ( const TREEMAP * tm, float x, float y )
+/*--------------------------------------------------------------------------*/
+{
+    const TM_RECT   * r;
+    uint32_t        i;
+
+    if ( tm == NULL )
+        return NULL;
+
+    for ( i = tm->count; i--; )
+    {
+        r = &tm->rects[i];
+
+        if ( x >= r->x && x < r->x + r->w && y >= r->y && y < r->y + r->h )
+            return r;
+    }
+
+    return NULL;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TmFolder
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: TREEMAP * tm     : treemap
+//    Param.    2: uint32_t node    : folder
+//    Param.    3: uint32_t depth   : below the top
+//    Param.    4: float x      : its rectangle
+//    Param.    5: float y      :
+//    Param.    6: float w      :
+//    Param.    7: float h      :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the folder's rectangle, then its inside if it's worth
+//                 it
+/*--------------------------------------------------------------------@@-@@-*/
+static int TmFolder ( TREEMAP * tm, uint32_t node, uint32_t depth, float x,
+    float y, float w, float h )
+/*--------------------------------------------------------------------------*/
+{
+    float top;
+
+    if ( !TmRect ( tm, node, depth, TM_FOLDER, x, y, w, h ) )
+        return 0;
+
+    if ( depth >= tm->max_depth || tm->tree.nchild[node] == 0 )
+        return 1;
+
+    top = ( h >= tm->head * 3.0f ) ? tm->head : 0.0f;
+
+    x += tm->pad;
+    y += tm->pad + top;
+    w -= tm->pad * 2.0f;
+    h -= tm->pad * 2.0f + top;
+
+    if ( w < tm->min_side || h < tm->min_side )
+        return 1;
+
+    return TmInside ( tm, node, depth, x, y, w, h );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TmInside
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: TREEMAP * tm     : treemap
+//    Param.    2: uint32_t node    : folder with subfolders
+//    Param.    3: uint32_t depth   : below the top
+//    Param.    4: float x      : room for its inside
+//    Param.    5: float y      :
+//    Param.    6: float w      :
+//    Param.    7: float h      :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the subfolders and the files right inside, biggest
+//                 first, squarified into the room given. From the first
+//                 one that would come out smaller than min_side square
+//                 on, the rest go together as one TM_REST. The pieces
+//                 sit on tm->items above the levels being laid out, and
+//                 the subfolders are done one after the other from there.
+/*--------------------------------------------------------------------@@-@@-*/
+static int TmInside ( TREEMAP * tm, uint32_t node, uint32_t depth, float x,
+    float y, float w, float h )
+/*--------------------------------------------------------------------------*/
+{
+    const TM_TREE   * t;
+    TM_ITEM         it;
+    int64_t         total, rest;
+    double          scale;
+    uint32_t        base, n, i, c;
+    int             ok;
+
+    t       = &tm->tree;
+    base    = tm->nitems;
+    total   = 0;
+
+    for ( i = 0, c = t->first[node]; i < t->nchild[node]; i++, c++ )
+        if ( t->size[c] > 0 )
+        {
+            if ( !TmPush ( tm, t->size[c], c, TM_FOLDER ) )
+                return 0;
+
+            total += t->size[c];
+        }
+
+    if ( t->own[node] > 0 )
+    {
+        if ( !TmPush ( tm, t->own[node], node, TM_FILES ) )
+            return 0;
+
+        total += t->own[node];
+    }
+
+    n = tm->nitems - base;
+
+    if ( n == 0 )
+        return 1;
+
+    qsort ( tm->items + base, n, sizeof ( TM_ITEM ), TmCompare );
+
+    // the tail too small to see, as one
+    scale = (double)w * h / (double)total;
+
+    for ( i = 0, rest = total; i < n; i++ )
+    {
+        if ( i + 1 < n && (double)tm->items[base+i].size * scale <
+                (double)tm->min_side * tm->min_side )
+        {
+            tm->items[base+i].size  = rest;
+            tm->items[base+i].node  = node;
+            tm->items[base+i].kind  = TM_REST;
+            n = i + 1;
+            break;
+        }
+
+        rest -= tm->items[base+i].size;
+    }
+
+    TmSquarify ( tm->items + base, n, x, y, w, h );
+
+    // the scratch may move while the subfolders are laid out
+    for ( i = 0, ok = 1; i < n && ok; i++ )
+    {
+        it = tm->items[base+i];
+
+        if ( it.kind == TM_FOLDER )
+            ok = TmFolder ( tm, it.node, depth + 1, it.x, it.y, it.w, it.h );
+        else
+            ok = TmRect ( tm, it.node, depth + 1, it.kind, it.x, it.y,
+                it.w, it.h );
+    }
+
+    tm->nitems = base;
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TmSquarify
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: TM_ITEM * it     : pieces, biggest first, sizes not 0
+//    Param.    2: uint32_t n       : how many
+//    Param.    3: float x      : room for them
+//    Param.    4: float y      :
+//    Param.    5: float w      :
+//    Param.    6: float h      :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: Bruls, Huizing and van Wijk's squarified layout. Pieces
+//                 go in strips along the shorter side of what's left; a
+//                 strip takes the next piece for as long as that makes
+//                 its worst aspect ratio better, then is laid down and
+//                 the room shrinks by it.
+/*--------------------------------------------------------------------@@-@@-*/
+static void TmSquarify ( TM_ITEM * it, uint32_t n, float x, float y,
+    float w, float h )
+/*--------------------------------------------------------------------------*/
+{
+    double      total, scale, side, sum, lo, hi, worst, next, a, s2;
+    double      thick, pos;
+    uint32_t    i, j, k;
+
+    for ( i = 0, total = 0.0; i < n; i++ )
+        total += (double)it[i].size;
+
+    scale = (double)w * h / total;
+
+    for ( i = 0; i < n; i = j )
+    {
+        side    = ( w < h ) ? w : h;
+        sum     = 0.0;
+        lo      = 0.0;
+        hi      = 0.0;
+        worst   = 0.0;
+
+        for ( j = i; j < n; j++ )
+        {
+            a       = (double)it[j].size * scale;
+            s2      = ( sum + a ) * ( sum + a );
+
+            lo      = ( j == i || a < lo ) ? a : lo;
+            hi      = ( a > hi ) ? a : hi;
+            next    = side * side * hi / s2;
+
+            if ( s2 / ( side * side * lo ) > next )
+                next = s2 / ( side * side * lo );
+
+            if ( j > i && next > worst )
+                break;
+
+            worst   = next;
+            sum    += a;
+        }
+
+        // the last strip takes what's left, rounding and all
+        thick = ( j == n ) ? ( ( w < h ) ? h : w ) : sum / side;
+
+        for ( k = i, pos = 0.0; k < j; k++ )
+        {
+            a = ( k + 1 == j ) ? side - pos :
+                (double)it[k].size * scale / thick;
+
+            if ( w < h )
+            {
+                it[k].x = (float)( x + pos );
+                it[k].y = y;
+                it[k].w = (float)a;
+                it[k].h = (float)thick;
+            }
+            else
+            {
+                it[k].x = x;
+                it[k].y = (float)( y + pos );
+                it[k].w = (float)thick;
+                it[k].h = (float)a;
+            }
+
+            pos += a;
+        }
+
+        if ( w < h )
+        {
+            y += (float)thick;
+            h -= (float)thick;
+        }
+        else
+        {
+            x += (float)thick;
+            w -= (float)thick;
+        }
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TmRect
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: TREEMAP * tm     : treemap
+//    Param.    2: uint32_t node    : TM_RECT fields
+//    Param.    3: uint32_t depth   :
+//    Param.    4: uint32_t kind    :
+//    Param.    5: float x      :
+//    Param.    6: float y      :
+//    Param.    7: float w      :
+//    Param.    8: float h      :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: add a rectangle. 0 if out of memory, or if max_rects
+//                 is reached (cut is set then), either way the layout
+//                 stops there.
+/*--------------------------------------------------------------------@@-@@-*/
+static int TmRect ( TREEMAP * tm, uint32_t node, uint32_t depth,
+    uint32_t kind, float x, float y, float w, float h )
+/*--------------------------------------------------------------------------*/
+{
+    TM_RECT     * tmp;
+    uint32_t    cap;
+
+    if ( tm->count == tm->max_rects )
+    {
+        tm->cut = 1;
+        return 0;
+    }
+
+    if ( tm->count == tm->cap )
+    {
+        cap = tm->cap ? tm->cap * 2 : 4096;
+        tmp = realloc ( tm->rects, (size_t)cap * sizeof ( TM_RECT ) );
+
+        if ( tmp == NULL )
+            return 0;
+
+        tm->rects   = tmp;
+        tm->cap     = cap;
+    }
+
+    tmp         = &tm->rects[tm->count++];
+    tmp->x      = x;
+    tmp->y      = y;
+    tmp->w      = w;
+    tmp->h      = h;
+    tmp->node   = node;
+    tmp->depth  = (uint16_t)depth;
+    tmp->kind   = (uint8_t)kind;
+    tmp->pad    = 0;
+
+    return 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TmPush
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: TREEMAP * tm     : treemap
+//    Param.    2: int64_t size     : bytes
+//    Param.    3: uint32_t node    : folder
+//    Param.    4: uint32_t kind    : TM_xxx
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static int TmPush ( TREEMAP * tm, int64_t size, uint32_t node,
+    uint32_t kind )
+/*--------------------------------------------------------------------------*/
+{
+    TM_ITEM     * tmp;
+    uint32_t    cap;
+
+    if ( tm->nitems == tm->items_cap )
+    {
+        cap = tm->items_cap ? tm->items_cap * 2 : 1024;
+        tmp = realloc ( tm->items, (size_t)cap * sizeof ( TM_ITEM ) );
+
+        if ( tmp == NULL )
+            return 0;
+
+        tm->items       = tmp;
+        tm->items_cap   = cap;
+    }
+
+    tmp         = &tm->items[tm->nitems++];
+    tmp->size   = size;
+    tmp->node   = node;
+    tmp->kind   = kind;
+
+    return 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TmCompare
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const void * a : TM_ITEM
+//    Param.    2: const void * b : TM_ITEM
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: qsort callback, biggest first
+/*--------------------------------------------------------------------@@-@@-*/
+static int TmCompare ( const void * a, const void * b )
+/*--------------------------------------------------------------------------*/
+{
+    int64_t sa, sb;
+
+    sa = ( (const TM_ITEM *)a )->size;
+    sb = ( (const TM_ITEM *)b )->size;
+
+    return ( sa < sb ) ? 1 : ( sa > sb ) ? -1 : 0;
+}
@@ -0,0 +1,81 @@
+
+// treemap.h - squarified treemap layout over a tree of sizes. Nothing
+// is drawn here, it only works out the rectangles. No Windows headers
+// either, the tree comes in plain arrays (an engine's columns, say) and
+// the layout builds and is tested anywhere (see tests/).
+
+#ifndef _TREEMAP_H
+#define _TREEMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// what a rectangle stands for
+#define TM_FOLDER           0   // folder node, its subfolders inside
+#define TM_FILES            1   // the files right inside node
+#define TM_REST             2   // node's subfolders too small to show,
+                                // all of them together
+
+#define TM_MAX_DEPTH        0xFFFF  // levels a rectangle can be down
+
+// The tree, one entry per folder. A folder's subfolders are next to
+// each other, first[node] to first[node] + nchild[node] - 1, the way
+// the engine keeps them. Only read, and as they are at the time.
+typedef struct _tm_tree
+{
+    const int64_t   * size;     // bytes below, the folder's own too
+    const int64_t   * own;      // bytes of the files right inside
+    const uint32_t  * first;
+    const uint32_t  * nchild;
+    uint32_t        count;      // folders in the arrays
+} TM_TREE;
+
+// One rectangle. They come out parents first, so the last one holding
+// a point is the innermost.
+typedef struct _tm_rect
+{
+    float       x, y, w, h;
+    uint32_t    node;
+    uint16_t    depth;      // levels below the top one
+    uint8_t     kind;       // TM_xxx
+    uint8_t     pad;
+} TM_RECT;
+
+// a folder's pieces while it's being laid out, biggest first
+typedef struct _tm_item
+{
+    int64_t     size;
+    float       x, y, w, h;
+    uint32_t    node;
+    uint32_t    kind;
+} TM_ITEM;
+
+// Laid out only as deep as there's room for: a rectangle smaller than
+// min_side either way isn't split, and the small subfolders that would
+// end up like that are lumped into one TM_REST. So a layout costs about
+// what it shows, however big the tree below is.
+typedef struct _treemap
+{
+    TM_TREE     tree;
+    TM_RECT     * rects;
+    uint32_t    count;
+    uint32_t    cap;
+    TM_ITEM     * items;    // scratch, one run per level being laid out
+    uint32_t    nitems;
+    uint32_t    items_cap;
+    float       min_side;   // in the units of the viewport
+    float       pad;        // kept around each folder's inside
+    float       head;       // kept above it too, for a label, if the
+                            // folder is at least 3 times that tall
+    uint32_t    max_depth;  // levels below the top one, at most
+    uint32_t    max_rects;
+    int         cut;        // max_rects was reached
+} TREEMAP;
+
+void    TreemapInit     ( TREEMAP * tm, const TM_TREE * tree );
+void    TreemapFree     ( TREEMAP * tm );
+int     TreemapLayout   ( TREEMAP * tm, uint32_t top, float x, float y,
+                            float w, float h );
+const TM_RECT * TreemapHit ( const TREEMAP * tm, float x, float y );
+
+#endif // _TREEMAP_H
@@ -0,0 +1,200 @@
+
+// utf8.c - UTF-16 names to UTF-8 for the exports
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "utf8.h"
+#include <string.h>
+
+#define UTF8_HIGH           0xFF80FF80FF80FF80ULL   // not ASCII, per char
+#define UTF8_ONES           0x0001000100010001ULL
+#define UTF8_SIGN           0x8000800080008000ULL
+#define UTF8_QUOTES         0x0022002200220022ULL   // 4 x '"'
+#define UTF8_SLASHES        0x005C005C005C005CULL   // 4 x '\\'
+#define UTF8_BLANKS         0x0020002000200020ULL   // 4 x ' '
+
+static uint64_t         Utf8Special     ( uint64_t w, unsigned mode );
+static size_t           Utf8Char        ( const uint16_t * s, size_t len,
+                                            size_t * i, char * out,
+                                            unsigned mode );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Utf8Encode
+/*--------------------------------------------------------------------------*/
+//           Type: size_t
+//    Param.    1: const uint16_t * s : text, needn't end in a 0
+//    Param.    2: size_t len         : its length, in chars
+//    Param.    3: char * out         : receives the UTF-8, not 0 ended;
+//                                      UTF8_MAX(len) bytes is always
+//                                      enough
+//    Param.    4: unsigned mode      : UTF8_xxx
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: returns the bytes written. Names are mostly ASCII, so
+//                 four chars are read at once as one 64 bit word: if no
+//                 char has a bit above 0x7F and none needs escaping (see
+//                 Utf8Special), their low bytes are the UTF-8 and go out
+//                 as one 32 bit store. Anything else goes one char at a
+//                 time, and the word at a time picks up again after it.
+//                 A surrogate without its pair becomes U+FFFD, as
+//                 Windows does.
+/*--------------------------------------------------------------------@@-@@-*/
+size_t Utf8Encode ( const uint16_t * s, size_t len, char * out,
+    unsigned mode )
+/*--------------------------------------------------------------------------*/
+{
+    uint64_t    w;
+    uint32_t    b;
+    size_t      i, o;
+
+    i = 0;
+    o = 0;
+
+    while ( i < len )
+    {
+        if ( i + 4 <= len )
+        {
+            memcpy ( &w, s + i, sizeof ( w ) );
+
+            if ( ( w & UTF8_HIGH ) == 0 && Utf8Special ( w, mode ) == 0 )
+            {
+                b = (uint32_t)( ( w & 0xFF ) | ( ( w >> 8 ) & 0xFF00 ) |
+                    ( ( w >> 16 ) & 0xFF0000 ) |
+                    ( ( w >> 24 ) & 0xFF000000 ) );
+
+                memcpy ( out + o, &b, sizeof ( b ) );
+
+                i += 4;
+                o += 4;
+                continue;
+            }
+        }
+
+        o += Utf8Char ( s, len, &i, out + o, mode );
+    }
+
+    return o;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Utf8Special
+/*--------------------------------------------------------------------------*/
+//           Type: static uint64_t
+//    Param.    1: uint64_t w     : four ASCII chars
+//    Param.    2: unsigned mode  : UTF8_xxx
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: not 0 if one of them needs escaping in mode. With all
+//                 chars below 0x80, x - y borrows into a char's top bit
+//                 only where that char is below y, so x ^ 4 quotes less
+//                 1 finds a quote, x less 4 blanks a control char.
+/*--------------------------------------------------------------------@@-@@-*/
+static uint64_t Utf8Special ( uint64_t w, unsigned mode )
+/*--------------------------------------------------------------------------*/
+{
+    uint64_t q, b, c;
+
+    q = w ^ UTF8_QUOTES;
+    q = ( q - UTF8_ONES ) & ~q;
+    b = w ^ UTF8_SLASHES;
+    b = ( b - UTF8_ONES ) & ~b;
+    c = ( w - UTF8_BLANKS ) & ~w;
+
+    switch ( mode )
+    {
+        case UTF8_CSV:      return q & UTF8_SIGN;
+        case UTF8_TSV:      return c & UTF8_SIGN;
+        case UTF8_JSON:     return ( q | b | c ) & UTF8_SIGN;
+    }
+
+    return 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Utf8Char
+/*--------------------------------------------------------------------------*/
+//           Type: static size_t
+//    Param.    1: const uint16_t * s : text
+//    Param.    2: size_t len         : its length, in chars
+//    Param.    3: size_t * i         : the char to do, moved past it (and
+//                                      past its pair, for a surrogate)
+//    Param.    4: char * out         : receives its UTF-8
+//    Param.    5: unsigned mode      : UTF8_xxx
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one code point, returns the bytes it took
+/*--------------------------------------------------------------------@@-@@-*/
+static size_t Utf8Char ( const uint16_t * s, size_t len, size_t * i,
+    char * out, unsigned mode )
+/*--------------------------------------------------------------------------*/
+{
+    static const char hex[] = "0123456789abcdef";
+
+    unsigned c, d;
+
+    c = s[(*i)++];
+
+    if ( c < 0x80 )
+    {
+        out[0] = (char)c;
+
+        if ( mode == UTF8_CSV && c == '"' )
+        {
+            out[1] = '"';
+            return 2;
+        }
+
+        if ( mode == UTF8_TSV && c < 0x20 )
+            out[0] = ' ';
+
+        if ( mode == UTF8_JSON && ( c == '"' || c == '\\' ) )
+        {
+            out[0] = '\\';
+            out[1] = (char)c;
+            return 2;
+        }
+
+        if ( mode == UTF8_JSON && c < 0x20 )
+        {
+            memcpy ( out, "\\u00", 4 );
+            out[4] = hex[c >> 4];
+            out[5] = hex[c & 0xF];
+            return 6;
+        }
+
+        return 1;
+    }
+
+    if ( c < 0x800 )
+    {
+        out[0] = (char)( 0xC0 | ( c >> 6 ) );
+        out[1] = (char)( 0x80 | ( c & 0x3F ) );
+        return 2;
+    }
+
+    if ( c >= 0xD800 && c <= 0xDFFF )
+    {
+        d = ( *i < len ) ? s[*i] : 0;
+
+        if ( c > 0xDBFF || d < 0xDC00 || d > 0xDFFF )
+            c = 0xFFFD;
+        else
+        {
+            (*i)++;
+            c = 0x10000 + ( ( c - 0xD800 ) << 10 ) + ( d - 0xDC00 );
+
+            out[0] = (char)( 0xF0 | ( c >> 18 ) );
+            out[1] = (char)( 0x80 | ( ( c >> 12 ) & 0x3F ) );
+            out[2] = (char)( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+            out[3] = (char)( 0x80 | ( c & 0x3F ) );
+            return 4;
+        }
+    }
+
+    out[0] = (char)( 0xE0 | ( c >> 12 ) );
+    out[1] = (char)( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+    out[2] = (char)( 0x80 | ( c & 0x3F ) );
+    return 3;
+}
@@ -0,0 +1,24 @@
+
+// utf8.h - UTF-16 names to UTF-8 for the exports, escaped on the way as
+// the format wants. No Windows headers: the text is UTF-16 units, which
+// a WCHAR is there, and it's tested anywhere (see tests/).
+
+#ifndef _UTF8_H
+#define _UTF8_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define UTF8_PLAIN          0       // as is
+#define UTF8_CSV            1       // " doubled, for inside a quoted field
+#define UTF8_TSV            2       // control chars (tab, CR, LF) blanked
+#define UTF8_JSON           3       // " \ and control chars escaped, for
+                                    // inside a JSON string
+
+#define UTF8_MAX(cch)       ( (size_t)(cch) * 6 )   // bytes any cch chars
+                            // can take, whatever the mode
+
+size_t      Utf8Encode      ( const uint16_t * s, size_t len, char * out,
+                                unsigned mode );
+
+#endif // _UTF8_H
@@ -0,0 +1,89 @@
+
+// weigh.c - how long a folder will take to walk, going by an older
+// snapshot of the same roots, for eng->longest
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "weigh.h"
+#include "pathidx.h"
+#include <windows.h>
+#include <wchar.h>
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: WeighInit
+/*--------------------------------------------------------------------------*/
+//           Type: void
+//    Param.    1: WEIGHER * wg          : weigher to set up
+//    Param.    2: const SNAPSHOT * prev : older walk, open, kept open for
+//                                         as long as the walk runs
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+void WeighInit ( WEIGHER * wg, const SNAPSHOT * prev )
+/*--------------------------------------------------------------------------*/
+{
+    UINT i;
+
+    wg->prev = prev;
+
+    for ( i = 0; i < ENG_MAX_THREADS; i++ )
+    {
+        wg->node[i]     = ENG_NONE;
+        wg->match[i]    = ENG_NONE;
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: WeighFolder
+/*--------------------------------------------------------------------------*/
+//           Type: UINT
+//    Param.    1: WEIGHER * wg       : weigher
+//    Param.    2: const ENGINE * eng : engine walking
+//    Param.    3: UINT worker        : worker asking, for its cache
+//    Param.    4: UINT node          : folder being enumerated, ENG_NONE
+//                                      for a root
+//    Param.    5: const WCHAR * name : subfolder found in it, or the
+//                                      root's path
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the on_weigh answer. node is matched in the snapshot
+//                 by its path (PathIdxMatch, which only reads node and
+//                 its parents, set for good by now), once per folder per
+//                 worker; then the subfolder is one probe below it.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT WeighFolder ( WEIGHER * wg, const ENGINE * eng, UINT worker,
+    UINT node, const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    const SNAPSHOT  * prev;
+    UINT            match;
+
+    prev = wg->prev;
+
+    if ( prev == NULL || prev->view == NULL || worker >= ENG_MAX_THREADS )
+        return 1;
+
+    if ( node != ENG_NONE )
+    {
+        if ( wg->node[worker] != node )
+        {
+            wg->node[worker]    = node;
+            wg->match[worker]   = PathIdxMatch ( &prev->idx, &prev->eng,
+                                    eng, node );
+        }
+
+        if ( wg->match[worker] == ENG_NONE )
+            return 1;
+    }
+
+    match = PathIdxChild ( &prev->idx, &prev->eng,
+        ( node != ENG_NONE ) ? wg->match[worker] : ENG_NONE, name,
+        (UINT)wcslen ( name ) );
+
+    if ( match == ENG_NONE || prev->eng.tdirs[match] == ENG_NONE )
+        return 1;
+
+    return prev->eng.tdirs[match] + 1;
+}
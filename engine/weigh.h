@@ -0,0 +1,27 @@
+
+// weigh.h - how long a folder will take to walk, going by an older
+// snapshot of the same roots, for eng->longest
+
+#ifndef _WEIGH_H
+#define _WEIGH_H
+
+#include <windows.h>
+#include "engine.h"
+#include "snap.h"
+
+// A folder weighs what it had below it last time, in folders, plus one
+// for itself; one it doesn't know weighs 1. Workers ask about every
+// subfolder of the folder they're in, so each keeps that folder's match
+// in the snapshot and it's one probe per subfolder.
+typedef struct _weigher
+{
+    const SNAPSHOT  * prev;
+    UINT            node[ENG_MAX_THREADS];  // last folder a worker asked
+    UINT            match[ENG_MAX_THREADS]; // about, and its node in prev
+} WEIGHER;
+
+void    WeighInit       ( WEIGHER * wg, const SNAPSHOT * prev );
+UINT    WeighFolder     ( WEIGHER * wg, const ENGINE * eng, UINT worker,
+                            UINT node, const WCHAR * name );
+
+#endif // _WEIGH_H
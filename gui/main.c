@@ -27,20 +27,25 @@
     Features
     ---------
     
-    It's designed to take a single folder path from command line and
-    go recursively from there to calculate total and subfolder size,
+    It takes one or more folder paths from command line and goes
+    recursively from there to calculate total and subfolder size,
     presenting a list with all of them. If no start folder is specified,
-    it uses the folder it was executed from.
+    it uses the folder it was executed from. Folders are crawled by a
+    pool of worker threads, all roots at the same time; a root that
+    lives inside another one given is only counted once.
 
     The console version takes a maximum "depth" (folder-in-folder) as
     a second optional parameter.
 
     The gui version is intended to work with the included Explorer shell 
-    extension which starts the app with the selected folder. Multiple  
-    or file selection is ignored. The folder crawling process starts in a
+    extension which starts the app with the selected folder(s). File
+    selection is ignored. The folder crawling process starts in a
     separate thread and works reasonably fast. If so desired, the process
     can be interrupted. The resulting list can be sorted ascending or
-    descending. 
+    descending. A complete walk is kept as a snapshot, next time the
+    same folders are opened it's mapped and shown right away, greyed
+    out, and each row gets its new size as the new walk finishes the
+    folder.
 
     Nothing fancy, but gets the job done reasonably fast,
     in under 100 KBytes :-)
@@ -59,11 +64,21 @@
 #include "main.h"
 #include "lv.h"
 #include "mem.h"
+#include "tmview.h"
+#include "../engine/engine.h"
+#include "../engine/export.h"
+#include "../engine/nav.h"
+#include "../engine/pathidx.h"
+#include "../engine/search.h"
+#include "../engine/snap.h"
+#include "../engine/weigh.h"
 #include <windows.h>
 #include <windowsx.h>
 #include <process.h>
 #include <commctrl.h>
 #include <strsafe.h>
+#include <stdlib.h>
+#include <wctype.h>
 
 // structure to pass to thread functions
 typedef struct _fsize_thread_data
@@ -72,15 +87,13 @@ typedef struct _fsize_thread_data
     LPARAM      lParam;     // unused
     HWND        hList;      // listview hwnd
     HWND        hParent;    // dlg hwnd
-    WCHAR       * fpath;    // root path
-    WCHAR       * crtDir;   // current path
-    __int64     size;       // crt. folder size
-    __int64     * fsizes;   // always holds the correct fsize table address
-    UINT        errcode;    // unused
+    WCHAR       * fpath;    // root path (the first one)
+    ENGINE      * eng;      // the crawler, holds all the roots
+    __int64     size;       // total size, once done
+    UINT        errcode;    // 0 if the walk went all the way
     UINT_PTR    subfolders; // how many subfolders processed
     UINT_PTR    files;      // how many files processed
-    UINT_PTR    depth;      // depth of recursion
-    UINT_PTR    index;      // used for indexing of fsizes table
+    UINT_PTR    index;      // rows in gRows
 } THREAD_DATA;
 
 // function prototypes
@@ -91,24 +104,38 @@ typedef HRESULT (WINAPI *PGetDpiForMonitor)(HMONITOR hmonitor,
 WORD GetWindowDPI ( HWND hWnd );
 WCHAR ** FILE_CommandLineToArgv ( WCHAR * CmdLine, int * _argc );
 INT_PTR CALLBACK MainDlgProc ( HWND, UINT, WPARAM, LPARAM );
-BOOL IsDotOrTwoDots ( const WCHAR * src );
-
-__int64 FolderSize ( const WCHAR * fpath, THREAD_DATA * ptd );
-
+void OnFolderFinal ( void * ctx, UINT node );
+void OnFolderRound ( void * ctx, UINT levels );
+UINT OnFolderWeigh ( void * ctx, UINT worker, UINT node,
+    const WCHAR * name );
 UINT __stdcall Thread_FolderSize ( void * thData );
 BOOL CALLBACK EnumChildProc ( HWND hwndChild, LPARAM lParam );
 BOOL ContextMenu ( HWND hWnd, int menuId );
 BOOL SaveFolderListToCSV ( HWND hWnd );
-BOOL LVItemsToCSV ( HWND hList, const WCHAR * fname);
-
-int CALLBACK CompareListItems
-( LPARAM lParam1, LPARAM lParam2, LPARAM lParamSort );
+BOOL ShowTreemap ( HWND hWnd );
+BOOL ListTreeView ( HWND hList, BOOL on );
+BOOL ListTreeKey ( HWND hList, WORD vk );
+void ListTreeUpdate ( HWND hList, int sel );
+BOOL ListFilter ( HWND hWnd );
+BOOL ListToCSV ( const WCHAR * fname );
+BOOL SnapFileName ( WCHAR * buf, DWORD cchDest );
+UINT ListNode ( int row );
+BOOL ListGetDispInfo ( NMLVDISPINFOW * pdi );
+BOOL ListSort ( BOOL ascending );
+BOOL ListCustomDraw ( HWND hWnd, NMLVCUSTOMDRAW * pcd );
+__int64 ListSize ( const ENGINE * eng, UINT node );
+void ListShowLive ( HWND hList );
+BOOL ListRank ( THREAD_DATA * ptd );
+void FormatKBytes ( __int64 size, WCHAR * buf, int cchDest );
+
+int CompareRows ( const void * row1, const void * row2 );
 
 // message handlers
 BOOL MainDLG_OnCOMMAND ( HWND hWnd, WPARAM wParam, LPARAM lParam );
 BOOL MainDLG_OnSIZING ( HWND hWnd, WPARAM wParam, LPARAM lParam );
 BOOL MainDLG_OnSIZE ( HWND hWnd, WPARAM wParam, LPARAM lParam );
 BOOL MainDLG_OnUPDFSIZE ( HWND hWnd, WPARAM wParam, LPARAM lParam );
+BOOL MainDLG_OnRNDFSIZE ( HWND hWnd, WPARAM wParam, LPARAM lParam );
 BOOL MainDLG_OnENDFSIZE ( HWND hWnd, WPARAM wParam, LPARAM lParam );
 BOOL MainDLG_OnINITDIALOG ( HWND hWnd, WPARAM wParam, LPARAM lParam );
 BOOL MainDLG_OnNOTIFY ( HWND hWnd, WPARAM wParam, LPARAM lParam );
@@ -124,6 +151,7 @@ int         gbnWidth, gbnHeight;        // hold button width and height
 HANDLE      ghInstance;
 HWND        ghList;                     // listview hwnd
 WCHAR       grootDir[1024];             // passed from cmdline
+WCHAR       grootLabel[1100];           // same, plus "(+n more)"
 UINT        gTid;                       // worker thread id
 UINT_PTR    gThandle;                   // worker thread handle
 BOOL        gThreadWorking = FALSE;     // flag for the worker thread
@@ -132,15 +160,51 @@ WORD        gDpi;                       // holds current monitor DPI
 
 THREAD_DATA gTtd;                       // structure to pass data to and
                                         // from the worker thread
-
-size_t      gfSizesCapacity;            // will hold gfSizes current capacity
-__int64     * gfSizes;                  // pointer to int64 table that 
-                                        // will hold ALL processed 
-                                        // folders (gTtd.crtDir) size;
-                                        // index of each element from
-                                        // this table are stored in the  
-                                        // coresponding list items data
-                                        // struct
+ENGINE      gEngine;                    // folder crawler, runs its own
+                                        // worker pool under gThandle
+
+size_t      gRowsCapacity;              // will hold gRows current capacity
+UINT        * gRows;                    // the list is virtual, a row is
+                                        // just the engine node of a
+                                        // processed folder, in the order
+                                        // they were done (or sorted);
+                                        // the text comes from the
+                                        // engine when the list asks
+UINT        gRanked;                    // the top folders, first in
+                                        // gRows from the first level
+                                        // done, biggest first so far
+BOOL        gRankedIn;                  // they're in
+
+SNAPSHOT    gSnap;                      // last complete walk of the same
+                                        // folders, mapped read-only
+BOOL        gSnapShown;                 // the list shows gSnap until the
+                                        // new walk is done
+UINT        * gSnapRows;                // its rows once sorted, NULL
+                                        // means node order
+WEIGHER     gWeigh;                     // what gSnap's folders weigh,
+                                        // to walk the biggest first
+__int64     * gFresh;                   // sizes from the new walk, per
+                                        // snapshot node, -1 until its
+                                        // folder is done again
+UINT        gFreshCount;                // rows updated so far
+WCHAR       gSnapFile[MAX_PATH];        // where it lives
+WCHAR       gSnapNew[MAX_PATH];         // the new one, until moved over
+WCHAR       gSnapNote[128];             // ", grey is the <date> scan"
+
+NAV         gNav;                       // folder tree view of the walk,
+                                        // a folder's subfolders only
+                                        // once it's opened
+BOOL        gTreeView;                  // the list shows gNav's rows
+
+SEARCH_INDEX gSearchIdx;                // the walk's names, indexed the
+                                        // first time the find box is
+                                        // typed in
+SEARCH      gSearch;                    // folders matching it
+BOOL        gFiltered;                  // the list shows gSearch.hits
+
+const ENGINE * gSortEng;                // for CompareRows
+BOOL        gSortAscending;
+BOOL        gSorted;                    // sort again after switching
 
 SYSTEMTIME  gTimeStart;                 // for calculating elapsed time
 
@@ -175,8 +239,7 @@ int APIENTRY wWinMain ( HINSTANCE hInstance, HINSTANCE hPrevInstance,
     INITCOMMONCONTROLSEX    icc;
     WNDCLASSEXW             wcx;
     WCHAR                   ** cmdLine;
-    int                     argc, result;
-    INT_PTR                 idx;
+    int                     argc, result, i;
 
     ghInstance          = hInstance;
 
@@ -195,7 +258,7 @@ int APIENTRY wWinMain ( HINSTANCE hInstance, HINSTANCE hPrevInstance,
     wcx.hIcon           = LoadIconW ( hInstance, MAKEINTRESOURCE(IDR_ICO_MAIN) );
     wcx.lpszClassName   = L"wfsizeClass";
 
-    if ( !RegisterClassExW (&wcx) )
+    if ( !RegisterClassExW (&wcx) || !TMViewRegister ( hInstance ) )
         return 0;
 
     grootDir[0]         = L'\0';
@@ -206,14 +269,7 @@ int APIENTRY wWinMain ( HINSTANCE hInstance, HINSTANCE hPrevInstance,
 
     // do we have something to do from cmd line?
     if ( argc >= 2 && cmdLine != NULL )
-    {
         StringCchCopyW ( grootDir, ARRAYSIZE(grootDir), cmdLine[1] );
-        idx = lstrlenW ( grootDir );
-
-        // erase any trailing backslash :-)
-        if ( grootDir[idx-1] == L'\\' )
-            grootDir[idx-1] = L'\0';
-    }
     // no, just use the crt dir
     else
     {
@@ -230,12 +286,51 @@ int APIENTRY wWinMain ( HINSTANCE hInstance, HINSTANCE hPrevInstance,
         }
     }
 
+    // all folders given are crawled together, the engine takes
+    // care of trailing backslashes and of roots inside other roots
+    if ( !EngineInit ( &gEngine, 0, MAX_DEPTH, 0 ) )
+    {
+        MessageBoxW ( NULL, L"Unable to allocate memory for the folder"
+            " crawler!", app_name, MB_OK | MB_ICONEXCLAMATION );
+
+        if ( cmdLine != NULL )
+            GlobalFree ( cmdLine );
+
+        return 0;
+    }
+
+    EngineAddRoot ( &gEngine, grootDir );
+
+    for ( i = 2; i < argc && cmdLine != NULL; i++ )
+        EngineAddRoot ( &gEngine, cmdLine[i] );
+
+    // show the first root only, the list tells the rest
+    if ( gEngine.nroots != 0 )
+        StringCchCopyW ( grootDir, ARRAYSIZE(grootDir), 
+            gEngine.roots[0].path );
+
+    if ( gEngine.nroots > 1 )
+        StringCchPrintfW ( grootLabel, ARRAYSIZE(grootLabel), 
+            L"%ls (+%u more)", grootDir, gEngine.nroots - 1 );
+    else
+        StringCchCopyW ( grootLabel, ARRAYSIZE(grootLabel), grootDir );
+
+    // last time's tree, if there is one, is up before the window is.
+    // Nothing is read here, the list pulls in the pages it shows.
+    if ( SnapFileName ( gSnapFile, ARRAYSIZE(gSnapFile) ) )
+    {
+        StringCchPrintfW ( gSnapNew, ARRAYSIZE(gSnapNew), L"%ls.new",
+            gSnapFile );
+
+        gSnapShown = SnapOpen ( &gSnap, gSnapFile );
+    }
+
     // make initial capacity equal to list capacity
-    gfSizesCapacity = LV_DEFAULT_CAPACITY;
+    gRowsCapacity = LV_DEFAULT_CAPACITY;
 
-    gfSizes = alloc_and_zero_mem (gfSizesCapacity*sizeof(__int64));
+    gRows = alloc_and_zero_mem (gRowsCapacity*sizeof(UINT));
 
-    if ( gfSizes == NULL )
+    if ( gRows == NULL )
     {
         MessageBoxW ( NULL, L"Unable to allocate memory for folders"
             " size table!", app_name, 
@@ -244,17 +339,41 @@ int APIENTRY wWinMain ( HINSTANCE hInstance, HINSTANCE hPrevInstance,
         if ( cmdLine != NULL )
             GlobalFree ( cmdLine );
 
+        SnapClose ( &gSnap );
+        EngineFree ( &gEngine );
+
         return 0;
     }
 
     result = (int)DialogBoxW ( hInstance, MAKEINTRESOURCE(DLG_MAIN), 
         NULL, (DLGPROC)MainDlgProc );
 
+    // closed while still crawling, WM_DESTROY told the engine to
+    // stop; wait for the workers before pulling the rug
+    if ( gThandle )
+    {
+        WaitForSingleObject ( (HANDLE)gThandle, INFINITE );
+        CloseHandle ( (HANDLE)gThandle );
+        gThandle = 0;
+    }
+
+    NavFree ( &gNav );
+    SearchFree ( &gSearch );
+    SearchFreeIndex ( &gSearchIdx );
+    SnapClose ( &gSnap );
+    EngineFree ( &gEngine );
+
     if ( cmdLine != NULL )
         GlobalFree ( cmdLine );
 
-    if ( gfSizes != NULL )
-        free_mem ( gfSizes );
+    if ( gRows != NULL )
+        free_mem ( gRows );
+
+    if ( gSnapRows != NULL )
+        free_mem ( gSnapRows );
+
+    if ( gFresh != NULL )
+        free_mem ( gFresh );
 
     return result;
 }
@@ -285,10 +404,7 @@ INT_PTR CALLBACK MainDlgProc ( HWND hwndDlg, UINT uMsg,
 
         // pass WM_NOTIFY for further processing (column header click?)
         case WM_NOTIFY:
-
-            if ( !gThreadWorking ) // do not disturb :-)
-                MainDLG_OnNOTIFY ( hwndDlg, wParam, lParam );
-
+            MainDLG_OnNOTIFY ( hwndDlg, wParam, lParam );
             return TRUE;
 
         // WM_UPDFSIZE is received when the working thread is done
@@ -306,7 +422,7 @@ INT_PTR CALLBACK MainDlgProc ( HWND hwndDlg, UINT uMsg,
                 {
                     gThreadWorking = FALSE;
 
-                    PostThreadMessage ( gTid, WM_ABTFSIZE, 0, 0 );
+                    EngineAbort ( &gEngine );
                     EnableWindow ( GetDlgItem ( hwndDlg, IDC_BREAKOP ), FALSE);
                     #ifdef LV_FAST_UPDATE
                         EndDraw ( ghList );
@@ -319,6 +435,12 @@ INT_PTR CALLBACK MainDlgProc ( HWND hwndDlg, UINT uMsg,
 
             return TRUE;
 
+        // WM_RNDFSIZE is received when the walk is done with another
+        // level of folders
+        case WM_RNDFSIZE:
+            MainDLG_OnRNDFSIZE ( hwndDlg, wParam, lParam );
+            return TRUE;
+
         // WM_ENDFSIZE is received when the whole operation is finished
         case WM_ENDFSIZE:
             MainDLG_OnENDFSIZE ( hwndDlg, wParam, lParam );
@@ -351,8 +473,8 @@ INT_PTR CALLBACK MainDlgProc ( HWND hwndDlg, UINT uMsg,
             break;
 
         case WM_DESTROY:
-            // signal the working thread that we've gone fishing :-)
-            PostThreadMessage ( gTid, WM_RAGEQUIT, 0, 0 );
+            // signal the working threads that we've gone fishing :-)
+            EngineAbort ( &gEngine );
             return TRUE;
 
         case WM_CLOSE:
@@ -367,165 +489,155 @@ INT_PTR CALLBACK MainDlgProc ( HWND hwndDlg, UINT uMsg,
 }
 
 /*-@@+@@--------------------------------------------------------------------*/
-//       Function: IsDotOrTwoDots 
+//       Function: OnFolderFinal 
 /*--------------------------------------------------------------------------*/
-//           Type: BOOL 
-//    Param.    1: const WCHAR * src : whatever string
+//           Type: void 
+//    Param.    1: void * ctx : pointer to THREAD_DATA struct
+//    Param.    2: UINT node  : folder whose size is now known
 /*--------------------------------------------------------------------------*/
 //         AUTHOR: Adrian Petrila, YO3GFH
-//           DATE: 10.09.2022
-//    DESCRIPTION: see if src is . or ..
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine hook, called by any of the workers once a folder
+//                 and everything below it is done. Hands the node over
+//                 to the dialog, which adds it to the list.
 /*--------------------------------------------------------------------@@-@@-*/
-BOOL IsDotOrTwoDots ( const WCHAR * src )
+void OnFolderFinal ( void * ctx, UINT node )
 /*--------------------------------------------------------------------------*/
 {
-    INT_PTR len;
-
-    if ( src == NULL )
-        return FALSE;
-
-    len = lstrlenW ( src );
+    THREAD_DATA * ptd;
 
-    if ( (len == 1 && src[0] == L'.') || 
-         (len == 2 && src[0] == L'.' && src[1] == L'.') )
-            return TRUE;
+    ptd = (THREAD_DATA *)ctx;
 
-    return FALSE;
+    // please don't use PostMessage, unless you worship Satan 8-)
+    // (the workers wait in line, the list is only touched by the
+    // dialog thread)
+    SendMessageW ( ptd->hParent, WM_UPDFSIZE, (WPARAM)node, (LPARAM)ptd );
 }
 
 /*-@@+@@--------------------------------------------------------------------*/
-//       Function: FolderSize 
+//       Function: OnFolderRound 
 /*--------------------------------------------------------------------------*/
-//           Type: __int64 
-//    Param.    1: const WCHAR * fpath: path to folder to calculate its size
-//    Param.    2: THREAD_DATA * ptd  : pointer to data struct passed by the 
-//                                      thread function
+//           Type: void 
+//    Param.    1: void * ctx  : pointer to THREAD_DATA struct
+//    Param.    2: UINT levels : folder levels done
 /*--------------------------------------------------------------------------*/
 //         AUTHOR: Adrian Petrila, YO3GFH
-//           DATE: 10.09.2022
-//    DESCRIPTION: this will compute the size of the folder specified by 
-//                 fpath, recursing through subfolders, with a 
-//                 "folder in folder" limit of MAX_DEPTH. Returns total size
-//                 or 0 on error.
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine hook, called by the worker that finished a level
+//                 of folders. The dialog ranks the top folders again.
 /*--------------------------------------------------------------------@@-@@-*/
-__int64 FolderSize ( const WCHAR * fpath, THREAD_DATA * ptd )
+void OnFolderRound ( void * ctx, UINT levels )
 /*--------------------------------------------------------------------------*/
 {
-    WIN32_FIND_DATAW    ffData;
-    HANDLE              hFind;
-    __int64             size;
-    __int64             * tmpptr;
-    WCHAR               buf[1024];
-    WCHAR               tmp[1024];
-    LARGE_INTEGER       li;
-    MSG                 msg;
-
-    if ( fpath == NULL || ptd == NULL )
-        return 0;
-
-    size = 0;
-
-    StringCchCopyW ( buf, ARRAYSIZE(buf), fpath );
-    StringCchCopyW ( tmp, ARRAYSIZE(tmp), fpath ); // save a pristine copy
-    StringCchCatW ( buf, ARRAYSIZE(buf), L"\\*" );
-
-    // start enumerating
-    hFind = FindFirstFileExW ( buf, FindExInfoStandard, &ffData, 
-        FindExSearchNameMatch, NULL, 0 );
-
-    if ( hFind != INVALID_HANDLE_VALUE )
-    {
-        do
-        {
-            // do we have a folder?
-            if ( ffData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
-            {
-                // skip . and .. (crt and parent folder)
-                if ( !IsDotOrTwoDots ( ffData.cFileName ) )
-                {
-                    // complete path with folder name
-                    StringCchCopyW ( buf+lstrlenW(fpath)+1, 
-                        ARRAYSIZE(buf), ffData.cFileName );
-
-                    ptd->depth++;
-                    ptd->subfolders++;
-                    // do recursion!
-                    size += FolderSize ( buf, ptd );
-                    ptd->depth--;
-                }
-            }
-            else // just files, add to total size
-            {
-                li.u.HighPart = ffData.nFileSizeHigh;
-                li.u.LowPart = ffData.nFileSizeLow;
-                size += li.QuadPart;
-                ptd->files++;
-            }
-        }
-
-        // stop if max. level of folder imbrication reached
-        while ( ( FindNextFile ( hFind, &ffData ) != 0 ) &&
-                  ( ptd->depth < MAX_DEPTH ) );
-    }
-
-    FindClose ( hFind );
-
-    // see if abort or sudden app quit happened (WM_ABTFSIZE
-    // or WM_RAGEQUIT messages) and simulate a MAX_DEPTH
-    // overflow to stop recursion
-    if ( PeekMessage ( &msg, (HWND)-1, WM_APP+100, WM_APP+200, PM_REMOVE ) )
-        ptd->depth = MAX_DEPTH+10;
-
-    // see if we reached the end of our current table, calculate the
-    // new size and realloc accordingly
-    if ( ptd->subfolders >= gfSizesCapacity - 1 )
-    {
-        gfSizesCapacity += (LV_DEFAULT_CAPACITY + 
-                (ptd->subfolders - gfSizesCapacity - 1));
+    THREAD_DATA * ptd;
 
-        tmpptr = realloc_and_zero_mem ( ptd->fsizes, 
-            gfSizesCapacity*sizeof (__int64));
+    ptd = (THREAD_DATA *)ctx;
 
-        if ( tmpptr != NULL )
-            ptd->fsizes = tmpptr;
-        else
-            ptd->depth = MAX_DEPTH+10; // can't go further so force eject
-    }
+    SendMessageW ( ptd->hParent, WM_RNDFSIZE, (WPARAM)levels, (LPARAM)ptd );
+}
 
-    // put results in our structure...
-    ptd->size       = size;
-    ptd->crtDir     = tmp;
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnFolderWeigh 
+/*--------------------------------------------------------------------------*/
+//           Type: UINT 
+//    Param.    1: void * ctx         : pointer to THREAD_DATA struct
+//    Param.    2: UINT worker        : worker asking
+//    Param.    3: UINT node          : folder being enumerated
+//    Param.    4: const WCHAR * name : subfolder found in it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine hook, with a snapshot shown. How much the
+//                 subfolder had below it last time.
+/*--------------------------------------------------------------------@@-@@-*/
+UINT OnFolderWeigh ( void * ctx, UINT worker, UINT node,
+    const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    THREAD_DATA * ptd;
 
-    // ...and signal main thread that we have data
-    // please don't use PostMessage, unless you worship Satan 8-)
-    SendMessageW ( ptd->hParent, WM_UPDFSIZE, 0, (LPARAM)ptd );
+    ptd = (THREAD_DATA *)ctx;
 
-    return size;
+    return WeighFolder ( &gWeigh, ptd->eng, worker, node, name );
 }
 
 /*-@@+@@--------------------------------------------------------------------*/
 //       Function: Thread_FolderSize 
 /*--------------------------------------------------------------------------*/
 //           Type: UINT __stdcall 
-//    Param.    1: void * thData : pointer to THREAD_DATA struct to pass
-//                                 to FolderSize
+//    Param.    1: void * thData : pointer to THREAD_DATA struct
 /*--------------------------------------------------------------------------*/
 //         AUTHOR: Adrian Petrila, YO3GFH
 //           DATE: 10.09.2022
-//    DESCRIPTION: thread function for _beginthreadex
+//    DESCRIPTION: thread function for _beginthreadex. Runs the engine (it
+//                 starts and joins its own workers) and sums up the roots
+//                 that were walked, nested ones are already in there.
+//                 The walk goes level by level, so the top folders can
+//                 be ranked from the start, by what's found in them;
+//                 with last time's tree on screen there's no need, the
+//                 folders that were biggest then go first instead, so
+//                 the walk is over sooner.
+//                 A complete walk is saved to gSnapNew, the dialog moves
+//                 it over the old snapshot once it stopped showing it.
 /*--------------------------------------------------------------------@@-@@-*/
 UINT __stdcall Thread_FolderSize ( void * thData )
 /*--------------------------------------------------------------------------*/
 {
     THREAD_DATA * ptd;
+    ENGINE      * eng;
+    PATH_INDEX  pi;
+    FILETIME    ft;
+    UINT        i, walked;
 
     if ( thData == NULL )
         return FALSE;
 
     ptd = (THREAD_DATA *)thData;
+    eng = ptd->eng;
+
+    eng->hooks.ctx      = ptd;
+    eng->hooks.on_final = OnFolderFinal;
+    eng->hooks.on_round = OnFolderRound;
+    eng->breadth        = !gSnapShown;
+
+    if ( gSnapShown )
+    {
+        WeighInit ( &gWeigh, &gSnap );
+        eng->hooks.on_weigh = OnFolderWeigh;
+        eng->longest        = TRUE;
+    }
+
+    GetSystemTimeAsFileTime ( &ft );
 
     // do actual work
-    ptd->size = FolderSize ( ptd->fpath, ptd );
+    ptd->errcode = !EngineRun ( eng );
+
+    if ( ptd->errcode == 0 && gSnapNew[0] != L'\0' )
+    {
+        if ( PathIdxBuild ( &pi, eng ) )
+        {
+            if ( !SnapSave ( eng, &pi, ( (UINT64)ft.dwHighDateTime << 32 )
+                    | ft.dwLowDateTime, gSnapNew ) )
+                gSnapNew[0] = L'\0';
+
+            PathIdxFree ( &pi );
+        }
+        else
+            gSnapNew[0] = L'\0';
+    }
+
+    ptd->size   = 0;
+    walked      = 0;
+
+    for ( i = 0; i < eng->nroots; i++ )
+        if ( eng->roots[i].state == ENG_ROOT_WALKED )
+        {
+            ptd->size += eng->size[eng->roots[i].node];
+            walked++;
+        }
+
+    ptd->subfolders = (UINT_PTR)eng->total_dirs - walked;
+    ptd->files      = (UINT_PTR)eng->total_files;
 
     // signal end of work an return ASAP, hence PostMessage
     return (UINT) PostMessageW ( ptd->hParent, 
@@ -729,6 +841,18 @@ BOOL CALLBACK EnumChildProc ( HWND hwndChild, LPARAM lParam )
             ShowWindow ( hwndChild, SW_SHOW );
             break;
 
+        // find box, left of the buttons
+        case IDC_FFILTER:
+            newTop = rcParent->bottom - MulDiv((13 + gbnHeight),
+                gDpi,DEFAULT_DPI);
+
+            MoveWindow ( hwndChild, MulDiv(8,gDpi,DEFAULT_DPI), newTop, 
+                MulDiv(300,gDpi,DEFAULT_DPI), MulDiv(gbnHeight,
+                    gDpi,DEFAULT_DPI), TRUE );
+
+            ShowWindow ( hwndChild, SW_SHOW );
+            break;
+
         // listview
         case IDC_FLIST:
             newWidth = rcParent->right - (MulDiv(8+8,gDpi,DEFAULT_DPI));
@@ -772,7 +896,32 @@ BOOL MainDLG_OnCOMMAND ( HWND hWnd, WPARAM wParam, LPARAM lParam )
 
             break;
 
+        case IDM_TREEMAP:
+            ShowTreemap ( hWnd );
+            break;
+
+        case IDM_TREEVIEW:
+            ListTreeView ( ghList, !gTreeView );
+            break;
+
+        case IDC_FFILTER:
+
+            if ( GET_WM_COMMAND_CMD(wParam, lParam) == EN_CHANGE )
+                ListFilter ( hWnd );
+
+            break;
+
         case IDOK:
+
+            // Enter in the find box goes to what it found
+            if ( GetFocus () == GetDlgItem ( hWnd, IDC_FFILTER ) )
+            {
+                LVSelectItem ( ghList, 0 );
+                LVEnsureVisible ( ghList, 0 );
+                SetFocus ( ghList );
+                return TRUE;
+            }
+
             EndDialog ( hWnd, TRUE );
             return TRUE;
 
@@ -787,7 +936,7 @@ BOOL MainDLG_OnCOMMAND ( HWND hWnd, WPARAM wParam, LPARAM lParam )
             {
                 gThreadWorking = FALSE;
 
-                PostThreadMessage ( gTid, WM_ABTFSIZE, 0, 0 );
+                EngineAbort ( &gEngine );
                 EnableWindow ( GetDlgItem ( hWnd, IDC_BREAKOP ), FALSE );
                 #ifdef LV_FAST_UPDATE
                     EndDraw ( ghList );
@@ -936,60 +1085,132 @@ BOOL MainDLG_OnSIZE ( HWND hWnd, WPARAM wParam, LPARAM lParam )
 //           DATE: 10.09.2022
 //    DESCRIPTION: message handler for the WM_UPDFSIZE, sent by our thread
 //                 when data is available to be inserted into the list.
+//                 wParam is the engine node of the folder that's done.
 /*--------------------------------------------------------------------@@-@@-*/
 BOOL MainDLG_OnUPDFSIZE ( HWND hWnd, WPARAM wParam, LPARAM lParam )
 /*--------------------------------------------------------------------------*/
 {
     THREAD_DATA         * ptd;
+    UINT                * tmpptr;
+    UINT                snode;
+    BOOL                top;
     WCHAR               f[1024];
-    WCHAR               s[1024];
 
     ptd = (THREAD_DATA *)lParam;
 
     if ( ptd != NULL )
     {
-        StringCchPrintfW ( f, ARRAYSIZE(f), L"%.2f", 
-            ((float)(ptd->size))/1024);
-
-        // format the number with the default thousand separator
-        GetNumberFormatW ( LOCALE_SYSTEM_DEFAULT, 
-            LOCALE_NOUSEROVERRIDE, f, NULL, s, ARRAYSIZE(s) );
+        // see if we reached the end of our current table and realloc.
+        // Only this thread touches it, the workers just wait for us.
+        if ( ptd->index >= gRowsCapacity - 1 )
+        {
+            tmpptr = realloc_and_zero_mem ( gRows, 
+                (gRowsCapacity + LV_DEFAULT_CAPACITY)*sizeof (UINT));
 
-        // add result to the list and store index to folder size 
-        // in the list as lParam member of LVITEM struct so we can sort 
-        // the list at a later time. NOTE: don't store pointers!
-        // this mem will be realloc'd and any ptr will be invalid!
-        gfSizes = ptd->fsizes;
+            if ( tmpptr == NULL )
+                return FALSE; // can't go further so force eject
 
-        __try
-        {
-            gfSizes[ptd->index] = ptd->size;
+            gRows          = tmpptr;
+            gRowsCapacity += LV_DEFAULT_CAPACITY;
         }
-        __except ( EXCEPTION_EXECUTE_HANDLER )
+
+        // add the folder to the list; nothing is copied, the list asks
+        // for the text (LVN_GETDISPINFO) when it draws the row. A
+        // snapshot on screen stays there until the walk is done, its
+        // row for the same folder takes the new size instead. The top
+        // folders have a row from ListRank, it just stops being grey.
+        top = ( ptd->eng->depth[wParam] == 1 );
+
+        if ( !top )
+            gRows[ptd->index] = (UINT)wParam;
+
+        if ( !gSnapShown && top )
+            InvalidateRect ( ptd->hList, NULL, FALSE );
+        else if ( !gSnapShown )
+            ListView_SetItemCountEx ( ptd->hList, ptd->index + 1,
+                LVSICF_NOSCROLL | LVSICF_NOINVALIDATEALL );
+        else if ( gFresh != NULL )
         {
-            return FALSE; // great booboo happened
-        }
-    
-        LVInsertItemEx ( ptd->hList, ptd->index, -1, ptd->crtDir, 
-            (LPARAM)(ptd->index) );
+            snode = PathIdxMatch ( &gSnap.idx, &gSnap.eng, ptd->eng,
+                (UINT)wParam );
+
+            if ( snode != ENG_NONE )
+            {
+                if ( gFresh[snode] < 0 )
+                    gFreshCount++;
 
-        LVSetItemText ( ptd->hList, ptd->index, 1, s );
+                gFresh[snode] = ptd->eng->size[wParam];
+
+                // only marks it dirty, the rows on screen are asked
+                // for again once the list gets to paint
+                InvalidateRect ( ptd->hList, NULL, FALSE );
+            }
+        }
 
         // from time to time, update total folders and scroll list
         // into view
         if ( ptd->index % 256 == 0 )
         {
-            StringCchPrintfW ( f, ARRAYSIZE(f), L"%ls (%zu subfolders, "
-                "%zu files processed)", grootDir, 
-                    ptd->subfolders, ptd->files );
+            if ( gSnapShown )
+                StringCchPrintfW ( f, ARRAYSIZE(f), L"%ls (%lld folders, "
+                    "%lld files processed, %u of %u rows updated%ls)",
+                        grootLabel, ptd->eng->total_dirs,
+                            ptd->eng->total_files, gFreshCount,
+                                gSnap.eng.count, gSnapNote );
+            else
+                StringCchPrintfW ( f, ARRAYSIZE(f), L"%ls (%lld folders, "
+                    "%lld files processed)", grootLabel, 
+                        ptd->eng->total_dirs, ptd->eng->total_files );
 
             SetDlgItemTextW ( hWnd, IDC_FLABEL, f );
             #ifndef LV_FAST_UPDATE
-                LVEnsureVisible ( ptd->hList, ptd->index );
+                if ( !gSnapShown )
+                    LVEnsureVisible ( ptd->hList, ptd->index );
             #endif
         }
 
-        ptd->index++;
+        if ( !top )
+            ptd->index++;
+    }
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: MainDLG_OnRNDFSIZE 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: HWND hWnd     : 
+//    Param.    2: WPARAM wParam : folder levels done
+//    Param.    3: LPARAM lParam : THREAD_DATA
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: handler for the WM_RNDFSIZE private message. Past the
+//                 roots' own level, the top folders have something in
+//                 them and are ranked by it.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL MainDLG_OnRNDFSIZE ( HWND hWnd, WPARAM wParam, LPARAM lParam )
+/*--------------------------------------------------------------------------*/
+{
+    THREAD_DATA * ptd;
+    WCHAR       f[1024];
+
+    ptd = (THREAD_DATA *)lParam;
+
+    if ( ptd == NULL || wParam < 2 )
+        return TRUE;
+
+    if ( !ListRank ( ptd ) )
+        return FALSE;
+
+    if ( !gSnapShown )
+    {
+        StringCchPrintfW ( f, ARRAYSIZE(f), L"%ls (%u levels, %lld "
+            "folders, %lld files processed, grey is so far)", grootLabel,
+                (UINT)wParam, ptd->eng->total_dirs, ptd->eng->total_files );
+
+        SetDlgItemTextW ( hWnd, IDC_FLABEL, f );
     }
 
     return TRUE;
@@ -1032,6 +1253,17 @@ BOOL MainDLG_OnENDFSIZE ( HWND hWnd, WPARAM wParam, LPARAM lParam )
     // scroll list into view, update totals and disable panic button :-)
     if ( ptd != NULL )
     {
+        // the list moves over to what was just walked (with the top
+        // folders, if the walk stopped before they were ranked), then
+        // the old snapshot can be unmapped and, if the walk went all
+        // the way, replaced (a mapped file can't be)
+        ListRank ( ptd );
+        ListShowLive ( ptd->hList );
+        SnapClose ( &gSnap );
+
+        if ( ptd->errcode == 0 && gSnapNew[0] != L'\0' )
+            MoveFileExW ( gSnapNew, gSnapFile, MOVEFILE_REPLACE_EXISTING );
+
         GetLocalTime ( &st_stop );
 
         SystemTimeToFileTime ( &gTimeStart, &ft_start );
@@ -1060,21 +1292,18 @@ BOOL MainDLG_OnENDFSIZE ( HWND hWnd, WPARAM wParam, LPARAM lParam )
         LVSelectItem ( ptd->hList, LVGetCount ( ptd->hList ) - 1 );
         SetFocus ( ptd->hList );
 
-        StringCchPrintfW ( f, ARRAYSIZE(f), L"%.2f", 
-            ((float)(ptd->size))/1024 );
-
-        GetNumberFormatW ( LOCALE_SYSTEM_DEFAULT, 
-            LOCALE_NOUSEROVERRIDE, f, NULL, s, ARRAYSIZE(s) );
+        FormatKBytes ( ptd->size, s, ARRAYSIZE(s) );
 
         StringCchPrintfW ( f, ARRAYSIZE(f), L"%ls (%zu subfolders, "
             "%zu files, %02uh:%02um:%02us:%03ums), %ls KBytes total size", 
-                grootDir, ptd->subfolders, ptd->files, 
+                grootLabel, ptd->subfolders, ptd->files, 
                     hr, min, sec, msec, s );
 
         SetDlgItemTextW ( hWnd, IDC_FLABEL, f );
     }
 
     EnableWindow ( GetDlgItem ( hWnd, IDC_BREAKOP ), FALSE );
+    EnableWindow ( GetDlgItem ( hWnd, IDC_FFILTER ), TRUE );
 
     return TRUE;
 }
@@ -1095,7 +1324,10 @@ BOOL MainDLG_OnENDFSIZE ( HWND hWnd, WPARAM wParam, LPARAM lParam )
 BOOL MainDLG_OnINITDIALOG ( HWND hWnd, WPARAM wParam, LPARAM lParam )
 /*--------------------------------------------------------------------------*/
 {
-    RECT    wr;
+    RECT        wr;
+    FILETIME    ft, lt;
+    SYSTEMTIME  st;
+    WCHAR       d[64], t[64], f[1280];
 
     SetWindowTextW ( hWnd, app_name_ex );
 
@@ -1124,18 +1356,60 @@ BOOL MainDLG_OnINITDIALOG ( HWND hWnd, WPARAM wParam, LPARAM lParam )
             LVCFMT_LEFT, 750, -1 );
         LVInsertColumn ( ghList, 1, L"Folder size (KBytes)", 
             LVCFMT_LEFT, 130, -1 );
+        LVInsertColumn ( ghList, 2, L"% of parent", 
+            LVCFMT_RIGHT, 90, -1 );
+
+        // the find box waits for the walk
+        SendDlgItemMessageW ( hWnd, IDC_FFILTER, EM_LIMITTEXT,
+            ENG_MAX_PATH - 1, 0 );
+        SendDlgItemMessageW ( hWnd, IDC_FFILTER, EM_SETCUEBANNER, TRUE,
+            (LPARAM)L"Find folders by name, or path with a \\" );
+        EnableWindow ( GetDlgItem ( hWnd, IDC_FFILTER ), FALSE );
 
         if ( grootDir[0] != L'\0' )
         {
             gTtd.fpath      = grootDir;
             gTtd.hList      = ghList;
             gTtd.hParent    = hWnd;
-            gTtd.fsizes     = gfSizes;
+            gTtd.eng        = &gEngine;
             gTtd.index      = 0;
             
             gThreadWorking  = TRUE;
 
-            SendMessage ( ghList, LVM_SETITEMCOUNT, LV_DEFAULT_CAPACITY, 0 );
+            // the snapshot, if any, is on the list right away
+            if ( gSnapShown )
+            {
+                ft.dwLowDateTime    = (DWORD)gSnap.scanned;
+                ft.dwHighDateTime   = (DWORD)( gSnap.scanned >> 32 );
+
+                FileTimeToLocalFileTime ( &ft, &lt );
+                FileTimeToSystemTime ( &lt, &st );
+
+                GetDateFormatW ( LOCALE_USER_DEFAULT, DATE_SHORTDATE, &st,
+                    NULL, d, ARRAYSIZE(d) );
+                GetTimeFormatW ( LOCALE_USER_DEFAULT, TIME_NOSECONDS, &st,
+                    NULL, t, ARRAYSIZE(t) );
+
+                StringCchPrintfW ( gSnapNote, ARRAYSIZE(gSnapNote),
+                    L", grey is the %ls %ls scan", d, t );
+
+                // -1 all over, nothing walked yet; without it the
+                // snapshot just stays as it is until the end
+                gFresh = alloc_and_zero_mem ( gSnap.eng.count *
+                    sizeof ( __int64 ) );
+
+                if ( gFresh != NULL )
+                    FillMemory ( gFresh, gSnap.eng.count *
+                        sizeof ( __int64 ), 0xFF );
+
+                StringCchPrintfW ( f, ARRAYSIZE(f), L"%ls (%u folders%ls)",
+                    grootLabel, gSnap.eng.count, gSnapNote );
+
+                SetDlgItemTextW ( hWnd, IDC_FLABEL, f );
+            }
+
+            SendMessage ( ghList, LVM_SETITEMCOUNT,
+                gSnapShown ? gSnap.eng.count : 0, 0 );
             EnableWindow ( GetDlgItem ( hWnd, IDC_BREAKOP ), TRUE );
             
             // disable listview updates - faster execution
@@ -1166,7 +1440,10 @@ BOOL MainDLG_OnINITDIALOG ( HWND hWnd, WPARAM wParam, LPARAM lParam )
 //         AUTHOR: Adrian Petrila, YO3GFH
 //           DATE: 10.09.2022
 //    DESCRIPTION: handle the WM_NOTIFY message for our dialog. Resort  
-//                 strictly to messages from our listview only.
+//                 strictly to messages from our listview only. The list
+//                 asks for its text all the time, the rest waits while
+//                 the walk is filling it (a snapshot on screen doesn't
+//                 change, that one can be sorted and saved).
 /*--------------------------------------------------------------------@@-@@-*/
 BOOL MainDLG_OnNOTIFY ( HWND hWnd, WPARAM wParam, LPARAM lParam )
 /*--------------------------------------------------------------------------*/
@@ -1183,14 +1460,30 @@ BOOL MainDLG_OnNOTIFY ( HWND hWnd, WPARAM wParam, LPARAM lParam )
     // is it from the list?
     if ( lpnm->idFrom == IDC_FLIST )
     {
+        if ( lpnm->code == LVN_GETDISPINFO )
+            return ListGetDispInfo ( (NMLVDISPINFOW *)lParam );
+
+        if ( lpnm->code == NM_CUSTOMDRAW )
+            return ListCustomDraw ( hWnd, (NMLVCUSTOMDRAW *)lParam );
+
+        if ( gThreadWorking && !gSnapShown ) // do not disturb :-)
+            return TRUE;
+
         switch (lpnm->code)
         {
-            // is it a column header clicky?
+            // is it a column header clicky? (the tree is always
+            // biggest first)
             case LVN_COLUMNCLICK:
                 hList = lpnm->hwndFrom;
 
+                if ( gTreeView )
+                    break;
+
                 // sort list items and set the column header arrow
-                LVSortItems ( hList, gAscending, (LPARAM)CompareListItems );
+                if ( !ListSort ( gAscending ) )
+                    break;
+
+                InvalidateRect ( hList, NULL, FALSE );
 
                 if ( gAscending )
                     LVSetHeaderSortImg ( hList, 1, UP_ARROW );
@@ -1204,6 +1497,14 @@ BOOL MainDLG_OnNOTIFY ( HWND hWnd, WPARAM wParam, LPARAM lParam )
                 LVEnsureVisible ( hList, 0 );
                 break;
 
+            // open or close a folder in the tree
+            case NM_DBLCLK:
+
+                if ( gTreeView )
+                    ListTreeKey ( lpnm->hwndFrom, VK_SPACE );
+
+                break;
+
             // mouse right-clicky
             case NM_RCLICK:
                 ContextMenu ( hWnd, IDR_LPOP );
@@ -1212,6 +1513,11 @@ BOOL MainDLG_OnNOTIFY ( HWND hWnd, WPARAM wParam, LPARAM lParam )
             // check for ctrl+something
             case LVN_KEYDOWN:
                 lpvk = (NMLVKEYDOWN *)lParam;
+
+                if ( gTreeView && ListTreeKey ( lpnm->hwndFrom,
+                        lpvk->wVKey ) )
+                    break;
+
                 switch ( lpvk->wVKey )
                 {
                     case VK_Q:
@@ -1228,6 +1534,16 @@ BOOL MainDLG_OnNOTIFY ( HWND hWnd, WPARAM wParam, LPARAM lParam )
                                         MB_OK|MB_ICONEXCLAMATION);
                         break;
 
+                    case VK_T:
+                        if (GetKeyState(VK_CONTROL) < 0)
+                            ShowTreemap ( hWnd );
+                        break;
+
+                    case VK_D:
+                        if (GetKeyState(VK_CONTROL) < 0)
+                            ListTreeView ( lpnm->hwndFrom, !gTreeView );
+                        break;
+
                     default:
                         break;
                 } 
@@ -1242,191 +1558,899 @@ BOOL MainDLG_OnNOTIFY ( HWND hWnd, WPARAM wParam, LPARAM lParam )
 }
 
 /*-@@+@@--------------------------------------------------------------------*/
-//       Function: CompareListItems 
+//       Function: CompareRows 
 /*--------------------------------------------------------------------------*/
-//           Type: int CALLBACK 
-//    Param.    1: LPARAM lParam1    : LVITEM.lParam
-//    Param.    2: LPARAM lParam2    : LVITEM.lParam
-//    Param.    3: LPARAM lParamSort : custom data that was passed to
-//                                     LVM_SORTITEMS message as wParam
+//           Type: int 
+//    Param.    1: const void * row1 : pointer to a list row (a node)
+//    Param.    2: const void * row2 : same
 /*--------------------------------------------------------------------------*/
 //         AUTHOR: Adrian Petrila, YO3GFH
 //           DATE: 10.09.2022
-//    DESCRIPTION: callback function called by the LVM_SORTITEMS message.
-//                 Compares what's on LVITEM.lParam (previously stored 
-//                 by the list when item was created) for two adjacent items.  
-//                 Returns -, + or 0, according to <, > or = relation between
-//                 lParam1 and lParam2.
+//    DESCRIPTION: qsort callback, compares the folder sizes of two rows
+//                 in gSortEng (the fresh ones, where the walk has them).
+//                 Returns -, + or 0, according to <, > or = relation
+//                 between them, reversed if not gSortAscending.
 /*--------------------------------------------------------------------@@-@@-*/
-int CALLBACK CompareListItems
-    ( LPARAM lParam1, LPARAM lParam2, LPARAM lParamSort )
+int CompareRows ( const void * row1, const void * row2 )
 /*--------------------------------------------------------------------------*/
 {
     __int64 i1, i2;
 
-    __try
-    {
-        i1 = gfSizes[lParam1];
-        i2 = gfSizes[lParam2];
-    }
-    __except ( EXCEPTION_EXECUTE_HANDLER )
-    {
-        return 0;
-    }
+    i1 = ListSize ( gSortEng, *(const UINT *)row1 );
+    i2 = ListSize ( gSortEng, *(const UINT *)row2 );
 
     if ( i1 > i2 )
-        return (lParamSort == TRUE) ? 1 : -1;
+        return gSortAscending ? 1 : -1;
 
     if ( i1 < i2 )
-        return (lParamSort == TRUE) ? -1 : 1;
+        return gSortAscending ? -1 : 1;
 
     return 0;
 
     // do not be tempted to optimize by replacing the whole shebang with
-    // "return (lParamSort == TRUE) ? i1 - i2 : i2 - i1;", it WILL return
+    // "return gSortAscending ? i1 - i2 : i2 - i1;", it WILL return
     // truncated values :-)
 }
 
 /*-@@+@@--------------------------------------------------------------------*/
-//       Function: ContextMenu 
+//       Function: ListNode 
 /*--------------------------------------------------------------------------*/
-//           Type: BOOL 
-//    Param.    1: HWND hWnd  : parent hwnd
-//    Param.    2: int menuId : resource ID of the manu that pops
+//           Type: UINT 
+//    Param.    1: int row : list row
 /*--------------------------------------------------------------------------*/
 //         AUTHOR: Adrian Petrila, YO3GFH
-//           DATE: 16.09.2022
-//    DESCRIPTION: make a pop!
+//           DATE: 19.10.2026
+//    DESCRIPTION: engine node shown on a row, of the snapshot or of the
+//                 walk, whichever the list shows. ENG_NONE if past the
+//                 end.
 /*--------------------------------------------------------------------@@-@@-*/
-BOOL ContextMenu ( HWND hWnd, int menuId )
+UINT ListNode ( int row )
 /*--------------------------------------------------------------------------*/
 {
-    static HMENU    hPop, hSub;
-    POINT           pt;
-    DWORD           states[2] = { MF_GRAYED, MF_ENABLED };
-    BOOL            state;
+    if ( row < 0 )
+        return ENG_NONE;
 
-    hPop = LoadMenuW ( GetModuleHandleW ( NULL ),
-        MAKEINTRESOURCEW ( menuId ));
+    if ( gTreeView )
+        return ( (UINT)row < gNav.count ) ? gNav.rows[row].node : ENG_NONE;
 
-    if ( !hPop )
-        return FALSE;
+    if ( gFiltered )
+        return ( (UINT)row < gSearch.nhits ) ? gSearch.hits[row] :
+            ENG_NONE;
 
-    hSub    = GetSubMenu ( hPop, 0 );
-    state   = ( LVGetCount ( ghList ) != 0 );
+    if ( gSnapShown )
+    {
+        if ( (UINT)row >= gSnap.eng.count )
+            return ENG_NONE;
 
-    EnableMenuItem ( hSub, IDM_SAVECSV, states[state] );
-    GetCursorPos ( &pt );
+        return ( gSnapRows != NULL ) ? gSnapRows[row] : (UINT)row;
+    }
 
-    TrackPopupMenuEx ( hSub, 
-        TPM_LEFTALIGN|TPM_LEFTBUTTON|TPM_RIGHTBUTTON, 
-            pt.x, pt.y, hWnd, NULL );
+    if ( (UINT_PTR)row >= gTtd.index )
+        return ENG_NONE;
 
-    return TRUE;
+    return gRows[row];
 }
 
 /*-@@+@@--------------------------------------------------------------------*/
-//       Function: SaveFolderListToCSV 
+//       Function: ListGetDispInfo 
 /*--------------------------------------------------------------------------*/
 //           Type: BOOL 
-//    Param.    1: HWND hWnd : parent hwnd
+//    Param.    1: NMLVDISPINFOW * pdi : LVN_GETDISPINFO data
 /*--------------------------------------------------------------------------*/
 //         AUTHOR: Adrian Petrila, YO3GFH
-//           DATE: 16.09.2022
-//    DESCRIPTION: display the Save dialog and call LVItemsToCSV
+//           DATE: 19.10.2026
+//    DESCRIPTION: the list is LVS_OWNERDATA, this is where its text comes
+//                 from: the path and size of the row's node, straight
+//                 from the engine columns (or the mapped snapshot). Only
+//                 the rows on screen are ever formatted.
 /*--------------------------------------------------------------------@@-@@-*/
-BOOL SaveFolderListToCSV ( HWND hWnd )
+BOOL ListGetDispInfo ( NMLVDISPINFOW * pdi )
 /*--------------------------------------------------------------------------*/
 {
-    OPENFILENAMEW   ofn;
-    DWORD           dlgstyle;
-    WCHAR           csvname[MAX_PATH];
+    const ENGINE    * eng;
+    const NAV_ROW   * row;
+    UINT            node, share;
+    WCHAR           buf[ENG_MAX_PATH];
+    WCHAR           mark;
 
-    RtlZeroMemory ( &ofn, sizeof ( ofn ) );
+    if ( pdi == NULL || !( pdi->item.mask & LVIF_TEXT ) ||
+            pdi->item.pszText == NULL || pdi->item.cchTextMax <= 0 )
+        return TRUE;
 
-    dlgstyle = OFN_EXPLORER|OFN_PATHMUSTEXIST|
-        OFN_HIDEREADONLY|OFN_OVERWRITEPROMPT;
+    eng     = gSnapShown ? &gSnap.eng : &gEngine;
+    node    = ListNode ( pdi->item.iItem );
+    buf[0]  = L'\0';
 
-    StringCchCopyW ( csvname, ARRAYSIZE(csvname), L"folderlist" );
+    if ( node != ENG_NONE && pdi->item.iSubItem == 2 )
+    {
+        share = NavShare ( eng, node );
+        StringCchPrintfW ( buf, ARRAYSIZE(buf), L"%u.%02u %%",
+            share / 100, share % 100 );
+    }
+    else if ( node != ENG_NONE && pdi->item.iSubItem == 0 && gTreeView )
+    {
+        // indented by level, + for a folder that can be opened
+        row     = &gNav.rows[pdi->item.iItem];
+        mark    = row->open ? L'-' : L' ';
 
-    ofn.lStructSize     = sizeof ( ofn );
-    ofn.hInstance       = GetModuleHandleW ( NULL );
-    ofn.hwndOwner       = hWnd;
-    ofn.Flags           = dlgstyle;
-    ofn.lpstrFilter     = opn_filter;
-    ofn.nFilterIndex    = 1;
-    ofn.lpstrFile       = csvname;
-    ofn.nMaxFile        = ARRAYSIZE ( csvname );
-    ofn.lpstrTitle      = sav_title;
-    ofn.lpstrDefExt     = opn_defext;
-    ofn.lpstrInitialDir = grootDir; // would be nice to pass this 
-                                    // as a param, not use a global :-)
+        if ( !row->open && eng->nchild[node] != 0 &&
+                !( eng->flags[node] & ENG_SPILLED ) )
+            mark = L'+';
 
-    if ( GetSaveFileNameW ( &ofn ) )
-        return LVItemsToCSV ( ghList, ofn.lpstrFile );
+        StringCchPrintfW ( buf, ARRAYSIZE(buf), L"%*ls%lc %.*ls",
+            row->level * 4, L"", mark, eng->nlen[node],
+                eng->names + eng->name[node] );
+    }
+    else if ( node != ENG_NONE )
+    {
+        if ( pdi->item.iSubItem == 0 )
+            EnginePath ( eng, node, buf, ARRAYSIZE(buf) );
+        else
+            FormatKBytes ( ListSize ( eng, node ), buf, ARRAYSIZE(buf) );
+    }
+
+    // too long is cut, a row has room for 260 chars only
+    StringCchCopyW ( pdi->item.pszText, pdi->item.cchTextMax, buf );
 
     return TRUE;
 }
 
 /*-@@+@@--------------------------------------------------------------------*/
-//       Function: LVItemsToCSV 
+//       Function: ListSize 
 /*--------------------------------------------------------------------------*/
-//           Type: BOOL 
-//    Param.    1: HWND hList          : ListView ctrl. handle
-//    Param.    2: const WCHAR * fname : path to csv file to save to
+//           Type: __int64 
+//    Param.    1: const ENGINE * eng : engine the list shows
+//    Param.    2: UINT node          : node on a row
 /*--------------------------------------------------------------------------*/
 //         AUTHOR: Adrian Petrila, YO3GFH
-//           DATE: 16.09.2022
-//    DESCRIPTION: this saves all the items and the first level of subitems 
-//                 from a listview control into a CSV file that you can open 
-//                 in Excel. 
+//           DATE: 19.10.2026
+//    DESCRIPTION: folder size to show and sort by. For the snapshot, the
+//                 new walk's size once it has it, the old one until then.
 /*--------------------------------------------------------------------@@-@@-*/
-BOOL LVItemsToCSV ( HWND hList, const WCHAR * fname )
+__int64 ListSize ( const ENGINE * eng, UINT node )
 /*--------------------------------------------------------------------------*/
 {
-    HANDLE  hFile;
-    size_t  i, items;
-    WCHAR   item[1024];     // holds item text
-    WCHAR   subitem[64];    // holds subitem text
-    WCHAR   s[1280];        // holds a csv line, in unicode
-    CHAR    b[1280];        // holds the ansi version
-    DWORD   towrite, written;
-    BOOL    result = TRUE;
-
-    if ( hList == NULL || fname == NULL )
+    if ( eng == &gSnap.eng && gFresh != NULL && gFresh[node] >= 0 )
+        return gFresh[node];
+
+    return eng->size[node];
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ListCustomDraw 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: HWND hWnd             : dialog
+//    Param.    2: NMLVCUSTOMDRAW * pcd  : NM_CUSTOMDRAW data
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: snapshot rows the new walk hasn't got to yet are drawn
+//                 grey, and so are the top folders of the walk until
+//                 they're done. Only asks for the rows while a snapshot
+//                 is up or the top folders are in.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ListCustomDraw ( HWND hWnd, NMLVCUSTOMDRAW * pcd )
+/*--------------------------------------------------------------------------*/
+{
+    LONG_PTR    result;
+    UINT        node;
+
+    result = CDRF_DODEFAULT;
+
+    switch ( pcd->nmcd.dwDrawStage )
+    {
+        case CDDS_PREPAINT:
+
+            if ( gSnapShown || gRankedIn )
+                result = CDRF_NOTIFYITEMDRAW;
+
+            break;
+
+        case CDDS_ITEMPREPAINT:
+            node = ListNode ( (int)pcd->nmcd.dwItemSpec );
+
+            if ( node == ENG_NONE )
+                break;
+
+            if ( gSnapShown ? ( gFresh == NULL || gFresh[node] < 0 ) :
+                    !( gEngine.flags[node] & ENG_FINAL ) )
+            {
+                pcd->clrText    = GetSysColor ( COLOR_GRAYTEXT );
+                result          = CDRF_NEWFONT;
+            }
+
+            break;
+
+        default:
+            break;
+    }
+
+    // dialogs hand back notify results this way
+    SetWindowLongPtrW ( hWnd, DWLP_MSGRESULT, result );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ListSort 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: BOOL ascending : sort order
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: sort the rows on the list by folder size. A snapshot
+//                 gets its own row table the first time, the mapped
+//                 file stays read-only. Returns FALSE if out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ListSort ( BOOL ascending )
+/*--------------------------------------------------------------------------*/
+{
+    UINT    * rows;
+    size_t  count, i;
+
+    if ( gSnapShown )
+    {
+        count = gSnap.eng.count;
+
+        if ( gSnapRows == NULL && count != 0 )
+        {
+            gSnapRows = alloc_and_zero_mem ( count * sizeof ( UINT ) );
+
+            if ( gSnapRows == NULL )
+                return FALSE;
+
+            for ( i = 0; i < count; i++ )
+                gSnapRows[i] = (UINT)i;
+        }
+
+        rows        = gSnapRows;
+        gSortEng    = &gSnap.eng;
+    }
+    else if ( gFiltered )
+    {
+        count       = gSearch.nhits;
+        rows        = gSearch.hits;
+        gSortEng    = &gEngine;
+    }
+    else
+    {
+        count       = gTtd.index;
+        rows        = gRows;
+        gSortEng    = &gEngine;
+    }
+
+    gSortAscending  = ascending;
+    gSorted         = TRUE;
+
+    if ( count > 1 )
+        qsort ( rows, count, sizeof ( UINT ), CompareRows );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ListShowLive 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: HWND hList : listview hwnd
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the walk is done, drop the snapshot from the list and
+//                 show the walk's rows instead, sorted the way the
+//                 snapshot was. Safe to call if there was no snapshot.
+/*--------------------------------------------------------------------@@-@@-*/
+void ListShowLive ( HWND hList )
+/*--------------------------------------------------------------------------*/
+{
+    if ( gSnapShown )
+    {
+        gSnapShown = FALSE;
+
+        if ( gSnapRows != NULL )
+        {
+            free_mem ( gSnapRows );
+            gSnapRows = NULL;
+        }
+
+        if ( gFresh != NULL )
+        {
+            free_mem ( gFresh );
+            gFresh = NULL;
+        }
+
+        // gAscending flipped after the last sort
+        if ( gSorted )
+            ListSort ( !gAscending );
+    }
+
+    ListView_SetItemCountEx ( hList, (int)gTtd.index, 0 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ListRank 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: THREAD_DATA * ptd : the walk
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the first time, put the roots' subfolders at the head
+//                 of gRows, ahead of the folders done so far (they're
+//                 left out of those, see MainDLG_OnUPDFSIZE); then sort
+//                 them biggest first. Their sizes are what the walk has
+//                 found in them yet, they only grow. Returns FALSE if
+//                 out of memory.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ListRank ( THREAD_DATA * ptd )
+/*--------------------------------------------------------------------------*/
+{
+    const ENGINE    * eng;
+    UINT            * tmpptr;
+    UINT            i, r, n, first;
+    size_t          cap;
+
+    eng = ptd->eng;
+
+    if ( !gRankedIn )
+    {
+        for ( r = 0, n = 0; r < eng->nroots; r++ )
+            if ( eng->roots[r].state == ENG_ROOT_WALKED &&
+                    eng->roots[r].node < eng->count &&
+                    eng->first[eng->roots[r].node] != ENG_NONE )
+                n += eng->nchild[eng->roots[r].node];
+
+        if ( ptd->index + n >= gRowsCapacity )
+        {
+            cap     = ptd->index + n + LV_DEFAULT_CAPACITY;
+            tmpptr  = realloc_and_zero_mem ( gRows, cap * sizeof ( UINT ) );
+
+            if ( tmpptr == NULL )
+                return FALSE;
+
+            gRows           = tmpptr;
+            gRowsCapacity   = cap;
+        }
+
+        MoveMemory ( gRows + n, gRows, ptd->index * sizeof ( UINT ) );
+
+        for ( r = 0, n = 0; r < eng->nroots; r++ )
+        {
+            if ( eng->roots[r].state != ENG_ROOT_WALKED ||
+                    eng->roots[r].node >= eng->count )
+                continue;
+
+            first = eng->first[eng->roots[r].node];
+
+            for ( i = 0; first != ENG_NONE &&
+                    i < eng->nchild[eng->roots[r].node]; i++ )
+                gRows[n++] = first + i;
+        }
+
+        ptd->index  += n;
+        gRanked     = n;
+        gRankedIn   = TRUE;
+
+        if ( !gSnapShown )
+            ListView_SetItemCountEx ( ptd->hList, (int)ptd->index,
+                LVSICF_NOSCROLL );
+    }
+
+    gSortEng        = eng;
+    gSortAscending  = FALSE;
+
+    if ( gRanked > 1 )
+        qsort ( gRows, gRanked, sizeof ( UINT ), CompareRows );
+
+    if ( !gSnapShown )
+        InvalidateRect ( ptd->hList, NULL, FALSE );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: FormatKBytes 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: __int64 size  : bytes
+//    Param.    2: WCHAR * buf   : buffer to hold the result
+//    Param.    3: int cchDest   : buf size, in (w)chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 10.09.2022
+//    DESCRIPTION: size in KBytes, with the default thousand separator
+/*--------------------------------------------------------------------@@-@@-*/
+void FormatKBytes ( __int64 size, WCHAR * buf, int cchDest )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR   f[64];
+
+    StringCchPrintfW ( f, ARRAYSIZE(f), L"%.2f", ((float)(size))/1024 );
+
+    if ( !GetNumberFormatW ( LOCALE_SYSTEM_DEFAULT, 
+            LOCALE_NOUSEROVERRIDE, f, NULL, buf, cchDest ) )
+        StringCchCopyW ( buf, cchDest, f );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SnapFileName 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: WCHAR * buf   : buffer to hold the result
+//    Param.    2: DWORD cchDest : buf size, in (w)chars
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: snapshot file for the roots in gEngine, under
+//                 %LOCALAPPDATA%\wfsize and named after a hash of
+//                 their paths, so each set of folders has its own.
+//                 Returns FALSE if there's no place for it.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL SnapFileName ( WCHAR * buf, DWORD cchDest )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR           dir[MAX_PATH];
+    const WCHAR     * p;
+    UINT64          hash;
+    DWORD           len;
+    UINT            i;
+
+    if ( buf == NULL || cchDest == 0 || gEngine.nroots == 0 )
         return FALSE;
 
-    items = LVGetCount ( hList );
+    buf[0]  = L'\0';
+    len     = GetEnvironmentVariableW ( L"LOCALAPPDATA", dir,
+        ARRAYSIZE(dir) );
 
-    if ( items == 0 ) // nothing to do
+    if ( len == 0 || len >= ARRAYSIZE(dir) ||
+            FAILED ( StringCchCatW ( dir, ARRAYSIZE(dir), L"\\wfsize" ) ) )
         return FALSE;
 
-    hFile = CreateFile ( fname, GENERIC_READ|GENERIC_WRITE,
-        FILE_SHARE_READ|FILE_SHARE_WRITE, NULL, CREATE_ALWAYS, 0, 0 );
-    
-    if ( hFile == INVALID_HANDLE_VALUE )
+    // fails if it's there already, that's fine
+    CreateDirectoryW ( dir, NULL );
+
+    // FNV-1a, case insensitive, like the paths
+    hash = 14695981039346656037ULL;
+
+    for ( i = 0; i < gEngine.nroots; i++ )
+    {
+        for ( p = gEngine.roots[i].path; *p != L'\0'; p++ )
+            hash = ( hash ^ towlower ( *p ) ) * 1099511628211ULL;
+
+        hash = ( hash ^ L'|' ) * 1099511628211ULL;
+    }
+
+    return SUCCEEDED ( StringCchPrintfW ( buf, cchDest,
+        L"%ls\\%016llx.snap", dir, hash ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ContextMenu 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: HWND hWnd  : parent hwnd
+//    Param.    2: int menuId : resource ID of the manu that pops
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 16.09.2022
+//    DESCRIPTION: make a pop!
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ContextMenu ( HWND hWnd, int menuId )
+/*--------------------------------------------------------------------------*/
+{
+    static HMENU    hPop, hSub;
+    POINT           pt;
+    DWORD           states[2] = { MF_GRAYED, MF_ENABLED };
+    BOOL            state;
+
+    hPop = LoadMenuW ( GetModuleHandleW ( NULL ),
+        MAKEINTRESOURCEW ( menuId ));
+
+    if ( !hPop )
+        return FALSE;
+
+    hSub    = GetSubMenu ( hPop, 0 );
+    state   = ( LVGetCount ( ghList ) != 0 );
+
+    EnableMenuItem ( hSub, IDM_SAVECSV, states[state] );
+    EnableMenuItem ( hSub, IDM_TREEMAP, states[state && !gThreadWorking] );
+    EnableMenuItem ( hSub, IDM_TREEVIEW, states[gThandle == 0] );
+    CheckMenuItem ( hSub, IDM_TREEVIEW, gTreeView ? MF_CHECKED :
+        MF_UNCHECKED );
+    GetCursorPos ( &pt );
+
+    TrackPopupMenuEx ( hSub, 
+        TPM_LEFTALIGN|TPM_LEFTBUTTON|TPM_RIGHTBUTTON, 
+            pt.x, pt.y, hWnd, NULL );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ShowTreemap 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: HWND hWnd : parent hwnd
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: treemap of the selected folder (the first root if none
+//                 is), from whatever the list shows. Not while walking,
+//                 the tree has to stay put under it.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ShowTreemap ( HWND hWnd )
+/*--------------------------------------------------------------------------*/
+{
+    const ENGINE    * eng;
+    UINT            node;
+
+    if ( gThreadWorking || LVGetCount ( ghList ) == 0 )
+        return FALSE;
+
+    eng     = gSnapShown ? &gSnap.eng : &gEngine;
+    node    = ListNode ( LVGetSelIndex ( ghList ) );
+
+    if ( node == ENG_NONE )
+        node = 0;
+
+    return ( TMViewOpen ( hWnd, eng, node ) != NULL );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ListTreeView 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: HWND hList : listview hwnd
+//    Param.    2: BOOL on    : TRUE for the folder tree, FALSE for the
+//                              flat list
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: switch the list between every folder done and the
+//                 folder tree, which starts at the roots (opened, if
+//                 there's only one) and stays as it was left when
+//                 switched back. Only once the walk is over.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ListTreeView ( HWND hList, BOOL on )
+/*--------------------------------------------------------------------------*/
+{
+    if ( gThandle != 0 || on == gTreeView )
         return FALSE;
 
-    for ( i = 0; i < items; i++ )
+    // the tree has every folder, the find box goes
+    if ( on && gFiltered )
+        SetDlgItemTextW ( GetParent ( hList ), IDC_FFILTER, L"" );
+
+    if ( on && gNav.eng == NULL )
     {
-        item[0]         = L'\0';
-        subitem[0]      = L'\0';
+        NavInit ( &gNav, &gEngine );
 
-        LVGetItemText ( hList, i, 0, item, ARRAYSIZE(item) );
-        LVGetItemText ( hList, i, 1, subitem, ARRAYSIZE(subitem) );
+        if ( !NavGo ( &gNav, ENG_NONE ) )
+        {
+            NavFree ( &gNav );
+            return FALSE;
+        }
 
-        StringCchPrintfW ( s, ARRAYSIZE(s), L"\"%ls\",\"%ls\"\r\n",
-            item, subitem );
+        if ( gNav.count == 1 )
+            NavExpand ( &gNav, 0 );
+    }
 
-        // make a regular text line 
-        towrite = WideCharToMultiByte ( GetACP(), 0, s, -1, b,
-            ARRAYSIZE(b), NULL, NULL );
+    gTreeView = on;
 
-        // write to file and accumulate errors, if any :-)
-        result &= WriteFile ( hFile, b, towrite-1, &written, NULL );
+    if ( on )
+        ListTreeUpdate ( hList, 0 );
+    else
+    {
+        ListView_SetItemCountEx ( hList, gFiltered ?
+            (int)gSearch.nhits : (int)gTtd.index, 0 );
+        InvalidateRect ( hList, NULL, FALSE );
+        LVSelectItem ( hList, 0 );
+        LVEnsureVisible ( hList, 0 );
     }
-    
-    CloseHandle ( hFile );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ListTreeKey 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: HWND hList : listview hwnd
+//    Param.    2: WORD vk    : key pressed
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: keys for the folder tree. Right opens the selected
+//                 folder, Left closes it (or goes to the one it's in),
+//                 Space does either; Ctrl+Right shows only what's inside
+//                 it, Ctrl+Left the folder above, Backspace goes back
+//                 and Shift+Backspace forward again. Returns FALSE for
+//                 keys it has nothing to do with.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ListTreeKey ( HWND hList, WORD vk )
+/*--------------------------------------------------------------------------*/
+{
+    int     sel;
+    UINT    up;
+    BOOL    ctrl;
+
+    sel     = LVGetSelIndex ( hList );
+    ctrl    = ( GetKeyState ( VK_CONTROL ) < 0 );
+
+    if ( sel >= (int)gNav.count )
+        sel = -1;
+
+    switch ( vk )
+    {
+        case VK_RIGHT:
+
+            if ( sel < 0 )
+                return FALSE;
+
+            if ( ctrl )
+            {
+                if ( NavGo ( &gNav, gNav.rows[sel].node ) )
+                    ListTreeUpdate ( hList, 0 );
+            }
+            else if ( NavExpand ( &gNav, (UINT)sel ) )
+                ListTreeUpdate ( hList, sel );
+
+            return TRUE;
+
+        case VK_LEFT:
+
+            if ( ctrl )
+            {
+                if ( NavUp ( &gNav ) )
+                    ListTreeUpdate ( hList, 0 );
+            }
+            else if ( sel >= 0 && NavCollapse ( &gNav, (UINT)sel ) )
+                ListTreeUpdate ( hList, sel );
+            else if ( sel >= 0 )
+            {
+                up = NavParentRow ( &gNav, (UINT)sel );
+
+                if ( up != ENG_NONE )
+                    ListTreeUpdate ( hList, (int)up );
+            }
+
+            return TRUE;
+
+        case VK_SPACE:
+
+            if ( sel < 0 )
+                return FALSE;
+
+            if ( NavCollapse ( &gNav, (UINT)sel ) ||
+                    NavExpand ( &gNav, (UINT)sel ) )
+                ListTreeUpdate ( hList, sel );
+
+            return TRUE;
+
+        case VK_BACK:
+
+            if ( GetKeyState ( VK_SHIFT ) < 0 ? NavForward ( &gNav ) :
+                    NavBack ( &gNav ) )
+                ListTreeUpdate ( hList, 0 );
+
+            return TRUE;
+
+        default:
+            break;
+    }
+
+    return FALSE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ListTreeUpdate 
+/*--------------------------------------------------------------------------*/
+//           Type: void 
+//    Param.    1: HWND hList : listview hwnd
+//    Param.    2: int sel    : row to select
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the tree's rows changed, tell the list
+/*--------------------------------------------------------------------@@-@@-*/
+void ListTreeUpdate ( HWND hList, int sel )
+/*--------------------------------------------------------------------------*/
+{
+    ListView_SetItemCountEx ( hList, (int)gNav.count, LVSICF_NOSCROLL );
+    InvalidateRect ( hList, NULL, FALSE );
+
+    if ( sel >= 0 && (UINT)sel < gNav.count )
+    {
+        LVSelectItem ( hList, sel );
+        LVEnsureVisible ( hList, sel );
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ListFilter 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: HWND hWnd : dialog
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the find box changed, show only the folders matching
+//                 it (all of them if it's empty), sorted the way the
+//                 list was. The names are indexed the first time, after
+//                 that a keystroke costs a few posting lists, or just a
+//                 pass over the rows shown if the text only grew.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ListFilter ( HWND hWnd )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR       q[ENG_MAX_PATH];
+    HCURSOR     hOld;
+    BOOL        ok;
+
+    if ( gThandle != 0 )
+        return FALSE;
+
+    GetDlgItemTextW ( hWnd, IDC_FFILTER, q, ARRAYSIZE(q) );
+
+    if ( q[0] == L'\0' )
+    {
+        if ( gFiltered )
+        {
+            gFiltered = FALSE;
+            ListView_SetItemCountEx ( ghList, (int)gTtd.index, 0 );
+            InvalidateRect ( ghList, NULL, FALSE );
+        }
+
+        return TRUE;
+    }
+
+    if ( gTreeView )
+        ListTreeView ( ghList, FALSE );
+
+    if ( gSearchIdx.eng == NULL )
+    {
+        hOld = SetCursor ( LoadCursorW ( NULL, IDC_WAIT ) );
+        ok   = SearchBuild ( &gSearchIdx, &gEngine );
+        SetCursor ( hOld );
+
+        if ( !ok )
+            return FALSE;
+
+        SearchInit ( &gSearch, &gSearchIdx );
+    }
+
+    if ( !SearchRun ( &gSearch, q ) )
+        return FALSE;
+
+    gFiltered = TRUE;
+
+    // gAscending flipped after the last sort
+    if ( gSorted )
+        ListSort ( !gAscending );
+
+    ListView_SetItemCountEx ( ghList, (int)gSearch.nhits, 0 );
+    InvalidateRect ( ghList, NULL, FALSE );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: SaveFolderListToCSV 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: HWND hWnd : parent hwnd
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 16.09.2022
+//    DESCRIPTION: display the Save dialog and call ListToCSV
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL SaveFolderListToCSV ( HWND hWnd )
+/*--------------------------------------------------------------------------*/
+{
+    OPENFILENAMEW   ofn;
+    DWORD           dlgstyle;
+    WCHAR           csvname[MAX_PATH];
+
+    RtlZeroMemory ( &ofn, sizeof ( ofn ) );
+
+    dlgstyle = OFN_EXPLORER|OFN_PATHMUSTEXIST|
+        OFN_HIDEREADONLY|OFN_OVERWRITEPROMPT;
+
+    StringCchCopyW ( csvname, ARRAYSIZE(csvname), L"folderlist" );
+
+    ofn.lStructSize     = sizeof ( ofn );
+    ofn.hInstance       = GetModuleHandleW ( NULL );
+    ofn.hwndOwner       = hWnd;
+    ofn.Flags           = dlgstyle;
+    ofn.lpstrFilter     = opn_filter;
+    ofn.nFilterIndex    = 1;
+    ofn.lpstrFile       = csvname;
+    ofn.nMaxFile        = ARRAYSIZE ( csvname );
+    ofn.lpstrTitle      = sav_title;
+    ofn.lpstrDefExt     = opn_defext;
+    ofn.lpstrInitialDir = grootDir; // would be nice to pass this 
+                                    // as a param, not use a global :-)
+
+    if ( GetSaveFileNameW ( &ofn ) )
+        return ListToCSV ( ofn.lpstrFile );
+
+    return TRUE;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: ListToCSV 
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL 
+//    Param.    1: const WCHAR * fname : path to csv file to save to
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 16.09.2022
+//    DESCRIPTION: save the folders on the list, in its order, into a CSV
+//                 file that you can open in Excel (TSV or JSON lines if
+//                 the name says so, see ExportFormat). The rows come
+//                 straight from the engine, not the list's text.
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL ListToCSV ( const WCHAR * fname )
+/*--------------------------------------------------------------------------*/
+{
+    const ENGINE    * eng;
+    EXPORT_COLS     cols;
+    UINT            * rows, * tmp;
+    UINT            count, i;
+    BOOL            result;
+
+    if ( fname == NULL )
+        return FALSE;
+
+    eng = gSnapShown ? &gSnap.eng : &gEngine;
+    tmp = NULL;
+
+    // same pick as ListNode; a snapshot not sorted yet is in node order
+    if ( gTreeView )
+    {
+        count   = gNav.count;
+        tmp     = ( count != 0 ) ?
+            alloc_and_zero_mem ( count * sizeof ( UINT ) ) : NULL;
+        rows    = tmp;
+
+        if ( tmp == NULL )
+            return FALSE;
+
+        for ( i = 0; i < count; i++ )
+            tmp[i] = gNav.rows[i].node;
+    }
+    else if ( gFiltered )
+    {
+        count   = gSearch.nhits;
+        rows    = gSearch.hits;
+    }
+    else if ( gSnapShown )
+    {
+        count   = gSnap.eng.count;
+        rows    = gSnapRows;
+    }
+    else
+    {
+        count   = (UINT)gTtd.index;
+        rows    = gRows;
+    }
+
+    if ( count == 0 ) // nothing to do
+        return FALSE;
+
+    // the sizes the list shows, a snapshot's patched with the new walk's
+    RtlZeroMemory ( &cols, sizeof ( cols ) );
+
+    if ( eng == &gSnap.eng )
+        cols.fresh = gFresh;
+
+    result = ExportFile ( eng, rows, count, &cols, ExportFormat ( fname ),
+        0, fname, NULL );
+
+    if ( tmp != NULL )
+        free_mem ( tmp );
 
     return result;
 }
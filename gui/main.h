@@ -24,19 +24,22 @@
 // how many "folder in folder" levels
 #define MAX_DEPTH       100
 
-// private thread messages
+// private thread messages (aborting goes through EngineAbort)
 #define WM_ENDFSIZE     WM_APP + 1      // end op.
 #define WM_UPDFSIZE     WM_APP + 2      // data available, update the list
-#define WM_ABTFSIZE     WM_APP + 100    // abort op.
-#define WM_RAGEQUIT     WM_APP + 199    // user depressed :-)
+#define WM_RNDFSIZE     WM_APP + 3      // a folder level is done, rank
+                                        // the top folders again
 
 #define DLG_MAIN        1001
 #define IDC_BREAKOP     4001
 #define IDC_FLIST       4007
 #define IDC_FLABEL      4008
+#define IDC_FFILTER     4009
 
 #define IDR_LPOP        2001
 #define IDM_SAVECSV     6001
+#define IDM_TREEMAP     6002
+#define IDM_TREEVIEW    6003
 
 #define IDR_ICO_MAIN    8001
 
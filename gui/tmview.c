@@ -0,0 +1,471 @@
+
+// tmview.c - treemap window, draws the engine's tree as nested boxes
+#pragma warn(disable: 2008 2118 2228 2231 2030 2260)
+
+#include "main.h"
+#include "tmview.h"
+#include "../engine/treemap.h"
+#include <windows.h>
+#include <windowsx.h>
+#include <strsafe.h>
+
+//
+// one treemap window at most, owned by the main dialog. The layout is
+// done again on every resize or zoom and only goes as deep as there's
+// room for, so it's cheap however big the tree is.
+//
+
+static HWND         ghTm;               // the window, NULL if closed
+static const ENGINE * gTmEng;           // the tree it shows
+static TREEMAP      gTm;                // its rectangles, laid out over
+                                        // gTmEng's columns
+static UINT         gTmTop;             // folder filling the window
+static int          gTmHot = -1;        // rect under the mouse
+
+// folders by depth, then their files a bit lighter
+static const COLORREF gTmColors[] =
+{
+    RGB(0x4E,0x79,0xA7), RGB(0xF2,0x8E,0x2B), RGB(0x59,0xA1,0x4F),
+    RGB(0xB0,0x7A,0xA1), RGB(0xED,0xC9,0x48), RGB(0x76,0xB7,0xB2),
+    RGB(0xE1,0x57,0x59), RGB(0x9C,0x75,0x5F)
+};
+
+#define TM_REST_COLOR   RGB(0xC0,0xC0,0xC0)
+#define TM_FRAME_COLOR  RGB(0x40,0x40,0x40)
+
+LRESULT CALLBACK TMViewProc ( HWND hWnd, UINT uMsg, WPARAM wParam,
+    LPARAM lParam );
+static void TMView_Tree ( const ENGINE * eng );
+static void TMView_Layout ( HWND hWnd );
+static void TMView_OnPAINT ( HWND hWnd );
+static void TMView_OnMOUSEMOVE ( HWND hWnd, LPARAM lParam );
+static void TMView_Zoom ( HWND hWnd, UINT node );
+static void TMView_Title ( HWND hWnd, const TM_RECT * r );
+static COLORREF TMView_Color ( const TM_RECT * r );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TMViewRegister
+/*--------------------------------------------------------------------------*/
+//           Type: BOOL
+//    Param.    1: HINSTANCE hInst : app instance
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+BOOL TMViewRegister ( HINSTANCE hInst )
+/*--------------------------------------------------------------------------*/
+{
+    WNDCLASSEXW     wcx;
+
+    RtlZeroMemory ( &wcx, sizeof ( wcx ) );
+
+    wcx.cbSize          = sizeof ( wcx );
+    wcx.style           = CS_HREDRAW | CS_VREDRAW;
+    wcx.lpfnWndProc     = TMViewProc;
+    wcx.hInstance       = hInst;
+    wcx.hIcon           = LoadIconW ( hInst, MAKEINTRESOURCE(IDR_ICO_MAIN) );
+    wcx.hCursor         = LoadCursorW ( NULL, IDC_ARROW );
+    wcx.lpszClassName   = TMVIEW_CLASS;
+
+    return ( RegisterClassExW ( &wcx ) != 0 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TMViewOpen
+/*--------------------------------------------------------------------------*/
+//           Type: HWND
+//    Param.    1: HWND hOwner        : main dialog
+//    Param.    2: const ENGINE * eng : tree to show, done walking
+//    Param.    3: UINT node          : folder to start from
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: show node's treemap, in the window already open if
+//                 there's one. Left click zooms in on a folder, right
+//                 click or Backspace goes up one, Esc closes. Returns
+//                 the window, NULL if it couldn't be made.
+/*--------------------------------------------------------------------@@-@@-*/
+HWND TMViewOpen ( HWND hOwner, const ENGINE * eng, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    HINSTANCE   hInst;
+    int         dpi;
+    HDC         hdc;
+
+    if ( eng == NULL || node >= eng->count )
+        return NULL;
+
+    if ( ghTm != NULL )
+    {
+        TMView_Tree ( eng );
+        TMView_Zoom ( ghTm, node );
+        SetForegroundWindow ( ghTm );
+        return ghTm;
+    }
+
+    TreemapInit ( &gTm, NULL );
+    TMView_Tree ( eng );
+
+    gTmTop  = node;
+    gTmHot  = -1;
+    hInst   = (HINSTANCE)GetWindowLongPtrW ( hOwner, GWLP_HINSTANCE );
+
+    hdc     = GetDC ( NULL );
+    dpi     = GetDeviceCaps ( hdc, LOGPIXELSY );
+    ReleaseDC ( NULL, hdc );
+
+    ghTm    = CreateWindowExW ( 0, TMVIEW_CLASS, L"", WS_OVERLAPPEDWINDOW,
+        CW_USEDEFAULT, CW_USEDEFAULT, MulDiv ( 800, dpi, DEFAULT_DPI ),
+            MulDiv ( 600, dpi, DEFAULT_DPI ), hOwner, NULL, hInst, NULL );
+
+    if ( ghTm == NULL )
+    {
+        TreemapFree ( &gTm );
+        return NULL;
+    }
+
+    TMView_Title ( ghTm, NULL );
+    ShowWindow ( ghTm, SW_SHOWNORMAL );
+
+    return ghTm;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TMViewProc
+/*--------------------------------------------------------------------------*/
+//           Type: LRESULT CALLBACK
+//    Param.    1: HWND hWnd     :
+//    Param.    2: UINT uMsg     :
+//    Param.    3: WPARAM wParam :
+//    Param.    4: LPARAM lParam :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: treemap window message handling
+/*--------------------------------------------------------------------@@-@@-*/
+LRESULT CALLBACK TMViewProc ( HWND hWnd, UINT uMsg, WPARAM wParam,
+    LPARAM lParam )
+/*--------------------------------------------------------------------------*/
+{
+    const TM_RECT   * r;
+
+    switch ( uMsg )
+    {
+        case WM_SIZE:
+            TMView_Layout ( hWnd );
+            return 0;
+
+        case WM_DPICHANGED:
+            TMView_Layout ( hWnd );
+            return 0;
+
+        // all of it is painted, over a memory DC
+        case WM_ERASEBKGND:
+            return 1;
+
+        case WM_PAINT:
+            TMView_OnPAINT ( hWnd );
+            return 0;
+
+        case WM_MOUSEMOVE:
+            TMView_OnMOUSEMOVE ( hWnd, lParam );
+            return 0;
+
+        // files and the small folders lumped together zoom to the
+        // folder they're in
+        case WM_LBUTTONUP:
+            r = TreemapHit ( &gTm, (float)GET_X_LPARAM(lParam),
+                (float)GET_Y_LPARAM(lParam) );
+
+            if ( r != NULL )
+                TMView_Zoom ( hWnd, r->node );
+
+            return 0;
+
+        case WM_RBUTTONUP:
+            TMView_Zoom ( hWnd, gTmEng->parent[gTmTop] );
+            return 0;
+
+        case WM_KEYDOWN:
+
+            if ( wParam == VK_BACK )
+                TMView_Zoom ( hWnd, gTmEng->parent[gTmTop] );
+            else if ( wParam == VK_ESCAPE )
+                DestroyWindow ( hWnd );
+
+            return 0;
+
+        case WM_DESTROY:
+            TreemapFree ( &gTm );
+            ghTm = NULL;
+            return 0;
+
+        default:
+            break;
+    }
+
+    return DefWindowProcW ( hWnd, uMsg, wParam, lParam );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TMView_Tree
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const ENGINE * eng : tree to show
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: hand the engine's columns to the layout, which knows
+//                 nothing of engines. Again before every layout, a
+//                 snapshot's columns may have been placed elsewhere.
+/*--------------------------------------------------------------------@@-@@-*/
+static void TMView_Tree ( const ENGINE * eng )
+/*--------------------------------------------------------------------------*/
+{
+    gTmEng              = eng;
+    gTm.tree.size       = (const int64_t *)eng->size;
+    gTm.tree.own        = (const int64_t *)eng->own;
+    gTm.tree.first      = (const uint32_t *)eng->first;
+    gTm.tree.nchild     = (const uint32_t *)eng->nchild;
+    gTm.tree.count      = eng->count;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TMView_Layout
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: HWND hWnd : treemap window
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: lay gTmTop out over the client area, with the smallest
+//                 box, the padding and the label strip scaled to the
+//                 screen's DPI, then have it all painted again
+/*--------------------------------------------------------------------@@-@@-*/
+static void TMView_Layout ( HWND hWnd )
+/*--------------------------------------------------------------------------*/
+{
+    RECT    rc;
+    HDC     hdc;
+    float   scale;
+
+    hdc     = GetDC ( hWnd );
+    scale   = (float)GetDeviceCaps ( hdc, LOGPIXELSY ) / DEFAULT_DPI;
+    ReleaseDC ( hWnd, hdc );
+
+    gTm.min_side    = 4.0f * scale;
+    gTm.pad         = 2.0f * scale;
+    gTm.head        = 16.0f * scale;
+    gTmHot          = -1;
+
+    TMView_Tree ( gTmEng );
+    GetClientRect ( hWnd, &rc );
+    TreemapLayout ( &gTm, gTmTop, 0.0f, 0.0f, (float)rc.right,
+        (float)rc.bottom );
+
+    InvalidateRect ( hWnd, NULL, FALSE );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TMView_OnPAINT
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: HWND hWnd : treemap window
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: fill every rectangle, parents first, frame the folders
+//                 and put a name on those with room for one. Drawn on a
+//                 bitmap first, then blitted, so it doesn't flicker.
+/*--------------------------------------------------------------------@@-@@-*/
+static void TMView_OnPAINT ( HWND hWnd )
+/*--------------------------------------------------------------------------*/
+{
+    PAINTSTRUCT     ps;
+    HDC             hdc, hmem;
+    HBITMAP         hbmp, hold;
+    HFONT           hfold;
+    HBRUSH          hdcb;
+    RECT            rc, rr;
+    const TM_RECT   * r;
+    const ENGINE    * eng;
+    UINT            i;
+
+    hdc = BeginPaint ( hWnd, &ps );
+    GetClientRect ( hWnd, &rc );
+
+    hmem    = CreateCompatibleDC ( hdc );
+    hbmp    = CreateCompatibleBitmap ( hdc, rc.right, rc.bottom );
+    hold    = SelectObject ( hmem, hbmp );
+    hfold   = SelectObject ( hmem, GetStockObject ( DEFAULT_GUI_FONT ) );
+    hdcb    = GetStockObject ( DC_BRUSH );
+    eng     = gTmEng;
+
+    FillRect ( hmem, &rc, GetSysColorBrush ( COLOR_WINDOW ) );
+    SetBkMode ( hmem, TRANSPARENT );
+
+    for ( i = 0; i < gTm.count; i++ )
+    {
+        r           = &gTm.rects[i];
+        rr.left     = (LONG)r->x;
+        rr.top      = (LONG)r->y;
+        rr.right    = (LONG)( r->x + r->w );
+        rr.bottom   = (LONG)( r->y + r->h );
+
+        SetDCBrushColor ( hmem, TMView_Color ( r ) );
+        FillRect ( hmem, &rr, hdcb );
+
+        if ( r->kind != TM_FOLDER )
+            continue;
+
+        SetDCBrushColor ( hmem, TM_FRAME_COLOR );
+        FrameRect ( hmem, &rr, hdcb );
+
+        // the label strip is only kept for folders tall enough
+        if ( r->w < 6.0f * gTm.head || r->h < 3.0f * gTm.head )
+            continue;
+
+        rr.left     += (LONG)gTm.pad + 2;
+        rr.right    -= (LONG)gTm.pad + 2;
+        rr.top      += (LONG)gTm.pad;
+        rr.bottom   = rr.top + (LONG)gTm.head;
+
+        DrawTextW ( hmem, eng->names + eng->name[r->node],
+            eng->nlen[r->node], &rr, DT_SINGLELINE | DT_VCENTER |
+                DT_END_ELLIPSIS | DT_NOPREFIX );
+    }
+
+    BitBlt ( hdc, 0, 0, rc.right, rc.bottom, hmem, 0, 0, SRCCOPY );
+
+    SelectObject ( hmem, hfold );
+    SelectObject ( hmem, hold );
+    DeleteObject ( hbmp );
+    DeleteDC ( hmem );
+
+    EndPaint ( hWnd, &ps );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TMView_OnMOUSEMOVE
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: HWND hWnd     : treemap window
+//    Param.    2: LPARAM lParam : mouse position
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the title tells what's under the mouse, only changed
+//                 when it's something else
+/*--------------------------------------------------------------------@@-@@-*/
+static void TMView_OnMOUSEMOVE ( HWND hWnd, LPARAM lParam )
+/*--------------------------------------------------------------------------*/
+{
+    const TM_RECT   * r;
+    int             hot;
+
+    r   = TreemapHit ( &gTm, (float)GET_X_LPARAM(lParam),
+        (float)GET_Y_LPARAM(lParam) );
+    hot = ( r != NULL ) ? (int)( r - gTm.rects ) : -1;
+
+    if ( hot == gTmHot )
+        return;
+
+    gTmHot = hot;
+    TMView_Title ( hWnd, r );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TMView_Zoom
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: HWND hWnd : treemap window
+//    Param.    2: UINT node : folder to fill the window with
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void TMView_Zoom ( HWND hWnd, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    if ( node >= gTmEng->count || node == gTmTop )
+        return;
+
+    gTmTop = node;
+
+    TMView_Layout ( hWnd );
+    TMView_Title ( hWnd, NULL );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TMView_Title
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: HWND hWnd          : treemap window
+//    Param.    2: const TM_RECT * r  : rect under the mouse, NULL for
+//                                      the top folder
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: path and size in KBytes of the folder (or its files)
+/*--------------------------------------------------------------------@@-@@-*/
+static void TMView_Title ( HWND hWnd, const TM_RECT * r )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR           path[ENG_MAX_PATH];
+    WCHAR           title[ENG_MAX_PATH+128];
+    WCHAR           s[64];
+    const ENGINE    * eng;
+    UINT            node, kind;
+
+    eng     = gTmEng;
+    node    = ( r != NULL ) ? r->node : gTmTop;
+    kind    = ( r != NULL ) ? r->kind : TM_FOLDER;
+
+    EnginePath ( eng, node, path, ARRAYSIZE(path) );
+
+    if ( kind == TM_REST )
+    {
+        StringCchPrintfW ( title, ARRAYSIZE(title),
+            L"%ls\\(smaller subfolders)", path );
+    }
+    else
+    {
+        FormatKBytes ( ( kind == TM_FILES ) ? eng->own[node] :
+            eng->size[node], s, ARRAYSIZE(s) );
+
+        StringCchPrintfW ( title, ARRAYSIZE(title), L"%ls%ls - %ls KBytes",
+            path, ( kind == TM_FILES ) ? L"\\(files)" : L"", s );
+    }
+
+    SetWindowTextW ( hWnd, title );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TMView_Color
+/*--------------------------------------------------------------------------*/
+//           Type: static COLORREF
+//    Param.    1: const TM_RECT * r : rectangle
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one color per level, the files halfway to white, the
+//                 lumped small folders grey
+/*--------------------------------------------------------------------@@-@@-*/
+static COLORREF TMView_Color ( const TM_RECT * r )
+/*--------------------------------------------------------------------------*/
+{
+    COLORREF    c;
+
+    if ( r->kind == TM_REST )
+        return TM_REST_COLOR;
+
+    c = gTmColors[r->depth % ARRAYSIZE(gTmColors)];
+
+    if ( r->kind == TM_FILES )
+        c = RGB ( ( GetRValue(c) + 255 ) / 2, ( GetGValue(c) + 255 ) / 2,
+            ( GetBValue(c) + 255 ) / 2 );
+
+    return c;
+}
@@ -0,0 +1,18 @@
+
+// tmview.h - treemap window, draws the engine's tree as nested boxes
+
+#ifndef _TMVIEW_H
+#define _TMVIEW_H
+
+#include <windows.h>
+#include "../engine/engine.h"
+
+#define TMVIEW_CLASS    L"wfsizeTreemap"
+
+BOOL    TMViewRegister      ( HINSTANCE hInst );
+HWND    TMViewOpen          ( HWND hOwner, const ENGINE * eng, UINT node );
+
+// from main.c
+void    FormatKBytes        ( __int64 size, WCHAR * buf, int cchDest );
+
+#endif // _TMVIEW_H
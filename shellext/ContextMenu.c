@@ -6,9 +6,8 @@
     IContextMenu interface
 --------------------------------------------------------------*/
 
-// all the code to pass multiple paths to wfsize.exe cmd line
-// is superfluous, since wfsize only takes a single path. But
-// it's left in place, for some possible future upgrades :-)
+// all the selected folders are passed to wfsize.exe cmd line,
+// each one quoted; wfsize crawls them together.
 
 #include "wfsizesh.h"
 #include <windows.h>
@@ -0,0 +1,479 @@
+
+// age_test.c - --age histograms through a snapshot: a walk of a made up
+// tree saved by SnapSave, the same walk spilled to a run file and saved
+// by SpillSave, and walked as two shards put together by ShardMerge. All
+// three have to agree, folder by folder, and the root with the ages the
+// files were given. Exits with 1 if any check fails.
+
+#include "../engine/engine.h"
+#include "../engine/pathidx.h"
+#include "../engine/snap.h"
+#include "../engine/spill.h"
+#include "../engine/shard.h"
+#include "../engine/agehist.h"
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define DIRS            12      // under the root...
+#define SUBS            3       // ...each with this many...
+#define FILES           4       // ...each with this many files, and
+                                // these in the root and in each of the
+                                // DIRS
+#define THREADS         4
+
+// days ago a file was written and read, a bucket each
+static const int    gDays[AGE_BUCKETS] = { 1, 45, 200, 800 };
+
+// the extra data, NODE_EXTRA-like: the histogram first, then more
+typedef struct _extra
+{
+    AGE_HIST    age;
+    UINT64      other;
+} EXTRA;
+
+static char         gRoot[64];
+static char         gOut[64];       // the snapshots, out of the tree
+static WCHAR        gRootW[64];
+static ENGINE       gEng;
+static SHARD_PLAN   gPlan;
+static __int64      gNow;
+static AGE_HIST     gWant;      // the root's, as the files were made
+static int          gFailed;
+
+#define CHECK(c)    Check ( (c), #c, __LINE__ )
+
+static void         Check           ( int ok, const char * what, int line );
+static void         Build           ( void );
+static void         File            ( const char * dir, UINT k );
+static const WCHAR  * Name          ( const char * file );
+static BOOL         Walk            ( BOOL age, BOOL spill, int shard,
+                                        const char * save );
+static void         Same            ( const SNAPSHOT * a,
+                                        const SNAPSHOT * b );
+static void         OnFile          ( void * ctx, UINT worker, UINT node,
+                                        const WCHAR * dir,
+                                        const WIN32_FIND_DATAW * fd );
+static void         OnRollup        ( void * ctx, UINT node, UINT parent );
+static BOOL         OnSubdir        ( void * ctx, UINT node,
+                                        const WCHAR * name );
+static int          Remove          ( const char * path,
+                                        const struct stat * st, int flag,
+                                        struct FTW * ftw );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: main
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+int main ( void )
+/*--------------------------------------------------------------------------*/
+{
+    SNAPSHOT        a, b, m, n;
+    WCHAR           part[2][128];
+    WCHAR           * parts[2];
+    const AGE_HIST  * ah;
+    __int64         msum, asum;
+    UINT            k;
+
+    gNow = AgeNow();
+    Build();
+
+    CHECK ( Walk ( TRUE, FALSE, -1, "a.snap" ) );
+    CHECK ( Walk ( TRUE, TRUE, -1, "b.snap" ) );
+    CHECK ( Walk ( TRUE, FALSE, 0, "p0.snap" ) );
+    CHECK ( Walk ( TRUE, FALSE, 1, "p1.snap" ) );
+    CHECK ( Walk ( FALSE, FALSE, -1, "n.snap" ) );
+
+    for ( k = 0; k < 2; k++ )
+    {
+        wcscpy ( part[k], Name ( k ? "p1.snap" : "p0.snap" ) );
+        parts[k] = part[k];
+    }
+
+    CHECK ( ShardMerge ( Name ( "m.snap" ), parts, 2 ) != 0 );
+
+    CHECK ( SnapOpen ( &a, Name ( "a.snap" ) ) );
+    CHECK ( SnapOpen ( &b, Name ( "b.snap" ) ) );
+    CHECK ( SnapOpen ( &m, Name ( "m.snap" ) ) );
+    CHECK ( SnapOpen ( &n, Name ( "n.snap" ) ) );
+
+    CHECK ( a.eng.age && b.eng.age && m.eng.age && !n.eng.age );
+
+    if ( a.eng.age )
+    {
+        // the root, file by file
+        ah      = EngineExtra ( &a.eng, 0 );
+        msum    = 0;
+        asum    = 0;
+
+        for ( k = 0; k < AGE_BUCKETS; k++ )
+        {
+            msum += ah->mbytes[k];
+            asum += ah->abytes[k];
+        }
+
+        CHECK ( memcmp ( ah, &gWant, sizeof ( AGE_HIST ) ) == 0 );
+        CHECK ( msum == a.eng.size[0] && asum == a.eng.size[0] );
+
+        Same ( &a, &b );
+        Same ( &a, &m );
+    }
+
+    SnapClose ( &a );
+    SnapClose ( &b );
+    SnapClose ( &m );
+    SnapClose ( &n );
+
+    nftw ( gRoot, Remove, 16, FTW_DEPTH | FTW_PHYS );
+    nftw ( gOut, Remove, 16, FTW_DEPTH | FTW_PHYS );
+
+    printf ( "age: %s\n", gFailed ? "FAILED" : "ok" );
+
+    return gFailed ? 1 : 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Same
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const SNAPSHOT * a : the plain walk's
+//    Param.    2: const SNAPSHOT * b : another
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: every folder of a is in b, by path, with the same size
+//                 and histogram
+/*--------------------------------------------------------------------@@-@@-*/
+static void Same ( const SNAPSHOT * a, const SNAPSHOT * b )
+/*--------------------------------------------------------------------------*/
+{
+    WCHAR   path[ENG_MAX_PATH];
+    UINT    i, j, bad;
+
+    CHECK ( a->eng.count == b->eng.count );
+
+    for ( i = 0, bad = 0; i < a->eng.count; i++ )
+    {
+        EnginePath ( &a->eng, i, path, ENG_MAX_PATH );
+        j = PathIdxLookup ( &b->idx, &b->eng, path );
+
+        if ( j == ENG_NONE || a->eng.size[i] != b->eng.size[j] ||
+                memcmp ( EngineExtra ( &a->eng, i ),
+                    EngineExtra ( &b->eng, j ), sizeof ( AGE_HIST ) ) != 0 )
+            bad++;
+    }
+
+    CHECK ( bad == 0 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Walk
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: BOOL age           : with the histograms
+//    Param.    2: BOOL spill         : everything it can to a run file
+//    Param.    3: int shard          : of two, or -1 for the whole tree
+//    Param.    4: const char * save  : snapshot to write
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: as the console does it, --age, --mem-limit and --shard
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL Walk ( BOOL age, BOOL spill, int shard, const char * save )
+/*--------------------------------------------------------------------------*/
+{
+    PATH_INDEX  pi;
+    SPILL       sp;
+    BOOL        ok;
+
+    RtlZeroMemory ( &sp, sizeof ( sp ) );
+
+    if ( !EngineInit ( &gEng, THREADS, 0, age ? sizeof ( EXTRA ) : 0 ) )
+        return FALSE;
+
+    gEng.age = age;
+    ok = ( EngineAddRoot ( &gEng, gRootW ) >= 0 );
+
+    if ( age )
+    {
+        gEng.hooks.on_file      = OnFile;
+        gEng.hooks.on_rollup    = OnRollup;
+    }
+
+    if ( shard >= 0 )
+    {
+        ok = ok && ShardPlanInit ( &gPlan, (UINT)shard, 2, 1, NULL );
+        gEng.hooks.on_subdir = OnSubdir;
+    }
+
+    // a byte: whatever is final goes out
+    if ( spill )
+        ok = ok && SpillInit ( &sp, &gEng, 1, Name ( "run" ) );
+
+    ok = ok && EngineRun ( &gEng );
+
+    if ( ok && spill )
+    {
+        CHECK ( sp.spills != 0 );
+        ok = SpillSave ( &sp, &gEng, 0, Name ( save ) );
+    }
+    else if ( ok && PathIdxBuild ( &pi, &gEng ) )
+    {
+        ok = SnapSave ( &gEng, &pi, 0, Name ( save ) );
+        PathIdxFree ( &pi );
+    }
+    else
+        ok = FALSE;
+
+    if ( shard >= 0 )
+        ShardPlanFree ( &gPlan );
+
+    SpillFree ( &sp );
+    EngineFree ( &gEng );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnFile
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void * ctx                 : unused
+//    Param.    2: UINT worker                : unused
+//    Param.    3: UINT node                  : folder it's in
+//    Param.    4: const WCHAR * dir          : unused
+//    Param.    5: const WIN32_FIND_DATAW * fd: the file
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: as the console has it
+/*--------------------------------------------------------------------@@-@@-*/
+static void OnFile ( void * ctx, UINT worker, UINT node, const WCHAR * dir,
+    const WIN32_FIND_DATAW * fd )
+/*--------------------------------------------------------------------------*/
+{
+    EXTRA   * ex;
+
+    (void)ctx; (void)worker; (void)dir;
+
+    ex = EngineExtra ( &gEng, node );
+    AgeHistAdd ( &ex->age, gNow, &fd->ftLastWriteTime,
+        &fd->ftLastAccessTime, ( (__int64)fd->nFileSizeHigh << 32 ) |
+        fd->nFileSizeLow );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnRollup
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void * ctx  : unused
+//    Param.    2: UINT node   : final folder
+//    Param.    3: UINT parent : its parent
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void OnRollup ( void * ctx, UINT node, UINT parent )
+/*--------------------------------------------------------------------------*/
+{
+    (void)ctx;
+
+    AgeHistMerge ( EngineExtra ( &gEng, parent ),
+        EngineExtra ( &gEng, node ) );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnSubdir
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: void * ctx         : unused
+//    Param.    2: UINT node          : folder being enumerated
+//    Param.    3: const WCHAR * name : subfolder found in it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL OnSubdir ( void * ctx, UINT node, const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    (void)ctx;
+
+    return ShardOwns ( &gPlan, &gEng, node, name );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Build
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the tree, in a new temporary folder, gWant, and gOut
+/*--------------------------------------------------------------------@@-@@-*/
+static void Build ( void )
+/*--------------------------------------------------------------------------*/
+{
+    char    path[256];
+    UINT    d, s, f, k;
+    size_t  len;
+
+    strcpy ( gRoot, "/tmp/age_XXXXXX" );
+    strcpy ( gOut, "/tmp/age_out_XXXXXX" );
+
+    if ( mkdtemp ( gRoot ) == NULL || mkdtemp ( gOut ) == NULL )
+    {
+        perror ( "mkdtemp" );
+        exit ( 1 );
+    }
+
+    mbstowcs ( gRootW, gRoot, ARRAYSIZE ( gRootW ) );
+
+    for ( k = 0, f = 0; f < FILES; f++ )
+        File ( gRoot, k++ );
+
+    for ( d = 0; d < DIRS; d++ )
+    {
+        len = (size_t)snprintf ( path, sizeof ( path ), "%s/d%02u", gRoot,
+                d );
+        mkdir ( path, 0755 );
+
+        for ( f = 0; f < FILES; f++ )
+            File ( path, k++ );
+
+        for ( s = 0; s < SUBS; s++ )
+        {
+            snprintf ( path + len, sizeof ( path ) - len, "/s%u", s );
+            mkdir ( path, 0755 );
+
+            for ( f = 0; f < FILES; f++ )
+                File ( path, k++ );
+        }
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: File
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const char * dir : folder
+//    Param.    2: UINT k           : file number, all folders counted
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: k*37+1 bytes (sparse), written and read some gDays ago,
+//                 each by k, and counted into gWant
+/*--------------------------------------------------------------------@@-@@-*/
+static void File ( const char * dir, UINT k )
+/*--------------------------------------------------------------------------*/
+{
+    struct timespec ts[2];
+    char            path[256];
+    UINT            mb, ab;
+    int             fd;
+
+    mb = k % AGE_BUCKETS;
+    ab = ( k / AGE_BUCKETS ) % AGE_BUCKETS;
+
+    snprintf ( path, sizeof ( path ), "%s/f%u", dir, k );
+    fd = open ( path, O_CREAT | O_WRONLY | O_TRUNC, 0644 );
+
+    if ( fd < 0 || ftruncate ( fd, k * 37 + 1 ) != 0 )
+    {
+        perror ( path );
+        exit ( 1 );
+    }
+
+    // a day less a minute past the bucket's start, never on the edge
+    ts[0].tv_sec    = time ( NULL ) - gDays[ab] * 86400 - 60;
+    ts[0].tv_nsec   = 0;
+    ts[1].tv_sec    = time ( NULL ) - gDays[mb] * 86400 - 60;
+    ts[1].tv_nsec   = 0;
+
+    futimens ( fd, ts );
+    close ( fd );
+
+    gWant.mbytes[mb] += k * 37 + 1;
+    gWant.abytes[ab] += k * 37 + 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Name
+/*--------------------------------------------------------------------------*/
+//           Type: static const WCHAR *
+//    Param.    1: const char * file : name in gOut
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: its full path, wide, good until the next call but one
+/*--------------------------------------------------------------------@@-@@-*/
+static const WCHAR * Name ( const char * file )
+/*--------------------------------------------------------------------------*/
+{
+    static WCHAR    buf[2][128];
+    static int      n;
+    char            tmp[128];
+
+    n = !n;
+    snprintf ( tmp, sizeof ( tmp ), "%s/%s", gOut, file );
+    mbstowcs ( buf[n], tmp, 128 );
+
+    return buf[n];
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Remove
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const char * path      : entry
+//    Param.    2: const struct stat * st : unused
+//    Param.    3: int flag               : unused
+//    Param.    4: struct FTW * ftw       : unused
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the tree goes, children first
+/*--------------------------------------------------------------------@@-@@-*/
+static int Remove ( const char * path, const struct stat * st, int flag,
+    struct FTW * ftw )
+/*--------------------------------------------------------------------------*/
+{
+    (void)st; (void)flag; (void)ftw;
+
+    return remove ( path );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Check
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: int ok           : passed
+//    Param.    2: const char * what: the check, as written
+//    Param.    3: int line         : where
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void Check ( int ok, const char * what, int line )
+/*--------------------------------------------------------------------------*/
+{
+    if ( ok )
+        return;
+
+    if ( gFailed++ < 20 )
+        fprintf ( stderr, "age_test.c:%d: %s\n", line, what );
+}
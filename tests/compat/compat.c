@@ -0,0 +1,1012 @@
+
+// compat.c - the Win32 calls in windows.h over POSIX threads, files and
+// mmap. Paths are the engine's, '\' turned into '/' and the UTF-32
+// WCHARs into UTF-8 on the way out, and back on the way in.
+
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+#include "windows.h"
+#include "process.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CH_SEMAPHORE    1
+#define CH_THREAD       2
+#define CH_FILE         3
+#define CH_MAPPING      4
+#define CH_FIND         5
+
+#define WAIT_TIMEOUT    258
+#define FILETIME_1970   116444736000000000ULL   // 100ns ticks to 1970
+
+// what a HANDLE points to
+typedef struct _compat_handle
+{
+    int             kind;           // CH_xxx
+    int             fd;             // file, mapping
+    size_t          size;           // mapping
+    int             prot;           // mapping
+    pthread_mutex_t m;              // semaphore
+    pthread_cond_t  c;
+    LONG            count;
+    pthread_t       th;             // thread
+    int             joined;
+    unsigned        ( * start ) ( void * );
+    void            * arg;
+    DIR             * dir;          // find
+    struct dirent   ** names;       // its entries, sorted
+    int             nnames;
+    int             next;
+    char            path[PATH_MAX]; // file, find
+} COMPAT_HANDLE;
+
+// reserved or mapped memory, to know how much to give back
+typedef struct _compat_region
+{
+    struct _compat_region   * next;
+    void                    * base;
+    size_t                  size;
+} COMPAT_REGION;
+
+static COMPAT_REGION    * gRegions;
+static pthread_mutex_t  gRegionLock = PTHREAD_MUTEX_INITIALIZER;
+
+static COMPAT_HANDLE    * CompatNew     ( int kind );
+static void             CompatRemember  ( void * base, size_t size );
+static size_t           CompatForget    ( const void * base );
+static int              CompatPath      ( const WCHAR * w, char * out,
+                                            size_t cap );
+static int              CompatWide      ( const char * s, size_t n,
+                                            WCHAR * out, size_t cch,
+                                            int strict );
+static void             CompatTime      ( const struct timespec * ts,
+                                            FILETIME * ft );
+static BOOL             CompatFind      ( COMPAT_HANDLE * h,
+                                            WIN32_FIND_DATAW * fd );
+static void             * CompatThread  ( void * param );
+
+/*--------------------------------------------------------------------------*/
+// critical sections, semaphores, threads
+/*--------------------------------------------------------------------------*/
+
+void InitializeCriticalSection ( CRITICAL_SECTION * cs )
+{
+    pthread_mutexattr_t a;
+
+    pthread_mutexattr_init ( &a );
+    pthread_mutexattr_settype ( &a, PTHREAD_MUTEX_RECURSIVE );
+    pthread_mutex_init ( &cs->m, &a );
+    pthread_mutexattr_destroy ( &a );
+}
+
+void DeleteCriticalSection ( CRITICAL_SECTION * cs )
+{
+    pthread_mutex_destroy ( &cs->m );
+}
+
+void EnterCriticalSection ( CRITICAL_SECTION * cs )
+{
+    pthread_mutex_lock ( &cs->m );
+}
+
+void LeaveCriticalSection ( CRITICAL_SECTION * cs )
+{
+    pthread_mutex_unlock ( &cs->m );
+}
+
+BOOL TryEnterCriticalSection ( CRITICAL_SECTION * cs )
+{
+    return pthread_mutex_trylock ( &cs->m ) == 0;
+}
+
+HANDLE CreateSemaphoreW ( void * sa, LONG initial, LONG max,
+    const WCHAR * name )
+{
+    COMPAT_HANDLE * h;
+
+    (void)sa; (void)max; (void)name;
+
+    if ( ( h = CompatNew ( CH_SEMAPHORE ) ) == NULL )
+        return NULL;
+
+    pthread_mutex_init ( &h->m, NULL );
+    pthread_cond_init ( &h->c, NULL );
+    h->count = initial;
+
+    return h;
+}
+
+BOOL ReleaseSemaphore ( HANDLE hh, LONG n, LONG * prev )
+{
+    COMPAT_HANDLE * h = hh;
+
+    pthread_mutex_lock ( &h->m );
+
+    if ( prev != NULL )
+        *prev = h->count;
+
+    h->count += n;
+    pthread_cond_broadcast ( &h->c );
+    pthread_mutex_unlock ( &h->m );
+
+    return TRUE;
+}
+
+DWORD WaitForSingleObject ( HANDLE hh, DWORD ms )
+{
+    COMPAT_HANDLE   * h = hh;
+    struct timespec ts;
+    DWORD           ret;
+
+    if ( h->kind == CH_THREAD )
+    {
+        if ( !h->joined )
+            pthread_join ( h->th, NULL );
+
+        h->joined = 1;
+        return 0;
+    }
+
+    clock_gettime ( CLOCK_REALTIME, &ts );
+    ts.tv_sec   += ms / 1000;
+    ts.tv_nsec  += (long)( ms % 1000 ) * 1000000;
+
+    if ( ts.tv_nsec >= 1000000000 )
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock ( &h->m );
+
+    for ( ret = 0; h->count == 0 && ret == 0; )
+        if ( ms == INFINITE )
+            pthread_cond_wait ( &h->c, &h->m );
+        else if ( pthread_cond_timedwait ( &h->c, &h->m, &ts ) ==
+                ETIMEDOUT )
+            ret = WAIT_TIMEOUT;
+
+    if ( h->count != 0 )
+    {
+        h->count--;
+        ret = 0;
+    }
+
+    pthread_mutex_unlock ( &h->m );
+
+    return ret;
+}
+
+// only ever for all of them, forever
+DWORD WaitForMultipleObjects ( DWORD n, const HANDLE * h, BOOL all,
+    DWORD ms )
+{
+    DWORD i;
+
+    (void)all;
+
+    for ( i = 0; i < n; i++ )
+        WaitForSingleObject ( h[i], ms );
+
+    return 0;
+}
+
+uintptr_t _beginthreadex ( void * sa, unsigned stack,
+    unsigned ( * start ) ( void * ), void * arg, unsigned flags,
+    unsigned * id )
+{
+    COMPAT_HANDLE * h;
+
+    (void)sa; (void)stack; (void)flags;
+
+    if ( ( h = CompatNew ( CH_THREAD ) ) == NULL )
+        return 0;
+
+    h->start    = start;
+    h->arg      = arg;
+
+    if ( pthread_create ( &h->th, NULL, CompatThread, h ) != 0 )
+    {
+        free ( h );
+        return 0;
+    }
+
+    if ( id != NULL )
+        *id = 0;
+
+    return (uintptr_t)h;
+}
+
+BOOL CloseHandle ( HANDLE hh )
+{
+    COMPAT_HANDLE * h = hh;
+
+    if ( h == NULL || h == INVALID_HANDLE_VALUE )
+        return FALSE;
+
+    switch ( h->kind )
+    {
+        case CH_SEMAPHORE:
+            pthread_cond_destroy ( &h->c );
+            pthread_mutex_destroy ( &h->m );
+            break;
+
+        case CH_THREAD:
+            if ( !h->joined )
+                pthread_detach ( h->th );
+            break;
+
+        case CH_FILE:
+        case CH_MAPPING:
+            close ( h->fd );
+            break;
+
+        case CH_FIND:
+            while ( h->nnames > 0 )
+                free ( h->names[--h->nnames] );
+
+            free ( h->names );
+            closedir ( h->dir );
+            break;
+    }
+
+    free ( h );
+
+    return TRUE;
+}
+
+HANDLE GetCurrentThread ( void )
+{
+    return (HANDLE)(intptr_t)-2;
+}
+
+// the tests time the walk, not the scheduler
+BOOL SetThreadPriority ( HANDLE h, int priority )
+{
+    (void)h; (void)priority;
+
+    return TRUE;
+}
+
+void Sleep ( DWORD ms )
+{
+    struct timespec ts;
+
+    ts.tv_sec   = ms / 1000;
+    ts.tv_nsec  = (long)( ms % 1000 ) * 1000000;
+
+    while ( nanosleep ( &ts, &ts ) != 0 && errno == EINTR )
+        ;
+}
+
+BOOL SwitchToThread ( void )
+{
+    return sched_yield ( ) == 0;
+}
+
+void GetSystemInfo ( SYSTEM_INFO * si )
+{
+    long n;
+
+    n = sysconf ( _SC_NPROCESSORS_ONLN );
+
+    si->dwPageSize              = (DWORD)sysconf ( _SC_PAGESIZE );
+    si->dwNumberOfProcessors    = ( n > 0 ) ? (DWORD)n : 1;
+}
+
+BOOL QueryPerformanceCounter ( LARGE_INTEGER * li )
+{
+    struct timespec ts;
+
+    clock_gettime ( CLOCK_MONOTONIC, &ts );
+    li->QuadPart = (LONGLONG)ts.tv_sec * 1000000000 + ts.tv_nsec;
+
+    return TRUE;
+}
+
+BOOL QueryPerformanceFrequency ( LARGE_INTEGER * li )
+{
+    li->QuadPart = 1000000000;
+
+    return TRUE;
+}
+
+void GetSystemTimeAsFileTime ( FILETIME * ft )
+{
+    struct timespec ts;
+
+    clock_gettime ( CLOCK_REALTIME, &ts );
+    CompatTime ( &ts, ft );
+}
+
+/*--------------------------------------------------------------------------*/
+// memory
+/*--------------------------------------------------------------------------*/
+
+// reserving maps it inaccessible, committing opens it up
+void * VirtualAlloc ( void * at, SIZE_T size, DWORD type, DWORD protect )
+{
+    uintptr_t   page, lo, hi;
+    void        * p;
+
+    (void)protect;
+
+    if ( type & MEM_RESERVE )
+    {
+        p = mmap ( at, size, ( type & MEM_COMMIT ) ?
+            PROT_READ | PROT_WRITE : PROT_NONE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+
+        if ( p == MAP_FAILED )
+            return NULL;
+
+        CompatRemember ( p, size );
+        return p;
+    }
+
+    page    = (uintptr_t)sysconf ( _SC_PAGESIZE );
+    lo      = (uintptr_t)at & ~( page - 1 );
+    hi      = ( (uintptr_t)at + size + page - 1 ) & ~( page - 1 );
+
+    if ( mprotect ( (void *)lo, hi - lo, PROT_READ | PROT_WRITE ) != 0 )
+        return NULL;
+
+    return at;
+}
+
+BOOL VirtualFree ( void * at, SIZE_T size, DWORD type )
+{
+    (void)size; (void)type;
+
+    size = CompatForget ( at );
+
+    return size != 0 && munmap ( at, size ) == 0;
+}
+
+/*--------------------------------------------------------------------------*/
+// files
+/*--------------------------------------------------------------------------*/
+
+HANDLE CreateFileW ( const WCHAR * path, DWORD access, DWORD share,
+    void * sa, DWORD how, DWORD flags, HANDLE tmpl )
+{
+    COMPAT_HANDLE   * h;
+    int             oflag;
+
+    (void)share; (void)sa; (void)tmpl;
+
+    if ( ( h = CompatNew ( CH_FILE ) ) == NULL )
+        return INVALID_HANDLE_VALUE;
+
+    if ( !CompatPath ( path, h->path, sizeof ( h->path ) ) )
+    {
+        free ( h );
+        return INVALID_HANDLE_VALUE;
+    }
+
+    oflag = O_CLOEXEC;
+
+    if ( access & GENERIC_WRITE )
+        oflag |= ( access & GENERIC_READ ) ? O_RDWR : O_WRONLY;
+
+    switch ( how )
+    {
+        case CREATE_NEW:    oflag |= O_CREAT | O_EXCL;  break;
+        case CREATE_ALWAYS: oflag |= O_CREAT | O_TRUNC; break;
+        case OPEN_ALWAYS:   oflag |= O_CREAT;           break;
+    }
+
+    h->fd = open ( h->path, oflag, 0644 );
+
+    if ( h->fd < 0 )
+    {
+        free ( h );
+        return INVALID_HANDLE_VALUE;
+    }
+
+    if ( flags & FILE_FLAG_DELETE_ON_CLOSE )
+        unlink ( h->path );
+
+    return h;
+}
+
+BOOL ReadFile ( HANDLE hh, void * buf, DWORD n, DWORD * got, void * ov )
+{
+    COMPAT_HANDLE       * h = hh;
+    const OVERLAPPED    * at = ov;
+    ssize_t             r;
+
+    // with an OVERLAPPED, from its offset, as WriteFile
+    do
+        r = ( at != NULL ) ? pread ( h->fd, buf, n,
+                (off_t)( (UINT64)at->OffsetHigh << 32 | at->Offset ) ) :
+            read ( h->fd, buf, n );
+    while ( r < 0 && errno == EINTR );
+
+    *got = ( r > 0 ) ? (DWORD)r : 0;
+
+    return r >= 0;
+}
+
+BOOL WriteFile ( HANDLE hh, const void * buf, DWORD n, DWORD * put,
+    void * ov )
+{
+    COMPAT_HANDLE       * h = hh;
+    const OVERLAPPED    * at = ov;
+    off_t               off;
+    ssize_t             r;
+    DWORD               done;
+
+    // with an OVERLAPPED, at its offset and the file pointer left alone
+    off = ( at != NULL ) ?
+        (off_t)( (UINT64)at->OffsetHigh << 32 | at->Offset ) : 0;
+
+    for ( done = 0; done < n; done += (DWORD)r )
+    {
+        if ( at != NULL )
+            r = pwrite ( h->fd, (const char *)buf + done, n - done,
+                    off + done );
+        else
+            r = write ( h->fd, (const char *)buf + done, n - done );
+
+        if ( r < 0 && errno == EINTR )
+            r = 0;
+        else if ( r < 0 )
+            break;
+    }
+
+    *put = done;
+
+    return done == n;
+}
+
+BOOL SetFilePointerEx ( HANDLE hh, LARGE_INTEGER to, LARGE_INTEGER * at,
+    DWORD how )
+{
+    COMPAT_HANDLE   * h = hh;
+    off_t           pos;
+
+    pos = lseek ( h->fd, (off_t)to.QuadPart, ( how == FILE_BEGIN ) ?
+        SEEK_SET : ( how == FILE_CURRENT ) ? SEEK_CUR : SEEK_END );
+
+    if ( at != NULL )
+        at->QuadPart = pos;
+
+    return pos != (off_t)-1;
+}
+
+BOOL GetFileSizeEx ( HANDLE hh, LARGE_INTEGER * size )
+{
+    COMPAT_HANDLE   * h = hh;
+    struct stat     st;
+
+    if ( fstat ( h->fd, &st ) != 0 )
+        return FALSE;
+
+    size->QuadPart = st.st_size;
+
+    return TRUE;
+}
+
+BOOL GetFileTime ( HANDLE hh, FILETIME * created, FILETIME * accessed,
+    FILETIME * written )
+{
+    COMPAT_HANDLE   * h = hh;
+    struct stat     st;
+
+    if ( fstat ( h->fd, &st ) != 0 )
+        return FALSE;
+
+    if ( created != NULL )
+        CompatTime ( &st.st_ctim, created );
+
+    if ( accessed != NULL )
+        CompatTime ( &st.st_atim, accessed );
+
+    if ( written != NULL )
+        CompatTime ( &st.st_mtim, written );
+
+    return TRUE;
+}
+
+BOOL GetFileInformationByHandle ( HANDLE hh,
+    BY_HANDLE_FILE_INFORMATION * bhfi )
+{
+    COMPAT_HANDLE   * h = hh;
+    struct stat     st;
+
+    if ( fstat ( h->fd, &st ) != 0 )
+        return FALSE;
+
+    memset ( bhfi, 0, sizeof ( *bhfi ) );
+
+    bhfi->dwFileAttributes      = S_ISDIR ( st.st_mode ) ?
+                                    FILE_ATTRIBUTE_DIRECTORY :
+                                    FILE_ATTRIBUTE_NORMAL;
+    bhfi->dwVolumeSerialNumber  = (DWORD)st.st_dev;
+    bhfi->nFileSizeHigh         = (DWORD)( (UINT64)st.st_size >> 32 );
+    bhfi->nFileSizeLow          = (DWORD)st.st_size;
+    bhfi->nNumberOfLinks        = (DWORD)st.st_nlink;
+    bhfi->nFileIndexHigh        = (DWORD)( (UINT64)st.st_ino >> 32 );
+    bhfi->nFileIndexLow         = (DWORD)st.st_ino;
+
+    CompatTime ( &st.st_mtim, &bhfi->ftLastWriteTime );
+
+    return TRUE;
+}
+
+// no \\?\ in front, there's no such thing here
+DWORD GetFinalPathNameByHandleW ( HANDLE hh, WCHAR * out, DWORD cch,
+    DWORD flags )
+{
+    COMPAT_HANDLE   * h = hh;
+    char            real[PATH_MAX];
+    WCHAR           tmp[PATH_MAX];
+    int             len;
+
+    (void)flags;
+
+    if ( realpath ( h->path, real ) == NULL )
+        return 0;
+
+    len = CompatWide ( real, strlen ( real ) + 1, tmp, PATH_MAX, 0 );
+
+    if ( len == 0 )
+        return 0;
+
+    if ( (DWORD)len > cch )
+        return (DWORD)len;
+
+    wmemcpy ( out, tmp, (size_t)len );
+
+    return (DWORD)len - 1;
+}
+
+BOOL DeleteFileW ( const WCHAR * path )
+{
+    char p[PATH_MAX];
+
+    return CompatPath ( path, p, sizeof ( p ) ) && unlink ( p ) == 0;
+}
+
+DWORD GetFileAttributesW ( const WCHAR * path )
+{
+    char        p[PATH_MAX];
+    struct stat st;
+
+    if ( !CompatPath ( path, p, sizeof ( p ) ) || stat ( p, &st ) != 0 )
+        return INVALID_FILE_ATTRIBUTES;
+
+    return S_ISDIR ( st.st_mode ) ? FILE_ATTRIBUTE_DIRECTORY :
+        FILE_ATTRIBUTE_NORMAL;
+}
+
+BOOL FlushFileBuffers ( HANDLE hh )
+{
+    COMPAT_HANDLE * h = hh;
+
+    return fsync ( h->fd ) == 0;
+}
+
+BOOL CopyFileW ( const WCHAR * from, const WCHAR * to, BOOL fail_if_there )
+{
+    char    a[PATH_MAX], b[PATH_MAX], buf[65536];
+    ssize_t r;
+    int     in, out;
+    BOOL    ok;
+
+    if ( !CompatPath ( from, a, sizeof ( a ) ) ||
+            !CompatPath ( to, b, sizeof ( b ) ) ||
+            ( in = open ( a, O_RDONLY | O_CLOEXEC ) ) < 0 )
+        return FALSE;
+
+    out = open ( b, O_WRONLY | O_CREAT | O_CLOEXEC |
+        ( fail_if_there ? O_EXCL : O_TRUNC ), 0644 );
+    ok  = ( out >= 0 );
+
+    while ( ok && ( r = read ( in, buf, sizeof ( buf ) ) ) != 0 )
+        ok = ( r > 0 && write ( out, buf, (size_t)r ) == r );
+
+    close ( in );
+
+    if ( out >= 0 )
+        close ( out );
+
+    return ok;
+}
+
+BOOL MoveFileExW ( const WCHAR * from, const WCHAR * to, DWORD flags )
+{
+    char a[PATH_MAX], b[PATH_MAX];
+
+    (void)flags;
+
+    return CompatPath ( from, a, sizeof ( a ) ) &&
+        CompatPath ( to, b, sizeof ( b ) ) && rename ( a, b ) == 0;
+}
+
+/*--------------------------------------------------------------------------*/
+// file mappings
+/*--------------------------------------------------------------------------*/
+
+// a read-write mapping bigger than the file grows it, like Windows does
+HANDLE CreateFileMappingW ( HANDLE hh, void * sa, DWORD protect, DWORD hi,
+    DWORD lo, const WCHAR * name )
+{
+    COMPAT_HANDLE   * f = hh, * h;
+    struct stat     st;
+    size_t          size;
+
+    (void)sa; (void)name;
+
+    if ( f == NULL || f == INVALID_HANDLE_VALUE || fstat ( f->fd, &st ) )
+        return NULL;
+
+    size = ( (size_t)hi << 32 ) | lo;
+
+    if ( size == 0 )
+        size = (size_t)st.st_size;
+
+    if ( size == 0 )
+        return NULL;
+
+    if ( size > (size_t)st.st_size && ( protect & PAGE_READWRITE ) &&
+            ftruncate ( f->fd, (off_t)size ) != 0 )
+        return NULL;
+
+    if ( ( h = CompatNew ( CH_MAPPING ) ) == NULL )
+        return NULL;
+
+    h->fd   = dup ( f->fd );
+    h->size = size;
+    h->prot = ( protect & PAGE_READWRITE ) ? PROT_READ | PROT_WRITE :
+                PROT_READ;
+
+    return h;
+}
+
+// the whole of it, that's all the engine asks for
+void * MapViewOfFile ( HANDLE hh, DWORD access, DWORD hi, DWORD lo,
+    SIZE_T size )
+{
+    COMPAT_HANDLE   * h = hh;
+    void            * p;
+
+    (void)hi; (void)lo; (void)size;
+
+    p = mmap ( NULL, h->size, ( access & FILE_MAP_WRITE ) ?
+        PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, h->fd, 0 );
+
+    if ( p == MAP_FAILED )
+        return NULL;
+
+    CompatRemember ( p, h->size );
+
+    return p;
+}
+
+BOOL UnmapViewOfFile ( const void * view )
+{
+    size_t size;
+
+    size = CompatForget ( view );
+
+    return size != 0 && munmap ( (void *)view, size ) == 0;
+}
+
+/*--------------------------------------------------------------------------*/
+// folders
+/*--------------------------------------------------------------------------*/
+
+// only ever called as "folder\*"
+HANDLE FindFirstFileExW ( const WCHAR * pattern, FINDEX_INFO_LEVELS level,
+    WIN32_FIND_DATAW * fd, FINDEX_SEARCH_OPS op, void * filter,
+    DWORD flags )
+{
+    COMPAT_HANDLE   * h;
+    size_t          len;
+
+    (void)level; (void)op; (void)filter; (void)flags;
+
+    if ( ( h = CompatNew ( CH_FIND ) ) == NULL )
+        return INVALID_HANDLE_VALUE;
+
+    if ( !CompatPath ( pattern, h->path, sizeof ( h->path ) ) ||
+            ( len = strlen ( h->path ) ) < 2 ||
+            strcmp ( h->path + len - 2, "/*" ) != 0 )
+    {
+        free ( h );
+        return INVALID_HANDLE_VALUE;
+    }
+
+    h->path[len-2] = '\0';
+    h->dir = opendir ( ( len == 2 ) ? "/" : h->path );
+
+    if ( h->dir == NULL )
+    {
+        free ( h );
+        return INVALID_HANDLE_VALUE;
+    }
+
+    // sorted, as NTFS gives them, so a walk goes the same way on any
+    // file system and a bench can put a folder where it wants it
+    h->nnames = scandir ( ( len == 2 ) ? "/" : h->path, &h->names, NULL,
+                    alphasort );
+
+    if ( h->nnames < 0 )
+    {
+        h->nnames = 0;
+        CloseHandle ( h );
+        return INVALID_HANDLE_VALUE;
+    }
+
+    if ( !CompatFind ( h, fd ) )
+    {
+        CloseHandle ( h );
+        return INVALID_HANDLE_VALUE;
+    }
+
+    return h;
+}
+
+BOOL FindNextFileW ( HANDLE hh, WIN32_FIND_DATAW * fd )
+{
+    return CompatFind ( hh, fd );
+}
+
+BOOL FindClose ( HANDLE hh )
+{
+    return CloseHandle ( hh );
+}
+
+/*--------------------------------------------------------------------------*/
+// text
+/*--------------------------------------------------------------------------*/
+
+char * lstrcpynA ( char * dst, const char * src, int cch )
+{
+    int i;
+
+    for ( i = 0; i + 1 < cch && src[i] != '\0'; i++ )
+        dst[i] = src[i];
+
+    if ( cch > 0 )
+        dst[i] = '\0';
+
+    return dst;
+}
+
+// the "code page" is Latin-1, enough for the tests
+int MultiByteToWideChar ( UINT cp, DWORD flags, const char * s, int n,
+    WCHAR * out, int cch )
+{
+    int i;
+
+    if ( n < 0 )
+        n = (int)strlen ( s ) + 1;
+
+    if ( cp == CP_UTF8 )
+        return CompatWide ( s, (size_t)n, out, (size_t)cch,
+            ( flags & MB_ERR_INVALID_CHARS ) != 0 );
+
+    if ( cch == 0 )
+        return n;
+
+    if ( n > cch )
+        return 0;
+
+    for ( i = 0; i < n; i++ )
+        out[i] = (unsigned char)s[i];
+
+    return n;
+}
+
+/*--------------------------------------------------------------------------*/
+// helpers
+/*--------------------------------------------------------------------------*/
+
+static COMPAT_HANDLE * CompatNew ( int kind )
+{
+    COMPAT_HANDLE * h;
+
+    if ( ( h = calloc ( 1, sizeof ( COMPAT_HANDLE ) ) ) != NULL )
+    {
+        h->kind = kind;
+        h->fd   = -1;
+    }
+
+    return h;
+}
+
+static void CompatRemember ( void * base, size_t size )
+{
+    COMPAT_REGION * r;
+
+    if ( ( r = malloc ( sizeof ( COMPAT_REGION ) ) ) == NULL )
+        return;
+
+    r->base = base;
+    r->size = size;
+
+    pthread_mutex_lock ( &gRegionLock );
+    r->next     = gRegions;
+    gRegions    = r;
+    pthread_mutex_unlock ( &gRegionLock );
+}
+
+// its size, 0 if it wasn't ours
+static size_t CompatForget ( const void * base )
+{
+    COMPAT_REGION   ** pr, * r;
+    size_t          size;
+
+    size = 0;
+
+    pthread_mutex_lock ( &gRegionLock );
+
+    for ( pr = &gRegions; ( r = *pr ) != NULL; pr = &r->next )
+        if ( r->base == base )
+        {
+            *pr     = r->next;
+            size    = r->size;
+            free ( r );
+            break;
+        }
+
+    pthread_mutex_unlock ( &gRegionLock );
+
+    return size;
+}
+
+// to UTF-8, '\' as '/'. 0 if it doesn't fit.
+static int CompatPath ( const WCHAR * w, char * out, size_t cap )
+{
+    size_t      n;
+    uint32_t    c;
+
+    for ( n = 0; *w != L'\0'; w++ )
+    {
+        c = (uint32_t)*w;
+
+        if ( n + 5 > cap )
+            return 0;
+
+        if ( c == '\\' )
+            out[n++] = '/';
+        else if ( c < 0x80 )
+            out[n++] = (char)c;
+        else if ( c < 0x800 )
+        {
+            out[n++] = (char)( 0xC0 | ( c >> 6 ) );
+            out[n++] = (char)( 0x80 | ( c & 0x3F ) );
+        }
+        else if ( c < 0x10000 )
+        {
+            out[n++] = (char)( 0xE0 | ( c >> 12 ) );
+            out[n++] = (char)( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+            out[n++] = (char)( 0x80 | ( c & 0x3F ) );
+        }
+        else
+        {
+            out[n++] = (char)( 0xF0 | ( c >> 18 ) );
+            out[n++] = (char)( 0x80 | ( ( c >> 12 ) & 0x3F ) );
+            out[n++] = (char)( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+            out[n++] = (char)( 0x80 | ( c & 0x3F ) );
+        }
+    }
+
+    out[n] = '\0';
+
+    return 1;
+}
+
+// UTF-8 to WCHARs, n bytes in; the count out, 0 if it doesn't fit or,
+// when strict, isn't valid. cch 0 only counts.
+static int CompatWide ( const char * s, size_t n, WCHAR * out, size_t cch,
+    int strict )
+{
+    const unsigned char * p, * end;
+    uint32_t            c;
+    size_t              k;
+    int                 more;
+
+    p   = (const unsigned char *)s;
+    end = p + n;
+
+    for ( k = 0; p < end; k++ )
+    {
+        c       = *p++;
+        more    = ( c < 0x80 ) ? 0 : ( c < 0xC2 ) ? -1 : ( c < 0xE0 ) ? 1 :
+                    ( c < 0xF0 ) ? 2 : ( c < 0xF5 ) ? 3 : -1;
+
+        if ( more > 0 )
+            c &= 0x3F >> more;
+
+        for ( ; more > 0 && p < end && ( *p & 0xC0 ) == 0x80; more-- )
+            c = ( c << 6 ) | ( *p++ & 0x3F );
+
+        if ( more != 0 )
+        {
+            if ( strict )
+                return 0;
+
+            c = 0xFFFD;
+        }
+
+        if ( cch != 0 )
+        {
+            if ( k == cch )
+                return 0;
+
+            out[k] = (WCHAR)c;
+        }
+    }
+
+    return (int)k;
+}
+
+static void CompatTime ( const struct timespec * ts, FILETIME * ft )
+{
+    UINT64 t;
+
+    t = (UINT64)ts->tv_sec * 10000000 + (UINT64)ts->tv_nsec / 100 +
+        FILETIME_1970;
+
+    ft->dwLowDateTime   = (DWORD)t;
+    ft->dwHighDateTime  = (DWORD)( t >> 32 );
+}
+
+// the next entry, as it is: a link is a file, whatever it points to
+static BOOL CompatFind ( COMPAT_HANDLE * h, WIN32_FIND_DATAW * fd )
+{
+    struct dirent   * e;
+    struct stat     st;
+
+    for ( ;; )
+    {
+        if ( h->next >= h->nnames )
+            return FALSE;
+
+        e = h->names[h->next++];
+
+        if ( fstatat ( dirfd ( h->dir ), e->d_name, &st,
+                AT_SYMLINK_NOFOLLOW ) == 0 &&
+                CompatWide ( e->d_name, strlen ( e->d_name ) + 1,
+                    fd->cFileName, MAX_PATH, 0 ) != 0 )
+            break;
+    }
+
+    fd->dwFileAttributes    = S_ISDIR ( st.st_mode ) ?
+                                FILE_ATTRIBUTE_DIRECTORY :
+                                FILE_ATTRIBUTE_NORMAL;
+    fd->nFileSizeHigh       = (DWORD)( (UINT64)st.st_size >> 32 );
+    fd->nFileSizeLow        = (DWORD)st.st_size;
+    fd->dwReserved0         = 0;
+    fd->dwReserved1         = 0;
+    fd->cAlternateFileName[0] = L'\0';
+
+    CompatTime ( &st.st_ctim, &fd->ftCreationTime );
+    CompatTime ( &st.st_atim, &fd->ftLastAccessTime );
+    CompatTime ( &st.st_mtim, &fd->ftLastWriteTime );
+
+    return TRUE;
+}
+
+static void * CompatThread ( void * param )
+{
+    COMPAT_HANDLE * h = param;
+
+    h->start ( h->arg );
+
+    return NULL;
+}
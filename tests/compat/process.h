@@ -0,0 +1,14 @@
+
+// process.h - _beginthreadex for tests/compat, see windows.h there
+
+#ifndef _COMPAT_PROCESS_H
+#define _COMPAT_PROCESS_H
+
+#include <stdint.h>
+
+uintptr_t   _beginthreadex  ( void * sa, unsigned stack,
+                                unsigned ( * start ) ( void * ),
+                                void * arg, unsigned flags,
+                                unsigned * id );
+
+#endif // _COMPAT_PROCESS_H
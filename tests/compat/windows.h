@@ -0,0 +1,271 @@
+
+// windows.h - the bit of Win32 the engine uses, over POSIX, so engine.c
+// and the parts it links with build and run on Linux for the tests and
+// benches in tests/. Not a port: only what those files call, and only
+// as far as they use it. See compat.c.
+
+#ifndef _COMPAT_WINDOWS_H
+#define _COMPAT_WINDOWS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+#include <pthread.h>
+
+#if defined(__LP64__) && !defined(_WIN64)
+    #define _WIN64
+#endif
+
+#define __int64             long long
+#define __stdcall
+#define __cdecl
+#define WINAPI
+
+typedef int                 BOOL;
+typedef unsigned char       BYTE;
+typedef unsigned short      USHORT;
+typedef int32_t             LONG;
+typedef uint32_t            DWORD;
+typedef uint32_t            UINT32;
+typedef unsigned int        UINT;
+typedef long long           LONGLONG;
+typedef long long           LONG64;
+typedef long long           INT64;
+typedef unsigned long long  ULONGLONG;
+typedef unsigned long long  UINT64;
+typedef uintptr_t           UINT_PTR;
+typedef uintptr_t           ULONG_PTR;
+typedef intptr_t            INT_PTR;
+typedef size_t              SIZE_T;
+typedef wchar_t             WCHAR;
+typedef void                * HANDLE;
+
+#define TRUE                1
+#define FALSE               0
+#define MAX_PATH            260
+#define INFINITE            0xFFFFFFFF
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define INVALID_FILE_ATTRIBUTES ((DWORD)-1)
+#define ARRAYSIZE(a)        ( sizeof ( a ) / sizeof ( (a)[0] ) )
+#define FIELD_OFFSET(t, f)  ((LONG)offsetof ( t, f ))
+
+typedef union _LARGE_INTEGER
+{
+    struct
+    {
+        DWORD   LowPart;
+        LONG    HighPart;
+    };
+    struct
+    {
+        DWORD   LowPart;
+        LONG    HighPart;
+    } u;
+    LONGLONG    QuadPart;
+} LARGE_INTEGER;
+
+typedef union _ULARGE_INTEGER
+{
+    struct
+    {
+        DWORD   LowPart;
+        DWORD   HighPart;
+    };
+    struct
+    {
+        DWORD   LowPart;
+        DWORD   HighPart;
+    } u;
+    ULONGLONG   QuadPart;
+} ULARGE_INTEGER;
+
+typedef struct _FILETIME
+{
+    DWORD   dwLowDateTime;
+    DWORD   dwHighDateTime;
+} FILETIME;
+
+typedef struct _WIN32_FIND_DATAW
+{
+    DWORD       dwFileAttributes;
+    FILETIME    ftCreationTime;
+    FILETIME    ftLastAccessTime;
+    FILETIME    ftLastWriteTime;
+    DWORD       nFileSizeHigh;
+    DWORD       nFileSizeLow;
+    DWORD       dwReserved0;
+    DWORD       dwReserved1;
+    WCHAR       cFileName[MAX_PATH];
+    WCHAR       cAlternateFileName[14];
+} WIN32_FIND_DATAW;
+
+typedef struct _BY_HANDLE_FILE_INFORMATION
+{
+    DWORD       dwFileAttributes;
+    FILETIME    ftCreationTime;
+    FILETIME    ftLastAccessTime;
+    FILETIME    ftLastWriteTime;
+    DWORD       dwVolumeSerialNumber;
+    DWORD       nFileSizeHigh;
+    DWORD       nFileSizeLow;
+    DWORD       nNumberOfLinks;
+    DWORD       nFileIndexHigh;
+    DWORD       nFileIndexLow;
+} BY_HANDLE_FILE_INFORMATION;
+
+// only the offset, for a positioned write on a synchronous handle
+typedef struct _OVERLAPPED
+{
+    ULONG_PTR   Internal;
+    ULONG_PTR   InternalHigh;
+    DWORD       Offset;
+    DWORD       OffsetHigh;
+    HANDLE      hEvent;
+} OVERLAPPED;
+
+typedef struct _SYSTEM_INFO
+{
+    DWORD       dwPageSize;
+    DWORD       dwNumberOfProcessors;
+} SYSTEM_INFO;
+
+// recursive, like the real one
+typedef struct _CRITICAL_SECTION
+{
+    pthread_mutex_t m;
+} CRITICAL_SECTION;
+
+typedef enum { FindExInfoStandard, FindExInfoBasic } FINDEX_INFO_LEVELS;
+typedef enum { FindExSearchNameMatch } FINDEX_SEARCH_OPS;
+
+#define FILE_ATTRIBUTE_DIRECTORY        0x10
+#define FILE_ATTRIBUTE_NORMAL           0x80
+#define FILE_ATTRIBUTE_TEMPORARY        0x100
+#define FILE_ATTRIBUTE_REPARSE_POINT    0x400
+#define FILE_FLAG_DELETE_ON_CLOSE       0x04000000
+#define FILE_FLAG_BACKUP_SEMANTICS      0x02000000
+#define FILE_FLAG_SEQUENTIAL_SCAN       0x08000000
+#define FILE_READ_ATTRIBUTES            0x80
+#define FILE_SHARE_READ                 1
+#define FILE_SHARE_WRITE                2
+#define FILE_SHARE_DELETE               4
+#define GENERIC_READ                    0x80000000
+#define GENERIC_WRITE                   0x40000000
+#define CREATE_NEW                      1
+#define CREATE_ALWAYS                   2
+#define OPEN_EXISTING                   3
+#define OPEN_ALWAYS                     4
+#define FILE_BEGIN                      0
+#define FILE_CURRENT                    1
+#define FILE_END                        2
+#define FIND_FIRST_EX_LARGE_FETCH       2
+#define MOVEFILE_REPLACE_EXISTING       1
+#define MEM_COMMIT                      0x1000
+#define MEM_RESERVE                     0x2000
+#define MEM_RELEASE                     0x8000
+#define PAGE_READONLY                   2
+#define PAGE_READWRITE                  4
+#define SEC_RESERVE                     0x4000000
+#define FILE_MAP_WRITE                  2
+#define FILE_MAP_READ                   4
+#define THREAD_MODE_BACKGROUND_BEGIN    0x10000
+#define THREAD_MODE_BACKGROUND_END      0x20000
+#define CP_ACP                          0
+#define CP_UTF8                         65001
+#define MB_ERR_INVALID_CHARS            8
+
+#define RtlZeroMemory(d, n)     memset ( (d), 0, (n) )
+#define ZeroMemory(d, n)        memset ( (d), 0, (n) )
+#define CopyMemory(d, s, n)     memcpy ( (d), (s), (n) )
+#define MoveMemory(d, s, n)     memmove ( (d), (s), (n) )
+#define FillMemory(d, n, v)     memset ( (d), (v), (n) )
+#define MemoryBarrier()         __sync_synchronize()
+
+#define _wcsicmp                wcscasecmp
+#define _wcsnicmp               wcsncasecmp
+#define lstrcmpiW               wcscasecmp
+#define _strtoui64              strtoull
+
+// full barriers, as on Windows
+#define InterlockedIncrement(p)         __sync_add_and_fetch ( (p), 1 )
+#define InterlockedDecrement(p)         __sync_sub_and_fetch ( (p), 1 )
+#define InterlockedIncrement64(p)       __sync_add_and_fetch ( (p), 1 )
+#define InterlockedExchangeAdd(p, v)    __sync_fetch_and_add ( (p), (v) )
+#define InterlockedExchangeAdd64(p, v)  __sync_fetch_and_add ( (p), (v) )
+#define InterlockedExchange(p, v)       \
+    __atomic_exchange_n ( (p), (v), __ATOMIC_SEQ_CST )
+#define InterlockedCompareExchange(p, x, c)     \
+    __sync_val_compare_and_swap ( (p), (c), (x) )
+#define InterlockedCompareExchange64(p, x, c)   \
+    __sync_val_compare_and_swap ( (p), (c), (x) )
+
+void    InitializeCriticalSection   ( CRITICAL_SECTION * cs );
+void    DeleteCriticalSection       ( CRITICAL_SECTION * cs );
+void    EnterCriticalSection        ( CRITICAL_SECTION * cs );
+void    LeaveCriticalSection        ( CRITICAL_SECTION * cs );
+BOOL    TryEnterCriticalSection     ( CRITICAL_SECTION * cs );
+
+HANDLE  CreateSemaphoreW    ( void * sa, LONG initial, LONG max,
+                                const WCHAR * name );
+BOOL    ReleaseSemaphore    ( HANDLE h, LONG n, LONG * prev );
+DWORD   WaitForSingleObject ( HANDLE h, DWORD ms );
+DWORD   WaitForMultipleObjects ( DWORD n, const HANDLE * h, BOOL all,
+                                DWORD ms );
+BOOL    CloseHandle         ( HANDLE h );
+HANDLE  GetCurrentThread    ( void );
+BOOL    SetThreadPriority   ( HANDLE h, int priority );
+void    Sleep               ( DWORD ms );
+BOOL    SwitchToThread      ( void );
+void    GetSystemInfo       ( SYSTEM_INFO * si );
+BOOL    QueryPerformanceCounter     ( LARGE_INTEGER * li );
+BOOL    QueryPerformanceFrequency   ( LARGE_INTEGER * li );
+void    GetSystemTimeAsFileTime     ( FILETIME * ft );
+
+void    * VirtualAlloc      ( void * at, SIZE_T size, DWORD type,
+                                DWORD protect );
+BOOL    VirtualFree         ( void * at, SIZE_T size, DWORD type );
+
+HANDLE  CreateFileW         ( const WCHAR * path, DWORD access,
+                                DWORD share, void * sa, DWORD how,
+                                DWORD flags, HANDLE tmpl );
+BOOL    ReadFile            ( HANDLE h, void * buf, DWORD n, DWORD * got,
+                                void * ov );
+BOOL    WriteFile           ( HANDLE h, const void * buf, DWORD n,
+                                DWORD * put, void * ov );
+BOOL    SetFilePointerEx    ( HANDLE h, LARGE_INTEGER to,
+                                LARGE_INTEGER * at, DWORD how );
+BOOL    GetFileSizeEx       ( HANDLE h, LARGE_INTEGER * size );
+BOOL    GetFileTime         ( HANDLE h, FILETIME * created,
+                                FILETIME * accessed, FILETIME * written );
+BOOL    GetFileInformationByHandle ( HANDLE h,
+                                BY_HANDLE_FILE_INFORMATION * bhfi );
+DWORD   GetFinalPathNameByHandleW ( HANDLE h, WCHAR * out, DWORD cch,
+                                DWORD flags );
+BOOL    FlushFileBuffers    ( HANDLE h );
+DWORD   GetFileAttributesW  ( const WCHAR * path );
+BOOL    CopyFileW           ( const WCHAR * from, const WCHAR * to,
+                                BOOL fail_if_there );
+BOOL    DeleteFileW         ( const WCHAR * path );
+BOOL    MoveFileExW         ( const WCHAR * from, const WCHAR * to,
+                                DWORD flags );
+
+HANDLE  CreateFileMappingW  ( HANDLE h, void * sa, DWORD protect,
+                                DWORD hi, DWORD lo, const WCHAR * name );
+void    * MapViewOfFile     ( HANDLE h, DWORD access, DWORD hi, DWORD lo,
+                                SIZE_T size );
+BOOL    UnmapViewOfFile     ( const void * view );
+
+HANDLE  FindFirstFileExW    ( const WCHAR * pattern,
+                                FINDEX_INFO_LEVELS level,
+                                WIN32_FIND_DATAW * fd,
+                                FINDEX_SEARCH_OPS op, void * filter,
+                                DWORD flags );
+BOOL    FindNextFileW       ( HANDLE h, WIN32_FIND_DATAW * fd );
+BOOL    FindClose           ( HANDLE h );
+
+char    * lstrcpynA         ( char * dst, const char * src, int cch );
+int     MultiByteToWideChar ( UINT cp, DWORD flags, const char * s,
+                                int n, WCHAR * out, int cch );
+
+#endif // _COMPAT_WINDOWS_H
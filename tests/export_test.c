@@ -0,0 +1,337 @@
+
+// export_test.c - engine/export.c over a tree built by hand: every row
+// there, in the order asked, with the sizes asked for, in each format and
+// the same whatever the number of workers, and with the age buckets when
+// the engine has them. Exits with 1 if any check
+// fails. Not the paths: Utf8Encode takes 2 byte units and a WCHAR is 4
+// here, so they come out mangled (utf8_test has the encoding covered).
+
+#include "../engine/engine.h"
+#include "../engine/export.h"
+#include "../engine/agehist.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FOLDERS         20001   // the root and its subfolders, a few
+                                // EXPORT_CHUNKs' worth
+
+// the extra data, NODE_EXTRA-like: the histogram first, then more
+typedef struct _extra
+{
+    AGE_HIST    age;
+    UINT64      other;
+} EXTRA;
+
+static ENGINE       gEng;
+static __int64      gFresh[FOLDERS];
+static UINT         gRows[FOLDERS];
+static int          gFailed;
+static char         gName[32];
+static WCHAR        gNameW[32];
+
+#define CHECK(c)    Check ( (c), #c, __LINE__ )
+
+static void         Check           ( int ok, const char * what, int line );
+static char         * Export        ( const EXPORT_COLS * cols,
+                                        UINT format, UINT threads,
+                                        size_t * len );
+static int          Rows            ( const char * text, size_t len,
+                                        UINT format,
+                                        const EXPORT_COLS * cols );
+static void         TestFormats     ( const EXPORT_COLS * cols );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: main
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the rows go out last folder first, like a list sorted
+//                 some other way than the nodes; a third of the folders
+//                 have no fresh size, as mid-rescan
+/*--------------------------------------------------------------------@@-@@-*/
+int main ( void )
+/*--------------------------------------------------------------------------*/
+{
+    EXPORT_COLS cols;
+    EXTRA       * ex;
+    WCHAR       name[16];
+    UINT        i, b, node;
+    int         fd;
+
+    if ( !EngineInit ( &gEng, 1, 0, sizeof ( EXTRA ) ) )
+    {
+        fprintf ( stderr, "EngineInit failed\n" );
+        return 1;
+    }
+
+    for ( i = 0; i < FOLDERS; i++ )
+    {
+        if ( i == 0 )
+            node = EngineAddNode ( &gEng, ENG_NONE, L"C:\\r", 4 );
+        else
+        {
+            swprintf ( name, ARRAYSIZE ( name ), L"d%u", i );
+            node = EngineAddNode ( &gEng, 0, name, (UINT)wcslen ( name ) );
+        }
+
+        CHECK ( node == i );
+
+        if ( node != i )
+            return 1;
+
+        gEng.size[i]    = (__int64)i * 1000 + 7;
+        gEng.own[i]     = (__int64)i * 10;
+        gEng.files[i]   = i % 97;
+        gEng.tfiles[i]  = i % 89;
+        gEng.tdirs[i]   = i % 83;
+        gEng.flags[i]   |= ENG_FINAL;
+
+        ex = EngineExtra ( &gEng, i );
+
+        for ( b = 0; b < AGE_BUCKETS; b++ )
+        {
+            ex->age.mbytes[b]   = (__int64)i * 100 + b;
+            ex->age.abytes[b]   = (__int64)i * 100 + 50 + b;
+        }
+
+        ex->other       = 0x3939393939393939ULL;    // never written
+        gFresh[i]       = ( i % 3 == 0 ) ? -1 : (__int64)i * 5000 + 3;
+        gRows[i]        = FOLDERS - 1 - i;
+    }
+
+    strcpy ( gName, "/tmp/export_XXXXXX" );
+    fd = mkstemp ( gName );
+
+    if ( fd < 0 )
+    {
+        perror ( "mkstemp" );
+        return 1;
+    }
+
+    close ( fd );
+    mbstowcs ( gNameW, gName, ARRAYSIZE ( gNameW ) );
+
+    TestFormats ( NULL );
+
+    RtlZeroMemory ( &cols, sizeof ( cols ) );
+    TestFormats ( &cols );
+
+    cols.fresh = gFresh;
+    TestFormats ( &cols );
+
+    gEng.age = TRUE;
+    TestFormats ( NULL );
+    TestFormats ( &cols );
+
+    unlink ( gName );
+    EngineFree ( &gEng );
+
+    printf ( "export: %s\n", gFailed ? "FAILED" : "ok" );
+
+    return gFailed ? 1 : 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestFormats
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const EXPORT_COLS * cols : what to export with
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: each format with one worker and with four: the rows
+//                 right and the two files the same
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestFormats ( const EXPORT_COLS * cols )
+/*--------------------------------------------------------------------------*/
+{
+    char    * one, * four;
+    size_t  n1, n4;
+    UINT    format;
+
+    for ( format = EXPORT_CSV; format <= EXPORT_JSON; format++ )
+    {
+        one     = Export ( cols, format, 1, &n1 );
+        four    = Export ( cols, format, 4, &n4 );
+
+        CHECK ( one != NULL && four != NULL );
+
+        if ( one != NULL && four != NULL )
+        {
+            CHECK ( n1 == n4 && memcmp ( one, four, n1 ) == 0 );
+            CHECK ( Rows ( one, n1, format, cols ) );
+        }
+
+        free ( one );
+        free ( four );
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Rows
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const char * text        : the file
+//    Param.    2: size_t len               : its length
+//    Param.    3: UINT format              : EXPORT_xxx
+//    Param.    4: const EXPORT_COLS * cols : what it was exported with
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one row per folder of gRows, in that order, each with
+//                 its fresh size if it has one and the engine's if not,
+//                 the engine's other numbers and, with gEng.age, its
+//                 histogram
+/*--------------------------------------------------------------------@@-@@-*/
+static int Rows ( const char * text, size_t len, UINT format,
+    const EXPORT_COLS * cols )
+/*--------------------------------------------------------------------------*/
+{
+    const EXTRA         * ex;
+    const char          * p, * end, * q, * d;
+    unsigned long long  v[5 + 2 * AGE_BUCKETS], m;
+    __int64             size;
+    UINT                i, k, b, n, node;
+
+    p   = text;
+    end = text + len;
+    n   = gEng.age ? 5 + 2 * AGE_BUCKETS : 5;
+
+    // the header line, and the byte order mark before it
+    if ( format != EXPORT_JSON )
+    {
+        if ( ( p = memchr ( p, '\n', len ) ) == NULL )
+            return 0;
+
+        p++;
+    }
+
+    for ( i = 0; i < FOLDERS; i++ )
+    {
+        q = memchr ( p, '\n', (size_t)( end - p ) );
+
+        if ( q == NULL )
+            return 0;
+
+        // the numbers, from the end of the line back: no name in the
+        // formats has a digit. The folder is told by its own bytes.
+        for ( d = q, k = n; k-- != 0; )
+        {
+            while ( d > p && ( d[-1] < '0' || d[-1] > '9' ) )
+                d--;
+
+            for ( v[k] = 0, m = 1; d > p && d[-1] >= '0' && d[-1] <= '9';
+                    d--, m *= 10 )
+                v[k] += (unsigned long long)( d[-1] - '0' ) * m;
+        }
+
+        node = (UINT)( v[1] / 10 );
+
+        if ( node != gRows[i] )
+            return 0;
+
+        size = gEng.size[node];
+
+        if ( cols != NULL && cols->fresh != NULL && cols->fresh[node] >= 0 )
+            size = cols->fresh[node];
+
+        if ( v[0] != (unsigned long long)size ||
+                v[1] != (unsigned long long)gEng.own[node] ||
+                v[2] != gEng.files[node] ||
+                v[3] != (unsigned long long)gEng.tfiles[node] ||
+                v[4] != gEng.tdirs[node] )
+            return 0;
+
+        ex = EngineExtra ( &gEng, node );
+
+        for ( b = 0; n != 5 && b < AGE_BUCKETS; b++ )
+            if ( v[5 + b] != (unsigned long long)ex->age.mbytes[b] ||
+                    v[5 + AGE_BUCKETS + b] !=
+                    (unsigned long long)ex->age.abytes[b] )
+                return 0;
+
+        p = q + 1;
+    }
+
+    return p == end;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Export
+/*--------------------------------------------------------------------------*/
+//           Type: static char *
+//    Param.    1: const EXPORT_COLS * cols : passed on
+//    Param.    2: UINT format              : EXPORT_xxx
+//    Param.    3: UINT threads             : workers
+//    Param.    4: size_t * len             : receives the file's length
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: gRows exported and read back, 0 ended, NULL if it
+//                 failed; free it
+/*--------------------------------------------------------------------@@-@@-*/
+static char * Export ( const EXPORT_COLS * cols, UINT format, UINT threads,
+    size_t * len )
+/*--------------------------------------------------------------------------*/
+{
+    FILE    * f;
+    char    * text;
+    UINT64  bytes;
+    long    n;
+
+    if ( !ExportFile ( &gEng, gRows, FOLDERS, cols, format, threads,
+            gNameW, &bytes ) || ( f = fopen ( gName, "rb" ) ) == NULL )
+        return NULL;
+
+    fseek ( f, 0, SEEK_END );
+    n = ftell ( f );
+    rewind ( f );
+
+    text = malloc ( (size_t)n + 1 );
+
+    if ( text != NULL && fread ( text, 1, (size_t)n, f ) != (size_t)n )
+    {
+        free ( text );
+        text = NULL;
+    }
+
+    fclose ( f );
+
+    if ( text == NULL || (UINT64)n != bytes )
+    {
+        free ( text );
+        return NULL;
+    }
+
+    text[n] = '\0';
+    *len    = (size_t)n;
+
+    return text;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Check
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: int ok           : passed
+//    Param.    2: const char * what: the check, as written
+//    Param.    3: int line         : where
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void Check ( int ok, const char * what, int line )
+/*--------------------------------------------------------------------------*/
+{
+    if ( ok )
+        return;
+
+    if ( gFailed++ < 20 )
+        fprintf ( stderr, "export_test.c:%d: %s\n", line, what );
+}
@@ -0,0 +1,314 @@
+
+// history_test.c - engine/history.c over snapshots of a tree built by
+// hand: the series read back after adds and a rebase, a rebase cut short
+// between its two renames, and a base that isn't the history's own.
+// Exits with 1 if any check fails.
+
+#include "../engine/engine.h"
+#include "../engine/pathidx.h"
+#include "../engine/snap.h"
+#include "../engine/history.h"
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DAY0            133000000000000000ULL  // a FILETIME, 2022
+#define SCANS           5
+
+// the tree at each scan, subfolders in the order walked and the size of
+// a, b and c; the fourth walk finds them the other way round, so its
+// node numbers aren't the base's though the count is
+static const struct
+{
+    const WCHAR * order;
+    __int64     size[3];
+} gScans[SCANS] =
+{
+    { L"abc", { 100, 200, 300 } },
+    { L"abc", { 150, 200, 300 } },
+    { L"abc", { 150, 250,  50 } },
+    { L"cba", { 400, 250,  60 } },
+    { L"abc", { 400, 250,  70 } },
+};
+
+static char         gDir[64];
+static int          gFailed;
+
+#define CHECK(c)    Check ( (c), #c, __LINE__ )
+
+static void         Check           ( int ok, const char * what, int line );
+static const WCHAR  * Name          ( const char * file );
+static BOOL         Snap            ( UINT k );
+static BOOL         Copy            ( const char * from, const char * to );
+static BOOL         Exists          ( const char * file );
+static int          Series          ( WCHAR folder, const __int64 * want,
+                                        UINT n );
+static int          Remove          ( const char * path,
+                                        const struct stat * st, int flag,
+                                        struct FTW * ftw );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: main
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+int main ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static const __int64 a3[] = { 150, 150, 100 };
+    static const __int64 c3[] = { 50, 300, 300 };
+    static const __int64 a4[] = { 400, 150, 150, 100 };
+    static const __int64 c4[] = { 60, 50, 300, 300 };
+    HISTORY h;
+    UINT    k;
+
+    strcpy ( gDir, "/tmp/history_XXXXXX" );
+
+    if ( mkdtemp ( gDir ) == NULL )
+    {
+        perror ( "mkdtemp" );
+        return 1;
+    }
+
+    for ( k = 0; k < SCANS; k++ )
+        CHECK ( Snap ( k ) );
+
+    // three adds, the first makes it
+    CHECK ( HistAdd ( Name ( "h" ), Name ( "s0" ), NULL ) );
+    CHECK ( HistAdd ( Name ( "h" ), Name ( "s1" ), NULL ) );
+    CHECK ( HistAdd ( Name ( "h" ), Name ( "s2" ), NULL ) );
+    CHECK ( !HistAdd ( Name ( "h" ), Name ( "s2" ), NULL ) );
+    CHECK ( Series ( L'a', a3, 3 ) && Series ( L'c', c3, 3 ) );
+
+    // a rebase on the reordered scan: a new base, the old one gone
+    CHECK ( Copy ( "h", "h.keep" ) && Copy ( "h.snap", "h.snap.keep" ) );
+    CHECK ( HistCompact ( Name ( "h" ), Name ( "s3" ), HIST_KEEP_DAYS ) );
+    CHECK ( Exists ( "h.1.snap" ) && !Exists ( "h.snap" ) );
+    CHECK ( Series ( L'a', a4, 4 ) && Series ( L'c', c4, 4 ) );
+
+    // cut short between the renames: the new base is there, the history
+    // and its base are the old ones, and read as such
+    CHECK ( Copy ( "h.keep", "h" ) && Copy ( "h.snap.keep", "h.snap" ) );
+    CHECK ( Series ( L'a', a3, 3 ) && Series ( L'c', c3, 3 ) );
+
+    // the new base under the old one's name is not taken for it
+    CHECK ( Copy ( "h.1.snap", "h.snap" ) );
+    CHECK ( !HistOpen ( &h, Name ( "h" ) ) );
+    CHECK ( !HistAdd ( Name ( "h" ), Name ( "s3" ), NULL ) );
+    CHECK ( Copy ( "h.snap.keep", "h.snap" ) );
+
+    // and the history goes on from where it was
+    CHECK ( HistAdd ( Name ( "h" ), Name ( "s3" ), NULL ) );
+    CHECK ( Series ( L'a', a4, 4 ) && Series ( L'c', c4, 4 ) );
+    CHECK ( HistCompact ( Name ( "h" ), Name ( "s3" ), HIST_KEEP_DAYS ) );
+    CHECK ( Exists ( "h.1.snap" ) && !Exists ( "h.snap" ) );
+    CHECK ( Series ( L'a', a4, 4 ) && Series ( L'c', c4, 4 ) );
+
+    CHECK ( HistAdd ( Name ( "h" ), Name ( "s4" ), NULL ) );
+    CHECK ( HistCompact ( Name ( "h" ), Name ( "s4" ), HIST_KEEP_DAYS ) );
+    CHECK ( Exists ( "h.2.snap" ) && !Exists ( "h.1.snap" ) );
+
+    nftw ( gDir, Remove, 16, FTW_DEPTH | FTW_PHYS );
+
+    printf ( "history: %s\n", gFailed ? "FAILED" : "ok" );
+
+    return gFailed ? 1 : 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Series
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: WCHAR folder         : a, b or c
+//    Param.    2: const __int64 * want : its sizes, newest first
+//    Param.    3: UINT n               : how many
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the history reads those, at the scans' times
+/*--------------------------------------------------------------------@@-@@-*/
+static int Series ( WCHAR folder, const __int64 * want, UINT n )
+/*--------------------------------------------------------------------------*/
+{
+    HISTORY     h;
+    HIST_POINT  pts[SCANS + 1];
+    WCHAR       path[8];
+    UINT        got, i;
+    int         ok;
+
+    if ( !HistOpen ( &h, Name ( "h" ) ) )
+        return 0;
+
+    wcscpy ( path, L"C:\\r\\a" );
+    path[5] = folder;
+
+    got = HistSeries ( &h, path, 0, pts, SCANS + 1 );
+    ok  = ( got == n );
+
+    for ( i = 0; ok && i < n; i++ )
+        ok = ( pts[i].size == want[i] &&
+            pts[i].when == DAY0 + ( n - 1 - i ) * HIST_DAY );
+
+    HistClose ( &h );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Snap
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: UINT k : scan
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: s<k>, C:\r and its three subfolders, scanned on day k
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL Snap ( UINT k )
+/*--------------------------------------------------------------------------*/
+{
+    ENGINE      eng;
+    PATH_INDEX  pi;
+    char        file[8];
+    UINT        i, node;
+    BOOL        ok;
+
+    if ( !EngineInit ( &eng, 1, 0, 0 ) )
+        return FALSE;
+
+    ok = ( EngineAddNode ( &eng, ENG_NONE, L"C:\\r", 4 ) == 0 );
+
+    for ( i = 0; ok && i < 3; i++ )
+    {
+        node    = EngineAddNode ( &eng, 0, gScans[k].order + i, 1 );
+        ok      = ( node != ENG_NONE );
+
+        if ( ok )
+        {
+            eng.size[node] = gScans[k].size[gScans[k].order[i] - L'a'];
+            eng.size[0]    += eng.size[node];
+        }
+    }
+
+    snprintf ( file, sizeof ( file ), "s%u", k );
+
+    ok = ok && PathIdxBuild ( &pi, &eng );
+
+    if ( ok )
+    {
+        ok = SnapSave ( &eng, &pi, DAY0 + k * HIST_DAY, Name ( file ) );
+        PathIdxFree ( &pi );
+    }
+
+    EngineFree ( &eng );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Name
+/*--------------------------------------------------------------------------*/
+//           Type: static const WCHAR *
+//    Param.    1: const char * file : name in the test's folder
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: its full path, wide, good until the next call but one
+/*--------------------------------------------------------------------@@-@@-*/
+static const WCHAR * Name ( const char * file )
+/*--------------------------------------------------------------------------*/
+{
+    static WCHAR    buf[2][128];
+    static int      n;
+    char            tmp[128];
+
+    n = !n;
+    snprintf ( tmp, sizeof ( tmp ), "%s/%s", gDir, file );
+    mbstowcs ( buf[n], tmp, 128 );
+
+    return buf[n];
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Copy
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: const char * from : file in the test's folder
+//    Param.    2: const char * to   : and its copy, overwritten
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL Copy ( const char * from, const char * to )
+/*--------------------------------------------------------------------------*/
+{
+    return CopyFileW ( Name ( from ), Name ( to ), FALSE );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Exists
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: const char * file : file in the test's folder
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL Exists ( const char * file )
+/*--------------------------------------------------------------------------*/
+{
+    return GetFileAttributesW ( Name ( file ) ) != INVALID_FILE_ATTRIBUTES;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Remove
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const char * path      : entry
+//    Param.    2: const struct stat * st : unused
+//    Param.    3: int flag               : unused
+//    Param.    4: struct FTW * ftw       : unused
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the test's folder goes, children first
+/*--------------------------------------------------------------------@@-@@-*/
+static int Remove ( const char * path, const struct stat * st, int flag,
+    struct FTW * ftw )
+/*--------------------------------------------------------------------------*/
+{
+    (void)st; (void)flag; (void)ftw;
+
+    return remove ( path );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Check
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: int ok           : passed
+//    Param.    2: const char * what: the check, as written
+//    Param.    3: int line         : where
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void Check ( int ok, const char * what, int line )
+/*--------------------------------------------------------------------------*/
+{
+    if ( ok )
+        return;
+
+    if ( gFailed++ < 20 )
+        fprintf ( stderr, "history_test.c:%d: %s\n", line, what );
+}
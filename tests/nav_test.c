@@ -0,0 +1,430 @@
+
+// nav_test.c - engine/nav.c over a tree built by hand with EngineAddNode,
+// no walk and no window. Exits with 1 if any check fails.
+
+#include "../engine/engine.h"
+#include "../engine/nav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+#define TIES            1000    // same size subfolders, for the order
+
+static ENGINE       gEng;
+static int          gFailed;
+
+#define CHECK(c)    Check ( (c), #c, __LINE__ )
+
+static void         Check           ( int ok, const char * what, int line );
+static UINT         Add             ( UINT parent, const WCHAR * name,
+                                        __int64 size );
+static int          Rows            ( const NAV * nav, const UINT * nodes,
+                                        const USHORT * levels, UINT n );
+static UINT         RowOf           ( const NAV * nav, UINT node );
+static void         TestRoots       ( void );
+static void         TestExpand      ( void );
+static void         TestHistory     ( void );
+static void         TestShare       ( void );
+static void         TestTies        ( void );
+
+// the tree, sizes in brackets; a and c tie, so do the roots
+//
+//  C:\r [1000]                     D:\s [1000]
+//    a [300]  b [500]  c [300]  d    e [1000]
+//    h [300]  f [200]  g [300]
+//    i [100]
+enum { R, S, A, B, C, D, E, F, G, H, I };
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: main
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: children go in together, right after each other, the
+//                 way the engine keeps them
+/*--------------------------------------------------------------------@@-@@-*/
+int main ( void )
+/*--------------------------------------------------------------------------*/
+{
+    if ( !EngineInit ( &gEng, 1, 0, 0 ) )
+    {
+        fprintf ( stderr, "EngineInit failed\n" );
+        return 1;
+    }
+
+    CHECK ( Add ( ENG_NONE, L"C:\\r", 1000 ) == R );
+    CHECK ( Add ( ENG_NONE, L"D:\\s", 1000 ) == S );
+    CHECK ( Add ( R, L"a", 300 ) == A );
+    CHECK ( Add ( R, L"b", 500 ) == B );
+    CHECK ( Add ( R, L"c", 300 ) == C );
+    CHECK ( Add ( R, L"d", 0 ) == D );
+    CHECK ( Add ( S, L"e", 1000 ) == E );
+    CHECK ( Add ( B, L"f", 200 ) == F );
+    CHECK ( Add ( B, L"g", 300 ) == G );
+    CHECK ( Add ( A, L"h", 300 ) == H );
+    CHECK ( Add ( H, L"i", 100 ) == I );
+
+    TestRoots();
+    TestExpand();
+    TestHistory();
+    TestShare();
+    TestTies();
+
+    EngineFree ( &gEng );
+
+    printf ( "nav: %s\n", gFailed ? "FAILED" : "ok" );
+
+    return gFailed ? 1 : 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestRoots
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the roots, tied, in the order they were added
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestRoots ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static const UINT   nodes[]     = { R, S };
+    static const USHORT levels[]    = { 0, 0 };
+    NAV                 nav;
+
+    NavInit ( &nav, &gEng );
+
+    CHECK ( nav.count == 0 && nav.top == ENG_NONE );
+    CHECK ( NavGo ( &nav, ENG_NONE ) );
+    CHECK ( Rows ( &nav, nodes, levels, 2 ) );
+    CHECK ( !NavGo ( &nav, gEng.count ) );
+    CHECK ( Rows ( &nav, nodes, levels, 2 ) );
+
+    NavFree ( &nav );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestExpand
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: opening puts the subfolders under the row, biggest
+//                 first, ties as added; closing takes away everything
+//                 under it, and opening again starts closed
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestExpand ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static const UINT   n1[] = { R, B, A, C, D, S };
+    static const USHORT l1[] = { 0, 1, 1, 1, 1, 0 };
+    static const UINT   n2[] = { R, B, G, F, A, H, I, C, D, S };
+    static const USHORT l2[] = { 0, 1, 2, 2, 1, 2, 3, 1, 1, 0 };
+    static const UINT   n3[] = { R, B, A, C, D, S, E };
+    static const USHORT l3[] = { 0, 1, 1, 1, 1, 0, 1 };
+    NAV                 nav;
+
+    NavInit ( &nav, &gEng );
+    NavGo ( &nav, ENG_NONE );
+
+    CHECK ( NavExpand ( &nav, 0 ) );
+    CHECK ( Rows ( &nav, n1, l1, 6 ) );
+    CHECK ( nav.rows[0].open && !nav.rows[1].open );
+    CHECK ( !NavExpand ( &nav, 0 ) );           // open already
+    CHECK ( !NavExpand ( &nav, 4 ) );           // d has none
+    CHECK ( !nav.rows[4].open );
+    CHECK ( !NavExpand ( &nav, nav.count ) );
+
+    CHECK ( NavExpand ( &nav, RowOf ( &nav, B ) ) );
+    CHECK ( NavExpand ( &nav, RowOf ( &nav, A ) ) );
+    CHECK ( NavExpand ( &nav, RowOf ( &nav, H ) ) );
+    CHECK ( Rows ( &nav, n2, l2, 10 ) );
+
+    CHECK ( NavParentRow ( &nav, RowOf ( &nav, I ) ) == RowOf ( &nav, H ) );
+    CHECK ( NavParentRow ( &nav, RowOf ( &nav, F ) ) == RowOf ( &nav, B ) );
+    CHECK ( NavParentRow ( &nav, RowOf ( &nav, C ) ) == 0 );
+    CHECK ( NavParentRow ( &nav, RowOf ( &nav, S ) ) == ENG_NONE );
+
+    // a, with h open under it, goes in one piece
+    CHECK ( NavCollapse ( &nav, RowOf ( &nav, A ) ) );
+    CHECK ( RowOf ( &nav, H ) == ENG_NONE && RowOf ( &nav, I ) == ENG_NONE );
+    CHECK ( !NavCollapse ( &nav, RowOf ( &nav, A ) ) );
+    CHECK ( NavExpand ( &nav, RowOf ( &nav, A ) ) );
+    CHECK ( !nav.rows[RowOf ( &nav, H )].open );
+
+    CHECK ( NavCollapse ( &nav, 0 ) );
+    CHECK ( nav.count == 2 && !nav.rows[0].open );
+    CHECK ( NavExpand ( &nav, 0 ) );
+    CHECK ( NavExpand ( &nav, 5 ) );
+    CHECK ( Rows ( &nav, n3, l3, 7 ) );
+
+    // a spilled folder has nothing under it in memory
+    gEng.flags[B] |= ENG_SPILLED;
+    CHECK ( !NavExpand ( &nav, RowOf ( &nav, B ) ) );
+    gEng.flags[B] &= ~ENG_SPILLED;
+
+    NavFree ( &nav );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestHistory
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: going to folders, back, forward and up, like a browser
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestHistory ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static const UINT   nb[] = { G, F };
+    static const USHORT l0[] = { 0, 0, 0, 0 };
+    NAV                 nav;
+    UINT                i;
+
+    NavInit ( &nav, &gEng );
+
+    CHECK ( !NavBack ( &nav ) && !NavUp ( &nav ) );
+    CHECK ( NavGo ( &nav, ENG_NONE ) );
+    CHECK ( NavGo ( &nav, B ) );
+    CHECK ( nav.top == B && Rows ( &nav, nb, l0, 2 ) );
+
+    CHECK ( NavBack ( &nav ) && nav.top == ENG_NONE && nav.count == 2 );
+    CHECK ( !NavBack ( &nav ) );
+    CHECK ( NavForward ( &nav ) && nav.top == B );
+    CHECK ( !NavForward ( &nav ) );
+
+    // up goes on the history too
+    CHECK ( NavUp ( &nav ) && nav.top == R && nav.count == 4 );
+    CHECK ( NavUp ( &nav ) && nav.top == ENG_NONE );
+    CHECK ( !NavUp ( &nav ) );
+    CHECK ( NavBack ( &nav ) && nav.top == R );
+    CHECK ( NavBack ( &nav ) && nav.top == B );
+
+    // going somewhere from the middle drops what was forward
+    CHECK ( NavGo ( &nav, S ) && nav.top == S );
+    CHECK ( !NavForward ( &nav ) );
+    CHECK ( NavBack ( &nav ) && nav.top == B );
+
+    // the same folder again isn't another step
+    i = nav.nhist;
+    CHECK ( NavGo ( &nav, B ) && nav.nhist == i );
+
+    // a full history drops the oldest
+    for ( i = 0; i < NAV_MAX_HISTORY * 2; i++ )
+        CHECK ( NavGo ( &nav, ( i & 1 ) ? A : H ) );
+
+    CHECK ( nav.nhist == NAV_MAX_HISTORY );
+    CHECK ( nav.hpos == NAV_MAX_HISTORY - 1 );
+
+    for ( i = 0; i < NAV_MAX_HISTORY - 1; i++ )
+        CHECK ( NavBack ( &nav ) );
+
+    CHECK ( !NavBack ( &nav ) && nav.top == H );
+
+    NavFree ( &nav );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestShare
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: hundredths of a percent of the parent, roots of all
+//                 the roots
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestShare ( void )
+/*--------------------------------------------------------------------------*/
+{
+    CHECK ( NavShare ( &gEng, B ) == 5000 );
+    CHECK ( NavShare ( &gEng, A ) == 3000 );
+    CHECK ( NavShare ( &gEng, D ) == 0 );
+    CHECK ( NavShare ( &gEng, I ) == 3333 );
+    CHECK ( NavShare ( &gEng, R ) == 5000 );
+    CHECK ( NavShare ( &gEng, gEng.count ) == 0 );
+    CHECK ( NavShare ( NULL, R ) == 0 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestTies
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: a thousand subfolders of a few sizes, under d. qsort isn't
+//                 stable, so it's the node order that keeps ties where
+//                 they were: the same rows every time it's opened, and
+//                 a selected folder found on the same row after closing
+//                 and opening its parent.
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestTies ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static UINT     first[TIES];
+    NAV             nav;
+    WCHAR           name[16];
+    UINT            top, i, sel, at;
+    __int64         total;
+
+    // d had none, these are all its
+    top = Add ( D, L"t", 0 );
+
+    for ( i = 0, total = 0; i < TIES; i++ )
+    {
+        swprintf ( name, 16, L"x%u", ( i * 7919 ) % TIES );
+        total += ( i * 37 ) % 5;
+        CHECK ( Add ( top, name, ( i * 37 ) % 5 ) == top + 1 + i );
+    }
+
+    gEng.size[top] = total;
+
+    NavInit ( &nav, &gEng );
+    CHECK ( NavGo ( &nav, top ) && nav.count == TIES );
+
+    for ( i = 1; i < nav.count; i++ )
+        CHECK ( gEng.size[nav.rows[i-1].node] >
+            gEng.size[nav.rows[i].node] ||
+            ( gEng.size[nav.rows[i-1].node] ==
+                gEng.size[nav.rows[i].node] &&
+                nav.rows[i-1].node < nav.rows[i].node ) );
+
+    for ( i = 0; i < TIES; i++ )
+        first[i] = nav.rows[i].node;
+
+    sel = first[TIES/2];
+    at  = TIES / 2;
+
+    CHECK ( NavGo ( &nav, D ) && nav.count == 1 );
+    CHECK ( NavExpand ( &nav, 0 ) );
+
+    for ( i = 0; i < 20; i++ )
+    {
+        CHECK ( NavCollapse ( &nav, RowOf ( &nav, top ) ) );
+        CHECK ( NavExpand ( &nav, RowOf ( &nav, top ) ) );
+        CHECK ( RowOf ( &nav, sel ) == RowOf ( &nav, top ) + 1 + at );
+    }
+
+    CHECK ( NavGo ( &nav, top ) );
+
+    for ( i = 0; i < TIES; i++ )
+        CHECK ( nav.rows[i].node == first[i] );
+
+    NavFree ( &nav );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Check
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: int ok             : what came out
+//    Param.    2: const char * what  : the check, as written
+//    Param.    3: int line           : where
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void Check ( int ok, const char * what, int line )
+/*--------------------------------------------------------------------------*/
+{
+    if ( ok )
+        return;
+
+    if ( gFailed++ < 20 )
+        fprintf ( stderr, "nav_test.c:%d: %s\n", line, what );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Add
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: UINT parent        : ENG_NONE for a root
+//    Param.    2: const WCHAR * name : its name
+//    Param.    3: __int64 size       : bytes below
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: a folder, the walk done with it
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT Add ( UINT parent, const WCHAR * name, __int64 size )
+/*--------------------------------------------------------------------------*/
+{
+    UINT node;
+
+    node = EngineAddNode ( &gEng, parent, name, (UINT)wcslen ( name ) );
+
+    if ( node != ENG_NONE )
+    {
+        gEng.size[node]     = size;
+        gEng.flags[node]    |= ENG_FINAL;
+    }
+
+    return node;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Rows
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const NAV * nav       : navigation
+//    Param.    2: const UINT * nodes    : the rows there should be
+//    Param.    3: const USHORT * levels : and their levels
+//    Param.    4: UINT n                : how many
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static int Rows ( const NAV * nav, const UINT * nodes,
+    const USHORT * levels, UINT n )
+/*--------------------------------------------------------------------------*/
+{
+    UINT i;
+
+    if ( nav->count != n )
+        return 0;
+
+    for ( i = 0; i < n; i++ )
+        if ( nav->rows[i].node != nodes[i] ||
+                nav->rows[i].level != levels[i] )
+            return 0;
+
+    return 1;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: RowOf
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: const NAV * nav : navigation
+//    Param.    2: UINT node       : folder
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the row showing node, ENG_NONE if none does
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT RowOf ( const NAV * nav, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    UINT i;
+
+    for ( i = 0; i < nav->count; i++ )
+        if ( nav->rows[i].node == node )
+            return i;
+
+    return ENG_NONE;
+}
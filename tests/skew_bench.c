@@ -0,0 +1,355 @@
+
+// skew_bench.c - eng->longest on a lopsided tree: lots of small folders
+// and one deep subtree, the last one enumerated, walked newest first as
+// usual and then heaviest first going by a snapshot of the first walk.
+// Every folder open is made to take LATENCY_US, about what a cold disk
+// costs, so the times are the schedule's and not the file system's.
+
+#include "../engine/engine.h"
+#include "../engine/pathidx.h"
+#include "../engine/snap.h"
+#include "../engine/weigh.h"
+#include <ftw.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define THREADS         8
+#define SMALL           120     // small folders under the root...
+#define SMALL_SUB       6       // ...each with this many empty ones
+#define CHAIN           120     // the deep one, this many levels...
+#define CHAIN_SIDE      2       // ...each with this many empty ones
+#define LATENCY_US      1000
+#define ROUNDS          5
+
+static char         gRoot[64];
+static WCHAR        gRootW[64];
+static WEIGHER      gWeigh;
+static double       gStart, gReached;
+
+static void         Build           ( void );
+static void         Mkdir           ( const char * path );
+static int          Remove          ( const char * path,
+                                        const struct stat * st, int flag,
+                                        struct FTW * ftw );
+static double       Now             ( void );
+static BOOL         Walk            ( BOOL longest, const SNAPSHOT * prev,
+                                        const WCHAR * save, double * took,
+                                        double * idle, double * reached );
+static void         OnEnter         ( void * ctx, UINT worker, UINT node );
+static UINT         OnWeigh         ( void * ctx, UINT worker, UINT node,
+                                        const WCHAR * name );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: main
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+int main ( void )
+/*--------------------------------------------------------------------------*/
+{
+    SNAPSHOT    snap;
+    WCHAR       save[80];
+    double      took[2], idle[2], reached[2], best[2][3];
+    UINT        folders;
+    int         i, k;
+
+    Build();
+
+    folders = 1 + SMALL * ( 1 + SMALL_SUB ) + CHAIN * ( 1 + CHAIN_SIDE );
+    swprintf ( save, ARRAYSIZE ( save ), L"%ls.snap", gRootW );
+
+    printf ( "%u folders, a %d deep one last, %d workers, %d us a folder,"
+        " best of %d\n", folders, CHAIN, THREADS, LATENCY_US, ROUNDS );
+    printf ( "at best %.1f ms for the work, %.1f ms for the deep one\n",
+        folders * LATENCY_US / 1e3 / THREADS, CHAIN * LATENCY_US / 1e3 );
+
+    // the first walk leaves the snapshot the heaviest first ones go by
+    memset ( &snap, 0, sizeof ( snap ) );
+
+    if ( !Walk ( FALSE, NULL, save, &took[0], &idle[0], &reached[0] ) ||
+            !SnapOpen ( &snap, save ) )
+    {
+        printf ( "walk or snapshot failed\n" );
+        nftw ( gRoot, Remove, 16, FTW_DEPTH | FTW_PHYS );
+        return 1;
+    }
+
+    for ( k = 0; k < 2; k++ )
+        best[k][0] = 1e30;
+
+    for ( i = 0; i < ROUNDS; i++ )
+        for ( k = 0; k < 2; k++ )
+        {
+            if ( !Walk ( k != 0, &snap, NULL, &took[k], &idle[k],
+                    &reached[k] ) )
+            {
+                printf ( "walk failed\n" );
+                break;
+            }
+
+            if ( took[k] < best[k][0] )
+            {
+                best[k][0] = took[k];
+                best[k][1] = idle[k];
+                best[k][2] = reached[k];
+            }
+        }
+
+    for ( k = 0; k < 2; k++ )
+        printf ( "%-16s %8.1f ms  %8.1f ms idle  deep one at %6.1f ms\n",
+            k ? "heaviest first" : "newest first", best[k][0] * 1e3,
+            best[k][1] * 1e3, best[k][2] * 1e3 );
+
+    SnapClose ( &snap );
+    DeleteFileW ( save );
+    nftw ( gRoot, Remove, 16, FTW_DEPTH | FTW_PHYS );
+
+    return 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Walk
+/*--------------------------------------------------------------------------*/
+//           Type: static BOOL
+//    Param.    1: BOOL longest          : heaviest first
+//    Param.    2: const SNAPSHOT * prev : what to weigh by, with longest
+//    Param.    3: const WCHAR * save    : snapshot to write after, or NULL
+//    Param.    4: double * took         : receives the walk's time...
+//    Param.    5: double * idle         : ...the workers' time waiting,
+//                                         all added up...
+//    Param.    6: double * reached      : ...and when the deep one was
+//                                         opened, all in seconds
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static BOOL Walk ( BOOL longest, const SNAPSHOT * prev, const WCHAR * save,
+    double * took, double * idle, double * reached )
+/*--------------------------------------------------------------------------*/
+{
+    ENGINE      eng;
+    PATH_INDEX  pi;
+    BOOL        ok;
+
+    if ( !EngineInit ( &eng, THREADS, 0, 0 ) )
+        return FALSE;
+
+    if ( EngineAddRoot ( &eng, gRootW ) < 0 )
+    {
+        EngineFree ( &eng );
+        return FALSE;
+    }
+
+    eng.hooks.ctx       = &eng;
+    eng.hooks.on_enter  = OnEnter;
+
+    if ( longest )
+    {
+        WeighInit ( &gWeigh, prev );
+        eng.longest         = TRUE;
+        eng.hooks.on_weigh  = OnWeigh;
+    }
+
+    gReached    = 0;
+    gStart      = Now();
+    ok          = EngineRun ( &eng );
+    *took       = Now() - gStart;
+    *idle       = eng.idle / 1e9;   // compat's counter runs in ns
+    *reached    = gReached - gStart;
+
+    if ( ok && save != NULL )
+    {
+        ok = PathIdxBuild ( &pi, &eng );
+
+        if ( ok )
+        {
+            ok = SnapSave ( &eng, &pi, 0, save );
+            PathIdxFree ( &pi );
+        }
+    }
+
+    EngineFree ( &eng );
+
+    return ok;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnEnter
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void * ctx  : the engine
+//    Param.    2: UINT worker : worker opening it
+//    Param.    3: UINT node   : folder about to be opened
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the disk's latency, and the time the deep one was got to
+/*--------------------------------------------------------------------@@-@@-*/
+static void OnEnter ( void * ctx, UINT worker, UINT node )
+/*--------------------------------------------------------------------------*/
+{
+    const ENGINE * eng = ctx;
+
+    (void)worker;
+
+    if ( eng->depth[node] == 1 && eng->nlen[node] == 2 &&
+            wcsncmp ( eng->names + eng->name[node], L"zz", 2 ) == 0 )
+        gReached = Now();
+
+    usleep ( LATENCY_US );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: OnWeigh
+/*--------------------------------------------------------------------------*/
+//           Type: static UINT
+//    Param.    1: void * ctx         : the engine
+//    Param.    2: UINT worker        : worker asking
+//    Param.    3: UINT node          : folder being enumerated
+//    Param.    4: const WCHAR * name : subfolder found in it
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: as the console has it
+/*--------------------------------------------------------------------@@-@@-*/
+static UINT OnWeigh ( void * ctx, UINT worker, UINT node,
+    const WCHAR * name )
+/*--------------------------------------------------------------------------*/
+{
+    return WeighFolder ( &gWeigh, ctx, worker, node, name );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Build
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the tree, in a new temporary folder. The small ones are
+//                 a000..., the deep one zz, so it sorts last and a walk
+//                 newest first gets to it after all the rest.
+/*--------------------------------------------------------------------@@-@@-*/
+static void Build ( void )
+/*--------------------------------------------------------------------------*/
+{
+    char    path[PATH_MAX];
+    size_t  len;
+    int     i, j;
+
+    strcpy ( gRoot, "/tmp/skew_XXXXXX" );
+
+    if ( mkdtemp ( gRoot ) == NULL )
+    {
+        perror ( "mkdtemp" );
+        exit ( 1 );
+    }
+
+    mbstowcs ( gRootW, gRoot, ARRAYSIZE ( gRootW ) );
+
+    for ( i = 0; i < SMALL; i++ )
+    {
+        snprintf ( path, sizeof ( path ), "%s/a%03d", gRoot, i );
+        Mkdir ( path );
+        len = strlen ( path );
+
+        for ( j = 0; j < SMALL_SUB; j++ )
+        {
+            snprintf ( path + len, sizeof ( path ) - len, "/%d", j );
+            Mkdir ( path );
+        }
+    }
+
+    len = (size_t)snprintf ( path, sizeof ( path ), "%s/zz", gRoot );
+
+    for ( i = 0; i < CHAIN; i++ )
+    {
+        if ( i > 0 )
+            len += (size_t)snprintf ( path + len, sizeof ( path ) - len,
+                        "/d" );
+
+        Mkdir ( path );
+
+        for ( j = 0; j < CHAIN_SIDE; j++ )
+        {
+            snprintf ( path + len, sizeof ( path ) - len, "/%d", j );
+            Mkdir ( path );
+        }
+
+        path[len] = '\0';
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Mkdir
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const char * path : folder to make
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void Mkdir ( const char * path )
+/*--------------------------------------------------------------------------*/
+{
+    if ( mkdir ( path, 0755 ) != 0 )
+    {
+        perror ( path );
+        exit ( 1 );
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Remove
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const char * path      : entry
+//    Param.    2: const struct stat * st : unused
+//    Param.    3: int flag               : unused
+//    Param.    4: struct FTW * ftw       : unused
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the tree goes, children first
+/*--------------------------------------------------------------------@@-@@-*/
+static int Remove ( const char * path, const struct stat * st, int flag,
+    struct FTW * ftw )
+/*--------------------------------------------------------------------------*/
+{
+    (void)st; (void)flag; (void)ftw;
+
+    return remove ( path );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Now
+/*--------------------------------------------------------------------------*/
+//           Type: static double
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: seconds, monotonic
+/*--------------------------------------------------------------------@@-@@-*/
+static double Now ( void )
+/*--------------------------------------------------------------------------*/
+{
+    struct timespec ts;
+
+    clock_gettime ( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
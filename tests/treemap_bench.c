@@ -0,0 +1,207 @@
+
+// treemap_bench.c - how long engine/treemap.c takes to lay out a big
+// random tree at a full screen size, from the root and zoomed in.
+
+#include "../engine/treemap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FOLDERS         2000000
+#define FANOUT          12
+#define ROUNDS          50
+
+static int64_t      * gSize, * gOwn;
+static uint32_t     * gFirst, * gNchild, * gParent;
+static uint32_t     gCount;
+static uint32_t     gSeed = 12345;
+
+static uint32_t     Rand            ( uint32_t n );
+static void         Build           ( void );
+static double       Now             ( void );
+static void         Run             ( TREEMAP * tm, uint32_t top,
+                                        const char * what );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: main
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+int main ( void )
+/*--------------------------------------------------------------------------*/
+{
+    TREEMAP     tm;
+    TM_TREE     tree;
+    uint32_t    top, i, c, end;
+
+    Build();
+
+    tree.size   = gSize;
+    tree.own    = gOwn;
+    tree.first  = gFirst;
+    tree.nchild = gNchild;
+    tree.count  = gCount;
+
+    TreemapInit ( &tm, &tree );
+    tm.head = 14.0f;
+
+    printf ( "%u folders, 1600 x 1000, %d layouts each\n", gCount,
+        ROUNDS );
+
+    Run ( &tm, 0, "root" );
+
+    // the biggest subfolder of the biggest subfolder, two zooms in
+    for ( top = 0, i = 0; i < 2 && gNchild[top] != 0; i++ )
+    {
+        c   = gFirst[top];
+        end = c + gNchild[top];
+
+        for ( top = c; c < end; c++ )
+            if ( gSize[c] > gSize[top] )
+                top = c;
+    }
+
+    Run ( &tm, top, "zoomed" );
+
+    tm.min_side = 1.0f;
+    Run ( &tm, 0, "min_side 1" );
+
+    TreemapFree ( &tm );
+
+    return 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Run
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: TREEMAP * tm       : set up
+//    Param.    2: uint32_t top       : folder to fill the viewport
+//    Param.    3: const char * what  : label
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void Run ( TREEMAP * tm, uint32_t top, const char * what )
+/*--------------------------------------------------------------------------*/
+{
+    double  t0, best, t;
+    int     i;
+
+    for ( i = 0, best = 1e30; i < ROUNDS; i++ )
+    {
+        t0 = Now();
+
+        if ( !TreemapLayout ( tm, top, 0.0f, 0.0f, 1600.0f, 1000.0f ) )
+        {
+            printf ( "%-12s layout failed\n", what );
+            return;
+        }
+
+        t = Now() - t0;
+        best = ( t < best ) ? t : best;
+    }
+
+    printf ( "%-12s %8u rects  %8.3f ms\n", what, tm->count, best * 1e3 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Build
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: folders level by level like a walk numbers them, with
+//                 sizes spread over a few orders of magnitude
+/*--------------------------------------------------------------------@@-@@-*/
+static void Build ( void )
+/*--------------------------------------------------------------------------*/
+{
+    uint32_t i, n;
+
+    gSize   = calloc ( FOLDERS, sizeof ( int64_t ) );
+    gOwn    = calloc ( FOLDERS, sizeof ( int64_t ) );
+    gFirst  = calloc ( FOLDERS, sizeof ( uint32_t ) );
+    gNchild = calloc ( FOLDERS, sizeof ( uint32_t ) );
+    gParent = calloc ( FOLDERS, sizeof ( uint32_t ) );
+
+    if ( !gSize || !gOwn || !gFirst || !gNchild || !gParent )
+    {
+        fprintf ( stderr, "out of memory\n" );
+        exit ( 1 );
+    }
+
+    for ( i = 0, gCount = 1; i < gCount && gCount < FOLDERS; i++ )
+    {
+        n = Rand ( FANOUT * 2 + 1 );
+
+        // don't let the tree end early
+        if ( n == 0 && i + 1 == gCount )
+            n = 1;
+
+        if ( n > FOLDERS - gCount )
+            n = FOLDERS - gCount;
+
+        gFirst[i]   = gCount;
+        gNchild[i]  = n;
+
+        while ( n-- )
+            gParent[gCount++] = i;
+    }
+
+    for ( i = 0; i < gCount; i++ )
+    {
+        gOwn[i]     = (int64_t)Rand ( 1u << 20 ) << Rand ( 12 );
+        gSize[i]    = gOwn[i];
+    }
+
+    for ( i = gCount; --i > 0; )
+        gSize[gParent[i]] += gSize[i];
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Rand
+/*--------------------------------------------------------------------------*/
+//           Type: static uint32_t
+//    Param.    1: uint32_t n : bound
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: 0 to n - 1, the same tree on every run
+/*--------------------------------------------------------------------@@-@@-*/
+static uint32_t Rand ( uint32_t n )
+/*--------------------------------------------------------------------------*/
+{
+    gSeed = gSeed * 1664525u + 1013904223u;
+
+    return (uint32_t)( ( (uint64_t)( gSeed >> 8 ) * n ) >> 24 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Now
+/*--------------------------------------------------------------------------*/
+//           Type: static double
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: seconds, from a monotonic clock
+/*--------------------------------------------------------------------@@-@@-*/
+static double Now ( void )
+/*--------------------------------------------------------------------------*/
+{
+    struct timespec ts;
+
+    clock_gettime ( CLOCK_MONOTONIC, &ts );
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
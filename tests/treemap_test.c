@@ -0,0 +1,582 @@
+
+// treemap_test.c - engine/treemap.c on hand made and random trees, no
+// Windows needed. Exits with 1 if any check fails.
+
+#include "../engine/treemap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define EPS             0.01    // pixels, floats added up many times
+#define MAX_NODES       20000
+
+// a tree the way the engine keeps one, subfolders next to each other
+typedef struct _test_tree
+{
+    int64_t     size[MAX_NODES];
+    int64_t     own[MAX_NODES];
+    uint32_t    first[MAX_NODES];
+    uint32_t    nchild[MAX_NODES];
+    uint32_t    parent[MAX_NODES];
+    uint32_t    count;
+} TEST_TREE;
+
+static TEST_TREE    gT;
+static int          gFailed;
+static uint32_t     gSeed = 12345;
+
+#define CHECK(c)    Check ( (c), #c, __LINE__ )
+
+static void         Check           ( int ok, const char * what, int line );
+static uint32_t     Rand            ( uint32_t n );
+static void         TreeFlat        ( const int64_t * sizes, uint32_t n,
+                                        int64_t own );
+static void         TreeRandom      ( uint32_t count, uint32_t fanout );
+static void         TreeView        ( TM_TREE * view );
+static int          Inside          ( const TM_RECT * in,
+                                        const TM_RECT * out, float pad );
+static int          Overlap         ( const TM_RECT * a, const TM_RECT * b );
+static void         TestSquarified  ( void );
+static void         TestLeaf        ( void );
+static void         TestNesting     ( void );
+static void         TestRest        ( void );
+static void         TestLimits      ( void );
+static void         TestHit         ( void );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: main
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+int main ( void )
+/*--------------------------------------------------------------------------*/
+{
+    TestSquarified();
+    TestLeaf();
+    TestNesting();
+    TestRest();
+    TestLimits();
+    TestHit();
+
+    printf ( "treemap: %s\n", gFailed ? "FAILED" : "ok" );
+
+    return gFailed ? 1 : 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestSquarified
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the paper's own example, 6 6 4 3 2 2 1 in a 6 x 4 box:
+//                 areas as the sizes, the box covered, nothing on top
+//                 of anything and no box worse than 3:1
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestSquarified ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static const int64_t sizes[] = { 6, 6, 4, 3, 2, 2, 1 };
+    TREEMAP         tm;
+    TM_TREE         view;
+    const TM_RECT   * r;
+    double          area, ratio;
+    uint32_t        i, j;
+
+    TreeFlat ( sizes, 7, 0 );
+    TreeView ( &view );
+    TreemapInit ( &tm, &view );
+
+    tm.min_side = 0.0f;
+    tm.pad      = 0.0f;
+
+    CHECK ( TreemapLayout ( &tm, 0, 0.0f, 0.0f, 6.0f, 4.0f ) );
+    CHECK ( tm.count == 8 );
+    CHECK ( !tm.cut );
+
+    for ( i = 1, area = 0.0; i < tm.count; i++ )
+    {
+        r = &tm.rects[i];
+
+        CHECK ( r->kind == TM_FOLDER && r->depth == 1 );
+        CHECK ( fabs ( r->w * r->h - (double)gT.size[r->node] ) < EPS );
+        CHECK ( Inside ( r, &tm.rects[0], 0.0f ) );
+
+        ratio = ( r->w > r->h ) ? r->w / r->h : r->h / r->w;
+        CHECK ( ratio < 3.0 );
+
+        for ( j = i + 1; j < tm.count; j++ )
+            CHECK ( !Overlap ( r, &tm.rects[j] ) );
+
+        area += r->w * r->h;
+    }
+
+    CHECK ( fabs ( area - 24.0 ) < EPS );
+
+    // the two 6s first, as a strip along the short side
+    CHECK ( tm.rects[1].node + tm.rects[2].node == 3 );
+    CHECK ( fabs ( tm.rects[1].x ) < EPS && fabs ( tm.rects[2].x ) < EPS );
+
+    TreemapFree ( &tm );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestLeaf
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: a folder of files only is one box; its files get their
+//                 own inside it once it has subfolders, and empty
+//                 subfolders get none
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestLeaf ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static const int64_t sizes[] = { 30, 0, 10 };
+    TREEMAP         tm;
+    TM_TREE         view;
+    uint32_t        i, files;
+
+    TreeFlat ( sizes, 0, 100 );
+    TreeView ( &view );
+    TreemapInit ( &tm, &view );
+
+    CHECK ( TreemapLayout ( &tm, 0, 10.0f, 20.0f, 300.0f, 200.0f ) );
+    CHECK ( tm.count == 1 );
+    CHECK ( tm.rects[0].x == 10.0f && tm.rects[0].y == 20.0f &&
+        tm.rects[0].w == 300.0f && tm.rects[0].h == 200.0f );
+
+    TreeFlat ( sizes, 3, 60 );
+    TreeView ( &view );
+    tm.tree = view;
+
+    CHECK ( TreemapLayout ( &tm, 0, 0.0f, 0.0f, 300.0f, 200.0f ) );
+    CHECK ( tm.count == 4 );
+
+    for ( i = 1, files = 0; i < tm.count; i++ )
+    {
+        CHECK ( tm.rects[i].node != 2 );
+
+        if ( tm.rects[i].kind == TM_FILES )
+        {
+            CHECK ( tm.rects[i].node == 0 );
+            files++;
+        }
+    }
+
+    CHECK ( files == 1 );
+
+    TreemapFree ( &tm );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestNesting
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: random trees, laid out from the root and from deeper
+//                 down: each box inside its folder's, padding and label
+//                 strip kept, boxes of one folder apart from each other,
+//                 folders before what's in them
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestNesting ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static uint32_t at[MAX_NODES];  // a folder's rect, by node
+    TREEMAP         tm;
+    TM_TREE         view;
+    const TM_RECT   * r, * p;
+    uint32_t        round, i, j, top;
+
+    for ( round = 0; round < 20; round++ )
+    {
+        TreeRandom ( 2000 + Rand ( 8000 ), 2 + Rand ( 30 ) );
+        TreeView ( &view );
+        TreemapInit ( &tm, &view );
+
+        tm.head = ( round & 1 ) ? 12.0f : 0.0f;
+        top     = ( round < 10 ) ? 0 : Rand ( gT.count );
+
+        CHECK ( TreemapLayout ( &tm, top, 5.0f, 5.0f, 1600.0f, 1000.0f ) );
+        CHECK ( tm.count != 0 && tm.rects[0].node == top );
+
+        for ( i = 0; i < gT.count; i++ )
+            at[i] = (uint32_t)-1;
+
+        for ( i = 0; i < tm.count; i++ )
+        {
+            r = &tm.rects[i];
+
+            CHECK ( r->w >= 0.0f && r->h >= 0.0f );
+
+            if ( r->kind == TM_FOLDER )
+                at[r->node] = i;
+
+            if ( i == 0 )
+                continue;
+
+            // what it's in was laid out already, as a folder
+            j = ( r->kind == TM_FOLDER ) ? gT.parent[r->node] : r->node;
+            CHECK ( j < gT.count && at[j] < i );
+
+            if ( j >= gT.count || at[j] >= i )
+                continue;
+
+            p = &tm.rects[at[j]];
+
+            CHECK ( r->depth == p->depth + 1 );
+            CHECK ( Inside ( r, p, tm.pad ) );
+
+            if ( p->h >= tm.head * 3.0f )
+                CHECK ( r->y >= p->y + tm.pad + tm.head - EPS );
+        }
+
+        // the boxes right inside one folder, a few folders
+        for ( i = 0; i < tm.count && i < 3000; i++ )
+            for ( j = i + 1; j < tm.count && j < i + 64; j++ )
+                if ( tm.rects[i].depth == tm.rects[j].depth &&
+                        tm.rects[i].depth != 0 )
+                    CHECK ( !Overlap ( &tm.rects[i], &tm.rects[j] ) );
+
+        TreemapFree ( &tm );
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestRest
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: one big subfolder and thousands of tiny ones: the tiny
+//                 ones come out as a single TM_REST of their total
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestRest ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static int64_t  sizes[5001];
+    TREEMAP         tm;
+    TM_TREE         view;
+    const TM_RECT   * rest;
+    uint32_t        i;
+
+    sizes[0] = 100000000;
+
+    for ( i = 1; i < 5001; i++ )
+        sizes[i] = 1000;
+
+    TreeFlat ( sizes, 5001, 0 );
+    TreeView ( &view );
+    TreemapInit ( &tm, &view );
+
+    CHECK ( TreemapLayout ( &tm, 0, 0.0f, 0.0f, 400.0f, 300.0f ) );
+    CHECK ( tm.count == 3 );
+
+    rest = &tm.rects[2];
+
+    CHECK ( tm.rects[1].node == 1 && tm.rects[1].kind == TM_FOLDER );
+    CHECK ( rest->kind == TM_REST && rest->node == 0 );
+    CHECK ( fabs ( rest->w * rest->h / ( 396.0 * 296.0 ) -
+        5000000.0 / 105000000.0 ) < 1e-4 );
+
+    TreemapFree ( &tm );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestLimits
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: max_rects, max_depth, an empty viewport, a bad top
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestLimits ( void )
+/*--------------------------------------------------------------------------*/
+{
+    TREEMAP     tm;
+    TM_TREE     view;
+    uint32_t    i;
+
+    TreeRandom ( 10000, 8 );
+    TreeView ( &view );
+    TreemapInit ( &tm, &view );
+
+    tm.max_rects = 50;
+
+    CHECK ( !TreemapLayout ( &tm, 0, 0.0f, 0.0f, 1000.0f, 1000.0f ) );
+    CHECK ( tm.cut && tm.count == 50 );
+
+    tm.max_rects = 1000000;
+    tm.max_depth = 1;
+
+    CHECK ( TreemapLayout ( &tm, 0, 0.0f, 0.0f, 1000.0f, 1000.0f ) );
+    CHECK ( !tm.cut );
+
+    for ( i = 0; i < tm.count; i++ )
+        CHECK ( tm.rects[i].depth <= 1 );
+
+    CHECK ( TreemapLayout ( &tm, 0, 0.0f, 0.0f, 0.0f, 100.0f ) );
+    CHECK ( tm.count == 0 );
+    CHECK ( !TreemapLayout ( &tm, gT.count, 0.0f, 0.0f, 10.0f, 10.0f ) );
+    CHECK ( !TreemapLayout ( NULL, 0, 0.0f, 0.0f, 10.0f, 10.0f ) );
+
+    TreemapFree ( &tm );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestHit
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the innermost box under a point, none outside
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestHit ( void )
+/*--------------------------------------------------------------------------*/
+{
+    TREEMAP         tm;
+    TM_TREE         view;
+    const TM_RECT   * r, * q;
+    uint32_t        i;
+    float           x, y;
+
+    TreeRandom ( 5000, 6 );
+    TreeView ( &view );
+    TreemapInit ( &tm, &view );
+
+    CHECK ( TreemapLayout ( &tm, 0, 0.0f, 0.0f, 800.0f, 600.0f ) );
+    CHECK ( TreemapHit ( &tm, -1.0f, 5.0f ) == NULL );
+    CHECK ( TreemapHit ( &tm, 5.0f, 600.0f ) == NULL );
+
+    for ( i = 0; i < 1000; i++ )
+    {
+        x = (float)Rand ( 8000 ) / 10.0f;
+        y = (float)Rand ( 6000 ) / 10.0f;
+        r = TreemapHit ( &tm, x, y );
+
+        CHECK ( r != NULL );
+
+        if ( r == NULL )
+            continue;
+
+        CHECK ( x >= r->x && x < r->x + r->w && y >= r->y &&
+            y < r->y + r->h );
+
+        // the others holding it are the folders it's in
+        for ( q = tm.rects; q < r; q++ )
+            if ( x >= q->x && x < q->x + q->w && y >= q->y &&
+                    y < q->y + q->h )
+                CHECK ( q->kind == TM_FOLDER && q->depth < r->depth );
+    }
+
+    TreemapFree ( &tm );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Check
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: int ok             : what came out
+//    Param.    2: const char * what  : the check, as written
+//    Param.    3: int line           : where
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: only the first few failures are told, they come in
+//                 heaps from inside loops
+/*--------------------------------------------------------------------@@-@@-*/
+static void Check ( int ok, const char * what, int line )
+/*--------------------------------------------------------------------------*/
+{
+    if ( ok )
+        return;
+
+    if ( gFailed++ < 20 )
+        fprintf ( stderr, "treemap_test.c:%d: %s\n", line, what );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Rand
+/*--------------------------------------------------------------------------*/
+//           Type: static uint32_t
+//    Param.    1: uint32_t n : bound
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: 0 to n - 1, the same on every run and platform
+/*--------------------------------------------------------------------@@-@@-*/
+static uint32_t Rand ( uint32_t n )
+/*--------------------------------------------------------------------------*/
+{
+    gSeed = gSeed * 1664525u + 1013904223u;
+
+    return (uint32_t)( ( (uint64_t)( gSeed >> 8 ) * n ) >> 24 );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TreeFlat
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const int64_t * sizes : subfolders of the root
+//    Param.    2: uint32_t n            : how many
+//    Param.    3: int64_t own           : the root's files
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: a root with n subfolders, no deeper
+/*--------------------------------------------------------------------@@-@@-*/
+static void TreeFlat ( const int64_t * sizes, uint32_t n, int64_t own )
+/*--------------------------------------------------------------------------*/
+{
+    uint32_t i;
+
+    memset ( &gT, 0, sizeof ( gT ) );
+
+    gT.count        = n + 1;
+    gT.own[0]       = own;
+    gT.size[0]      = own;
+    gT.first[0]     = 1;
+    gT.nchild[0]    = n;
+    gT.parent[0]    = (uint32_t)-1;
+
+    for ( i = 1; i <= n; i++ )
+    {
+        gT.size[i]      = sizes[i-1];
+        gT.own[i]       = sizes[i-1];
+        gT.parent[i]    = 0;
+        gT.size[0]      += sizes[i-1];
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TreeRandom
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: uint32_t count  : folders
+//    Param.    2: uint32_t fanout : subfolders a folder has, at most
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: folders numbered level by level like a walk does, each
+//                 with some files or none, sizes summed up from below
+/*--------------------------------------------------------------------@@-@@-*/
+static void TreeRandom ( uint32_t count, uint32_t fanout )
+/*--------------------------------------------------------------------------*/
+{
+    uint32_t i, n;
+
+    memset ( &gT, 0, sizeof ( gT ) );
+
+    gT.count        = 1;
+    gT.parent[0]    = (uint32_t)-1;
+
+    for ( i = 0; i < gT.count && gT.count < count; i++ )
+    {
+        n = Rand ( fanout + 1 );
+
+        // don't let the tree end early
+        if ( n == 0 && i + 1 == gT.count )
+            n = 1;
+
+        if ( n > count - gT.count )
+            n = count - gT.count;
+
+        gT.first[i]     = gT.count;
+        gT.nchild[i]    = n;
+
+        while ( n-- )
+            gT.parent[gT.count++] = i;
+    }
+
+    for ( i = 0; i < gT.count; i++ )
+    {
+        gT.own[i]   = ( Rand ( 4 ) == 0 ) ? 0 : 1 + Rand ( 1u << 24 );
+        gT.size[i]  = gT.own[i];
+    }
+
+    // children come after their parent, so from the end up it adds up
+    for ( i = gT.count; --i > 0; )
+        gT.size[gT.parent[i]] += gT.size[i];
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TreeView
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: TM_TREE * view : receives gT's arrays
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static void TreeView ( TM_TREE * view )
+/*--------------------------------------------------------------------------*/
+{
+    view->size      = gT.size;
+    view->own       = gT.own;
+    view->first     = gT.first;
+    view->nchild    = gT.nchild;
+    view->count     = gT.count;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Inside
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const TM_RECT * in  : box
+//    Param.    2: const TM_RECT * out : box it should be in
+//    Param.    3: float pad           : kept free inside out
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+static int Inside ( const TM_RECT * in, const TM_RECT * out, float pad )
+/*--------------------------------------------------------------------------*/
+{
+    return in->x >= out->x + pad - EPS && in->y >= out->y + pad - EPS &&
+        in->x + in->w <= out->x + out->w - pad + EPS &&
+        in->y + in->h <= out->y + out->h - pad + EPS;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Overlap
+/*--------------------------------------------------------------------------*/
+//           Type: static int
+//    Param.    1: const TM_RECT * a : box
+//    Param.    2: const TM_RECT * b : another
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: more than rounding in common
+/*--------------------------------------------------------------------@@-@@-*/
+static int Overlap ( const TM_RECT * a, const TM_RECT * b )
+/*--------------------------------------------------------------------------*/
+{
+    double w, h;
+
+    w = fmin ( a->x + a->w, b->x + b->w ) - fmax ( a->x, b->x );
+    h = fmin ( a->y + a->h, b->y + b->h ) - fmax ( a->y, b->y );
+
+    return w > EPS && h > EPS;
+}
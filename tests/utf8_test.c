@@ -0,0 +1,304 @@
+
+// utf8_test.c - engine/utf8.c against a plain one char at a time encoder:
+// every code point, every surrogate, every ASCII char in every lane of
+// the four chars at a time path, in every mode. Exits with 1 if any
+// check fails.
+
+#include "../engine/utf8.h"
+#include <stdio.h>
+#include <string.h>
+
+#define WINDOW          12      // chars around what's tested
+#define MODES           4
+
+static int          gFailed;
+static unsigned     gChecked;
+
+static void         Check           ( const uint16_t * s, size_t len,
+                                        unsigned mode, const char * what );
+static size_t       Reference       ( const uint16_t * s, size_t len,
+                                        char * out, unsigned mode );
+static void         TestCodePoints  ( void );
+static void         TestSurrogates  ( void );
+static void         TestLanes       ( void );
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: main
+/*--------------------------------------------------------------------------*/
+//           Type: int
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: <lol>
+/*--------------------------------------------------------------------@@-@@-*/
+int main ( void )
+/*--------------------------------------------------------------------------*/
+{
+    TestCodePoints();
+    TestSurrogates();
+    TestLanes();
+
+    printf ( "utf8: %u strings, %s\n", gChecked, gFailed ? "FAILED" : "ok" );
+
+    return gFailed ? 1 : 0;
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestCodePoints
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: each code point, lone surrogates included, alone and at
+//                 each place in a run of ASCII, from each alignment
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestCodePoints ( void )
+/*--------------------------------------------------------------------------*/
+{
+    uint16_t    buf[WINDOW + 8], unit[2];
+    uint32_t    c;
+    size_t      n, at, i;
+    unsigned    mode;
+
+    for ( c = 0; c <= 0x10FFFF; c++ )
+    {
+        if ( c < 0x10000 )
+        {
+            unit[0] = (uint16_t)c;
+            n       = 1;
+        }
+        else
+        {
+            unit[0] = (uint16_t)( 0xD800 + ( ( c - 0x10000 ) >> 10 ) );
+            unit[1] = (uint16_t)( 0xDC00 + ( ( c - 0x10000 ) & 0x3FF ) );
+            n       = 2;
+        }
+
+        for ( mode = 0; mode < MODES; mode++ )
+        {
+            Check ( unit, n, mode, "alone" );
+
+            // the planes above the first only in one place, for time
+            for ( at = 0; at < 8 && ( at == 0 || c < 0x10000 ); at++ )
+            {
+                for ( i = 0; i < WINDOW; i++ )
+                    buf[i] = (uint16_t)( 'a' + i );
+
+                memcpy ( buf + at, unit, n * sizeof ( uint16_t ) );
+
+                Check ( buf + ( at & 3 ), WINDOW - ( at & 3 ), mode,
+                    "in ASCII" );
+            }
+        }
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestSurrogates
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: every pair of surrogates, in both orders, and a high
+//                 one cut off by the end of the text or followed by
+//                 something else
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestSurrogates ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static const uint16_t after[] = { 'x', '"', 0x7FF, 0xE000, 0xFFFF,
+                                        0xD800, 0xDBFF };
+    uint16_t    s[6];
+    uint32_t    h, l;
+    size_t      k;
+
+    for ( h = 0xD800; h <= 0xDFFF; h++ )
+        for ( l = 0xD800; l <= 0xDFFF; l++ )
+        {
+            s[0] = 'a';
+            s[1] = (uint16_t)h;
+            s[2] = (uint16_t)l;
+            s[3] = 'b';
+
+            Check ( s, 4, UTF8_PLAIN, "two surrogates" );
+        }
+
+    for ( h = 0xD800; h <= 0xDFFF; h++ )
+    {
+        s[0] = (uint16_t)h;
+        Check ( s, 1, UTF8_JSON, "cut off" );
+
+        for ( k = 0; k < sizeof ( after ) / sizeof ( after[0] ); k++ )
+        {
+            s[1] = after[k];
+            s[2] = 'z';
+            Check ( s, 3, UTF8_JSON, "then something else" );
+            Check ( s, 2, UTF8_CSV, "then something else" );
+        }
+    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: TestLanes
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: void :
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the four at a time test borrows from lane to lane, so
+//                 every ASCII pair in every two lanes, the others filled
+//                 with each of a few chars near the ones escaped
+/*--------------------------------------------------------------------@@-@@-*/
+static void TestLanes ( void )
+/*--------------------------------------------------------------------------*/
+{
+    static const uint16_t fill[] = { 0, 0x1F, 0x20, 0x21, 0x22, 0x23,
+                                        0x5B, 0x5C, 0x5D, 0x7F };
+    uint16_t    s[8];
+    uint32_t    x, y;
+    size_t      p, q, f, i;
+    unsigned    mode;
+
+    for ( p = 0; p < 4; p++ )
+        for ( q = p + 1; q < 4; q++ )
+            for ( f = 0; f < sizeof ( fill ) / sizeof ( fill[0] ); f++ )
+                for ( x = 0; x < 0x80; x++ )
+                    for ( y = 0; y < 0x80; y++ )
+                    {
+                        for ( i = 0; i < 8; i++ )
+                            s[i] = fill[f];
+
+                        s[p]        = (uint16_t)x;
+                        s[q]        = (uint16_t)y;
+                        s[4 + p]    = (uint16_t)y;
+
+                        for ( mode = 0; mode < MODES; mode++ )
+                            Check ( s, 8, mode, "lanes" );
+                    }
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Check
+/*--------------------------------------------------------------------------*/
+//           Type: static void
+//    Param.    1: const uint16_t * s : text
+//    Param.    2: size_t len         : its length
+//    Param.    3: unsigned mode      : UTF8_xxx
+//    Param.    4: const char * what  : for the message
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: the same bytes as the reference, and no more than
+//                 UTF8_MAX; the first few failures are told
+/*--------------------------------------------------------------------@@-@@-*/
+static void Check ( const uint16_t * s, size_t len, unsigned mode,
+    const char * what )
+/*--------------------------------------------------------------------------*/
+{
+    char    got[UTF8_MAX ( 64 ) + 8], want[UTF8_MAX ( 64 )];
+    size_t  n, m, i;
+
+    memset ( got, 0x55, sizeof ( got ) );
+
+    n = Utf8Encode ( s, len, got, mode );
+    m = Reference ( s, len, want, mode );
+
+    gChecked++;
+
+    if ( n == m && n <= UTF8_MAX ( len ) && memcmp ( got, want, n ) == 0 &&
+            got[n] == 0x55 )
+        return;
+
+    if ( gFailed++ >= 10 )
+        return;
+
+    fprintf ( stderr, "%s, mode %u:", what, mode );
+
+    for ( i = 0; i < len; i++ )
+        fprintf ( stderr, " %04X", s[i] );
+
+    fprintf ( stderr, "\n  got  %u bytes:", (unsigned)n );
+
+    for ( i = 0; i < n && i < 64; i++ )
+        fprintf ( stderr, " %02X", (unsigned char)got[i] );
+
+    fprintf ( stderr, "\n  want %u bytes:", (unsigned)m );
+
+    for ( i = 0; i < m; i++ )
+        fprintf ( stderr, " %02X", (unsigned char)want[i] );
+
+    fprintf ( stderr, "\n" );
+}
+
+/*-@@+@@--------------------------------------------------------------------*/
+//       Function: Reference
+/*--------------------------------------------------------------------------*/
+//           Type: static size_t
+//    Param.    1: const uint16_t * s : text
+//    Param.    2: size_t len         : its length
+//    Param.    3: char * out         : receives the UTF-8
+//    Param.    4: unsigned mode      : UTF8_xxx
+/*--------------------------------------------------------------------------*/
+//         AUTHOR: Adrian Petrila, YO3GFH
+//           DATE: 19.10.2026
+//    DESCRIPTION: what Utf8Encode should give, the slow obvious way:
+//                 decode a code point, a lone surrogate as U+FFFD,
+//                 escape it as the mode wants, encode it
+/*--------------------------------------------------------------------@@-@@-*/
+static size_t Reference ( const uint16_t * s, size_t len, char * out,
+    unsigned mode )
+/*--------------------------------------------------------------------------*/
+{
+    uint32_t    c;
+    size_t      i, o;
+
+    for ( i = 0, o = 0; i < len; i++ )
+    {
+        c = s[i];
+
+        if ( c >= 0xD800 && c <= 0xDBFF && i + 1 < len &&
+                s[i+1] >= 0xDC00 && s[i+1] <= 0xDFFF )
+        {
+            c = 0x10000 + ( ( c - 0xD800 ) << 10 ) + ( s[++i] - 0xDC00 );
+        }
+        else if ( c >= 0xD800 && c <= 0xDFFF )
+            c = 0xFFFD;
+
+        if ( mode == UTF8_CSV && c == '"' )
+            o += (size_t)sprintf ( out + o, "\"\"" );
+        else if ( mode == UTF8_TSV && c < 0x20 )
+            out[o++] = ' ';
+        else if ( mode == UTF8_JSON && ( c == '"' || c == '\\' ) )
+            o += (size_t)sprintf ( out + o, "\\%c", (char)c );
+        else if ( mode == UTF8_JSON && c < 0x20 )
+            o += (size_t)sprintf ( out + o, "\\u%04x", (unsigned)c );
+        else if ( c < 0x80 )
+            out[o++] = (char)c;
+        else if ( c < 0x800 )
+        {
+            out[o++] = (char)( 0xC0 | ( c >> 6 ) );
+            out[o++] = (char)( 0x80 | ( c & 0x3F ) );
+        }
+        else if ( c < 0x10000 )
+        {
+            out[o++] = (char)( 0xE0 | ( c >> 12 ) );
+            out[o++] = (char)( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+            out[o++] = (char)( 0x80 | ( c & 0x3F ) );
+        }
+        else
+        {
+            out[o++] = (char)( 0xF0 | ( c >> 18 ) );
+            out[o++] = (char)( 0x80 | ( ( c >> 12 ) & 0x3F ) );
+            out[o++] = (char)( 0x80 | ( ( c >> 6 ) & 0x3F ) );
+            out[o++] = (char)( 0x80 | ( c & 0x3F ) );
+        }
+    }
+
+    return o;
+}